@@ -22,6 +22,27 @@ C_MODE_START
 
 uint32 murmur3_32(const uchar * key, size_t len, uint32 seed);
 
+/* Size of digest produced by 128-bit version of MurmurHash3. */
+#define MURMUR3_128_HASH_SIZE 16
+
+/*
+  State of incremental 128-bit MurmurHash3 (x64 variant) computation.
+  Allows to hash data which is not available as one contiguous buffer
+  (e.g. row fields) without copying it first.
+*/
+typedef struct st_murmur3_128_ctx
+{
+  ulonglong h1, h2;
+  uchar     tail[16];   /* bytes which do not yet form full block */
+  uint      tail_len;
+  ulonglong total_len;
+} murmur3_128_ctx;
+
+void murmur3_128_init(murmur3_128_ctx *ctx, uint32 seed);
+void murmur3_128_update(murmur3_128_ctx *ctx, const uchar *key, size_t len);
+void murmur3_128_final(murmur3_128_ctx *ctx, uchar *digest);
+void murmur3_128(const uchar *key, size_t len, uint32 seed, uchar *digest);
+
 C_MODE_END
 
 #endif /* MY_MURMUR3_INCLUDED */
@@ -20,6 +20,7 @@
 */
 
 #include <my_murmur3.h>
+#include <string.h>
 
 
 /*
@@ -132,3 +133,209 @@ uint32 murmur3_32(const uchar *key, size_t len, uint32 seed)
 
   return h1;
 }
+
+
+/*
+  128-bit version of MurmurHash3 optimized for x64 platforms.
+*/
+
+static inline ulonglong rotl64(ulonglong x, char r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+
+static inline ulonglong fmix64(ulonglong k)
+{
+  k^= k >> 33;
+  k*= 0xff51afd7ed558ccdULL;
+  k^= k >> 33;
+  k*= 0xc4ceb9fe1a85ec53ULL;
+  k^= k >> 33;
+  return k;
+}
+
+
+static const ulonglong murmur3_128_c1= 0x87c37b91114253d5ULL;
+static const ulonglong murmur3_128_c2= 0x4cf5ad432745937fULL;
+
+
+static inline void murmur3_128_block(murmur3_128_ctx *ctx, const uchar *data)
+{
+  ulonglong k1= uint8korr(data);
+  ulonglong k2= uint8korr(data + 8);
+
+  k1*= murmur3_128_c1;
+  k1= rotl64(k1, 31);
+  k1*= murmur3_128_c2;
+  ctx->h1^= k1;
+
+  ctx->h1= rotl64(ctx->h1, 27);
+  ctx->h1+= ctx->h2;
+  ctx->h1= ctx->h1 * 5 + 0x52dce729;
+
+  k2*= murmur3_128_c2;
+  k2= rotl64(k2, 33);
+  k2*= murmur3_128_c1;
+  ctx->h2^= k2;
+
+  ctx->h2= rotl64(ctx->h2, 31);
+  ctx->h2+= ctx->h1;
+  ctx->h2= ctx->h2 * 5 + 0x38495ab5;
+}
+
+
+/**
+  Initialize context for incremental computation of 128-bit MurmurHash3.
+
+  @param ctx   Context to initialize.
+  @param seed  Seed for hash computation.
+*/
+
+void murmur3_128_init(murmur3_128_ctx *ctx, uint32 seed)
+{
+  ctx->h1= seed;
+  ctx->h2= seed;
+  ctx->tail_len= 0;
+  ctx->total_len= 0;
+}
+
+
+/**
+  Feed next portion of key into 128-bit MurmurHash3 computation.
+
+  Result of hashing key in several portions is the same as of hashing
+  it in one go.
+
+  @param ctx   Context of hash computation.
+  @param key   Next portion of key.
+  @param len   Length of the portion.
+*/
+
+void murmur3_128_update(murmur3_128_ctx *ctx, const uchar *key, size_t len)
+{
+  ctx->total_len+= len;
+
+  /* Complete block left incomplete by previous call, if any. */
+  if (ctx->tail_len)
+  {
+    size_t fill= MY_MIN(len, 16 - (size_t) ctx->tail_len);
+    memcpy(ctx->tail + ctx->tail_len, key, fill);
+    ctx->tail_len+= (uint) fill;
+    key+= fill;
+    len-= fill;
+    if (ctx->tail_len < 16)
+      return;
+    murmur3_128_block(ctx, ctx->tail);
+    ctx->tail_len= 0;
+  }
+
+  /* Body: process all 128-bit blocks directly from the key. */
+  const uchar *end= key + (len - len % 16);
+  for (; key != end; key+= 16)
+    murmur3_128_block(ctx, key);
+
+  /* Stash remaining len % 16 bytes until more data or finalization. */
+  ctx->tail_len= (uint) (len % 16);
+  memcpy(ctx->tail, key, ctx->tail_len);
+}
+
+
+/**
+  Finish 128-bit MurmurHash3 computation.
+
+  @param ctx     Context of hash computation.
+  @param digest  Buffer of MURMUR3_128_HASH_SIZE bytes for the result,
+                 stored as two little-endian 64-bit halves.
+*/
+
+void murmur3_128_final(murmur3_128_ctx *ctx, uchar *digest)
+{
+  const uchar *tail= ctx->tail;
+  ulonglong h1= ctx->h1;
+  ulonglong h2= ctx->h2;
+  ulonglong k1= 0;
+  ulonglong k2= 0;
+
+  /* Tail: handle remaining len % 16 bytes. */
+
+  switch (ctx->tail_len)
+  {
+  case 15: k2^= static_cast<ulonglong>(tail[14]) << 48;
+    /* Fall through. */
+  case 14: k2^= static_cast<ulonglong>(tail[13]) << 40;
+    /* Fall through. */
+  case 13: k2^= static_cast<ulonglong>(tail[12]) << 32;
+    /* Fall through. */
+  case 12: k2^= static_cast<ulonglong>(tail[11]) << 24;
+    /* Fall through. */
+  case 11: k2^= static_cast<ulonglong>(tail[10]) << 16;
+    /* Fall through. */
+  case 10: k2^= static_cast<ulonglong>(tail[9]) << 8;
+    /* Fall through. */
+  case 9:
+    k2^= static_cast<ulonglong>(tail[8]);
+    k2*= murmur3_128_c2;
+    k2= rotl64(k2, 33);
+    k2*= murmur3_128_c1;
+    h2^= k2;
+    /* Fall through. */
+  case 8: k1^= static_cast<ulonglong>(tail[7]) << 56;
+    /* Fall through. */
+  case 7: k1^= static_cast<ulonglong>(tail[6]) << 48;
+    /* Fall through. */
+  case 6: k1^= static_cast<ulonglong>(tail[5]) << 40;
+    /* Fall through. */
+  case 5: k1^= static_cast<ulonglong>(tail[4]) << 32;
+    /* Fall through. */
+  case 4: k1^= static_cast<ulonglong>(tail[3]) << 24;
+    /* Fall through. */
+  case 3: k1^= static_cast<ulonglong>(tail[2]) << 16;
+    /* Fall through. */
+  case 2: k1^= static_cast<ulonglong>(tail[1]) << 8;
+    /* Fall through. */
+  case 1:
+    k1^= static_cast<ulonglong>(tail[0]);
+    k1*= murmur3_128_c1;
+    k1= rotl64(k1, 31);
+    k1*= murmur3_128_c2;
+    h1^= k1;
+  };
+
+  /* Finalization mix. */
+
+  h1^= ctx->total_len;
+  h2^= ctx->total_len;
+
+  h1+= h2;
+  h2+= h1;
+
+  h1= fmix64(h1);
+  h2= fmix64(h2);
+
+  h1+= h2;
+  h2+= h1;
+
+  int8store(digest, h1);
+  int8store(digest + 8, h2);
+}
+
+
+/**
+  Compute 128-bit version of MurmurHash3 (x64 variant) for the key.
+
+  @param key     Key for which hash value to be computed.
+  @param len     Key length.
+  @param seed    Seed for hash computation.
+  @param digest  Buffer of MURMUR3_128_HASH_SIZE bytes for the result.
+
+  @note The same warning about "hash DoS" as for murmur3_32() applies.
+*/
+
+void murmur3_128(const uchar *key, size_t len, uint32 seed, uchar *digest)
+{
+  murmur3_128_ctx ctx;
+  murmur3_128_init(&ctx, seed);
+  murmur3_128_update(&ctx, key, len);
+  murmur3_128_final(&ctx, digest);
+}
@@ -0,0 +1,57 @@
+/* Copyright (C) 2015 Codership Oy <info@codership.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA */
+
+/*
+  INFORMATION_SCHEMA views into wsrep state of the server.
+
+  WSREP_HOT_KEYS lists certification keys most often written by local
+  transactions (wsrep_hot_key_sampling) with estimated write and
+  conflict counts. Tables are filled by the server.
+*/
+
+#include "mysql_version.h"
+#include <my_global.h>
+#include <mysql/plugin.h>
+#include "table.h"          // ST_SCHEMA_TABLE
+#include "wsrep_hotkey.h"
+
+static struct st_mysql_information_schema wsrep_info_view=
+{ MYSQL_INFORMATION_SCHEMA_INTERFACE_VERSION };
+
+static int wsrep_hot_keys_init(void *p)
+{
+  ST_SCHEMA_TABLE *schema= (ST_SCHEMA_TABLE*) p;
+  schema->fields_info= wsrep_hot_keys_fields;
+  schema->fill_table= wsrep_fill_hot_keys;
+  return 0;
+}
+
+mysql_declare_plugin(wsrep_info)
+{
+  MYSQL_INFORMATION_SCHEMA_PLUGIN,
+  &wsrep_info_view,
+  "WSREP_HOT_KEYS",
+  "Codership Oy",
+  "Most written wsrep certification keys",
+  PLUGIN_LICENSE_GPL,
+  wsrep_hot_keys_init,
+  NULL,
+  0x0100,
+  NULL,
+  NULL,
+  NULL,
+  0
+}
+mysql_declare_plugin_end;
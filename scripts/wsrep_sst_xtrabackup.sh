@@ -619,11 +619,11 @@ then
     if [ ! -r "${DATA}/${IST_FILE}" ]
     then
         wsrep_log_info "Proceeding with SST"
-        wsrep_log_info "Removing existing ib_logfile files"
+        wsrep_log_info "Removing existing ib_logfile and ib_dblwr files"
         if [[ $incremental -ne 1 ]];then 
-            rm -f ${DATA}/ib_logfile*
+            rm -f ${DATA}/ib_logfile* ${DATA}/ib_dblwr_*
         else
-            rm -f ${BDATA}/ib_logfile*
+            rm -f ${BDATA}/ib_logfile* ${BDATA}/ib_dblwr_*
         fi
 
         get_proc
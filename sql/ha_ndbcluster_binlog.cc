@@ -898,7 +898,7 @@ static void ndbcluster_reset_slave(THD *thd)
   ndb data to be logged has made it to the binary log to get a deterministic
   behavior on the rotation of the log.
  */
-static bool ndbcluster_flush_logs(handlerton *hton)
+static bool ndbcluster_flush_logs(handlerton *hton, bool group_flush)
 {
   ndbcluster_binlog_wait(current_thd);
   return FALSE;
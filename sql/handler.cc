@@ -2295,24 +2295,33 @@ static my_bool flush_handlerton(THD *thd, plugin_ref plugin,
 {
   handlerton *hton= plugin_data(plugin, handlerton *);
   if (hton->state == SHOW_OPTION_YES && hton->flush_logs && 
-      hton->flush_logs(hton))
+      hton->flush_logs(hton, *(bool*) arg))
     return TRUE;
   return FALSE;
 }
 
 
-bool ha_flush_logs(handlerton *db_type)
+/**
+  Flush the logs of one or all storage engines.
+
+  @param db_type      engine to flush, NULL for all engines
+  @param group_flush  true if the flush makes a group of commits durable
+                      on behalf of the committing transactions. The engine
+                      then flushes only as much as a regular commit would
+                      have done with its configured durability.
+*/
+bool ha_flush_logs(handlerton *db_type, bool group_flush)
 {
   if (db_type == NULL)
   {
     if (plugin_foreach(NULL, flush_handlerton,
-                          MYSQL_STORAGE_ENGINE_PLUGIN, 0))
+                          MYSQL_STORAGE_ENGINE_PLUGIN, &group_flush))
       return TRUE;
   }
   else
   {
     if (db_type->state != SHOW_OPTION_YES ||
-        (db_type->flush_logs && db_type->flush_logs(db_type)))
+        (db_type->flush_logs && db_type->flush_logs(db_type, group_flush)))
       return TRUE;
   }
   return FALSE;
@@ -77,6 +77,9 @@
 #include "wsrep_var.h"
 #include "wsrep_thd.h"
 #include "wsrep_sst.h"
+#include "wsrep_ws_log.h"
+#include "wsrep_hotkey.h"
+#include "wsrep_applier.h"
 #endif
 #include "sql_callback.h"
 #include "opt_trace_context.h"
@@ -775,11 +778,18 @@ mysql_mutex_t LOCK_wsrep_sst_init;
 mysql_cond_t  COND_wsrep_sst_init;
 mysql_mutex_t LOCK_wsrep_rollback;
 mysql_cond_t  COND_wsrep_rollback;
-wsrep_aborting_thd_t wsrep_aborting_thd= NULL;
 mysql_mutex_t LOCK_wsrep_replaying;
 mysql_cond_t  COND_wsrep_replaying;
 mysql_mutex_t LOCK_wsrep_slave_threads;
 mysql_mutex_t LOCK_wsrep_desync;
+mysql_mutex_t LOCK_wsrep_group_commit;
+mysql_cond_t  COND_wsrep_group_commit;
+mysql_mutex_t LOCK_wsrep_sync_wait;
+mysql_cond_t  COND_wsrep_sync_wait;
+mysql_mutex_t LOCK_wsrep_nbo;
+mysql_cond_t  COND_wsrep_nbo;
+mysql_mutex_t LOCK_wsrep_hot_key;
+mysql_cond_t  COND_wsrep_hot_key;
 int wsrep_replaying= 0;
 ulong wsrep_running_threads = 0; // # of currently running wsrep threads
 static void wsrep_close_threads(THD* thd);
@@ -2140,6 +2150,14 @@ static void clean_up_mutexes()
   (void) mysql_cond_destroy(&COND_wsrep_replaying);
   (void) mysql_mutex_destroy(&LOCK_wsrep_slave_threads);
   (void) mysql_mutex_destroy(&LOCK_wsrep_desync);
+  (void) mysql_mutex_destroy(&LOCK_wsrep_group_commit);
+  (void) mysql_cond_destroy(&COND_wsrep_group_commit);
+  (void) mysql_mutex_destroy(&LOCK_wsrep_sync_wait);
+  (void) mysql_cond_destroy(&COND_wsrep_sync_wait);
+  (void) mysql_mutex_destroy(&LOCK_wsrep_nbo);
+  (void) mysql_cond_destroy(&COND_wsrep_nbo);
+  (void) mysql_mutex_destroy(&LOCK_wsrep_hot_key);
+  (void) mysql_cond_destroy(&COND_wsrep_hot_key);
 #endif
   mysql_cond_destroy(&COND_connection_count);
 }
@@ -4452,6 +4470,17 @@ static int init_thread_environment()
                    &LOCK_wsrep_slave_threads, MY_MUTEX_INIT_FAST);
   mysql_mutex_init(key_LOCK_wsrep_desync,
                    &LOCK_wsrep_desync, MY_MUTEX_INIT_FAST);
+  mysql_mutex_init(key_LOCK_wsrep_group_commit,
+                   &LOCK_wsrep_group_commit, MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_wsrep_group_commit, &COND_wsrep_group_commit, NULL);
+  mysql_mutex_init(key_LOCK_wsrep_sync_wait,
+                   &LOCK_wsrep_sync_wait, MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_wsrep_sync_wait, &COND_wsrep_sync_wait, NULL);
+  mysql_mutex_init(key_LOCK_wsrep_nbo, &LOCK_wsrep_nbo, MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_wsrep_nbo, &COND_wsrep_nbo, NULL);
+  mysql_mutex_init(key_LOCK_wsrep_hot_key, &LOCK_wsrep_hot_key,
+                   MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_wsrep_hot_key, &COND_wsrep_hot_key, NULL);
 #endif
   return 0;
 }
@@ -5752,10 +5781,8 @@ void wsrep_wait_appliers_close(THD *thd)
 {
   /* Wait for wsrep appliers to gracefully exit */
   mysql_mutex_lock(&LOCK_thread_count);
-  while (have_wsrep_appliers(thd) > 1)
-  // 1 is for rollbacker thread which needs to be killed explicitly.
-  // This gotta be fixed in a more elegant manner if we gonna have arbitrary
-  // number of non-applier wsrep threads.
+  while (have_wsrep_appliers(thd) > wsrep_rollbacker_count + wsrep_nbo_workers)
+  // rollbacker and NBO worker threads need to be killed explicitly.
   {
     mysql_cond_wait(&COND_thread_count,&LOCK_thread_count);
     DBUG_PRINT("quit",("One applier died (count=%u)", get_thread_count()));
@@ -6360,6 +6387,9 @@ int mysqld_main(int argc, char **argv)
   {
     wsrep_SE_initialized();
 
+    /*! before anything is applied, complete NBOs interrupted by a crash */
+    wsrep_nbo_recover();
+
     if (wsrep_before_SE())
     {
       /*! in case of no SST wsrep waits in view handler callback */
@@ -8828,6 +8858,13 @@ SHOW_VAR status_vars[]= {
   {"wsrep_cluster_size",       (char*) &wsrep_cluster_size,      SHOW_LONG_NOFLUSH},
   {"wsrep_local_index",        (char*) &wsrep_local_index,       SHOW_LONG_NOFLUSH},
   {"wsrep_local_bf_aborts",    (char*) &wsrep_show_bf_aborts,    SHOW_FUNC},
+  {"wsrep_local_rollback_queue",(char*) &wsrep_rollback_queue_len, SHOW_LONG_NOFLUSH},
+  {"wsrep_local_rollback_latency",(char*) &wsrep_show_rollback_latency, SHOW_FUNC},
+  {"wsrep_local_sync_waits",   (char*) &wsrep_local_sync_waits,  SHOW_LONGLONG},
+  {"wsrep_local_sync_wait_rounds",(char*) &wsrep_local_sync_wait_rounds, SHOW_LONGLONG},
+  {"wsrep_local_hot_key_delays",(char*) &wsrep_show_hot_key_delays, SHOW_FUNC},
+  {"wsrep_ws_log_first",       (char*) &wsrep_show_ws_log_first, SHOW_FUNC},
+  {"wsrep_ws_log_last",        (char*) &wsrep_show_ws_log_last,  SHOW_FUNC},
   {"wsrep_provider_name",      (char*) &wsrep_provider_name,     SHOW_CHAR_PTR},
   {"wsrep_provider_version",   (char*) &wsrep_provider_version,  SHOW_CHAR_PTR},
   {"wsrep_provider_vendor",    (char*) &wsrep_provider_vendor,   SHOW_CHAR_PTR},
@@ -10481,7 +10518,10 @@ PSI_mutex_key
 PSI_mutex_key key_LOCK_wsrep_rollback, key_LOCK_wsrep_thd, 
   key_LOCK_wsrep_replaying, key_LOCK_wsrep_ready, key_LOCK_wsrep_sst, 
   key_LOCK_wsrep_sst_thread, key_LOCK_wsrep_sst_init, 
-  key_LOCK_wsrep_slave_threads, key_LOCK_wsrep_desync;
+  key_LOCK_wsrep_slave_threads, key_LOCK_wsrep_desync,
+  key_LOCK_wsrep_group_commit, key_LOCK_wsrep_ws_log,
+  key_LOCK_wsrep_ws_log_append,
+  key_LOCK_wsrep_sync_wait, key_LOCK_wsrep_nbo, key_LOCK_wsrep_hot_key;
 #endif
 PSI_mutex_key key_LOCK_thd_remove;
 PSI_mutex_key key_RELAYLOG_LOCK_commit;
@@ -10580,6 +10620,12 @@ static PSI_mutex_info all_server_mutexes[]=
   { &key_LOCK_wsrep_replaying, "LOCK_wsrep_replaying", PSI_FLAG_GLOBAL},
   { &key_LOCK_wsrep_slave_threads, "LOCK_wsrep_slave_threads", PSI_FLAG_GLOBAL},
   { &key_LOCK_wsrep_desync, "LOCK_wsrep_desync", PSI_FLAG_GLOBAL},
+  { &key_LOCK_wsrep_group_commit, "LOCK_wsrep_group_commit", PSI_FLAG_GLOBAL},
+  { &key_LOCK_wsrep_ws_log, "wsp::ws_log::lock_", 0},
+  { &key_LOCK_wsrep_ws_log_append, "wsp::ws_log::append_lock_", 0},
+  { &key_LOCK_wsrep_sync_wait, "LOCK_wsrep_sync_wait", PSI_FLAG_GLOBAL},
+  { &key_LOCK_wsrep_nbo, "LOCK_wsrep_nbo", PSI_FLAG_GLOBAL},
+  { &key_LOCK_wsrep_hot_key, "LOCK_wsrep_hot_key", PSI_FLAG_GLOBAL},
 #endif
   { &key_LOCK_thd_remove, "LOCK_thd_remove", PSI_FLAG_GLOBAL},
   { &key_LOCK_log_throttle_qni, "LOCK_log_throttle_qni", PSI_FLAG_GLOBAL},
@@ -10640,7 +10686,9 @@ PSI_cond_key key_BINLOG_update_cond,
 #ifdef WITH_WSREP
 PSI_cond_key key_COND_wsrep_rollback, key_COND_wsrep_thd, 
   key_COND_wsrep_replaying, key_COND_wsrep_ready, key_COND_wsrep_sst,
-  key_COND_wsrep_sst_init, key_COND_wsrep_sst_thread;
+  key_COND_wsrep_sst_init, key_COND_wsrep_sst_thread,
+  key_COND_wsrep_group_commit, key_COND_wsrep_sync_wait,
+  key_COND_wsrep_nbo, key_COND_wsrep_hot_key;
 
 #endif /* WITH_WSREP */
 PSI_cond_key key_RELAYLOG_update_cond;
@@ -10695,6 +10743,10 @@ static PSI_cond_info all_server_conds[]=
   { &key_COND_wsrep_rollback, "COND_wsrep_rollback", PSI_FLAG_GLOBAL},
   { &key_COND_wsrep_thd, "THD::COND_wsrep_thd", 0},
   { &key_COND_wsrep_replaying, "COND_wsrep_replaying", PSI_FLAG_GLOBAL},
+  { &key_COND_wsrep_group_commit, "COND_wsrep_group_commit", PSI_FLAG_GLOBAL},
+  { &key_COND_wsrep_sync_wait, "COND_wsrep_sync_wait", PSI_FLAG_GLOBAL},
+  { &key_COND_wsrep_nbo, "COND_wsrep_nbo", PSI_FLAG_GLOBAL},
+  { &key_COND_wsrep_hot_key, "COND_wsrep_hot_key", PSI_FLAG_GLOBAL},
 #endif
   { &key_COND_flush_thread_cache, "COND_flush_thread_cache", PSI_FLAG_GLOBAL},
   { &key_gtid_ensure_index_cond, "Gtid_state", PSI_FLAG_GLOBAL},
@@ -10704,6 +10756,12 @@ static PSI_cond_info all_server_conds[]=
 PSI_thread_key key_thread_bootstrap, key_thread_delayed_insert,
   key_thread_handle_manager, key_thread_main,
   key_thread_one_connection, key_thread_signal_hand;
+#ifdef WITH_WSREP
+PSI_thread_key key_thread_wsrep_decode, key_thread_wsrep_group_commit,
+  key_thread_wsrep_sst_joiner,
+  key_thread_wsrep_sst_receiver, key_thread_wsrep_sst_donor,
+  key_thread_wsrep_sst_sender;
+#endif /* WITH_WSREP */
 
 static PSI_thread_info all_server_threads[]=
 {
@@ -10728,7 +10786,15 @@ static PSI_thread_info all_server_threads[]=
   { &key_thread_handle_manager, "manager", PSI_FLAG_GLOBAL},
   { &key_thread_main, "main", PSI_FLAG_GLOBAL},
   { &key_thread_one_connection, "one_connection", 0},
-  { &key_thread_signal_hand, "signal_handler", PSI_FLAG_GLOBAL}
+  { &key_thread_signal_hand, "signal_handler", PSI_FLAG_GLOBAL},
+#ifdef WITH_WSREP
+  { &key_thread_wsrep_decode, "wsrep_decode", 0},
+  { &key_thread_wsrep_group_commit, "wsrep_group_commit", PSI_FLAG_GLOBAL},
+  { &key_thread_wsrep_sst_joiner, "wsrep_sst_joiner", PSI_FLAG_GLOBAL},
+  { &key_thread_wsrep_sst_receiver, "wsrep_sst_receiver", 0},
+  { &key_thread_wsrep_sst_donor, "wsrep_sst_donor", PSI_FLAG_GLOBAL},
+  { &key_thread_wsrep_sst_sender, "wsrep_sst_sender", 0},
+#endif /* WITH_WSREP */
 };
 
 #ifdef HAVE_MMAP
@@ -60,6 +60,7 @@
 #ifdef WITH_WSREP
 #include "wsrep_mysqld.h"
 #include "wsrep_thd.h"
+#include "wsrep_binlog.h"
 #endif
 #include "lock.h"
 #include "global_threads.h"
@@ -1222,6 +1223,13 @@ THD::THD(bool enable_plugins)
   wsrep_affected_rows     = 0;
   wsrep_replicate_GTID    = false;
   wsrep_skip_wsrep_GTID   = false;
+  wsrep_ws_map            = NULL;
+  wsrep_ws_map_len        = 0;
+  wsrep_ws_log_buf        = NULL;
+  wsrep_ws_log_len        = 0;
+  wsrep_nbo               = NULL;
+  wsrep_hot_keys_num      = 0;
+  wsrep_hot_key_appends   = 0;
 #endif
   /* Call to init() below requires fully initialized Open_tables_state. */
   reset_open_tables_state();
@@ -1848,6 +1856,7 @@ void THD::release_resources()
     delete wsrep_rli;
     wsrep_rli = NULL;
   }
+  wsrep_release_cache_map(this);
   wsrep_free_status(this);
 #endif
 }
@@ -85,6 +85,7 @@ void thd_exit_cond(MYSQL_THD thd, const PSI_stage_info *stage,
 
 #ifdef WITH_WSREP
 #include "wsrep_mysqld.h"
+#include "wsrep_hotkey.h"
 struct wsrep_thd_shadow {
   ulonglong            options;
   uint                 server_status;
@@ -3244,6 +3245,15 @@ public:
   ulong                     wsrep_affected_rows;
   bool                      wsrep_replicate_GTID;
   bool                      wsrep_skip_wsrep_GTID;
+  void*                     wsrep_ws_map;     /* mapped spilled trx cache */
+  size_t                    wsrep_ws_map_len; /* passed to provider by ref */
+  const void*               wsrep_ws_log_buf; /* applied ws, to be logged */
+  size_t                    wsrep_ws_log_len; /* at commit */
+  void*                     wsrep_nbo;        /* NBO in progress, if any */
+  /* hashes of first keys written by transaction, see wsrep_hotkey.cc */
+  ulonglong                 wsrep_hot_keys[WSREP_HOT_KEY_TRX_KEYS];
+  uint                      wsrep_hot_keys_num;
+  ulong                     wsrep_hot_key_appends;
 #endif /* WITH_WSREP */
   /**
     Internal parser state.
@@ -4252,6 +4252,8 @@ static Sys_var_tz Sys_time_zone(
 #include "wsrep_var.h"
 #include "wsrep_sst.h"
 #include "wsrep_binlog.h"
+#include "wsrep_ws_log.h"
+#include "wsrep_hotkey.h"
 
 static Sys_var_charptr Sys_wsrep_provider(
        "wsrep_provider", "Path to replication provider library",
@@ -4322,6 +4324,26 @@ static Sys_var_ulong Sys_wsrep_slave_threads(
        ON_CHECK(NULL),
        ON_UPDATE(wsrep_slave_threads_update));
 
+static Sys_var_ulong Sys_wsrep_slave_decode_threads(
+       "wsrep_slave_decode_threads", "Number of helper threads an applier "
+       "uses to decode events of a large write set in parallel "
+       "(0 - applier decodes all events itself)",
+       GLOBAL_VAR(wsrep_slave_decode_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 64), DEFAULT(0), BLOCK_SIZE(1));
+
+static Sys_var_mybool Sys_wsrep_slave_group_commit(
+       "wsrep_slave_group_commit", "Let slave appliers commit without "
+       "flushing the InnoDB redo log in commit order and make a batch of "
+       "committed write sets durable with one flush in background",
+       GLOBAL_VAR(wsrep_slave_group_commit), CMD_LINE(OPT_ARG),
+       DEFAULT(FALSE));
+
+static Sys_var_ulong Sys_wsrep_rollbacker_threads(
+       "wsrep_rollbacker_threads", "Number of threads rolling back "
+       "brute force aborted idle transactions",
+       READ_ONLY GLOBAL_VAR(wsrep_rollbacker_threads), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 64), DEFAULT(1), BLOCK_SIZE(1));
+
 static Sys_var_charptr Sys_wsrep_dbug_option(
        "wsrep_dbug_option", "DBUG options to provider library",
        GLOBAL_VAR(wsrep_dbug_option),CMD_LINE(REQUIRED_ARG),
@@ -4387,12 +4409,47 @@ static Sys_var_charptr Sys_wsrep_sst_donor(
        ON_CHECK(wsrep_sst_donor_check),
        ON_UPDATE(wsrep_sst_donor_update)); 
 
+static Sys_var_ulong Sys_wsrep_sst_native_streams(
+       "wsrep_sst_native_streams", "Number of parallel connections a donor "
+       "uses to stream data files with 'native' state snapshot transfer "
+       "method",
+       GLOBAL_VAR(wsrep_sst_native_streams), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 64), DEFAULT(4), BLOCK_SIZE(1));
+
+static Sys_var_ulong Sys_wsrep_sst_native_timeout(
+       "wsrep_sst_native_timeout", "Seconds a 'native' state snapshot "
+       "transfer peer waits for a connection or for data before it fails "
+       "the transfer",
+       GLOBAL_VAR(wsrep_sst_native_timeout), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(1, 86400), DEFAULT(300), BLOCK_SIZE(1));
+
 static Sys_var_mybool Sys_wsrep_sst_donor_rejects_queries(
        "wsrep_sst_donor_rejects_queries", "Reject client queries "
        "when donating state snapshot transfer", 
        GLOBAL_VAR(wsrep_sst_donor_rejects_queries), 
        CMD_LINE(OPT_ARG), DEFAULT(FALSE));
 
+static Sys_var_ulonglong Sys_wsrep_ws_log_size(
+       "wsrep_ws_log_size", "Size of the on-disk ring log of applied write "
+       "sets kept in the data directory, 0 disables the log",
+       READ_ONLY GLOBAL_VAR(wsrep_ws_log_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, ULONGLONG_MAX), DEFAULT(0), BLOCK_SIZE(1024*1024));
+
+static Sys_var_ulong Sys_wsrep_hot_key_sampling(
+       "wsrep_hot_key_sampling", "Sample one of this many certification "
+       "keys appended by local transactions into the hot key statistics, "
+       "0 disables hot key tracking",
+       GLOBAL_VAR(wsrep_hot_key_sampling), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 1000000), DEFAULT(0), BLOCK_SIZE(1));
+
+static Sys_var_ulong Sys_wsrep_hot_key_throttle(
+       "wsrep_hot_key_throttle", "Maximum time in microseconds a local "
+       "transaction which has written keys with recent certification "
+       "conflicts waits at commit for write sets being applied, "
+       "0 disables throttling",
+       GLOBAL_VAR(wsrep_hot_key_throttle), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 1000000), DEFAULT(0), BLOCK_SIZE(1));
+
 static Sys_var_mybool Sys_wsrep_on (
        "wsrep_on", "To enable wsrep replication ",
        SESSION_VAR(wsrep_on), 
@@ -4416,6 +4473,13 @@ static Sys_var_ulong Sys_wsrep_max_ws_size (
        BLOCK_SIZE(1), NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(wsrep_max_ws_size_update));
 
+static Sys_var_mybool Sys_wsrep_zero_copy_writeset(
+       "wsrep_zero_copy_writeset", "Pass transaction cache pages to "
+       "the provider by reference instead of copying them into a "
+       "temporary write set buffer",
+       GLOBAL_VAR(wsrep_zero_copy_writeset),
+       CMD_LINE(OPT_ARG), DEFAULT(FALSE));
+
 static Sys_var_ulong Sys_wsrep_max_ws_rows (
        "wsrep_max_ws_rows", "Max number of rows in write set",
        GLOBAL_VAR(wsrep_max_ws_rows), CMD_LINE(REQUIRED_ARG),
@@ -4431,6 +4495,15 @@ static Sys_var_mybool Sys_wsrep_certify_nonPK(
        GLOBAL_VAR(wsrep_certify_nonPK), 
        CMD_LINE(OPT_ARG), DEFAULT(TRUE));
 
+static Sys_var_long Sys_wsrep_max_protocol_version(
+       "wsrep_max_protocol_version", "Maximum application protocol version "
+       "to negotiate. Version 4 hashes rows of tables without a primary key "
+       "with MurmurHash3 instead of MD5, set it only when every node of "
+       "the cluster supports it",
+       READ_ONLY GLOBAL_VAR(wsrep_max_protocol_version),
+       CMD_LINE(REQUIRED_ARG), VALID_RANGE(0, 4), DEFAULT(3),
+       BLOCK_SIZE(1));
+
 static Sys_var_mybool Sys_wsrep_causal_reads(
        "wsrep_causal_reads", "(DEPRECATED) setting this variable is equivalent to setting wsrep_sync_wait READ flag",
        SESSION_VAR(wsrep_causal_reads), 
@@ -4448,7 +4521,7 @@ static Sys_var_uint Sys_wsrep_sync_wait(
        NO_MUTEX_GUARD, NOT_IN_BINLOG, ON_CHECK(0),
        ON_UPDATE(wsrep_sync_wait_update));
 
-static const char *wsrep_OSU_method_names[]= { "TOI", "RSU", NullS };
+static const char *wsrep_OSU_method_names[]= { "TOI", "RSU", "NBO", NullS };
 static Sys_var_enum Sys_wsrep_OSU_method(
        "wsrep_OSU_method", "Method for Online Schema Upgrade",
        SESSION_VAR(wsrep_OSU_method), CMD_LINE(OPT_ARG),
@@ -18,6 +18,11 @@
 #include "wsrep_priv.h"
 #include "wsrep_binlog.h" // wsrep_dump_rbr_buf()
 #include "wsrep_xid.h"
+#include "wsrep_ws_log.h"
+#include "wsrep_thd.h"    // wsrep_create_nbo_worker()
+#include "mysqld.h"       // mysql_real_data_home, unireg_abort()
+
+#include <my_dir.h>
 
 #include "log_event.h" // class THD, EVENT_LEN_OFFSET, etc.
 #include "debug_sync.h"
@@ -76,6 +81,220 @@ wsrep_get_apply_format(THD* thd)
   return thd->wsrep_rli->get_rli_description_event();
 }
 
+/*
+  Apply single event to applier THD. Takes ownership of the event.
+
+  @return 0 on success, event apply error on failure or -1 if the applier
+          was BF aborted and its transaction has been rolled back
+*/
+static int wsrep_apply_event(THD* thd, Log_event* ev, int* event)
+{
+  switch (ev->get_type_code()) {
+  case FORMAT_DESCRIPTION_EVENT:
+    wsrep_set_apply_format(thd, (Format_description_log_event*)ev);
+    return 0;
+  case GTID_LOG_EVENT:
+  {
+    Gtid_log_event* gev= (Gtid_log_event*)ev;
+    if (gev->get_gno() == 0)
+    {
+      /* Skip GTID log event to make binlog to generate LTID on commit */
+      delete ev;
+      return 0;
+    }
+  }
+  default:
+    break;
+  }
+
+  thd->server_id = ev->server_id; // use the original server id for logging
+  thd->set_time();                // time the query
+  wsrep_xid_init(&thd->transaction.xid_state.xid,
+                 thd->wsrep_trx_meta.gtid.uuid,
+                 thd->wsrep_trx_meta.gtid.seqno);
+  thd->lex->current_select= 0;
+  if (!ev->when.tv_sec)
+    my_micro_time_to_timeval(my_micro_time(), &ev->when);
+  ev->thd = thd;
+  int const exec_res= ev->apply_event(thd->wsrep_rli);
+  DBUG_PRINT("info", ("exec_event result: %d", exec_res));
+
+  if (exec_res)
+  {
+    WSREP_WARN("RBR event %d %s apply warning: %d, %lld",
+               *event, ev->get_type_str(), exec_res,
+               (long long) wsrep_thd_trx_seqno(thd));
+    delete ev;
+    return exec_res;
+  }
+  (*event)++;
+
+  if (thd->wsrep_conflict_state!= NO_CONFLICT &&
+      thd->wsrep_conflict_state!= REPLAYING)
+    WSREP_WARN("conflict state after RBR event applying: %d, %lld",
+               thd->wsrep_query_state, (long long)wsrep_thd_trx_seqno(thd));
+
+  delete ev;
+
+  if (thd->wsrep_conflict_state == MUST_ABORT) {
+    WSREP_WARN("RBR event apply failed, rolling back: %lld",
+               (long long) wsrep_thd_trx_seqno(thd));
+    trans_rollback(thd);
+    thd->locked_tables_list.unlock_locked_tables(thd);
+    /* Release transactional metadata locks. */
+    thd->mdl_context.release_transactional_locks();
+    thd->wsrep_conflict_state= NO_CONFLICT;
+    return -1;
+  }
+
+  return 0;
+}
+
+/* Write sets smaller than this are always decoded by the applier itself */
+#define WSREP_PARALLEL_DECODE_MIN (1 << 20) /* 1M */
+
+/* Decoding job of a single helper thread: events [begin, end) */
+struct wsrep_decode_job
+{
+  const Format_description_log_event* format;
+  char**      events;   /* event start positions */
+  Log_event** decoded;  /* decoded events, NULL on failure */
+  size_t      begin;
+  size_t      end;
+};
+
+static void* wsrep_decode_thread(void* arg)
+{
+  wsrep_decode_job* const job((wsrep_decode_job*)arg);
+
+  if (my_thread_init()) return NULL;
+
+  for (size_t i(job->begin); i < job->end; ++i)
+  {
+    size_t len(uint4korr(job->events[i] + EVENT_LEN_OFFSET));
+    char*  buf(job->events[i]);
+    job->decoded[i]= wsrep_read_log_event(&buf, &len, job->format);
+  }
+
+  my_thread_end();
+  return NULL;
+}
+
+/*
+  Decode events of a large write set with wsrep_slave_decode_threads helper
+  threads while applier waits.
+
+  Rows of the write set still have to be applied by the applier THD, as
+  they all belong to a single storage engine transaction, but event
+  decoding (row image copying, table map parsing, etc.) of one event does
+  not depend on the others as long as the format does not change midway.
+
+  @return number of decoded events stored in *decoded_events,
+          0 if the write set has to be processed sequentially
+*/
+static size_t wsrep_decode_events(THD*         thd,
+                                  char*        buf,
+                                  size_t       buf_len,
+                                  Log_event*** decoded_events)
+{
+  size_t const threads(wsrep_slave_decode_threads);
+  size_t count(0);
+
+  *decoded_events= NULL;
+
+  if (threads == 0 || buf_len < WSREP_PARALLEL_DECODE_MIN) return 0;
+
+  /* Find event boundaries, bail out on anything changing decoding format */
+  for (size_t pos(0); pos < buf_len; ++count)
+  {
+    if (buf_len - pos < LOG_EVENT_MINIMAL_HEADER_LEN) return 0;
+
+    uint const type(buf[pos + EVENT_TYPE_OFFSET]);
+    if (type == START_EVENT_V3 || type == FORMAT_DESCRIPTION_EVENT) return 0;
+
+    uint const len(uint4korr(buf + pos + EVENT_LEN_OFFSET));
+    if (len == 0 || len > buf_len - pos) return 0;
+    pos+= len;
+  }
+
+  char**      events((char**)my_malloc(count * sizeof(char*), MYF(0)));
+  Log_event** decoded((Log_event**)my_malloc(count * sizeof(Log_event*),
+                                             MYF(MY_ZEROFILL)));
+  wsrep_decode_job* jobs((wsrep_decode_job*)
+                         my_malloc(threads * sizeof(wsrep_decode_job),
+                                   MYF(0)));
+  pthread_t* tids((pthread_t*)my_malloc(threads * sizeof(pthread_t),
+                                        MYF(0)));
+
+  if (!events || !decoded || !jobs || !tids)
+  {
+    WSREP_WARN("failed to allocate parallel decoding context for %zu "
+               "events, decoding sequentially", count);
+    my_free(events);
+    my_free(decoded);
+    my_free(jobs);
+    my_free(tids);
+    return 0;
+  }
+
+  size_t i(0);
+  for (size_t pos(0); pos < buf_len; ++i)
+  {
+    events[i]= buf + pos;
+    pos+= uint4korr(buf + pos + EVENT_LEN_OFFSET);
+  }
+
+  /* Split events between jobs by volume, so that jobs get even share */
+  const Format_description_log_event* const format(wsrep_get_apply_format(thd));
+  size_t const share(buf_len / threads + 1);
+  size_t begin(0);
+  size_t started(0);
+
+  for (size_t t(0); t < threads && begin < count; ++t)
+  {
+    size_t end(begin);
+    size_t volume(0);
+    while (end < count && (volume < share || t == threads - 1))
+    {
+      volume+= uint4korr(events[end] + EVENT_LEN_OFFSET);
+      ++end;
+    }
+
+    jobs[t].format = format;
+    jobs[t].events = events;
+    jobs[t].decoded= decoded;
+    jobs[t].begin  = begin;
+    jobs[t].end    = end;
+
+    if (mysql_thread_create(key_thread_wsrep_decode, &tids[t], NULL,
+                            wsrep_decode_thread, &jobs[t]))
+    {
+      WSREP_WARN("failed to start decoding thread: %d (%s), decoding "
+                 "remaining events sequentially", errno, strerror(errno));
+      break;
+    }
+    ++started;
+    begin= end;
+  }
+
+  /* whatever was not given to a helper is decoded here */
+  for (; begin < count; ++begin)
+  {
+    size_t len(uint4korr(events[begin] + EVENT_LEN_OFFSET));
+    char*  ptr(events[begin]);
+    decoded[begin]= wsrep_read_log_event(&ptr, &len, format);
+  }
+
+  for (size_t t(0); t < started; ++t) pthread_join(tids[t], NULL);
+
+  my_free(tids);
+  my_free(jobs);
+  my_free(events);
+
+  *decoded_events= decoded;
+  return count;
+}
+
 static wsrep_cb_status_t wsrep_apply_events(THD*        thd,
                                             const void* events_buf,
                                             size_t      buf_len)
@@ -83,6 +302,9 @@ static wsrep_cb_status_t wsrep_apply_events(THD*        thd,
   char *buf= (char *)events_buf;
   int rcode= 0;
   int event= 1;
+  Log_event** decoded= NULL;
+  size_t decoded_count= 0;
+  size_t decoded_next= 0;
 
   DBUG_ENTER("wsrep_apply_events");
 
@@ -103,82 +325,74 @@ static wsrep_cb_status_t wsrep_apply_events(THD*        thd,
   if (!buf_len) WSREP_DEBUG("empty rbr buffer to apply: %lld",
                             (long long) wsrep_thd_trx_seqno(thd));
 
-  while(buf_len)
+  /*
+    Format description event, if present, leads the write set. Apply it
+    first, so that the rest can be decoded in parallel with right format.
+  */
+  if (buf_len >= LOG_EVENT_MINIMAL_HEADER_LEN &&
+      buf[EVENT_TYPE_OFFSET] == FORMAT_DESCRIPTION_EVENT)
   {
-    int exec_res;
     Log_event* ev= wsrep_read_log_event(&buf, &buf_len,
                                         wsrep_get_apply_format(thd));
-
     if (!ev)
     {
-      WSREP_ERROR("applier could not read binlog event, seqno: %lld, len: %zu",
-                  (long long)wsrep_thd_trx_seqno(thd), buf_len);
+      WSREP_ERROR("applier could not read binlog event, seqno: %lld, "
+                  "pos: 0", (long long)wsrep_thd_trx_seqno(thd));
       rcode= 1;
       goto error;
     }
+    wsrep_set_apply_format(thd, (Format_description_log_event*)ev);
+  }
 
-    switch (ev->get_type_code()) {
-    case FORMAT_DESCRIPTION_EVENT:
-      wsrep_set_apply_format(thd, (Format_description_log_event*)ev);
-      continue;
-    case GTID_LOG_EVENT:
+  decoded_count= wsrep_decode_events(thd, buf, buf_len, &decoded);
+
+  while(decoded_next < decoded_count || (!decoded_count && buf_len))
+  {
+    Log_event* ev;
+    size_t const pos(buf - (char*)events_buf);
+
+    if (decoded_count)
     {
-      Gtid_log_event* gev= (Gtid_log_event*)ev;
-      if (gev->get_gno() == 0)
-      {
-        /* Skip GTID log event to make binlog to generate LTID on commit */
-        delete ev;
-        continue;
-      }
+      ev= decoded[decoded_next];
+      decoded[decoded_next++]= NULL;
+      /* buf is not consumed by the decoding threads, keep it at the event */
+      buf+= uint4korr(buf + EVENT_LEN_OFFSET);
     }
-    default:
-      break;
+    else
+    {
+      ev= wsrep_read_log_event(&buf, &buf_len, wsrep_get_apply_format(thd));
     }
 
-    thd->server_id = ev->server_id; // use the original server id for logging
-    thd->set_time();                // time the query
-    wsrep_xid_init(&thd->transaction.xid_state.xid,
-                   thd->wsrep_trx_meta.gtid.uuid,
-                   thd->wsrep_trx_meta.gtid.seqno);
-    thd->lex->current_select= 0;
-    if (!ev->when.tv_sec)
-      my_micro_time_to_timeval(my_micro_time(), &ev->when);
-    ev->thd = thd;
-    exec_res = ev->apply_event(thd->wsrep_rli);
-    DBUG_PRINT("info", ("exec_event result: %d", exec_res));
-
-    if (exec_res)
+    if (!ev)
     {
-      WSREP_WARN("RBR event %d %s apply warning: %d, %lld",
-                 event, ev->get_type_str(), exec_res,
-                 (long long) wsrep_thd_trx_seqno(thd));
-      rcode= exec_res;
-      /* stop processing for the first error */
-      delete ev;
+      WSREP_ERROR("applier could not read binlog event, seqno: %lld, "
+                  "event: %d, pos: %zu",
+                  (long long)wsrep_thd_trx_seqno(thd), event, pos);
+      rcode= 1;
       goto error;
     }
-    event++;
-
-    if (thd->wsrep_conflict_state!= NO_CONFLICT &&
-        thd->wsrep_conflict_state!= REPLAYING)
-      WSREP_WARN("conflict state after RBR event applying: %d, %lld",
-                 thd->wsrep_query_state, (long long)wsrep_thd_trx_seqno(thd));
-
-    if (thd->wsrep_conflict_state == MUST_ABORT) {
-      WSREP_WARN("RBR event apply failed, rolling back: %lld",
-                 (long long) wsrep_thd_trx_seqno(thd));
-      trans_rollback(thd);
-      thd->locked_tables_list.unlock_locked_tables(thd);
-      /* Release transactional metadata locks. */
-      thd->mdl_context.release_transactional_locks();
-      thd->wsrep_conflict_state= NO_CONFLICT;
+
+    int const res(wsrep_apply_event(thd, ev, &event));
+
+    if (res < 0)
+    {
+      while (decoded_next < decoded_count) delete decoded[decoded_next++];
+      my_free(decoded);
       DBUG_RETURN(WSREP_CB_FAILURE);
     }
 
-    delete ev;
+    if (res > 0)
+    {
+      /* stop processing for the first error */
+      rcode= res;
+      goto error;
+    }
   }
 
  error:
+  while (decoded_next < decoded_count) delete decoded[decoded_next++];
+  my_free(decoded);
+
   mysql_mutex_lock(&thd->LOCK_wsrep_thd);
   thd->wsrep_query_state= QUERY_IDLE;
   mysql_mutex_unlock(&thd->LOCK_wsrep_thd);
@@ -192,6 +406,606 @@ static wsrep_cb_status_t wsrep_apply_events(THD*        thd,
   DBUG_RETURN(WSREP_CB_SUCCESS);
 }
 
+/*
+  Applying of non-blocking schema changes (wsrep_OSU_method=NBO).
+
+  NBO begin event makes a worker thread take exclusive MDL locks on the
+  tables of the operation and returns as soon as the locks are granted, so
+  total order is held only for the time of locking. The worker then
+  executes the operation concurrently with other write sets and keeps the
+  locks until NBO end event (or the departure of the originator from the
+  cluster) tells that the operation has completed on its originator.
+*/
+enum wsrep_nbo_end_t
+{
+  WSREP_NBO_RUNNING,     /* end event not received yet */
+  WSREP_NBO_END_EVENT,   /* end event is waiting for the worker */
+  WSREP_NBO_ABORT_EVENT, /* abort event is waiting for the worker */
+  WSREP_NBO_ORPHANED     /* originator has left the cluster */
+};
+
+struct wsrep_nbo
+{
+  wsrep_seqno_t     seqno;    /* seqno of begin event identifies the NBO */
+  wsrep_uuid_t      origin;   /* originator node */
+  wsrep_trx_meta_t  meta;
+  uchar*            buf;      /* copy of begin event payload */
+  size_t            len;
+  THD*              thd;      /* worker which has taken the NBO */
+  bool              locked;   /* worker holds MDL locks */
+  bool              executed; /* worker has finished the operation */
+  bool              done;     /* worker has released MDL locks */
+  wsrep_nbo_end_t   end;
+  wsrep_cb_status_t rcode;
+  wsrep_nbo*        next;
+};
+
+static wsrep_nbo* wsrep_nbo_list= NULL;
+ulong             wsrep_nbo_workers= 0;
+
+static PSI_stage_info stage_wsrep_nbo_wait=
+  { 0, "Waiting for NBO end", 0};
+
+bool wsrep_nbo_event(const void* buf, size_t len)
+{
+  const uchar* const b((const uchar*)buf);
+  return (len >= WSREP_NBO_HEADER_LEN &&
+          !memcmp(b, WSREP_NBO_MAGIC, sizeof(WSREP_NBO_MAGIC) - 1) &&
+          b[EVENT_TYPE_OFFSET] == UNKNOWN_EVENT);
+}
+
+/*
+  Parses table names following NBO header into (*names)[2 * i] (schema)
+  and (*names)[2 * i + 1] (table) allocated on thd->mem_root.
+  @return offset of the binlog events in buf or 0 if payload is malformed
+*/
+static size_t wsrep_nbo_tables(THD* thd, const uchar* buf, size_t len,
+                               const char*** names, uint* count)
+{
+  *count= uint2korr(buf + 6);
+  *names= (const char**)alloc_root(thd->mem_root,
+                                   (2 * (*count) + 1) * sizeof(char*));
+  if (!*names) return 0;
+
+  size_t off= WSREP_NBO_HEADER_LEN;
+  for (uint i= 0; i < 2 * (*count); ++i)
+  {
+    const uchar* const end((const uchar*)memchr(buf + off, 0, len - off));
+    if (!end) return 0;
+    (*names)[i]= (const char*)buf + off;
+    off= end - buf + 1;
+  }
+  return off;
+}
+
+static void wsrep_nbo_free(wsrep_nbo* nbo)
+{
+  wsrep_nbo** p(&wsrep_nbo_list);
+  while (*p != nbo) p= &(*p)->next;
+  *p= nbo->next;
+  my_free(nbo->buf);
+  my_free(nbo);
+}
+
+/* Body of NBO worker thread, thd is prepared for applying */
+void wsrep_nbo_execute(THD* thd)
+{
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  wsrep_nbo* nbo(wsrep_nbo_list);
+  while (nbo && nbo->thd) nbo= nbo->next;
+  if (nbo) nbo->thd= thd;
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+  if (!nbo)
+  {
+    mysql_mutex_lock(&LOCK_wsrep_nbo);
+    wsrep_nbo_workers--;
+    mysql_mutex_unlock(&LOCK_wsrep_nbo);
+    return;
+  }
+
+  const char** names;
+  uint         count;
+  size_t const off(wsrep_nbo_tables(thd, nbo->buf, nbo->len, &names, &count));
+
+  /* appliers wait for the operation, see wsrep_grant_mdl_exception() */
+  mysql_mutex_lock(&thd->LOCK_wsrep_thd);
+  thd->wsrep_nbo= nbo;
+  mysql_mutex_unlock(&thd->LOCK_wsrep_thd);
+
+  thd->wsrep_trx_meta= nbo->meta;
+  uint               locks_num(0);
+  MDL_request* const locks(off ? wsrep_nbo_lock_tables(thd, names, count,
+                                                       &locks_num) : NULL);
+  bool const         locked(locks != NULL);
+
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  nbo->locked= locked;
+  nbo->executed= !locked;
+  nbo->rcode= locked ? WSREP_CB_SUCCESS : WSREP_CB_FAILURE;
+  mysql_cond_broadcast(&COND_wsrep_nbo);
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+  if (locked)
+  {
+    thd->wsrep_apply_toi= true;
+    thd->variables.option_bits&= ~OPTION_BEGIN;
+    thd->server_status&= ~SERVER_STATUS_IN_TRANS;
+
+    wsrep_cb_status_t const rcode(wsrep_apply_events(thd, nbo->buf + off,
+                                                     nbo->len - off));
+    if (WSREP_CB_SUCCESS != rcode && !thd->killed)
+    {
+      WSREP_WARN("NBO %lld failed to apply", (long long)nbo->seqno);
+      wsrep_dump_rbr_buf(thd, nbo->buf + off, nbo->len - off);
+    }
+
+    thd->wsrep_rli->cleanup_context(thd, 0);
+    thd->variables.gtid_next.set_automatic();
+    wsrep_set_apply_format(thd, NULL);
+    thd->mdl_context.release_transactional_locks();
+    free_root(thd->mem_root, MYF(MY_KEEP_PREALLOC));
+
+    /* operation is over, appliers may use the tables as it has left them */
+    mysql_mutex_lock(&thd->LOCK_wsrep_thd);
+    thd->wsrep_nbo= NULL;
+    mysql_mutex_unlock(&thd->LOCK_wsrep_thd);
+    wsrep_nbo_unblock_tables(locks, locks_num);
+
+    PSI_stage_info old_stage;
+    mysql_mutex_lock(&LOCK_wsrep_nbo);
+    nbo->executed= true;
+    nbo->rcode= rcode;
+    mysql_cond_broadcast(&COND_wsrep_nbo);
+
+    thd->ENTER_COND(&COND_wsrep_nbo, &LOCK_wsrep_nbo,
+                    &stage_wsrep_nbo_wait, &old_stage);
+    while (nbo->end == WSREP_NBO_RUNNING && !thd->killed)
+      mysql_cond_wait(&COND_wsrep_nbo, &LOCK_wsrep_nbo);
+    thd->EXIT_COND(&old_stage);
+
+    thd->mdl_context.release_explicit_locks();
+  }
+  else
+  {
+    mysql_mutex_lock(&thd->LOCK_wsrep_thd);
+    thd->wsrep_nbo= NULL;
+    mysql_mutex_unlock(&thd->LOCK_wsrep_thd);
+  }
+
+  wsrep_nbo_journal_remove(nbo->seqno);
+
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  nbo->done= true;
+  nbo->thd= NULL;
+  if (nbo->end == WSREP_NBO_END_EVENT || nbo->end == WSREP_NBO_ABORT_EVENT)
+    mysql_cond_broadcast(&COND_wsrep_nbo); // end event frees it
+  else
+    wsrep_nbo_free(nbo);
+  wsrep_nbo_workers--;
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+}
+
+static wsrep_cb_status_t wsrep_apply_nbo_begin(THD* thd,
+                                               const void* buf, size_t len,
+                                               const wsrep_trx_meta_t* meta)
+{
+  wsrep_nbo* const nbo((wsrep_nbo*)my_malloc(sizeof(wsrep_nbo),
+                                             MYF(MY_ZEROFILL)));
+  uchar* const copy((uchar*)my_malloc(len, MYF(0)));
+  if (!nbo || !copy)
+  {
+    my_free(nbo);
+    my_free(copy);
+    return WSREP_CB_FAILURE;
+  }
+
+  /* must be durable before the begin event commits */
+  wsrep_nbo_journal_write(meta, buf, len);
+
+  memcpy(copy, buf, len);
+  nbo->seqno= meta->gtid.seqno;
+  nbo->meta=  *meta;
+  memcpy(&nbo->origin, (const uchar*)buf + 16, sizeof(nbo->origin));
+  nbo->buf=   copy;
+  nbo->len=   len;
+  nbo->end=   WSREP_NBO_RUNNING;
+
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  wsrep_nbo** p(&wsrep_nbo_list);
+  while (*p) p= &(*p)->next;
+  *p= nbo;
+  wsrep_nbo_workers++;
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+  if (wsrep_create_nbo_worker())
+  {
+    WSREP_WARN("Can't create NBO worker thread, applying NBO %lld in "
+               "total order", (long long)nbo->seqno);
+    mysql_mutex_lock(&LOCK_wsrep_nbo);
+    wsrep_nbo_workers--;
+    wsrep_nbo_free(nbo);
+    mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+    const char** names;
+    uint         count;
+    size_t const off(wsrep_nbo_tables(thd, (const uchar*)buf, len,
+                                      &names, &count));
+    wsrep_cb_status_t const rcode(off ?
+                                  wsrep_apply_events(thd, (const uchar*)buf + off,
+                                                     len - off) :
+                                  WSREP_CB_FAILURE);
+    wsrep_nbo_journal_remove(meta->gtid.seqno);
+    return rcode;
+  }
+
+  /* total order is held until the locks are granted */
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  while (!nbo->locked && !nbo->executed)
+    mysql_cond_wait(&COND_wsrep_nbo, &LOCK_wsrep_nbo);
+  wsrep_cb_status_t const rcode(nbo->rcode);
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+  if (WSREP_CB_SUCCESS != rcode)
+    WSREP_ERROR("NBO %lld failed to lock tables", (long long)meta->gtid.seqno);
+
+  return rcode;
+}
+
+static wsrep_cb_status_t wsrep_apply_nbo_end(THD* thd, const void* buf)
+{
+  wsrep_seqno_t const seqno(sint8korr((const uchar*)buf + 8));
+  wsrep_cb_status_t rcode(WSREP_CB_SUCCESS);
+
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+
+  wsrep_nbo* nbo(wsrep_nbo_list);
+  while (nbo && nbo->seqno != seqno) nbo= nbo->next;
+
+  if (nbo)
+  {
+    /* wait for the operation to complete here as well */
+    nbo->end= WSREP_NBO_END_EVENT;
+    mysql_cond_broadcast(&COND_wsrep_nbo);
+    while (!nbo->done)
+      mysql_cond_wait(&COND_wsrep_nbo, &LOCK_wsrep_nbo);
+    rcode= nbo->rcode;
+    wsrep_nbo_free(nbo);
+  }
+  else
+  {
+    WSREP_DEBUG("NBO %lld is not in progress", (long long)seqno);
+  }
+
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+  return rcode;
+}
+
+/*
+  Originator failed to lock the tables, so the operation is killed here. If
+  it has completed already, this node can't follow the originator.
+*/
+static wsrep_cb_status_t wsrep_apply_nbo_abort(THD* thd, const void* buf)
+{
+  wsrep_seqno_t const seqno(sint8korr((const uchar*)buf + 8));
+  bool completed(false);
+
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+
+  wsrep_nbo* nbo(wsrep_nbo_list);
+  while (nbo && nbo->seqno != seqno) nbo= nbo->next;
+
+  if (nbo)
+  {
+    nbo->end= WSREP_NBO_ABORT_EVENT;
+    if (nbo->thd && !nbo->executed)
+    {
+      mysql_mutex_lock(&nbo->thd->LOCK_thd_data);
+      nbo->thd->awake(THD::KILL_QUERY);
+      mysql_mutex_unlock(&nbo->thd->LOCK_thd_data);
+    }
+    mysql_cond_broadcast(&COND_wsrep_nbo);
+    while (!nbo->done)
+      mysql_cond_wait(&COND_wsrep_nbo, &LOCK_wsrep_nbo);
+    completed= (nbo->locked && WSREP_CB_SUCCESS == nbo->rcode);
+    wsrep_nbo_free(nbo);
+  }
+  else
+  {
+    WSREP_DEBUG("NBO %lld is not in progress", (long long)seqno);
+  }
+
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+  if (completed)
+  {
+    WSREP_ERROR("NBO %lld was aborted by its originator, but it has "
+                "completed on this node", (long long)seqno);
+    return WSREP_CB_FAILURE;
+  }
+
+  WSREP_INFO("NBO %lld aborted by its originator", (long long)seqno);
+  return WSREP_CB_SUCCESS;
+}
+
+static wsrep_cb_status_t wsrep_apply_nbo(THD* thd,
+                                         const void* buf, size_t len,
+                                         const wsrep_trx_meta_t* meta)
+{
+  switch (((const uchar*)buf)[5])
+  {
+  case WSREP_NBO_BEGIN: return wsrep_apply_nbo_begin(thd, buf, len, meta);
+  case WSREP_NBO_END:   return wsrep_apply_nbo_end(thd, buf);
+  case WSREP_NBO_ABORT: return wsrep_apply_nbo_abort(thd, buf);
+  }
+  WSREP_ERROR("Unknown NBO event type %d", ((const uchar*)buf)[5]);
+  return WSREP_CB_FAILURE;
+}
+
+/* Releases NBOs whose originators are not members of the primary view */
+void wsrep_nbo_view_change(const wsrep_view_info_t* view)
+{
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+
+  for (wsrep_nbo* nbo= wsrep_nbo_list; nbo; nbo= nbo->next)
+  {
+    if (nbo->end != WSREP_NBO_RUNNING) continue;
+
+    bool member(false);
+    for (int i= 0; !member && i < view->memb_num; ++i)
+      member= !memcmp(&view->members[i].id, &nbo->origin,
+                      sizeof(wsrep_uuid_t));
+
+    if (!member)
+    {
+      WSREP_WARN("Originator of NBO %lld has left the cluster, "
+                 "releasing its locks", (long long)nbo->seqno);
+      nbo->end= WSREP_NBO_ORPHANED;
+    }
+  }
+  mysql_cond_broadcast(&COND_wsrep_nbo);
+
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+}
+
+/*
+  NBO journal file: magic(8) uuid(16) seqno(8) len(8) begin event(len)
+  crc32(4) of all that, so that a file written partially is recognized.
+*/
+#define WSREP_NBO_JOURNAL       "wsrep_nbo_"
+#define WSREP_NBO_JOURNAL_MAGIC "WSREPNB1"
+#define WSREP_NBO_JOURNAL_HDR   40
+
+static wsrep_uuid_t  wsrep_nbo_start_uuid=  WSREP_UUID_UNDEFINED;
+static wsrep_seqno_t wsrep_nbo_start_seqno= WSREP_SEQNO_UNDEFINED;
+static wsrep_nbo*    wsrep_nbo_recovered=   NULL; /* in seqno order */
+static bool          wsrep_nbo_recovering=  false;
+static int           wsrep_nbo_recover_err= 0;
+
+static void wsrep_nbo_journal_path(char* path, wsrep_seqno_t seqno)
+{
+  char name[FN_REFLEN];
+  snprintf(name, sizeof(name), WSREP_NBO_JOURNAL "%lld.dat", (long long)seqno);
+  fn_format(path, name, mysql_real_data_home, "",
+            MY_UNPACK_FILENAME | MY_SAFE_PATH);
+}
+
+void wsrep_nbo_journal_write(const wsrep_trx_meta_t* meta,
+                             const void* buf, size_t len)
+{
+  uchar hdr[WSREP_NBO_JOURNAL_HDR];
+  memcpy(hdr, WSREP_NBO_JOURNAL_MAGIC, 8);
+  memcpy(hdr + 8, &meta->gtid.uuid, sizeof(meta->gtid.uuid));
+  int8store(hdr + 24, (ulonglong)meta->gtid.seqno);
+  int8store(hdr + 32, (ulonglong)len);
+
+  uchar crc[4];
+  int4store(crc, my_checksum(my_checksum(0, hdr, sizeof(hdr)),
+                             (const uchar*)buf, len));
+
+  char path[FN_REFLEN];
+  wsrep_nbo_journal_path(path, meta->gtid.seqno);
+
+  File const file(my_open(path, O_WRONLY | O_CREAT | O_TRUNC, MYF(MY_WME)));
+  bool const err(file < 0 ||
+                 my_write(file, hdr, sizeof(hdr), MYF(MY_WME | MY_NABP)) ||
+                 my_write(file, (const uchar*)buf, len,
+                          MYF(MY_WME | MY_NABP)) ||
+                 my_write(file, crc, sizeof(crc), MYF(MY_WME | MY_NABP)) ||
+                 my_sync(file, MYF(MY_WME)) ||
+                 my_sync_dir_by_file(path, MYF(0)));
+  if (file >= 0) my_close(file, MYF(0));
+
+  if (err)
+  {
+    WSREP_WARN("Failed to write NBO %lld to '%s', it will not be executed "
+               "again if the node crashes before the NBO completes",
+               (long long)meta->gtid.seqno, path);
+    my_delete(path, MYF(0));
+  }
+}
+
+void wsrep_nbo_journal_remove(wsrep_seqno_t seqno)
+{
+  char path[FN_REFLEN];
+  wsrep_nbo_journal_path(path, seqno);
+  my_delete(path, MYF(0));
+}
+
+/* @return begin event read from journal file or NULL if it is not valid */
+static wsrep_nbo* wsrep_nbo_journal_read(const char* path)
+{
+  File const file(my_open(path, O_RDONLY, MYF(MY_WME)));
+  if (file < 0) return NULL;
+
+  wsrep_nbo* nbo(NULL);
+  uchar      hdr[WSREP_NBO_JOURNAL_HDR];
+  if (!my_read(file, hdr, sizeof(hdr), MYF(MY_NABP)) &&
+      !memcmp(hdr, WSREP_NBO_JOURNAL_MAGIC, 8))
+  {
+    size_t const len(uint8korr(hdr + 32));
+    uchar* const buf(len >= WSREP_NBO_HEADER_LEN && len <= wsrep_max_ws_size ?
+                     (uchar*)my_malloc(len, MYF(0)) : NULL);
+    uchar        crc[4];
+    if (buf &&
+        !my_read(file, buf, len, MYF(MY_NABP)) &&
+        !my_read(file, crc, sizeof(crc), MYF(MY_NABP)) &&
+        my_checksum(my_checksum(0, hdr, sizeof(hdr)), buf, len) ==
+        uint4korr(crc) &&
+        wsrep_nbo_event(buf, len) && buf[5] == WSREP_NBO_BEGIN &&
+        (nbo= (wsrep_nbo*)my_malloc(sizeof(wsrep_nbo), MYF(MY_ZEROFILL))))
+    {
+      memcpy(&nbo->meta.gtid.uuid, hdr + 8, sizeof(nbo->meta.gtid.uuid));
+      nbo->meta.gtid.seqno= sint8korr(hdr + 24);
+      nbo->meta.depends_on= nbo->meta.gtid.seqno - 1;
+      nbo->seqno= nbo->meta.gtid.seqno;
+      nbo->buf=   buf;
+      nbo->len=   len;
+    }
+    else
+    {
+      my_free(buf);
+    }
+  }
+  my_close(file, MYF(0));
+
+  return nbo;
+}
+
+/* Records the state of the data before a state transfer could replace it */
+void wsrep_nbo_start_position(const wsrep_uuid_t& uuid, wsrep_seqno_t seqno)
+{
+  wsrep_nbo_start_uuid=  uuid;
+  wsrep_nbo_start_seqno= seqno;
+}
+
+/*
+  Called once storage engines are initialized, before anything is applied:
+  executes again the NBOs whose begin events have committed on this node,
+  but which did not complete before a crash.
+*/
+void wsrep_nbo_recover()
+{
+  MY_DIR* const dir(my_dir(mysql_real_data_home, MYF(0)));
+  if (!dir) return;
+
+  wsrep_uuid_t  uuid;
+  wsrep_seqno_t seqno;
+  wsrep_get_SE_checkpoint(uuid, seqno);
+
+  /* journal was written for the data a state transfer has replaced */
+  bool const replaced(wsrep_nbo_start_seqno != WSREP_SEQNO_UNDEFINED &&
+                      (memcmp(&uuid, &wsrep_nbo_start_uuid, sizeof(uuid)) ||
+                       seqno != wsrep_nbo_start_seqno));
+
+  size_t const prefix_len(sizeof(WSREP_NBO_JOURNAL) - 1);
+  for (uint i= 0; i < dir->number_off_files; ++i)
+  {
+    const char* const name(dir->dir_entry[i].name);
+    if (strncmp(name, WSREP_NBO_JOURNAL, prefix_len)) continue;
+
+    char path[FN_REFLEN];
+    fn_format(path, name, mysql_real_data_home, "",
+              MY_UNPACK_FILENAME | MY_SAFE_PATH);
+
+    wsrep_nbo* const nbo(replaced ? NULL : wsrep_nbo_journal_read(path));
+    if (nbo && nbo->seqno <= seqno &&
+        !memcmp(&nbo->meta.gtid.uuid, &uuid, sizeof(uuid)))
+    {
+      wsrep_nbo** p(&wsrep_nbo_recovered);
+      while (*p && (*p)->seqno < nbo->seqno) p= &(*p)->next;
+      nbo->next= *p;
+      *p= nbo;
+    }
+    else
+    {
+      /* begin event will be delivered again, or is not for this data */
+      if (nbo) my_free(nbo->buf);
+      my_free(nbo);
+      my_delete(path, MYF(0));
+    }
+  }
+  my_dirend(dir);
+
+  if (!wsrep_nbo_recovered) return;
+
+  wsrep_nbo_recovering= true;
+  if (wsrep_create_nbo_recoverer())
+  {
+    WSREP_ERROR("Can't create thread to execute NBOs interrupted by a "
+                "crash. Can't continue.");
+    unireg_abort(1);
+  }
+
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  while (wsrep_nbo_recovering)
+    mysql_cond_wait(&COND_wsrep_nbo, &LOCK_wsrep_nbo);
+  int const err(wsrep_nbo_recover_err);
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+
+  if (err) unireg_abort(1);
+}
+
+/* Body of NBO recovery thread, thd is prepared for applying */
+void wsrep_nbo_recover_execute(THD* thd)
+{
+  int err(0);
+
+  while (wsrep_nbo* const nbo= wsrep_nbo_recovered)
+  {
+    wsrep_nbo_recovered= nbo->next;
+
+    if (!err)
+    {
+      WSREP_INFO("Executing NBO %lld interrupted by a crash",
+                 (long long)nbo->seqno);
+
+      const char** names;
+      uint         count;
+      size_t const off(wsrep_nbo_tables(thd, nbo->buf, nbo->len,
+                                        &names, &count));
+
+      thd->wsrep_trx_meta= nbo->meta;
+      thd->wsrep_apply_toi= true;
+      thd->variables.option_bits&= ~OPTION_BEGIN;
+      thd->server_status&= ~SERVER_STATUS_IN_TRANS;
+
+      if (off &&
+          WSREP_CB_SUCCESS == wsrep_apply_events(thd, nbo->buf + off,
+                                                 nbo->len - off))
+      {
+        wsrep_nbo_journal_remove(nbo->seqno);
+      }
+      else
+      {
+        char path[FN_REFLEN];
+        wsrep_nbo_journal_path(path, nbo->seqno);
+        WSREP_ERROR("Failed to execute NBO %lld interrupted by a crash. If "
+                    "it had completed before the crash, remove '%s' and "
+                    "restart. Can't continue.", (long long)nbo->seqno, path);
+        err= 1;
+      }
+
+      thd->wsrep_rli->cleanup_context(thd, 0);
+      thd->variables.gtid_next.set_automatic();
+      wsrep_set_apply_format(thd, NULL);
+      thd->mdl_context.release_transactional_locks();
+      free_root(thd->mem_root, MYF(MY_KEEP_PREALLOC));
+      thd->wsrep_apply_toi= false;
+    }
+
+    my_free(nbo->buf);
+    my_free(nbo);
+  }
+
+  mysql_mutex_lock(&LOCK_wsrep_nbo);
+  wsrep_nbo_recover_err= err;
+  wsrep_nbo_recovering= false;
+  mysql_cond_broadcast(&COND_wsrep_nbo);
+  mysql_mutex_unlock(&LOCK_wsrep_nbo);
+}
+
 wsrep_cb_status_t wsrep_apply_cb(void* const             ctx,
                                  const void* const       buf,
                                  size_t const            buf_len,
@@ -214,6 +1028,7 @@ wsrep_cb_status_t wsrep_apply_cb(void* const             ctx,
                  };);
 
   thd->wsrep_trx_meta = *meta;
+  wsrep_hot_key_apply_begin(meta->gtid.seqno);
 
 #ifdef WSREP_PROC_INFO
   snprintf(thd->wsrep_info, sizeof(thd->wsrep_info) - 1,
@@ -244,7 +1059,10 @@ wsrep_cb_status_t wsrep_apply_cb(void* const             ctx,
     thd->variables.option_bits&= ~OPTION_BEGIN;
     thd->server_status&= ~SERVER_STATUS_IN_TRANS;
   }
-  wsrep_cb_status_t rcode(wsrep_apply_events(thd, buf, buf_len));
+  wsrep_cb_status_t rcode((flags & WSREP_FLAG_ISOLATION) &&
+                          wsrep_nbo_event(buf, buf_len) ?
+                          wsrep_apply_nbo(thd, buf, buf_len, meta) :
+                          wsrep_apply_events(thd, buf, buf_len));
 
 #ifdef WSREP_PROC_INFO
   snprintf(thd->wsrep_info, sizeof(thd->wsrep_info) - 1,
@@ -258,6 +1076,10 @@ wsrep_cb_status_t wsrep_apply_cb(void* const             ctx,
   {
     wsrep_dump_rbr_buf(thd, buf, buf_len);
   }
+  else
+  {
+    wsrep_ws_log_stage(thd, buf, buf_len);
+  }
 
   TABLE *tmp;
   while ((tmp = thd->temporary_tables))
@@ -272,6 +1094,122 @@ wsrep_cb_status_t wsrep_apply_cb(void* const             ctx,
   return rcode;
 }
 
+/*
+  Group commit stage of the applier pipeline.
+
+  With wsrep_slave_group_commit appliers commit without flushing the redo
+  log while they hold their commit order slot, and the group commit thread
+  makes all commits done meanwhile durable with a single log flush. Thus
+  appliers are released as soon as their commit is ordered and a slow
+  fsync is paid once per batch of consecutive seqnos rather than per
+  write set.
+
+  The batch flush is as durable as the commits would have been by
+  themselves: engines honour their own settings for a group flush (e.g.
+  nothing is flushed with innodb_flush_log_at_trx_commit=0). When binary
+  log is written, it is the transaction coordinator, commits are made
+  durable by its own group commit according to sync_binlog, and this
+  stage is not used.
+
+  Losing a not yet flushed tail of commits on crash is safe: the write
+  set position is stored in the same redo log, so recovered position
+  matches recovered data and missing write sets are received by IST.
+*/
+static bool      wsrep_group_commit_running= false;
+static bool      wsrep_group_commit_stopping= false;
+static ulonglong wsrep_group_commit_pending= 0; // commits not flushed yet
+static pthread_t wsrep_group_commit_thread;
+
+static void* wsrep_group_commit_process(void* arg)
+{
+  if (my_thread_init()) return NULL;
+
+  mysql_mutex_lock(&LOCK_wsrep_group_commit);
+
+  while (true)
+  {
+    while (!wsrep_group_commit_pending && !wsrep_group_commit_stopping)
+      mysql_cond_wait(&COND_wsrep_group_commit, &LOCK_wsrep_group_commit);
+
+    if (!wsrep_group_commit_pending) break;
+
+    ulonglong const batch(wsrep_group_commit_pending);
+    wsrep_group_commit_pending= 0;
+    mysql_mutex_unlock(&LOCK_wsrep_group_commit);
+
+    /* commits arriving during the flush form the next batch */
+    if (ha_flush_logs(NULL, true))
+    {
+      WSREP_WARN("failed to flush logs for %llu committed write sets",
+                 batch);
+    }
+
+    mysql_mutex_lock(&LOCK_wsrep_group_commit);
+  }
+
+  wsrep_group_commit_running= false;
+  mysql_cond_broadcast(&COND_wsrep_group_commit);
+  mysql_mutex_unlock(&LOCK_wsrep_group_commit);
+
+  my_thread_end();
+  return NULL;
+}
+
+/*
+  Hand a committed transaction over to the group commit thread.
+  @return false if group commit thread can't be started and the caller
+          must flush by itself.
+*/
+static bool wsrep_group_commit_enqueue()
+{
+  bool ret(true);
+
+  mysql_mutex_lock(&LOCK_wsrep_group_commit);
+
+  if (!wsrep_group_commit_running)
+  {
+    wsrep_group_commit_stopping= false;
+    int const err(mysql_thread_create(key_thread_wsrep_group_commit,
+                                      &wsrep_group_commit_thread, NULL,
+                                      wsrep_group_commit_process, NULL));
+    if (err)
+    {
+      WSREP_WARN("failed to start group commit thread: %d (%s)",
+                 err, strerror(err));
+      ret= false;
+    }
+    else
+    {
+      wsrep_group_commit_running= true;
+    }
+  }
+
+  if (ret)
+  {
+    wsrep_group_commit_pending++;
+    mysql_cond_signal(&COND_wsrep_group_commit);
+  }
+
+  mysql_mutex_unlock(&LOCK_wsrep_group_commit);
+
+  return ret;
+}
+
+/* Flush the last batch and stop group commit thread, if running */
+void wsrep_group_commit_stop()
+{
+  mysql_mutex_lock(&LOCK_wsrep_group_commit);
+  bool const running(wsrep_group_commit_running);
+  if (running)
+  {
+    wsrep_group_commit_stopping= true;
+    mysql_cond_broadcast(&COND_wsrep_group_commit);
+  }
+  mysql_mutex_unlock(&LOCK_wsrep_group_commit);
+
+  if (running) pthread_join(wsrep_group_commit_thread, NULL);
+}
+
 static wsrep_cb_status_t wsrep_commit(THD* const thd)
 {
 #ifdef WSREP_PROC_INFO
@@ -282,9 +1220,25 @@ static wsrep_cb_status_t wsrep_commit(THD* const thd)
   thd_proc_info(thd, "committing");
 #endif /* WSREP_PROC_INFO */
 
+  /*
+    leave redo log flush to group commit stage, unless commit is written
+    to binary log, which then takes care of durability
+  */
+  bool const deferred(wsrep_slave_group_commit &&
+                      !(mysql_bin_log.is_open() &&
+                        (thd->variables.option_bits & OPTION_BIN_LOG)));
+  if (deferred) thd->durability_property= HA_IGNORE_DURABILITY;
+
   wsrep_cb_status_t const rcode(trans_commit(thd) ?
                                 WSREP_CB_FAILURE : WSREP_CB_SUCCESS);
 
+  if (deferred)
+  {
+    thd->durability_property= HA_REGULAR_DURABILITY;
+    if (WSREP_CB_SUCCESS == rcode && !wsrep_group_commit_enqueue())
+      ha_flush_logs(NULL, true);
+  }
+
 #ifdef WSREP_PROC_INFO
   snprintf(thd->wsrep_info, sizeof(thd->wsrep_info) - 1,
            "committed %lld", (long long)wsrep_thd_trx_seqno(thd));
@@ -350,6 +1304,8 @@ wsrep_cb_status_t wsrep_commit_cb(void*         const     ctx,
   else
     rcode = wsrep_rollback(thd);
 
+  wsrep_ws_log_commit(thd, flags, commit && WSREP_CB_SUCCESS == rcode);
+
   wsrep_set_apply_format(thd, NULL);
   thd->mdl_context.release_transactional_locks();
   free_root(thd->mem_root,MYF(MY_KEEP_PREALLOC));
@@ -374,6 +1330,8 @@ wsrep_cb_status_t wsrep_commit_cb(void*         const     ctx,
     thd->wsrep_apply_toi= false;
   }
 
+  wsrep_hot_key_apply_end(meta->gtid.seqno);
+
   return rcode;
 }
 
@@ -18,6 +18,8 @@
 
 #include "../wsrep/wsrep_api.h"
 
+class THD;
+
 /* wsrep callback prototypes */
 
 wsrep_cb_status_t wsrep_apply_cb(void *ctx,
@@ -35,4 +37,41 @@ wsrep_cb_status_t wsrep_unordered_cb(void*       ctx,
                                      const void* data,
                                      size_t      size);
 
+void wsrep_group_commit_stop();
+
+/*
+  NBO events are TOI events whose payload starts with a header which can't
+  be mistaken for a binlog event (event type byte is UNKNOWN_EVENT):
+
+  magic(4) 0(1) type(1) table count(2) begin seqno(8) (end and abort events)
+  originator node uuid(16) followed by schema\0table\0 name pairs and
+  binlog events (begin event only).
+
+  Abort event replaces end event when the originator could not lock the
+  tables: the operation must not complete on any node.
+*/
+#define WSREP_NBO_MAGIC      "WNBO"
+#define WSREP_NBO_HEADER_LEN 32
+#define WSREP_NBO_BEGIN      1
+#define WSREP_NBO_END        2
+#define WSREP_NBO_ABORT      3
+
+extern ulong wsrep_nbo_workers;
+
+bool wsrep_nbo_event(const void* buf, size_t len);
+void wsrep_nbo_execute(THD* thd);
+void wsrep_nbo_view_change(const wsrep_view_info_t* view);
+
+/*
+  Begin events of NBOs in progress on this node are kept in files in the
+  data directory, so that an operation interrupted by a crash is executed
+  again at startup: the node's checkpoint is past the begin event already.
+*/
+void wsrep_nbo_journal_write(const wsrep_trx_meta_t* meta,
+                             const void* buf, size_t len);
+void wsrep_nbo_journal_remove(wsrep_seqno_t seqno);
+void wsrep_nbo_start_position(const wsrep_uuid_t& uuid, wsrep_seqno_t seqno);
+void wsrep_nbo_recover();
+void wsrep_nbo_recover_execute(THD* thd);
+
 #endif /* WSREP_APPLIER_H */
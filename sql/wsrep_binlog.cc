@@ -282,6 +282,123 @@ cleanup:
     return err;
 }
 
+void wsrep_release_cache_map(THD* const thd)
+{
+    if (thd->wsrep_ws_map)
+    {
+        if (my_munmap(thd->wsrep_ws_map, thd->wsrep_ws_map_len))
+        {
+            WSREP_WARN("failed to unmap transaction cache: %d (%s)",
+                       errno, strerror(errno));
+        }
+        thd->wsrep_ws_map= NULL;
+        thd->wsrep_ws_map_len= 0;
+    }
+}
+
+/*
+  Write the contents of a cache to wsrep provider.
+
+  This version does not copy the data at all: the in-memory part of the
+  cache and the pages spilled to its temporary file are handed to provider
+  as a wsrep_buf vector with copy flag off.
+
+  On reinit to READ_CACHE a cache that was never spilled keeps all of its
+  data in the cache buffer. A spilled cache is flushed by reinit, so all of
+  its data is in the temporary file which is then mapped read-only.
+  The buffer and the mapping stay intact until the transaction is cleaned
+  up, see wsrep_cleanup_transaction().
+ */
+static int wsrep_write_cache_zero_copy(wsrep_t*  const wsrep,
+                                       THD*      const thd,
+                                       IO_CACHE* const cache,
+                                       size_t*   const len)
+{
+    my_off_t const saved_pos(my_b_tell(cache));
+
+    if (reinit_io_cache(cache, READ_CACHE, 0, 0, 0))
+    {
+        WSREP_ERROR("failed to initialize io-cache");
+        return WSREP_TRX_ERROR;
+    }
+
+    int err(WSREP_OK);
+
+    size_t const total_length(cache->end_of_file);
+    struct wsrep_buf buff = { NULL, 0 };
+
+    if (unlikely(total_length > wsrep_max_ws_size))
+    {
+        WSREP_WARN("transaction size limit (%lu) exceeded: %zu",
+                   wsrep_max_ws_size, total_length);
+        err = WSREP_TRX_SIZE_EXCEEDED;
+        goto cleanup;
+    }
+
+    if (my_b_bytes_in_cache(cache) == total_length)
+    {
+        /* everything is still in the cache buffer */
+        buff.ptr = cache->read_pos;
+        buff.len = total_length;
+    }
+    else if (cache->file >= 0)
+    {
+        DBUG_ASSERT(0 == my_b_bytes_in_cache(cache));
+
+        wsrep_release_cache_map(thd);
+
+        void* const map(my_mmap(0, total_length, PROT_READ, MAP_SHARED,
+                                cache->file, 0));
+        if (MAP_FAILED == map)
+        {
+            WSREP_WARN("failed to map transaction cache of %zu bytes: "
+                       "%d (%s), falling back to copying",
+                       total_length, errno, strerror(errno));
+            goto fallback;
+        }
+
+        thd->wsrep_ws_map= map;
+        thd->wsrep_ws_map_len= total_length;
+        buff.ptr = map;
+        buff.len = total_length;
+    }
+    else
+    {
+        DBUG_ASSERT(0);
+        goto fallback;
+    }
+
+    if (buff.len > 0)
+    {
+        err = wsrep->append_data(wsrep, &thd->wsrep_ws_handle, &buff, 1,
+                                 WSREP_DATA_ORDERED, false);
+        if (WSREP_OK != err)
+        {
+            WSREP_WARN("append_data() returned %d", err);
+        }
+    }
+
+    if (WSREP_OK == err) *len = total_length;
+
+cleanup:
+    if (reinit_io_cache(cache, WRITE_CACHE, saved_pos, 0, 0))
+    {
+        WSREP_ERROR("failed to reinitialize io-cache");
+    }
+
+    if (unlikely(WSREP_OK != err)) wsrep_dump_rbr_direct(thd, cache);
+
+    return err;
+
+fallback:
+    if (reinit_io_cache(cache, WRITE_CACHE, saved_pos, 0, 0))
+    {
+        WSREP_ERROR("failed to reinitialize io-cache");
+        return WSREP_TRX_ERROR;
+    }
+    return wsrep_write_cache_once(wsrep, thd, cache, len);
+}
+
 /*
   Write the contents of a cache to wsrep provider.
 
@@ -296,6 +413,9 @@ int wsrep_write_cache(wsrep_t*  const wsrep,
     if (wsrep_incremental_data_collection) {
         return wsrep_write_cache_inc(wsrep, thd, cache, len);
     }
+    else if (wsrep_zero_copy_writeset) {
+        return wsrep_write_cache_zero_copy(wsrep, thd, cache, len);
+    }
     else {
         return wsrep_write_cache_once(wsrep, thd, cache, len);
     }
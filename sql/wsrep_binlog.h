@@ -43,6 +43,13 @@ int wsrep_write_cache (wsrep_t*  wsrep,
                        IO_CACHE* cache,
                        size_t*   len);
 
+/*
+  Release the mapping of a spilled transaction cache which was handed over
+  to provider by reference in wsrep_write_cache(). Safe to call when there
+  is no mapping.
+ */
+void wsrep_release_cache_map(THD* thd);
+
 /* Dump replication buffer to disk */
 void wsrep_dump_rbr_buf(THD *thd, const void* rbr_buf, size_t buf_len);
 
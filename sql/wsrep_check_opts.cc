@@ -50,6 +50,9 @@ static struct opt opts[] =
     { "wsrep_cluster_address",   "0" }, // mysqld.cc
     { "locks_unsafe_for_binlog", "0" }, // ha_innodb.cc
     { "autoinc_lock_mode",       "1" }, // ha_innodb.cc
+    { "innodb_data_home_dir",     "" }, // ha_innodb.cc
+    { "innodb_log_group_home_dir","" }, // ha_innodb.cc
+    { "innodb_undo_directory",    "" }, // ha_innodb.cc
     { 0, 0 }
 };
 
@@ -66,9 +69,17 @@ enum
     LOCKED_IN_MEMORY,
     WSREP_CLUSTER_ADDRESS,
     LOCKS_UNSAFE_FOR_BINLOG,
-    AUTOINC_LOCK_MODE
+    AUTOINC_LOCK_MODE,
+    INNODB_DATA_HOME_DIR,
+    INNODB_LOG_GROUP_HOME_DIR,
+    INNODB_UNDO_DIRECTORY
 };
 
+/* InnoDB file locations, native SST needs them before InnoDB is loaded */
+char wsrep_innodb_data_home_dir[FN_REFLEN]=      "";
+char wsrep_innodb_log_group_home_dir[FN_REFLEN]= "";
+char wsrep_innodb_undo_directory[FN_REFLEN]=     "";
+
 
 /* A class to make a copy of argv[] vector */
 struct argv_copy
@@ -278,6 +289,15 @@ check_opts (int const argc, const char* const argv[], struct opt opts[])
     /* At this point we have updated default values in our option list to
        what has been specified on the command line / my.cnf */
 
+    /* option values point into the copy of argv, which goes away */
+    strmake (wsrep_innodb_data_home_dir, opts[INNODB_DATA_HOME_DIR].value,
+             sizeof(wsrep_innodb_data_home_dir) - 1);
+    strmake (wsrep_innodb_log_group_home_dir,
+             opts[INNODB_LOG_GROUP_HOME_DIR].value,
+             sizeof(wsrep_innodb_log_group_home_dir) - 1);
+    strmake (wsrep_innodb_undo_directory, opts[INNODB_UNDO_DIRECTORY].value,
+             sizeof(wsrep_innodb_undo_directory) - 1);
+
     long long slave_threads;
     err = get_long_long (opts[WSREP_SLAVE_THREADS], &slave_threads, 10);
     if (err) return err;
@@ -0,0 +1,323 @@
+/* Copyright (C) 2015 Codership Oy <info@codership.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA. */
+
+#include "wsrep_hotkey.h"
+
+#include "sql_class.h"    // THD, SHOW_VAR
+#include "sql_show.h"     // schema_table_store_record()
+#include "sql_parse.h"    // check_global_access()
+#include "table.h"        // ST_FIELD_INFO
+#include "wsrep_priv.h"
+#include "my_murmur3.h"
+
+namespace wsp
+{
+
+uint32 cm_sketch::add(ulonglong hash, uint32 n)
+{
+  uint32 ret= UINT_MAX32;
+  for (uint row= 0; row < depth; ++row)
+  {
+    uint32 const c= (uint32)my_atomic_add32(&counts_[row][index(hash, row)],
+                                            (int32)n) + n;
+    if (c < ret) ret= c;
+  }
+  return ret;
+}
+
+uint32 cm_sketch::estimate(ulonglong hash)
+{
+  uint32 ret= UINT_MAX32;
+  for (uint row= 0; row < depth; ++row)
+  {
+    uint32 const c= (uint32)my_atomic_load32(&counts_[row][index(hash, row)]);
+    if (c < ret) ret= c;
+  }
+  return ret;
+}
+
+void cm_sketch::halve()
+{
+  for (uint row= 0; row < depth; ++row)
+    for (uint i= 0; i < width; ++i)
+      my_atomic_store32(&counts_[row][i],
+                        (int32)((uint32)my_atomic_load32(&counts_[row][i]) >> 1));
+}
+
+void cm_sketch::clear()
+{
+  memset(counts_, 0, sizeof(counts_));
+}
+
+} /* namespace wsp */
+
+ulong wsrep_hot_key_sampling= 0;
+ulong wsrep_hot_key_throttle= 0;
+
+/* a key is hot if it has had at least this many recent conflicts */
+#define WSREP_HOT_KEY_CONFLICTS 2
+/* sketches are halved this often to forget old history */
+#define WSREP_HOT_KEY_DECAY     10000000ULL /* microseconds */
+/* number of hottest keys to keep names of */
+#define WSREP_HOT_KEY_TOP       32
+#define WSREP_HOT_KEY_DATA_LEN  32
+
+static wsp::cm_sketch hot_key_writes;
+static wsp::cm_sketch hot_key_conflicts;
+
+struct wsrep_hot_key
+{
+  ulonglong hash;
+  uint32    writes;                        /* estimate when last sampled */
+  char      db[NAME_LEN + 1];
+  char      table[NAME_LEN + 1];
+  uchar     data[WSREP_HOT_KEY_DATA_LEN];  /* key value prefix */
+  uint      data_len;
+};
+
+/* protected by LOCK_wsrep_hot_key */
+static wsrep_hot_key hot_key_top[WSREP_HOT_KEY_TOP];
+static uint          hot_key_top_num= 0;
+static int32         hot_key_top_min= 0;  /* lowest writes if top is full */
+
+static int64 hot_key_decayed_at= 0;
+static int64 hot_key_received= WSREP_SEQNO_UNDEFINED;
+static int64 hot_key_applied=  WSREP_SEQNO_UNDEFINED;
+static int32 hot_key_waiters= 0;
+static long long hot_key_delays= 0;
+
+static void wsrep_hot_key_decay()
+{
+  int64 const now((int64)my_micro_time());
+  int64 then(my_atomic_load64(&hot_key_decayed_at));
+
+  if (now - then < (int64)WSREP_HOT_KEY_DECAY ||
+      !my_atomic_cas64(&hot_key_decayed_at, &then, now))
+    return;
+
+  hot_key_writes.halve();
+  hot_key_conflicts.halve();
+
+  mysql_mutex_lock(&LOCK_wsrep_hot_key);
+  for (uint i= 0; i < hot_key_top_num; ++i)
+    hot_key_top[i].writes>>= 1;
+  my_atomic_store32(&hot_key_top_min, my_atomic_load32(&hot_key_top_min) >> 1);
+  mysql_mutex_unlock(&LOCK_wsrep_hot_key);
+}
+
+static void wsrep_hot_key_top_update(ulonglong hash, uint32 writes,
+                                     const wsrep_buf_t* key_parts,
+                                     size_t key_parts_num)
+{
+  if (hot_key_top_num == WSREP_HOT_KEY_TOP &&
+      writes <= (uint32)my_atomic_load32(&hot_key_top_min))
+    return;
+
+  mysql_mutex_lock(&LOCK_wsrep_hot_key);
+
+  uint pos= hot_key_top_num;
+  uint min= 0;
+  for (uint i= 0; i < hot_key_top_num; ++i)
+  {
+    if (hot_key_top[i].hash == hash) { pos= i; break; }
+    if (hot_key_top[i].writes < hot_key_top[min].writes) min= i;
+  }
+
+  if (pos == WSREP_HOT_KEY_TOP)
+  {
+    if (writes <= hot_key_top[min].writes)
+    {
+      mysql_mutex_unlock(&LOCK_wsrep_hot_key);
+      return;
+    }
+    pos= min;
+  }
+
+  wsrep_hot_key* const k(&hot_key_top[pos]);
+  if (pos == hot_key_top_num || k->hash != hash)
+  {
+    if (pos == hot_key_top_num) hot_key_top_num++;
+    k->hash= hash;
+    k->db[0]= k->table[0]= '\0';
+    if (key_parts_num >= 3)
+    {
+      strmake(k->db, (const char*)key_parts[0].ptr,
+              MY_MIN(key_parts[0].len, NAME_LEN));
+      strmake(k->table, (const char*)key_parts[1].ptr,
+              MY_MIN(key_parts[1].len, NAME_LEN));
+    }
+    const wsrep_buf_t& data(key_parts[key_parts_num - 1]);
+    k->data_len= MY_MIN(data.len, WSREP_HOT_KEY_DATA_LEN);
+    memcpy(k->data, data.ptr, k->data_len);
+  }
+  k->writes= writes;
+
+  if (hot_key_top_num == WSREP_HOT_KEY_TOP)
+  {
+    uint32 m= hot_key_top[0].writes;
+    for (uint i= 1; i < hot_key_top_num; ++i)
+      if (hot_key_top[i].writes < m) m= hot_key_top[i].writes;
+    my_atomic_store32(&hot_key_top_min, (int32)m);
+  }
+
+  mysql_mutex_unlock(&LOCK_wsrep_hot_key);
+}
+
+void wsrep_hot_key_append(THD* thd, const wsrep_buf_t* key_parts,
+                          size_t key_parts_num)
+{
+  ulong const sampling(wsrep_hot_key_sampling);
+  if (!sampling || !key_parts_num) return;
+
+  uint32 h1= 0, h2= 0x9e3779b9;
+  for (size_t i= 0; i < key_parts_num; ++i)
+  {
+    h1= murmur3_32((const uchar*)key_parts[i].ptr, key_parts[i].len, h1);
+    h2= murmur3_32((const uchar*)key_parts[i].ptr, key_parts[i].len, h2);
+  }
+  ulonglong const hash((ulonglong)h2 << 32 | h1);
+
+  if (thd->wsrep_hot_keys_num < WSREP_HOT_KEY_TRX_KEYS)
+    thd->wsrep_hot_keys[thd->wsrep_hot_keys_num++]= hash;
+
+  if (++thd->wsrep_hot_key_appends % sampling) return;
+
+  wsrep_hot_key_decay();
+  uint32 const writes(hot_key_writes.add(hash, (uint32)sampling));
+  wsrep_hot_key_top_update(hash, writes, key_parts, key_parts_num);
+}
+
+void wsrep_hot_key_conflict(THD* thd)
+{
+  if (wsrep_hot_key_sampling)
+  {
+    wsrep_hot_key_decay();
+    for (uint i= 0; i < thd->wsrep_hot_keys_num; ++i)
+      hot_key_conflicts.add(thd->wsrep_hot_keys[i], 1);
+  }
+  thd->wsrep_hot_keys_num= 0;
+}
+
+void wsrep_hot_key_apply_begin(wsrep_seqno_t seqno)
+{
+  int64 cur(my_atomic_load64(&hot_key_received));
+  while (cur < seqno && !my_atomic_cas64(&hot_key_received, &cur, seqno)) {}
+}
+
+void wsrep_hot_key_apply_end(wsrep_seqno_t seqno)
+{
+  int64 cur(my_atomic_load64(&hot_key_applied));
+  while (cur < seqno && !my_atomic_cas64(&hot_key_applied, &cur, seqno)) {}
+
+  if (my_atomic_load32(&hot_key_waiters))
+  {
+    mysql_mutex_lock(&LOCK_wsrep_hot_key);
+    mysql_cond_broadcast(&COND_wsrep_hot_key);
+    mysql_mutex_unlock(&LOCK_wsrep_hot_key);
+  }
+}
+
+/*
+  Certification fails when a write set ordered after the transaction has
+  last seen the database conflicts with it. If the transaction has written
+  keys with recent conflicts, let write sets which are being applied
+  commit first: the transaction then replicates with a later last seen
+  seqno or, if they touch its rows, gets BF aborted before spending more
+  work on a doomed commit.
+*/
+void wsrep_hot_key_throttle_commit(THD* thd)
+{
+  ulong const throttle(wsrep_hot_key_throttle);
+  if (!throttle || !wsrep_hot_key_sampling) return;
+
+  bool hot(false);
+  for (uint i= 0; !hot && i < thd->wsrep_hot_keys_num; ++i)
+    hot= (hot_key_conflicts.estimate(thd->wsrep_hot_keys[i]) >=
+          WSREP_HOT_KEY_CONFLICTS);
+  if (!hot) return;
+
+  int64 const target(my_atomic_load64(&hot_key_received));
+  if (my_atomic_load64(&hot_key_applied) >= target) return;
+
+  static PSI_stage_info stage_wsrep_hot_key_wait=
+    { 0, "wsrep waiting for hot key appliers", 0};
+  PSI_stage_info old_stage;
+  struct timespec deadline;
+  set_timespec_nsec(deadline, (ulonglong)throttle * 1000);
+
+  my_atomic_add64(&hot_key_delays, 1);
+  my_atomic_add32(&hot_key_waiters, 1);
+  mysql_mutex_lock(&LOCK_wsrep_hot_key);
+  thd->ENTER_COND(&COND_wsrep_hot_key, &LOCK_wsrep_hot_key,
+                  &stage_wsrep_hot_key_wait, &old_stage);
+  while (my_atomic_load64(&hot_key_applied) < target &&
+         thd->wsrep_conflict_state == NO_CONFLICT &&
+         !thd->killed &&
+         !mysql_cond_timedwait(&COND_wsrep_hot_key, &LOCK_wsrep_hot_key,
+                               &deadline)) {}
+  thd->EXIT_COND(&old_stage);
+  my_atomic_add32(&hot_key_waiters, -1);
+}
+
+int wsrep_show_hot_key_delays(THD* thd, SHOW_VAR* var, char* buff)
+{
+  *(longlong*)buff= my_atomic_load64(&hot_key_delays);
+  var->type= SHOW_LONGLONG;
+  var->value= buff;
+  return 0;
+}
+
+ST_FIELD_INFO wsrep_hot_keys_fields[]=
+{
+  {"TABLE_SCHEMA", NAME_CHAR_LEN, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE},
+  {"TABLE_NAME", NAME_CHAR_LEN, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE},
+  {"KEY_DATA", 2 * WSREP_HOT_KEY_DATA_LEN, MYSQL_TYPE_STRING, 0, 0, 0,
+   SKIP_OPEN_TABLE},
+  {"WRITES", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {"CONFLICTS", MY_INT64_NUM_DECIMAL_DIGITS, MYSQL_TYPE_LONGLONG, 0,
+   MY_I_S_UNSIGNED, 0, SKIP_OPEN_TABLE},
+  {0, 0, MYSQL_TYPE_STRING, 0, 0, 0, SKIP_OPEN_TABLE}
+};
+
+int wsrep_fill_hot_keys(THD* thd, TABLE_LIST* tables, Item*)
+{
+  DBUG_ENTER("wsrep_fill_hot_keys");
+
+  if (check_global_access(thd, PROCESS_ACL)) DBUG_RETURN(0);
+
+  wsrep_hot_key top[WSREP_HOT_KEY_TOP];
+  mysql_mutex_lock(&LOCK_wsrep_hot_key);
+  uint const num(hot_key_top_num);
+  memcpy(top, hot_key_top, num * sizeof(top[0]));
+  mysql_mutex_unlock(&LOCK_wsrep_hot_key);
+
+  TABLE* const table(tables->table);
+  for (uint i= 0; i < num; ++i)
+  {
+    char hex[2 * WSREP_HOT_KEY_DATA_LEN + 1];
+    char* const end(octet2hex(hex, (const char*)top[i].data, top[i].data_len));
+
+    table->field[0]->store(top[i].db, strlen(top[i].db), system_charset_info);
+    table->field[1]->store(top[i].table, strlen(top[i].table),
+                           system_charset_info);
+    table->field[2]->store(hex, end - hex, system_charset_info);
+    table->field[3]->store(hot_key_writes.estimate(top[i].hash), true);
+    table->field[4]->store(hot_key_conflicts.estimate(top[i].hash), true);
+    if (schema_table_store_record(thd, table)) DBUG_RETURN(1);
+  }
+
+  DBUG_RETURN(0);
+}
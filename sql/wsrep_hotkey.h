@@ -0,0 +1,91 @@
+/* Copyright (C) 2015 Codership Oy <info@codership.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA. */
+
+#ifndef WSREP_HOTKEY_H
+#define WSREP_HOTKEY_H
+
+#include "my_global.h"
+#include "my_atomic.h"
+#include "../wsrep/wsrep_api.h"
+
+class THD;
+class Item;
+struct TABLE_LIST;
+struct st_field_info;
+struct st_mysql_show_var;
+
+namespace wsp
+{
+
+/*
+  Count-min sketch of 64-bit key hashes. Estimates never undercount, and
+  overcount only by collisions in all rows. Counters are updated with
+  atomic operations, halve() may lose concurrent increments, which is
+  fine for an estimate.
+*/
+class cm_sketch
+{
+public:
+
+  static const uint depth= 4;
+  static const uint width= 4096; /* power of 2 */
+
+  cm_sketch() { clear(); }
+
+  /* adds n to the key count, returns new estimate */
+  uint32 add (ulonglong hash, uint32 n);
+  uint32 estimate (ulonglong hash);
+  void   halve ();
+  void   clear ();
+
+private:
+
+  /* double hashing, rows use h1 + row * h2 */
+  static uint index (ulonglong hash, uint row)
+  {
+    uint32 const h1= (uint32)hash;
+    uint32 const h2= (uint32)(hash >> 32) | 1;
+    return (h1 + row * h2) & (width - 1);
+  }
+
+  int32 counts_[depth][width];
+};
+
+} /* namespace wsp */
+
+/* number of key hashes a local transaction remembers for conflict stats */
+#define WSREP_HOT_KEY_TRX_KEYS 8
+
+extern ulong wsrep_hot_key_sampling;
+extern ulong wsrep_hot_key_throttle;
+
+/* local transaction has appended key of key_parts_num parts */
+void wsrep_hot_key_append(THD* thd, const wsrep_buf_t* key_parts,
+                          size_t key_parts_num);
+/* local transaction has lost certification or was BF aborted */
+void wsrep_hot_key_conflict(THD* thd);
+/* delays commit of local transaction which has written hot keys */
+void wsrep_hot_key_throttle_commit(THD* thd);
+/* applier has started / finished applying write set */
+void wsrep_hot_key_apply_begin(wsrep_seqno_t seqno);
+void wsrep_hot_key_apply_end(wsrep_seqno_t seqno);
+
+int  wsrep_show_hot_key_delays(THD* thd, st_mysql_show_var* var, char* buff);
+
+/* INFORMATION_SCHEMA.WSREP_HOT_KEYS, see plugin/wsrep_info */
+extern st_field_info wsrep_hot_keys_fields[];
+int  wsrep_fill_hot_keys(THD* thd, TABLE_LIST* tables, Item* cond);
+
+#endif /* WSREP_HOTKEY_H */
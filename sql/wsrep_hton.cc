@@ -21,6 +21,7 @@
 #include "wsrep_mysqld.h"
 #include "wsrep_binlog.h"
 #include "wsrep_xid.h"
+#include "wsrep_ws_log.h"
 #include <cstdio>
 #include <cstdlib>
 #include "debug_sync.h"
@@ -40,6 +41,7 @@ void wsrep_cleanup_transaction(THD *thd)
 {
   if (!WSREP(thd)) return;
 
+  wsrep_release_cache_map(thd);
   if (wsrep_emulate_bin_log) thd_binlog_trx_reset(thd);
   thd->wsrep_ws_handle.trx_id= WSREP_UNDEFINED_TRX_ID;
   thd->wsrep_trx_meta.gtid= WSREP_GTID_UNDEFINED;
@@ -47,6 +49,7 @@ void wsrep_cleanup_transaction(THD *thd)
   thd->wsrep_exec_mode= LOCAL_STATE;
   thd->wsrep_affected_rows= 0;
   thd->wsrep_skip_wsrep_GTID= false;
+  thd->wsrep_hot_keys_num= 0;
   return;
 }
 
@@ -352,6 +355,8 @@ wsrep_run_wsrep_commit(THD *thd, handlerton *hton, bool all)
 
   DBUG_PRINT("wsrep", ("replicating commit"));
 
+  wsrep_hot_key_throttle_commit(thd);
+
   mysql_mutex_lock(&thd->LOCK_wsrep_thd);
   if (thd->wsrep_conflict_state == MUST_ABORT) {
     DBUG_PRINT("wsrep", ("replicate commit fail"));
@@ -470,16 +475,19 @@ wsrep_run_wsrep_commit(THD *thd, handlerton *hton, bool all)
   }
   else if (!rcode)
   {
+    uint32_t const flags(WSREP_FLAG_COMMIT |
+                         ((thd->wsrep_PA_safe) ? 0ULL : WSREP_FLAG_PA_UNSAFE));
     if (WSREP_OK == rcode)
       rcode = wsrep->pre_commit(wsrep,
                                 (wsrep_conn_id_t)thd->thread_id,
                                 &thd->wsrep_ws_handle,
-                                WSREP_FLAG_COMMIT |
-                                ((thd->wsrep_PA_safe) ?
-                                 0ULL : WSREP_FLAG_PA_UNSAFE),
+                                flags,
                                 &thd->wsrep_trx_meta);
 
-    if (rcode == WSREP_TRX_MISSING) {
+    if (WSREP_OK == rcode) {
+      /* in commit order now, see wsrep_ws_log_append() */
+      wsrep_ws_log_local(thd, cache, flags);
+    } else if (rcode == WSREP_TRX_MISSING) {
       WSREP_WARN("Transaction missing in provider thd: %ld schema: %s SQL: %s",
                  thd->thread_id, (thd->db ? thd->db : "(null)"),
                  WSREP_QUERY(thd));
@@ -563,6 +571,8 @@ wsrep_run_wsrep_commit(THD *thd, handlerton *hton, bool all)
     }
     mysql_mutex_unlock(&thd->LOCK_wsrep_thd);
 
+    wsrep_hot_key_conflict(thd);
+
     DBUG_RETURN(WSREP_TRX_CERT_FAIL);
 
   case WSREP_SIZE_EXCEEDED:
@@ -26,6 +26,7 @@
 #include "wsrep_binlog.h"
 #include "wsrep_applier.h"
 #include "wsrep_xid.h"
+#include "wsrep_ws_log.h"
 #include <cstdio>
 #include <cstdlib>
 #include "log_event.h"
@@ -45,6 +46,9 @@ const char* wsrep_data_home_dir = NULL;
 const char* wsrep_dbug_option   = "";
 
 long    wsrep_slave_threads            = 1; // # of slave action appliers wanted
+ulong   wsrep_slave_decode_threads     = 0; // # of write set decoding helpers
+ulong   wsrep_rollbacker_threads       = 1; // # of BF abort rollbackers
+my_bool wsrep_slave_group_commit       = 0; // batch applier redo flushes
 int     wsrep_slave_count_change       = 0; // # of appliers to stop or start
 my_bool wsrep_debug                    = 0; // enable debug level logging
 my_bool wsrep_convert_LOCK_to_trx      = 1; // convert locking sessions to trx
@@ -52,6 +56,7 @@ ulong   wsrep_retry_autocommit         = 5; // retry aborted autocommit trx
 my_bool wsrep_auto_increment_control   = 1; // control auto increment variables
 my_bool wsrep_drupal_282555_workaround = 1; // retry autoinc insert after dupkey
 my_bool wsrep_incremental_data_collection = 0; // incremental data collection
+my_bool wsrep_zero_copy_writeset       = 0; // hand cache pages to provider
 ulong   wsrep_max_ws_size              = 1073741824UL;//max ws (RBR buffer) size
 ulong   wsrep_max_ws_rows              = 65536; // max number of rows in ws
 int     wsrep_to_isolation             = 0; // # of active TO isolation threads
@@ -76,6 +81,7 @@ my_bool wsrep_slave_FK_checks          = 0; // slave thread does FK checks
  */
 
 static wsrep_uuid_t cluster_uuid = WSREP_UUID_UNDEFINED;
+static wsrep_uuid_t node_uuid    = WSREP_UUID_UNDEFINED;
 static char         cluster_uuid_str[40]= { 0, };
 static const char*  cluster_status_str[WSREP_VIEW_MAX] =
 {
@@ -99,6 +105,8 @@ const char* wsrep_cluster_status = cluster_status_str[WSREP_VIEW_DISCONNECTED];
 long        wsrep_cluster_size       = 0;
 long        wsrep_local_index        = -1;
 long long   wsrep_local_bf_aborts    = 0;
+long long   wsrep_local_sync_waits   = 0; // statements that did sync wait
+long long   wsrep_local_sync_wait_rounds = 0; // causal reads sent to provider
 const char* wsrep_provider_name      = provider_name;
 const char* wsrep_provider_version   = provider_version;
 const char* wsrep_provider_vendor    = provider_vendor;
@@ -198,6 +206,8 @@ wsrep_view_handler_cb (void*                    app_ctx,
   wsrep_cluster_status= cluster_status_str[view->status];
   wsrep_cluster_size= view->memb_num;
   wsrep_local_index= view->my_idx;
+  if (view->my_idx >= 0)
+    memcpy(&node_uuid, &view->members[view->my_idx].id, sizeof(node_uuid));
 
   WSREP_INFO("New cluster view: global state: %s:%lld, view# %lld: %s, "
              "number of nodes: %ld, my index: %ld, protocol version %d",
@@ -219,12 +229,15 @@ wsrep_view_handler_cb (void*                    app_ctx,
     goto out;
   }
 
+  wsrep_nbo_view_change(view);
+
   switch (view->proto_ver)
   {
   case 0:
   case 1:
   case 2:
   case 3:
+  case 4:
       // version change
       if (view->proto_ver != wsrep_protocol_version)
       {
@@ -648,6 +661,10 @@ void wsrep_init_startup (bool first)
   /* Skip replication start if no cluster address */
   if (!wsrep_cluster_address || strlen(wsrep_cluster_address) == 0) return;
 
+  wsrep_ws_log_init();
+  wsrep_ws_log_position(local_uuid, local_seqno);
+  wsrep_nbo_start_position(local_uuid, local_seqno);
+
   if (first) wsrep_sst_grab(); // do it so we can wait for SST below
 
   if (!wsrep_start_replication()) unireg_abort(1);
@@ -661,6 +678,8 @@ void wsrep_init_startup (bool first)
 
 void wsrep_deinit()
 {
+  wsrep_group_commit_stop();
+  wsrep_ws_log_deinit();
   wsrep_unload(wsrep);
   wsrep= 0;
   provider_name[0]=    '\0';
@@ -708,6 +727,9 @@ void wsrep_stop_replication(THD *thd)
   /* wait until appliers have stopped */
   wsrep_wait_appliers_close(thd);
 
+  /* make commits of the last applied write sets durable */
+  wsrep_group_commit_stop();
+
   return;
 }
 
@@ -810,6 +832,74 @@ bool wsrep_must_sync_wait (THD* thd, uint mask)
     thd->wsrep_sync_wait_gtid.seqno == WSREP_SEQNO_UNDEFINED;
 }
 
+/*
+  Causal reads are batched: at most one wsrep->causal_read() is in flight
+  and the sessions that arrive while it is running wait for the next one,
+  which is then issued once on behalf of all of them. A round started
+  after the session arrived is causally after it, so its GTID and applied
+  watermark satisfy every session of the round (or of any later round).
+*/
+static PSI_stage_info stage_wsrep_sync_wait=
+  { 0, "Waiting for causal read", 0};
+
+static ulonglong      sync_wait_issued=   0; // last round started
+static ulonglong      sync_wait_done=     0; // last round completed
+static bool           sync_wait_running=  false;
+static wsrep_status_t sync_wait_ret=      WSREP_OK;
+static wsrep_gtid_t   sync_wait_gtid=     WSREP_GTID_UNDEFINED;
+
+static wsrep_status_t wsrep_causal_read (THD* thd, wsrep_gtid_t* gtid)
+{
+  wsrep_status_t ret;
+  PSI_stage_info old_stage;
+
+  mysql_mutex_lock(&LOCK_wsrep_sync_wait);
+
+  ulonglong const round= sync_wait_issued + 1;
+  ++wsrep_local_sync_waits;
+
+  thd->ENTER_COND(&COND_wsrep_sync_wait, &LOCK_wsrep_sync_wait,
+                  &stage_wsrep_sync_wait, &old_stage);
+
+  while (sync_wait_done < round)
+  {
+    if (!sync_wait_running)
+    {
+      /* lead the round for everybody waiting */
+      sync_wait_running= true;
+      sync_wait_issued= round;
+      ++wsrep_local_sync_wait_rounds;
+      mysql_mutex_unlock(&LOCK_wsrep_sync_wait);
+
+      wsrep_gtid_t round_gtid;
+      ret= wsrep->causal_read (wsrep, &round_gtid);
+
+      mysql_mutex_lock(&LOCK_wsrep_sync_wait);
+      sync_wait_ret=     ret;
+      sync_wait_gtid=    round_gtid;
+      sync_wait_done=    round;
+      sync_wait_running= false;
+      mysql_cond_broadcast(&COND_wsrep_sync_wait);
+      break;
+    }
+
+    if (thd->killed)
+    {
+      thd->EXIT_COND(&old_stage);
+      return WSREP_CONN_FAIL;
+    }
+
+    mysql_cond_wait(&COND_wsrep_sync_wait, &LOCK_wsrep_sync_wait);
+  }
+
+  ret=   sync_wait_ret;
+  *gtid= sync_wait_gtid;
+
+  thd->EXIT_COND(&old_stage);
+
+  return ret;
+}
+
 bool wsrep_sync_wait (THD* thd, uint mask)
 {
   if (wsrep_must_sync_wait(thd, mask))
@@ -818,13 +908,19 @@ bool wsrep_sync_wait (THD* thd, uint mask)
                 thd->variables.wsrep_sync_wait, mask);
     // This allows autocommit SELECTs and a first SELECT after SET AUTOCOMMIT=0
     // TODO: modify to check if thd has locked any rows.
-    wsrep_status_t ret= wsrep->causal_read (wsrep, &thd->wsrep_sync_wait_gtid);
+    wsrep_status_t ret= wsrep_causal_read (thd, &thd->wsrep_sync_wait_gtid);
 
     if (unlikely(WSREP_OK != ret))
     {
       const char* msg;
       int err;
 
+      if (thd->killed)
+      {
+        thd->send_kill_message();
+        return true;
+      }
+
       // Possibly relevant error codes:
       // ER_CHECKREAD, ER_ERROR_ON_READ, ER_INVALID_DEFAULT, ER_EMPTY_QUERY,
       // ER_FUNCTION_NOT_DEFINED, ER_NOT_ALLOWED_COMMAND, ER_NOT_SUPPORTED_YET,
@@ -889,6 +985,7 @@ static bool wsrep_prepare_key_for_isolation(const char* db,
     case 1:
     case 2:
     case 3:
+    case 4:
     {
         *key_len= 0;
         if (db)
@@ -1009,6 +1106,7 @@ bool wsrep_prepare_key_for_innodb(const uchar* cache_key,
     case 1:
     case 2:
     case 3:
+    case 4:
     {
         key[0].ptr = cache_key;
         key[0].len = strlen( (char*)cache_key );
@@ -1345,6 +1443,8 @@ static int wsrep_TOI_begin(THD *thd, char *db_, char *table_,
   {
     thd->wsrep_exec_mode= TOTAL_ORDER;
     wsrep_to_isolation++;
+    wsrep_ws_log_append(&thd->wsrep_trx_meta,
+                        WSREP_FLAG_COMMIT | WSREP_FLAG_ISOLATION, buf, buf_len);
     if (buf) my_free(buf);
     wsrep_keys_free(&key_arr);
     WSREP_DEBUG("TO BEGIN: %lld, %d",(long long)wsrep_thd_trx_seqno(thd),
@@ -1392,6 +1492,285 @@ static void wsrep_TOI_end(THD *thd) {
   }
 }
 
+/*
+  Takes explicit exclusive MDL locks on tables given by schema/table name
+  pairs. Locks are acquired by the caller's thd, so for BF threads
+  conflicting local transactions are aborted.
+  @return array of *locks granted requests on thd->mem_root or NULL
+*/
+MDL_request* wsrep_nbo_lock_tables(THD* thd, const char* const* names,
+                                   uint count, uint* locks)
+{
+  MDL_request_list requests;
+  MDL_request* const reqs((MDL_request*)
+                          alloc_root(thd->mem_root,
+                                     (2 * count + 1) * sizeof(MDL_request)));
+  if (!reqs) return NULL;
+
+  uint n= 0;
+  reqs[n].init(MDL_key::GLOBAL, "", "", MDL_INTENTION_EXCLUSIVE, MDL_EXPLICIT);
+  requests.push_front(&reqs[n++]);
+  for (uint i= 0; i < count; ++i)
+  {
+    reqs[n].init(MDL_key::SCHEMA, names[2 * i], "",
+                 MDL_INTENTION_EXCLUSIVE, MDL_EXPLICIT);
+    requests.push_front(&reqs[n++]);
+    reqs[n].init(MDL_key::TABLE, names[2 * i], names[2 * i + 1],
+                 MDL_EXCLUSIVE, MDL_EXPLICIT);
+    requests.push_front(&reqs[n++]);
+  }
+
+  if (thd->mdl_context.acquire_locks(&requests,
+                                     thd->variables.lock_wait_timeout))
+    return NULL;
+
+  if (locks) *locks= n;
+  return reqs;
+}
+
+/*
+  Downgrades table locks taken by wsrep_nbo_lock_tables() when the operation
+  is over: local statements are still kept out, but appliers waiting for
+  the operation (see wsrep_grant_mdl_exception()) get the tables.
+*/
+void wsrep_nbo_unblock_tables(MDL_request* reqs, uint count)
+{
+  for (uint i= 0; reqs && i < count; ++i)
+  {
+    if (reqs[i].key.mdl_namespace() == MDL_key::TABLE && reqs[i].ticket)
+      reqs[i].ticket->downgrade_lock(MDL_SHARED_NO_READ_WRITE);
+  }
+}
+
+static void wsrep_NBO_finish(THD *thd, uchar type);
+
+/* State of NBO at originator between begin and end events */
+struct wsrep_nbo_local
+{
+  wsrep_key_arr_t keys;
+  MDL_request*    locks;
+  uint            locks_num;
+  wsrep_seqno_t   seqno;     /* seqno of the begin event */
+};
+
+/*
+  NBO events can only be replicated when all nodes understand them, which
+  the provider announces with its own capability, independent of the
+  application protocol version.
+*/
+static bool wsrep_nbo_capable()
+{
+  return (wsrep->capabilities(wsrep) & WSREP_CAP_NBO);
+}
+
+/*
+  Decide if statement can run as NBO: a single table ALTER (other than
+  RENAME and foreign key changes, which involve other tables), CREATE
+  INDEX or DROP INDEX, when all nodes understand NBO events.
+*/
+static bool wsrep_can_run_in_nbo(THD *thd, const char *db, const char *table,
+                                 const TABLE_LIST *table_list)
+{
+  if (!wsrep_nbo_capable() || thd->locked_tables_mode ||
+      thd->mdl_context.wsrep_has_explicit_locks())
+    return false;
+
+  switch (thd->lex->sql_command)
+  {
+  case SQLCOM_ALTER_TABLE:
+    if (db || table || !table_list || table_list->next_global ||
+        (thd->lex->alter_info.flags & (Alter_info::ALTER_RENAME |
+                                       Alter_info::ADD_FOREIGN_KEY |
+                                       Alter_info::DROP_FOREIGN_KEY)))
+      return false;
+    return !find_temporary_table(thd, table_list->db, table_list->table_name);
+  case SQLCOM_CREATE_INDEX:
+  case SQLCOM_DROP_INDEX:
+    return (db && table && !table_list && !find_temporary_table(thd, db, table));
+  default:
+    return false;
+  }
+}
+
+/*
+  returns:
+   0: statement was replicated as NBO or TOI
+   1: replication was skipped
+  -1: replication failed
+ */
+static int wsrep_NBO_begin(THD *thd, char *db_, char *table_,
+                           const TABLE_LIST* table_list)
+{
+  if (!wsrep_can_run_in_nbo(thd, db_, table_, table_list))
+  {
+    WSREP_DEBUG("No NBO for %s, using TOI", WSREP_QUERY(thd));
+    return wsrep_TOI_begin(thd, db_, table_, table_list);
+  }
+
+  WSREP_DEBUG("NBO BEGIN: %s", WSREP_QUERY(thd));
+
+  const char* names[2];
+  names[0]= db_ ? db_ : table_list->db;
+  names[1]= db_ ? table_ : table_list->table_name;
+
+  size_t const names_len(strlen(names[0]) + strlen(names[1]) + 2);
+  uchar*       events(0);
+  size_t       events_len(0);
+  uchar*       buf(0);
+  size_t       buf_len(0);
+
+  wsrep_nbo_local* const nbo(new (thd->mem_root) wsrep_nbo_local);
+  if (!nbo ||
+      wsrep_to_buf_helper(thd, thd->query(), thd->query_length(),
+                          &events, &events_len) ||
+      !(buf= (uchar*)my_malloc(WSREP_NBO_HEADER_LEN + names_len + events_len,
+                               MYF(MY_ZEROFILL))))
+  {
+    my_free(events);
+    my_error(ER_OUT_OF_RESOURCES, MYF(0));
+    return -1;
+  }
+
+  memcpy(buf, WSREP_NBO_MAGIC, sizeof(WSREP_NBO_MAGIC) - 1);
+  buf[EVENT_TYPE_OFFSET]= UNKNOWN_EVENT;
+  buf[5]= WSREP_NBO_BEGIN;
+  int2store(buf + 6, 1);
+  memcpy(buf + 16, &node_uuid, sizeof(node_uuid));
+  buf_len= WSREP_NBO_HEADER_LEN;
+  for (int i= 0; i < 2; ++i)
+  {
+    size_t const len(strlen(names[i]) + 1);
+    memcpy(buf + buf_len, names[i], len);
+    buf_len+= len;
+  }
+  memcpy(buf + buf_len, events, events_len);
+  buf_len+= events_len;
+  my_free(events);
+
+  wsrep_status_t ret(WSREP_WARNING);
+  struct wsrep_buf buff= { buf, buf_len };
+  if (wsrep_prepare_keys_for_isolation(thd, db_, table_, table_list,
+                                       &nbo->keys) ||
+      WSREP_OK != (ret= wsrep->to_execute_start(wsrep, thd->thread_id,
+                                                nbo->keys.keys,
+                                                nbo->keys.keys_len,
+                                                &buff, 1,
+                                                &thd->wsrep_trx_meta)))
+  {
+    WSREP_WARN("NBO begin failed for: %d, schema: %s, sql: %s. Check wsrep "
+               "connection state and retry the query.",
+               ret, (thd->db ? thd->db : "(null)"), WSREP_QUERY(thd));
+    my_error(ER_LOCK_DEADLOCK, MYF(0), "WSREP replication failed. Check "
+             "your wsrep connection state and retry the query.");
+    my_free(buf);
+    wsrep_keys_free(&nbo->keys);
+    return -1;
+  }
+  wsrep_ws_log_append(&thd->wsrep_trx_meta,
+                      WSREP_FLAG_COMMIT | WSREP_FLAG_ISOLATION, buf, buf_len);
+  wsrep_nbo_journal_write(&thd->wsrep_trx_meta, buf, buf_len);
+  my_free(buf);
+
+  /* lock in total order, like appliers do, conflicting locals get aborted */
+  thd->wsrep_exec_mode= TOTAL_ORDER;
+  nbo->seqno= thd->wsrep_trx_meta.gtid.seqno;
+  nbo->locks= wsrep_nbo_lock_tables(thd, names, 1, &nbo->locks_num);
+
+  if (WSREP_OK != (ret= wsrep->to_execute_end(wsrep, thd->thread_id)))
+  {
+    WSREP_WARN("NBO begin end failed for: %d, schema: %s, sql: %s",
+               ret, (thd->db ? thd->db : "(null)"), WSREP_QUERY(thd));
+  }
+
+  wsrep_to_isolation++;
+  mysql_mutex_lock(&thd->LOCK_wsrep_thd);
+  thd->wsrep_nbo= nbo;
+  mysql_mutex_unlock(&thd->LOCK_wsrep_thd);
+
+  if (!nbo->locks)
+  {
+    /* the other nodes are executing already, make them roll back */
+    WSREP_WARN("NBO %lld failed to lock table %s.%s, aborting it on all "
+               "nodes: %s", (long long)nbo->seqno, names[0], names[1],
+               WSREP_QUERY(thd));
+    wsrep_NBO_finish(thd, WSREP_NBO_ABORT);
+    thd->wsrep_exec_mode= LOCAL_STATE;
+    return -1;
+  }
+
+  WSREP_DEBUG("NBO BEGIN: %lld", (long long)nbo->seqno);
+  return 0;
+}
+
+static void wsrep_NBO_end(THD *thd)
+{
+  if (!thd->wsrep_nbo)
+  {
+    /* statement ran in TOI */
+    wsrep_TOI_end(thd);
+    return;
+  }
+
+  wsrep_NBO_finish(thd, WSREP_NBO_END);
+}
+
+/* Replicates end or abort event of the NBO begun by thd */
+static void wsrep_NBO_finish(THD *thd, uchar type)
+{
+  wsrep_nbo_local* const nbo((wsrep_nbo_local*)thd->wsrep_nbo);
+
+  /* appliers waiting for the operation may go on */
+  mysql_mutex_lock(&thd->LOCK_wsrep_thd);
+  thd->wsrep_nbo= NULL;
+  mysql_mutex_unlock(&thd->LOCK_wsrep_thd);
+  wsrep_nbo_unblock_tables(nbo->locks, nbo->locks_num);
+
+  wsrep_to_isolation--;
+  wsrep_nbo_journal_remove(nbo->seqno);
+
+  WSREP_DEBUG("NBO %s: %lld : %s", type == WSREP_NBO_END ? "END" : "ABORT",
+              (long long)nbo->seqno, WSREP_QUERY(thd));
+
+  uchar buf[WSREP_NBO_HEADER_LEN]= { 0, };
+  memcpy(buf, WSREP_NBO_MAGIC, sizeof(WSREP_NBO_MAGIC) - 1);
+  buf[EVENT_TYPE_OFFSET]= UNKNOWN_EVENT;
+  buf[5]= type;
+  int8store(buf + 8, (ulonglong)nbo->seqno);
+  memcpy(buf + 16, &node_uuid, sizeof(node_uuid));
+
+  struct wsrep_buf buff= { buf, sizeof(buf) };
+  wsrep_status_t ret(wsrep->to_execute_start(wsrep, thd->thread_id,
+                                             nbo->keys.keys,
+                                             nbo->keys.keys_len,
+                                             &buff, 1,
+                                             &thd->wsrep_trx_meta));
+
+  for (uint i= 0; nbo->locks && i < nbo->locks_num; ++i)
+    thd->mdl_context.release_lock(nbo->locks[i].ticket);
+
+  wsrep_keys_free(&nbo->keys);
+
+  if (WSREP_OK != ret)
+  {
+    WSREP_WARN("NBO end failed for: %d, schema: %s, sql: %s",
+               ret, (thd->db ? thd->db : "(null)"), WSREP_QUERY(thd));
+    return;
+  }
+
+  wsrep_ws_log_append(&thd->wsrep_trx_meta,
+                      WSREP_FLAG_COMMIT | WSREP_FLAG_ISOLATION,
+                      buf, sizeof(buf));
+
+  wsrep_set_SE_checkpoint(thd->wsrep_trx_meta.gtid.uuid,
+                          thd->wsrep_trx_meta.gtid.seqno);
+
+  if (WSREP_OK != (ret= wsrep->to_execute_end(wsrep, thd->thread_id)))
+  {
+    WSREP_WARN("NBO end end failed for: %d, schema: %s, sql: %s",
+               ret, (thd->db ? thd->db : "(null)"), WSREP_QUERY(thd));
+  }
+}
+
 static int wsrep_RSU_begin(THD *thd, char *db_, char *table_)
 {
   wsrep_status_t ret(WSREP_WARNING);
@@ -1531,6 +1910,9 @@ int wsrep_to_isolation_begin(THD *thd, char *db_, char *table_,
     case WSREP_OSU_RSU:
       ret =  wsrep_RSU_begin(thd, db_, table_);
       break;
+    case WSREP_OSU_NBO:
+      ret =  wsrep_NBO_begin(thd, db_, table_, table_list);
+      break;
     default:
       WSREP_ERROR("Unsupported OSU method: %lu",
                   thd->variables.wsrep_OSU_method);
@@ -1559,6 +1941,7 @@ void wsrep_to_isolation_end(THD *thd)
     {
     case WSREP_OSU_TOI: wsrep_TOI_end(thd); break;
     case WSREP_OSU_RSU: wsrep_RSU_end(thd); break;
+    case WSREP_OSU_NBO: wsrep_NBO_end(thd); break;
     default:
       WSREP_WARN("Unsupported wsrep OSU method at isolation end: %lu",
                  thd->variables.wsrep_OSU_method);
@@ -1606,8 +1989,22 @@ wsrep_grant_mdl_exception(MDL_context *requestor_ctx,
     ticket->wsrep_report(wsrep_debug);
 
     mysql_mutex_lock(&granted_thd->LOCK_wsrep_thd);
-    if (granted_thd->wsrep_exec_mode == TOTAL_ORDER ||
-        granted_thd->wsrep_exec_mode == REPL_RECV)
+    if (granted_thd->wsrep_nbo)
+    {
+      /*
+        NBO is executing on the table: write set can't be applied before
+        the operation is over, the locks are downgraded then (see
+        wsrep_nbo_unblock_tables()). Operation does not need total order
+        to complete, so waiting here can't deadlock.
+      */
+      WSREP_MDL_LOG(DEBUG, "MDL conflict with NBO, waiting", schema,
+                    schema_len, request_thd, granted_thd);
+      ticket->wsrep_report(wsrep_debug);
+      mysql_mutex_unlock(&granted_thd->LOCK_wsrep_thd);
+      ret = FALSE;
+    }
+    else if (granted_thd->wsrep_exec_mode == TOTAL_ORDER ||
+             granted_thd->wsrep_exec_mode == REPL_RECV)
     {
       WSREP_MDL_LOG(INFO, "MDL BF-BF conflict", schema, schema_len,
                     request_thd, granted_thd);
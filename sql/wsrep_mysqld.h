@@ -74,6 +74,11 @@ extern const char* wsrep_node_incoming_address;
 extern const char* wsrep_data_home_dir;
 extern const char* wsrep_dbug_option;
 extern long        wsrep_slave_threads;
+extern ulong       wsrep_slave_decode_threads;
+extern ulong       wsrep_rollbacker_threads;
+extern my_bool     wsrep_slave_group_commit;
+extern long        wsrep_rollbacker_count;
+extern long        wsrep_rollback_queue_len;
 extern int         wsrep_slave_count_change;
 extern MYSQL_PLUGIN_IMPORT my_bool wsrep_debug;
 extern my_bool     wsrep_convert_LOCK_to_trx;
@@ -81,6 +86,7 @@ extern ulong       wsrep_retry_autocommit;
 extern my_bool     wsrep_auto_increment_control;
 extern my_bool     wsrep_drupal_282555_workaround;
 extern my_bool     wsrep_incremental_data_collection;
+extern my_bool     wsrep_zero_copy_writeset;
 extern const char* wsrep_start_position;
 extern ulong       wsrep_max_ws_size;
 extern ulong       wsrep_max_ws_rows;
@@ -111,6 +117,7 @@ enum enum_wsrep_reject_types {
 enum enum_wsrep_OSU_method {
     WSREP_OSU_TOI,
     WSREP_OSU_RSU,
+    WSREP_OSU_NBO,
     WSREP_OSU_NONE,
 };
 
@@ -132,6 +139,8 @@ extern const char* wsrep_cluster_status;
 extern long        wsrep_cluster_size;
 extern long        wsrep_local_index;
 extern long long   wsrep_local_bf_aborts;
+extern long long   wsrep_local_sync_waits;
+extern long long   wsrep_local_sync_wait_rounds;
 extern const char* wsrep_provider_name;
 extern const char* wsrep_provider_version;
 extern const char* wsrep_provider_vendor;
@@ -182,6 +191,7 @@ extern "C" query_id_t wsrep_thd_wsrep_last_query_id(THD *thd);
 extern "C" void wsrep_thd_set_wsrep_last_query_id(THD *thd, query_id_t id);
 extern "C" void wsrep_thd_awake(THD *thd, my_bool signal);
 extern "C" int wsrep_thd_retry_counter(THD *thd);
+extern "C" void wsrep_thd_enqueue_rollback(THD *thd, my_bool priority);
 
 
 extern void wsrep_close_client_connections(my_bool wait_to_end);
@@ -290,6 +300,7 @@ extern "C" bool wsrep_consistency_check(void *thd_ptr);
 typedef struct wsrep_aborting_thd {
   struct wsrep_aborting_thd *next;
   THD *aborting_thd;
+  ulonglong queued_at;      /* my_micro_time() of enqueueing */
 } *wsrep_aborting_thd_t;
 
 extern mysql_mutex_t LOCK_wsrep_ready;
@@ -305,7 +316,14 @@ extern mysql_mutex_t LOCK_wsrep_replaying;
 extern mysql_cond_t  COND_wsrep_replaying;
 extern mysql_mutex_t LOCK_wsrep_slave_threads;
 extern mysql_mutex_t LOCK_wsrep_desync;
-extern wsrep_aborting_thd_t wsrep_aborting_thd;
+extern mysql_mutex_t LOCK_wsrep_group_commit;
+extern mysql_cond_t  COND_wsrep_group_commit;
+extern mysql_mutex_t LOCK_wsrep_sync_wait;
+extern mysql_cond_t  COND_wsrep_sync_wait;
+extern mysql_mutex_t LOCK_wsrep_nbo;
+extern mysql_cond_t  COND_wsrep_nbo;
+extern mysql_mutex_t LOCK_wsrep_hot_key;
+extern mysql_cond_t  COND_wsrep_hot_key;
 extern my_bool       wsrep_emulate_bin_log;
 extern int           wsrep_to_isolation;
 extern rpl_sidno     wsrep_sidno;
@@ -325,6 +343,22 @@ extern PSI_mutex_key key_LOCK_wsrep_replaying;
 extern PSI_cond_key  key_COND_wsrep_replaying;
 extern PSI_mutex_key key_LOCK_wsrep_slave_threads;
 extern PSI_mutex_key key_LOCK_wsrep_desync;
+extern PSI_mutex_key key_LOCK_wsrep_group_commit;
+extern PSI_cond_key  key_COND_wsrep_group_commit;
+extern PSI_mutex_key key_LOCK_wsrep_ws_log;
+extern PSI_mutex_key key_LOCK_wsrep_ws_log_append;
+extern PSI_mutex_key key_LOCK_wsrep_sync_wait;
+extern PSI_cond_key  key_COND_wsrep_sync_wait;
+extern PSI_mutex_key key_LOCK_wsrep_nbo;
+extern PSI_cond_key  key_COND_wsrep_nbo;
+extern PSI_mutex_key key_LOCK_wsrep_hot_key;
+extern PSI_cond_key  key_COND_wsrep_hot_key;
+extern PSI_thread_key key_thread_wsrep_decode;
+extern PSI_thread_key key_thread_wsrep_group_commit;
+extern PSI_thread_key key_thread_wsrep_sst_joiner;
+extern PSI_thread_key key_thread_wsrep_sst_receiver;
+extern PSI_thread_key key_thread_wsrep_sst_donor;
+extern PSI_thread_key key_thread_wsrep_sst_sender;
 #endif /* HAVE_PSI_INTERFACE */
 struct TABLE_LIST;
 int wsrep_to_isolation_begin(THD *thd, char *db_, char *table_,
@@ -356,4 +390,8 @@ bool wsrep_prepare_keys_for_isolation(THD*              thd,
                                       const TABLE_LIST* table_list,
                                       wsrep_key_arr_t*  ka);
 void wsrep_keys_free(wsrep_key_arr_t* key_arr);
+class MDL_request;
+MDL_request* wsrep_nbo_lock_tables(THD* thd, const char* const* names,
+                                   uint count, uint* locks);
+void wsrep_nbo_unblock_tables(MDL_request* reqs, uint count);
 #endif /* WSREP_MYSQLD_H */
@@ -24,8 +24,17 @@
 #include "wsrep_priv.h"
 #include "wsrep_utils.h"
 #include "wsrep_xid.h"
+#include "wsrep_thd.h"
+#include "wsrep_ws_log.h"
+#include <my_dir.h>
 #include <cstdio>
 #include <cstdlib>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <poll.h>
 
 extern const char wsrep_defaults_file[];
 extern const char wsrep_defaults_group_suffix[];
@@ -56,6 +65,7 @@ extern const char wsrep_defaults_group_suffix[];
 #define WSREP_SST_SKIP            "skip"
 #define WSREP_SST_XTRABACKUP      "xtrabackup"
 #define WSREP_SST_XTRABACKUP_V2   "xtrabackup-v2"
+#define WSREP_SST_NATIVE          "native"
 #define WSREP_SST_DEFAULT      WSREP_SST_RSYNC
 #define WSREP_SST_ADDRESS_AUTO "AUTO"
 #define WSREP_SST_AUTH_MASK    "********"
@@ -269,6 +279,9 @@ void wsrep_sst_received (wsrep_t* const      wsrep,
 
     wsrep_init_sidno(uuid);
 
+    /* write set history continues from the received state */
+    if (seqno >= 0) wsrep_ws_log_position(uuid, seqno);
+
     if (wsrep)
     {
         int const rcode(seqno < 0 ? seqno : 0);
@@ -280,11 +293,20 @@ void wsrep_sst_received (wsrep_t* const      wsrep,
     }
 }
 
+/* Joiner state sent in request, and whether write sets were received */
+static wsrep_uuid_t  sst_ws_uuid=  WSREP_UUID_UNDEFINED;
+static wsrep_seqno_t sst_ws_seqno= WSREP_SEQNO_UNDEFINED;
+static bool          sst_ws_received= false;
+static int           sst_ws_err= 0;
+
+static void sst_apply_received_ws ();
+
 // Let applier threads to continue
 void wsrep_sst_continue ()
 {
   if (sst_needed)
   {
+    if (sst_ws_received) sst_apply_received_ws ();
     WSREP_INFO("Signalling provider to continue.");
     wsrep_sst_received (wsrep, local_uuid, local_seqno, NULL, 0);
   }
@@ -607,6 +629,812 @@ static ssize_t sst_prepare_mysqldump (const char*  addr_in,
   return ret;
 }
 
+/*
+  Native SST method: donor streams data directory files to the joiner over
+  wsrep_sst_native_streams parallel TCP connections, without any external
+  tools. Every chunk carries a CRC32 which joiner verifies before writing.
+
+  Consistency model is that of rsync method: donor holds global read lock
+  and InnoDB file writes are disallowed for the duration of the copy.
+
+  What is transferred is also that of rsync method: InnoDB system, log and
+  undo files from the directories InnoDB is configured to keep them in and
+  the schema directories of the data directory. Other files of the data
+  directory (logs, certificates, ...) belong to the node and are neither
+  transferred nor removed on joiner.
+
+  Joiner puts its own state into the request. If the donor's write set log
+  (wsrep_ws_log_size) covers all write sets the joiner misses, the donor
+  sends them instead of files: joiner stores them and applies them once its
+  storage engines are initialized, before it reports the state received.
+  This makes an incremental transfer possible long after the provider's
+  write set cache has moved on.
+
+  Protocol (integers are little-endian):
+    request, joiner -> donor: "native" 0 address 0 joiner_state 0
+    control connection, donor -> joiner:
+      magic(4) version(4) streams(4) files(4) state_len(2) state
+      files x { root(1) path_len(2) path size(8) }
+    control connection, joiner -> donor: ack(4), 0 or errno
+    each data connection, donor -> joiner:
+      magic(4) { file(4) offset(8) len(4) crc32(4) data }... end marker(4)
+    or, if streams is 0, control connection, donor -> joiner:
+      write sets following joiner state up to state, see wsp::ws_stream_put()
+    control connection, joiner -> donor: result(4), 0 or errno
+*/
+
+#define WSREP_SST_NATIVE_PORT    4444
+#define WSREP_SST_NATIVE_MAGIC   0x54535357 /* "WSST" */
+#define WSREP_SST_NATIVE_VERSION 3
+#define WSREP_SST_NATIVE_END     0xFFFFFFFFU
+#define WSREP_SST_NATIVE_CHUNK   (1 << 20)  /* max data in one record  */
+#define WSREP_SST_NATIVE_RANGE   (64 << 20) /* unit of work of a stream */
+#define WSREP_SST_NATIVE_WS_FILE "wsrep_sst_ws.dat"
+
+ulong wsrep_sst_native_streams= 4;
+ulong wsrep_sst_native_timeout= 300;
+
+/* Directories files are transferred from and to, as configured on each side */
+enum sst_native_root
+{
+  SST_NATIVE_DATADIR,        /* data directory and schema subdirectories */
+  SST_NATIVE_DATA_HOME_DIR,  /* innodb_data_home_dir */
+  SST_NATIVE_LOG_DIR,        /* innodb_log_group_home_dir */
+  SST_NATIVE_UNDO_DIR,       /* innodb_undo_directory */
+  SST_NATIVE_ROOTS
+};
+
+static char sst_native_roots[SST_NATIVE_ROOTS][FN_REFLEN];
+
+struct sst_native_file
+{
+  uint      root;
+  char      path[FN_REFLEN]; /* relative to root directory */
+  ulonglong size;
+};
+
+typedef std::vector<sst_native_file> sst_native_manifest;
+
+static int sst_native_send (int fd, const void* buf, size_t len)
+{
+  const char* ptr= (const char*) buf;
+  while (len > 0)
+  {
+    ssize_t ret= send (fd, ptr, len, MSG_NOSIGNAL);
+    if (ret < 0)
+    {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        WSREP_ERROR("Native SST: peer did not accept data in %lu seconds",
+                    wsrep_sst_native_timeout);
+        return -ETIMEDOUT;
+      }
+      return -errno;
+    }
+    ptr+= ret;
+    len-= ret;
+  }
+  return 0;
+}
+
+static int sst_native_recv (int fd, void* buf, size_t len)
+{
+  char* ptr= (char*) buf;
+  while (len > 0)
+  {
+    ssize_t ret= recv (fd, ptr, len, 0);
+    if (ret < 0)
+    {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        WSREP_ERROR("Native SST: no data from peer in %lu seconds",
+                    wsrep_sst_native_timeout);
+        return -ETIMEDOUT;
+      }
+      return -errno;
+    }
+    if (ret == 0) return -ECONNRESET;
+    ptr+= ret;
+    len-= ret;
+  }
+  return 0;
+}
+
+static int sst_native_send_uint4 (int fd, uint32 val)
+{
+  uchar buf[4];
+  int4store(buf, val);
+  return sst_native_send (fd, buf, sizeof(buf));
+}
+
+static int sst_native_recv_uint4 (int fd, uint32* val)
+{
+  uchar buf[4];
+  int ret= sst_native_recv (fd, buf, sizeof(buf));
+  if (!ret) *val= uint4korr(buf);
+  return ret;
+}
+
+static int sst_native_stream_write (void* ctx, const void* buf, size_t len)
+{
+  return sst_native_send (*(int*) ctx, buf, len);
+}
+
+static int sst_native_stream_read (void* ctx, void* buf, size_t len)
+{
+  return sst_native_recv (*(int*) ctx, buf, len);
+}
+
+/* Makes blocking operations on socket fail after wsrep_sst_native_timeout */
+static void sst_native_set_timeout (int fd)
+{
+  struct timeval tv;
+  tv.tv_sec=  wsrep_sst_native_timeout;
+  tv.tv_usec= 0;
+  setsockopt (fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  setsockopt (fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+/*
+  Waits for donor to connect. If donor does not show up or crashes, joiner
+  fails SST after wsrep_sst_native_timeout instead of waiting forever.
+*/
+static int sst_native_accept (int listen_fd)
+{
+  struct pollfd pfd;
+  pfd.fd=      listen_fd;
+  pfd.events=  POLLIN;
+  pfd.revents= 0;
+
+  int ret;
+  while ((ret= poll (&pfd, 1, (int) wsrep_sst_native_timeout * 1000)) < 0 &&
+         errno == EINTR) {}
+
+  if (ret == 0)
+  {
+    WSREP_ERROR("Native SST: no connection from donor in %lu seconds",
+                wsrep_sst_native_timeout);
+    return -ETIMEDOUT;
+  }
+  if (ret < 0) return -errno;
+
+  int const fd= accept (listen_fd, NULL, NULL);
+  if (fd < 0) return -errno;
+
+  sst_native_set_timeout (fd);
+  return fd;
+}
+
+/* Splits "host[:port]" into host and port, strips IPv6 brackets */
+static void sst_native_parse_addr (const char* addr, char* host,
+                                   size_t host_len, uint* port)
+{
+  const char* colon= strrchr (addr, ':');
+  const char* bracket= strrchr (addr, ']');
+  size_t len= strlen (addr);
+
+  *port= WSREP_SST_NATIVE_PORT;
+  if (colon && (!bracket || colon > bracket) &&
+      (bracket || colon == strchr (addr, ':')))
+  {
+    *port= atoi (colon + 1);
+    len= colon - addr;
+  }
+  if (addr[0] == '[' && len >= 2 && addr[len - 1] == ']')
+  {
+    addr++;
+    len-= 2;
+  }
+  len= MY_MIN(len, host_len - 1);
+  memcpy (host, addr, len);
+  host[len]= '\0';
+}
+
+static int sst_native_socket (const char* addr, bool listening)
+{
+  char host[256];
+  uint port;
+  sst_native_parse_addr (addr, host, sizeof(host), &port);
+
+  char port_str[16];
+  snprintf (port_str, sizeof(port_str), "%u", port);
+
+  struct addrinfo hints;
+  struct addrinfo* res= NULL;
+  memset (&hints, 0, sizeof(hints));
+  hints.ai_family=   AF_UNSPEC;
+  hints.ai_socktype= SOCK_STREAM;
+  hints.ai_flags=    listening ? AI_PASSIVE : 0;
+
+  int ret= getaddrinfo (host, port_str, &hints, &res);
+  if (ret)
+  {
+    WSREP_ERROR("Native SST: failed to resolve '%s': %s",
+                addr, gai_strerror(ret));
+    return -EINVAL;
+  }
+
+  int fd= -1;
+  ret= -EADDRNOTAVAIL;
+  for (struct addrinfo* ai= res; ai; ai= ai->ai_next)
+  {
+    fd= socket (ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0) { ret= -errno; continue; }
+
+    if (listening)
+    {
+      int const on= 1;
+      setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+      if (!bind (fd, ai->ai_addr, ai->ai_addrlen) && !listen (fd, 64)) break;
+    }
+    else if (!connect (fd, ai->ai_addr, ai->ai_addrlen))
+    {
+      sst_native_set_timeout (fd);
+      break;
+    }
+    ret= -errno;
+    close (fd);
+    fd= -1;
+  }
+  freeaddrinfo (res);
+
+  if (fd < 0)
+  {
+    WSREP_ERROR("Native SST: failed to %s '%s': %d (%s)",
+                listening ? "listen at" : "connect to", addr,
+                -ret, strerror(-ret));
+    return ret;
+  }
+  return fd;
+}
+
+static bool sst_native_has_prefix (const char* name, const char* prefix)
+{
+  return !strncmp (name, prefix, strlen (prefix));
+}
+
+/*
+  InnoDB files outside of schema directories which are part of the state,
+  as in rsync filter. Everything else there belongs to the node.
+*/
+static bool sst_native_innodb_file (const char* name)
+{
+  return (sst_native_has_prefix (name, "ibdata") ||
+          sst_native_has_prefix (name, "ib_logfile") ||
+          sst_native_has_prefix (name, "undo") ||
+          !strcmp (name, "ib_lru_dump"));
+}
+
+/*
+  Resolves directories of every root as configured on this node. InnoDB
+  directories which are not absolute are relative to the data directory,
+  empty ones are the data directory itself.
+
+  @param create  create missing directories (joiner)
+*/
+static int sst_native_init_roots (bool create)
+{
+  const char* const dirs[SST_NATIVE_ROOTS]= {
+    "", wsrep_innodb_data_home_dir, wsrep_innodb_log_group_home_dir,
+    wsrep_innodb_undo_directory };
+
+  for (uint i= 0; i < SST_NATIVE_ROOTS; ++i)
+  {
+    char dir[FN_REFLEN];
+    if (test_if_hard_path (dirs[i]))
+      strmake (dir, dirs[i], sizeof(dir) - 1);
+    else
+      snprintf (dir, sizeof(dir), "%s/%s", mysql_real_data_home, dirs[i]);
+
+    if (create && my_mkdir (dir, 0777, MYF(0)) && errno != EEXIST)
+    {
+      WSREP_ERROR("Native SST: failed to create directory '%s': %d (%s)",
+                  dir, errno, strerror(errno));
+      return -errno;
+    }
+
+    /* canonical paths tell which roots are the same directory */
+    if (my_realpath (sst_native_roots[i], dir, MYF(0)))
+      strmake (sst_native_roots[i], dir, sizeof(sst_native_roots[i]) - 1);
+  }
+  return 0;
+}
+
+static void sst_native_path (const sst_native_file& file, char* path,
+                             size_t len)
+{
+  snprintf (path, len, "%s/%s", sst_native_roots[file.root], file.path);
+}
+
+/* @return true if directory is one of the roots other than data directory */
+static bool sst_native_is_root (const char* dir)
+{
+  char real[FN_REFLEN];
+  if (my_realpath (real, dir, MYF(0))) return false;
+
+  for (uint i= SST_NATIVE_DATADIR + 1; i < SST_NATIVE_ROOTS; ++i)
+    if (!strcmp (real, sst_native_roots[i])) return true;
+  return false;
+}
+
+/*
+  Calls visit() for every regular file which is part of the state: InnoDB
+  files of every root directory and files of schema directories. Roots are
+  visited once even if several of them are the same directory.
+*/
+template <typename Visitor>
+static int sst_native_scan (Visitor& visit)
+{
+  int err= 0;
+
+  for (uint root= 0; !err && root < SST_NATIVE_ROOTS; ++root)
+  {
+    bool duplicate= false;
+    for (uint i= 0; i < root; ++i)
+      duplicate|= !strcmp (sst_native_roots[i], sst_native_roots[root]);
+    if (duplicate) continue;
+
+    MY_DIR* top= my_dir (sst_native_roots[root], MYF(MY_WANT_STAT | MY_WME));
+    if (!top) return -errno;
+
+    for (uint i= 0; !err && i < top->number_off_files; ++i)
+    {
+      const FILEINFO& entry= top->dir_entry[i];
+
+      if (MY_S_ISREG(entry.mystat->st_mode))
+      {
+        if (sst_native_innodb_file (entry.name))
+          err= visit (root, entry.name, entry.mystat->st_size);
+        continue;
+      }
+
+      /* schema directories, like rsync: all but hidden and lost+found */
+      if (root != SST_NATIVE_DATADIR || !MY_S_ISDIR(entry.mystat->st_mode) ||
+          entry.name[0] == '.' || !strcmp (entry.name, "lost+found"))
+        continue;
+
+      char dir_path[FN_REFLEN];
+      snprintf (dir_path, sizeof(dir_path), "%s/%s",
+                sst_native_roots[root], entry.name);
+      if (sst_native_is_root (dir_path)) continue;
+
+      MY_DIR* sub= my_dir (dir_path, MYF(MY_WANT_STAT | MY_WME));
+      if (!sub) { err= -errno; break; }
+
+      for (uint j= 0; !err && j < sub->number_off_files; ++j)
+      {
+        const FILEINFO& file= sub->dir_entry[j];
+        if (!MY_S_ISREG(file.mystat->st_mode)) continue;
+
+        char rel_path[FN_REFLEN];
+        snprintf (rel_path, sizeof(rel_path), "%s/%s",
+                  entry.name, file.name);
+        err= visit (root, rel_path, file.mystat->st_size);
+      }
+      my_dirend (sub);
+    }
+    my_dirend (top);
+  }
+  return err;
+}
+
+/* Joiner side */
+
+struct sst_native_joiner_arg
+{
+  int listen_fd;
+};
+
+struct sst_native_receiver
+{
+  int                        fd;
+  const sst_native_manifest* files;
+  int                        err;
+};
+
+static void* sst_native_receiver_thread (void* a)
+{
+  sst_native_receiver* const rcv= (sst_native_receiver*) a;
+  File   file= -1;
+  uint32 file_idx= WSREP_SST_NATIVE_END;
+  int    err= my_thread_init() ? -ENOMEM : 0;
+  uchar* const buf= (uchar*) my_malloc (WSREP_SST_NATIVE_CHUNK, MYF(0));
+
+  if (!buf) err= -ENOMEM;
+
+  while (!err)
+  {
+    uint32 idx;
+    if ((err= sst_native_recv_uint4 (rcv->fd, &idx))) break;
+    if (idx == WSREP_SST_NATIVE_END) break;
+
+    uchar hdr[16];
+    if ((err= sst_native_recv (rcv->fd, hdr, sizeof(hdr)))) break;
+    ulonglong const offset= uint8korr(hdr);
+    uint32    const len=    uint4korr(hdr + 8);
+    uint32    const crc=    uint4korr(hdr + 12);
+
+    if (idx >= rcv->files->size() || len > WSREP_SST_NATIVE_CHUNK ||
+        offset + len > (*rcv->files)[idx].size)
+    {
+      WSREP_ERROR("Native SST: bad chunk: file %u, offset %llu, len %u",
+                  idx, offset, len);
+      err= -EPROTO;
+      break;
+    }
+
+    if ((err= sst_native_recv (rcv->fd, buf, len))) break;
+
+    if (my_checksum (0, buf, len) != crc)
+    {
+      WSREP_ERROR("Native SST: checksum mismatch in '%s' at offset %llu",
+                  (*rcv->files)[idx].path, offset);
+      err= -EIO;
+      break;
+    }
+
+    if (idx != file_idx)
+    {
+      if (file >= 0 && (my_sync (file, MYF(MY_WME)) ||
+                        my_close (file, MYF(MY_WME))))
+      {
+        file= -1;
+        err= -EIO;
+        break;
+      }
+      char path[FN_REFLEN];
+      sst_native_path ((*rcv->files)[idx], path, sizeof(path));
+      file= my_open (path, O_WRONLY, MYF(MY_WME));
+      if (file < 0) { err= -EIO; break; }
+      file_idx= idx;
+    }
+
+    if (my_pwrite (file, buf, len, offset, MYF(MY_WME | MY_NABP)))
+    {
+      err= -EIO;
+      break;
+    }
+  }
+
+  if (file >= 0 &&
+      (my_sync (file, MYF(MY_WME)) | my_close (file, MYF(MY_WME))) && !err)
+    err= -EIO;
+
+  my_free (buf);
+  rcv->err= err;
+  my_thread_end();
+  return NULL;
+}
+
+/*
+  Creates manifest files empty and removes InnoDB and schema files which
+  are not part of the transferred state. Files are compared by full path,
+  as roots which are distinct on donor may be the same directory here.
+*/
+struct sst_native_cleaner
+{
+  std::vector<std::string> paths; /* sorted full paths of the manifest */
+
+  explicit sst_native_cleaner (const sst_native_manifest& files)
+  {
+    paths.reserve (files.size());
+    for (size_t i= 0; i < files.size(); ++i)
+    {
+      char path[FN_REFLEN];
+      sst_native_path (files[i], path, sizeof(path));
+      paths.push_back (path);
+    }
+    std::sort (paths.begin(), paths.end());
+  }
+
+  int operator() (uint root, const char* path, ulonglong)
+  {
+    char full_path[FN_REFLEN];
+    snprintf (full_path, sizeof(full_path), "%s/%s",
+              sst_native_roots[root], path);
+
+    if (std::binary_search (paths.begin(), paths.end(),
+                            std::string(full_path))) return 0;
+
+    WSREP_DEBUG("Native SST: removing stale file '%s'", full_path);
+    return my_delete (full_path, MYF(MY_WME)) ? -EIO : 0;
+  }
+};
+
+static int sst_native_prepare_files (const sst_native_manifest& files)
+{
+  int err= sst_native_init_roots (true);
+  if (err) return err;
+
+  sst_native_cleaner cleaner(files);
+  if ((err= sst_native_scan (cleaner))) return err;
+
+  for (size_t i= 0; i < files.size(); ++i)
+  {
+    char path[FN_REFLEN];
+    sst_native_path (files[i], path, sizeof(path));
+
+    char* const slash= strchr (path + strlen(sst_native_roots[files[i].root])
+                               + 1, '/');
+    if (slash)
+    {
+      *slash= '\0';
+      if (my_mkdir (path, 0777, MYF(0)) && errno != EEXIST)
+      {
+        WSREP_ERROR("Native SST: failed to create directory '%s': %d (%s)",
+                    path, errno, strerror(errno));
+        return -errno;
+      }
+      *slash= '/';
+    }
+
+    File file= my_create (path, 0, O_WRONLY | O_TRUNC, MYF(MY_WME));
+    if (file < 0) return -EIO;
+    my_close (file, MYF(0));
+  }
+  return 0;
+}
+
+static int sst_native_recv_manifest (int fd, uint32* streams,
+                                     wsrep_uuid_t* uuid,
+                                     wsrep_seqno_t* seqno,
+                                     sst_native_manifest* files)
+{
+  uchar hdr[18];
+  int err;
+  if ((err= sst_native_recv (fd, hdr, sizeof(hdr)))) return err;
+
+  if (uint4korr(hdr) != WSREP_SST_NATIVE_MAGIC ||
+      uint4korr(hdr + 4) != WSREP_SST_NATIVE_VERSION)
+  {
+    WSREP_ERROR("Native SST: unsupported donor protocol: %x/%u",
+                uint4korr(hdr), uint4korr(hdr + 4));
+    return -EPROTO;
+  }
+  *streams= uint4korr(hdr + 8);
+  uint32 const count= uint4korr(hdr + 12);
+  uint const state_len= uint2korr(hdr + 16);
+
+  char state[128];
+  /* no streams means write sets instead of files */
+  if (state_len >= sizeof(state) || *streams > 64 || (!*streams && count))
+    return -EPROTO;
+  if ((err= sst_native_recv (fd, state, state_len))) return err;
+  state[state_len]= '\0';
+  if ((err= sst_scan_uuid_seqno (state, uuid, seqno))) return err;
+
+  for (uint32 i= 0; i < count; ++i)
+  {
+    sst_native_file file;
+    uchar len_buf[3];
+    if ((err= sst_native_recv (fd, len_buf, sizeof(len_buf)))) return err;
+    file.root= len_buf[0];
+    uint const path_len= uint2korr(len_buf + 1);
+    if (file.root >= SST_NATIVE_ROOTS ||
+        path_len == 0 || path_len >= sizeof(file.path)) return -EPROTO;
+    if ((err= sst_native_recv (fd, file.path, path_len))) return err;
+    file.path[path_len]= '\0';
+
+    uchar size_buf[8];
+    if ((err= sst_native_recv (fd, size_buf, sizeof(size_buf)))) return err;
+    file.size= uint8korr(size_buf);
+
+    /* never write outside of root directory or schema directories */
+    const char* const slash= strchr (file.path, '/');
+    if (file.path[0] == '/' || strstr (file.path, "..") ||
+        slash != strrchr (file.path, '/') ||
+        (slash && file.root != SST_NATIVE_DATADIR))
+    {
+      WSREP_ERROR("Native SST: refusing path '%s'", file.path);
+      return -EPROTO;
+    }
+    files->push_back (file);
+  }
+  return 0;
+}
+
+static void sst_native_ws_path (char* path)
+{
+  fn_format (path, WSREP_SST_NATIVE_WS_FILE, mysql_real_data_home, "",
+             MY_UNPACK_FILENAME | MY_SAFE_PATH);
+}
+
+static int sst_native_store_ws (void* ctx, wsrep_seqno_t seqno, uint32 flags,
+                                const void* buf, size_t len)
+{
+  return wsp::ws_stream_put (wsp::ws_stream_file_write, ctx, seqno, flags,
+                             buf, len);
+}
+
+/* Receives write sets following joiner state up to donor state in a file */
+static int sst_native_recv_ws (int fd, const wsrep_uuid_t& uuid,
+                               wsrep_seqno_t seqno)
+{
+  if (memcmp (&uuid, &sst_ws_uuid, sizeof(uuid)) || seqno < sst_ws_seqno)
+    return -EPROTO;
+
+  char path[FN_REFLEN];
+  sst_native_ws_path (path);
+  File file= my_open (path, O_WRONLY | O_CREAT | O_TRUNC, MYF(MY_WME));
+  if (file < 0) return -EIO;
+
+  wsrep_seqno_t last;
+  int err= wsp::ws_stream_get (sst_native_stream_read, &fd, sst_ws_seqno + 1,
+                               sst_native_store_ws, &file, &last);
+  if (!err && last != seqno) err= -EPROTO;
+  if (!err) err= wsp::ws_stream_end (wsp::ws_stream_file_write, &file);
+  if (!err && my_sync (file, MYF(MY_WME))) err= -EIO;
+  my_close (file, MYF(0));
+
+  if (err)
+  {
+    my_delete (path, MYF(0));
+    return err;
+  }
+
+  WSREP_INFO("Native SST: received write sets %lld - %lld",
+             (long long) sst_ws_seqno + 1, (long long) seqno);
+  sst_ws_received= true;
+  return 0;
+}
+
+static void* sst_native_joiner_thread (void* a)
+{
+  int const listen_fd= ((sst_native_joiner_arg*) a)->listen_fd;
+  delete (sst_native_joiner_arg*) a;
+
+  wsrep_uuid_t  ret_uuid=  WSREP_UUID_UNDEFINED;
+  wsrep_seqno_t ret_seqno= WSREP_SEQNO_UNDEFINED;
+  sst_native_manifest files;
+  uint32 streams= 0;
+  int err= 0;
+
+  if (my_thread_init()) err= -ENOMEM;
+
+  int const ctl_fd= err ? -1 : sst_native_accept (listen_fd);
+  if (!err && ctl_fd < 0) err= ctl_fd;
+
+  if (!err)
+    err= sst_native_recv_manifest (ctl_fd, &streams, &ret_uuid, &ret_seqno,
+                                   &files);
+  if (!err && !files.empty())
+    err= sst_native_prepare_files (files);
+  if (ctl_fd >= 0)
+  {
+    int const ack_err= sst_native_send_uint4 (ctl_fd, -err);
+    if (!err) err= ack_err;
+  }
+
+  if (!err && !streams)
+  {
+    err= sst_native_recv_ws (ctl_fd, ret_uuid, ret_seqno);
+    int const res_err= sst_native_send_uint4 (ctl_fd, -err);
+    if (!err) err= res_err;
+  }
+
+  if (!err && !files.empty())
+  {
+    WSREP_INFO("Native SST: receiving %zu files over %u streams",
+               files.size(), streams);
+
+    sst_native_receiver* rcv= new sst_native_receiver[streams];
+    pthread_t* tids= new pthread_t[streams];
+    uint32 started= 0;
+
+    for (; started < streams; ++started)
+    {
+      rcv[started].files= &files;
+      rcv[started].err= 0;
+      rcv[started].fd= sst_native_accept (listen_fd);
+      if (rcv[started].fd < 0)
+      {
+        err= rcv[started].fd;
+        break;
+      }
+      uint32 magic= 0;
+      if (sst_native_recv_uint4 (rcv[started].fd, &magic) ||
+          magic != WSREP_SST_NATIVE_MAGIC)
+      {
+        err= -EPROTO;
+        close (rcv[started].fd);
+        break;
+      }
+      int const ret= mysql_thread_create (key_thread_wsrep_sst_receiver,
+                                          &tids[started], NULL,
+                                          sst_native_receiver_thread,
+                                          &rcv[started]);
+      if (ret)
+      {
+        err= -ret;
+        close (rcv[started].fd);
+        break;
+      }
+    }
+
+    for (uint32 i= 0; i < started; ++i)
+    {
+      pthread_join (tids[i], NULL);
+      close (rcv[i].fd);
+      if (!err) err= rcv[i].err;
+    }
+    delete[] tids;
+    delete[] rcv;
+
+    int const res_err= sst_native_send_uint4 (ctl_fd, -err);
+    if (!err) err= res_err;
+  }
+
+  if (ctl_fd >= 0) close (ctl_fd);
+  close (listen_fd);
+
+  if (err)
+  {
+    WSREP_ERROR("Native SST failed: %d (%s)", -err, strerror(-err));
+    ret_uuid=  WSREP_UUID_UNDEFINED;
+    ret_seqno= err;
+  }
+  else
+  {
+    WSREP_INFO("Native SST: received state up to seqno %lld",
+               (long long) ret_seqno);
+  }
+
+  // Tell initializer thread that SST is complete
+  wsrep_sst_complete (&ret_uuid, ret_seqno, true);
+
+  my_thread_end();
+  return NULL;
+}
+
+/*! Starts listening for donor connections, address goes to SST request */
+static ssize_t sst_prepare_native (const char*  addr_in,
+                                   const char** addr_out)
+{
+  char host[256];
+  uint port;
+  sst_native_parse_addr (addr_in, host, sizeof(host), &port);
+
+  ssize_t const s= strlen (host) + 9;
+  char* const tmp= (char*) malloc (s);
+  if (!tmp) return -ENOMEM;
+
+  ssize_t const ret= snprintf (tmp, s,
+                               strchr (host, ':') ? "[%s]:%u" : "%s:%u",
+                               host, port);
+
+  int const fd= sst_native_socket (tmp, true);
+  if (fd < 0)
+  {
+    free (tmp);
+    return fd;
+  }
+
+  sst_native_joiner_arg* const arg= new sst_native_joiner_arg;
+  arg->listen_fd= fd;
+
+  sst_ws_uuid=  local_uuid;
+  sst_ws_seqno= local_seqno;
+
+  pthread_t thd;
+  int const err= mysql_thread_create (key_thread_wsrep_sst_joiner, &thd, NULL,
+                                      sst_native_joiner_thread, arg);
+  if (err)
+  {
+    WSREP_ERROR("sst_prepare_native(): mysql_thread_create() failed: %d (%s)",
+                err, strerror(err));
+    delete arg;
+    close (fd);
+    free (tmp);
+    return -err;
+  }
+  pthread_detach (thd);
+
+  *addr_out= tmp;
+  return ret;
+}
+
 static bool SE_initialized = false;
 
 ssize_t wsrep_sst_prepare (void** msg)
@@ -692,8 +1520,11 @@ ssize_t wsrep_sst_prepare (void** msg)
       return 0;
     }
 
-    addr_len = sst_prepare_other (wsrep_sst_method, sst_auth_real,
-                                  addr_in, &addr_out);
+    if (!strcmp(wsrep_sst_method, WSREP_SST_NATIVE))
+      addr_len = sst_prepare_native (addr_in, &addr_out);
+    else
+      addr_len = sst_prepare_other (wsrep_sst_method, sst_auth_real,
+                                    addr_in, &addr_out);
     if (addr_len < 0)
     {
       WSREP_ERROR("Failed to prepare for '%s' SST. Unrecoverable.",
@@ -702,8 +1533,20 @@ ssize_t wsrep_sst_prepare (void** msg)
     }
   }
 
+  /* native joiner tells its state, so that donor may send write sets */
+  char state[64]= "";
+  if (!strcmp(wsrep_sst_method, WSREP_SST_NATIVE))
+  {
+    char uuid_str[37];
+    wsrep_uuid_print (&sst_ws_uuid, uuid_str, sizeof(uuid_str));
+    snprintf (state, sizeof(state), "%s:%lld", uuid_str,
+              (long long) sst_ws_seqno);
+  }
+
   size_t const method_len(strlen(wsrep_sst_method));
-  size_t const msg_len   (method_len + addr_len + 2 /* + auth_len + 1*/);
+  size_t const state_len (state[0] ? strlen(state) + 1 : 0);
+  size_t const msg_len   (method_len + addr_len + 2 /* + auth_len + 1*/ +
+                          state_len);
 
   *msg = malloc (msg_len);
   if (NULL != *msg) {
@@ -711,6 +1554,7 @@ ssize_t wsrep_sst_prepare (void** msg)
     strcpy (method_ptr, wsrep_sst_method);
     char* const addr_ptr(method_ptr + method_len + 1);
     strcpy (addr_ptr, addr_out);
+    if (state_len) strcpy (addr_ptr + strlen(addr_ptr) + 1, state);
 
     WSREP_INFO ("Prepared SST request: %s|%s", method_ptr, addr_ptr);
   }
@@ -1079,6 +1923,365 @@ static int sst_donate_other (const char*   method,
   return arg.err;
 }
 
+/* Native SST donor side */
+
+struct sst_native_range
+{
+  uint32    file;
+  ulonglong offset;
+  ulonglong len;
+};
+
+struct sst_native_collector
+{
+  sst_native_manifest& files;
+
+  explicit sst_native_collector (sst_native_manifest& f) : files(f) {}
+
+  int operator() (uint root, const char* path, ulonglong size)
+  {
+    sst_native_file file;
+    file.root= root;
+    strmake (file.path, path, sizeof(file.path) - 1);
+    file.size= size;
+    files.push_back (file);
+    return 0;
+  }
+};
+
+struct sst_native_sender
+{
+  const char*                          addr;
+  const sst_native_manifest*           files;
+  const std::vector<sst_native_range>* ranges;
+  size_t*                              next;  /* next range to send */
+  mysql_mutex_t*                       lock;
+  int                                  err;
+};
+
+static int sst_native_send_range (int fd, const sst_native_file& file,
+                                  const sst_native_range& range, uchar* buf)
+{
+  char path[FN_REFLEN];
+  sst_native_path (file, path, sizeof(path));
+
+  File const fh= my_open (path, O_RDONLY, MYF(MY_WME));
+  if (fh < 0) return -EIO;
+
+  int err= 0;
+  for (ulonglong done= 0; !err && done < range.len; )
+  {
+    uint32 const len= (uint32) MY_MIN(range.len - done,
+                                      (ulonglong) WSREP_SST_NATIVE_CHUNK);
+    ulonglong const offset= range.offset + done;
+
+    if (my_pread (fh, buf + 20, len, offset, MYF(MY_WME | MY_NABP)))
+    {
+      err= -EIO;
+      break;
+    }
+    int4store(buf,      range.file);
+    int8store(buf + 4,  offset);
+    int4store(buf + 12, len);
+    int4store(buf + 16, my_checksum (0, buf + 20, len));
+
+    err= sst_native_send (fd, buf, 20 + len);
+    done+= len;
+  }
+
+  my_close (fh, MYF(0));
+  return err;
+}
+
+static void* sst_native_sender_thread (void* a)
+{
+  sst_native_sender* const snd= (sst_native_sender*) a;
+  int err= my_thread_init() ? -ENOMEM : 0;
+  uchar* const buf= (uchar*) my_malloc (WSREP_SST_NATIVE_CHUNK + 20, MYF(0));
+  int const fd= err ? -1 : sst_native_socket (snd->addr, false);
+
+  if (!buf) err= -ENOMEM;
+  if (!err && fd < 0) err= fd;
+  if (!err) err= sst_native_send_uint4 (fd, WSREP_SST_NATIVE_MAGIC);
+
+  while (!err)
+  {
+    mysql_mutex_lock (snd->lock);
+    size_t const idx= (*snd->next)++;
+    mysql_mutex_unlock (snd->lock);
+
+    if (idx >= snd->ranges->size()) break;
+
+    const sst_native_range& range= (*snd->ranges)[idx];
+    err= sst_native_send_range (fd, (*snd->files)[range.file], range, buf);
+  }
+
+  if (!err) err= sst_native_send_uint4 (fd, WSREP_SST_NATIVE_END);
+  if (fd >= 0) close (fd);
+
+  my_free (buf);
+  snd->err= err;
+  my_thread_end();
+  return NULL;
+}
+
+static int sst_native_send_manifest (int fd, uint32 streams,
+                                     const char* state,
+                                     const sst_native_manifest& files)
+{
+  uchar hdr[18];
+  int4store(hdr,      WSREP_SST_NATIVE_MAGIC);
+  int4store(hdr + 4,  WSREP_SST_NATIVE_VERSION);
+  int4store(hdr + 8,  streams);
+  int4store(hdr + 12, (uint32) files.size());
+  int2store(hdr + 16, (uint16) strlen (state));
+
+  int err= sst_native_send (fd, hdr, sizeof(hdr));
+  if (!err) err= sst_native_send (fd, state, strlen (state));
+
+  for (size_t i= 0; !err && i < files.size(); ++i)
+  {
+    uchar buf[3 + FN_REFLEN + 8];
+    size_t const path_len= strlen (files[i].path);
+    buf[0]= (uchar) files[i].root;
+    int2store(buf + 1, (uint16) path_len);
+    memcpy (buf + 3, files[i].path, path_len);
+    int8store(buf + 3 + path_len, files[i].size);
+    err= sst_native_send (fd, buf, 3 + path_len + 8);
+  }
+  return err;
+}
+
+/* Sends all files of the manifest over parallel streams */
+static int sst_native_send_files (const char* addr,
+                                  const sst_native_manifest& files,
+                                  uint32 streams)
+{
+  std::vector<sst_native_range> ranges;
+  for (size_t i= 0; i < files.size(); ++i)
+  {
+    for (ulonglong offset= 0; offset < files[i].size;
+         offset+= WSREP_SST_NATIVE_RANGE)
+    {
+      sst_native_range range;
+      range.file=   (uint32) i;
+      range.offset= offset;
+      range.len=    MY_MIN(files[i].size - offset,
+                           (ulonglong) WSREP_SST_NATIVE_RANGE);
+      ranges.push_back (range);
+    }
+  }
+
+  mysql_mutex_t lock;
+  mysql_mutex_init (key_LOCK_wsrep_sst_thread, &lock, MY_MUTEX_INIT_FAST);
+  size_t next= 0;
+
+  sst_native_sender* snd= new sst_native_sender[streams];
+  pthread_t* tids= new pthread_t[streams];
+  uint32 started= 0;
+  int err= 0;
+
+  for (; started < streams; ++started)
+  {
+    snd[started].addr=   addr;
+    snd[started].files=  &files;
+    snd[started].ranges= &ranges;
+    snd[started].next=   &next;
+    snd[started].lock=   &lock;
+    snd[started].err=    0;
+    if ((err= mysql_thread_create (key_thread_wsrep_sst_sender,
+                                   &tids[started], NULL,
+                                   sst_native_sender_thread, &snd[started])))
+    {
+      WSREP_ERROR("Native SST: failed to start stream: %d (%s)",
+                  err, strerror(err));
+      err= -err;
+      break;
+    }
+  }
+
+  for (uint32 i= 0; i < started; ++i)
+  {
+    pthread_join (tids[i], NULL);
+    if (!err) err= snd[i].err;
+  }
+
+  delete[] tids;
+  delete[] snd;
+  mysql_mutex_destroy (&lock);
+  return err;
+}
+
+struct sst_native_donor_arg
+{
+  char*         addr;
+  wsrep_uuid_t  uuid;
+  wsrep_seqno_t seqno;
+  bool          bypass;
+  wsrep_uuid_t  joiner_uuid;
+  wsrep_seqno_t joiner_seqno;  /* undefined if joiner did not tell it */
+};
+
+static void* sst_native_donor_thread (void* a)
+{
+  sst_native_donor_arg* const arg= (sst_native_donor_arg*) a;
+
+  wsp::thd thd(FALSE); // we turn off wsrep_on for this THD so that it can
+                       // operate with wsrep_ready == OFF
+  wsrep_uuid_t  ret_uuid=  arg->uuid;
+  wsrep_seqno_t ret_seqno= arg->seqno;
+  sst_native_manifest files;
+  uint32 const streams= arg->bypass ? 1 : wsrep_sst_native_streams;
+  bool locked= false;
+  bool ws=     false; /* sending write sets instead of files */
+  int  err= 0;
+
+  int const fd= sst_native_socket (arg->addr, false);
+  if (fd < 0) err= fd;
+
+  if (!err && !arg->bypass)
+  {
+    err= sst_flush_tables (thd.ptr);
+    if (!err)
+    {
+      locked= true;
+      /* state of the snapshot is the one fixed by global read lock */
+      wsrep_uuid_scan (wsrep_cluster_state_uuid,
+                       strlen(wsrep_cluster_state_uuid), &ret_uuid);
+      ret_seqno= wsrep_locked_seqno;
+
+      if (arg->joiner_seqno >= 0 && arg->joiner_seqno <= ret_seqno &&
+          !memcmp (&arg->joiner_uuid, &ret_uuid, sizeof(ret_uuid)))
+      {
+        /* all write sets up to the snapshot have committed by now */
+        wsrep_ws_log_sync (ret_uuid, ret_seqno);
+        ws= wsrep_ws_log_covers (ret_uuid, arg->joiner_seqno + 1, ret_seqno);
+      }
+
+      if (ws)
+      {
+        /* logged write sets don't change, no need to block the node */
+        thd.ptr->global_read_lock.unlock_global_read_lock (thd.ptr);
+        locked= false;
+      }
+      else
+      {
+        sst_disallow_writes (thd.ptr, true);
+        sst_native_collector collector(files);
+        if (!(err= sst_native_init_roots (false)))
+          err= sst_native_scan (collector);
+      }
+    }
+  }
+
+  if (!err)
+  {
+    char state[128];
+    char uuid_str[37];
+    wsrep_uuid_print (&ret_uuid, uuid_str, sizeof(uuid_str));
+    snprintf (state, sizeof(state), "%s:%lld", uuid_str,
+              (long long) ret_seqno);
+    err= sst_native_send_manifest (fd, ws ? 0 : streams, state, files);
+  }
+
+  uint32 ack= 0;
+  if (!err) err= sst_native_recv_uint4 (fd, &ack);
+  if (!err && ack) err= -(int) ack;
+
+  if (!err && ws)
+  {
+    WSREP_INFO("Native SST: sending write sets %lld - %lld",
+               (long long) arg->joiner_seqno + 1, (long long) ret_seqno);
+
+    int sock= fd;
+    err= wsrep_ws_log_serve (arg->joiner_seqno + 1, ret_seqno,
+                             sst_native_stream_write, &sock);
+    if (!err)
+    {
+      uint32 result= 0;
+      int const res_err= sst_native_recv_uint4 (fd, &result);
+      err= res_err ? res_err : -(int) result;
+    }
+  }
+
+  if (!err && !files.empty())
+  {
+    ulonglong total= 0;
+    for (size_t i= 0; i < files.size(); ++i) total+= files[i].size;
+    WSREP_INFO("Native SST: sending %zu files, %llu bytes over %u streams",
+               files.size(), total, streams);
+
+    err= sst_native_send_files (arg->addr, files, streams);
+
+    uint32 result= 0;
+    int const res_err= sst_native_recv_uint4 (fd, &result);
+    if (!err) err= res_err ? res_err : -(int) result;
+  }
+
+  if (fd >= 0) close (fd);
+
+  if (locked) // don't forget to unlock server before return
+  {
+    sst_disallow_writes (thd.ptr, false);
+    thd.ptr->global_read_lock.unlock_global_read_lock (thd.ptr);
+  }
+
+  if (err)
+    WSREP_ERROR("Native SST failed: %d (%s)", -err, strerror(-err));
+
+  // signal to donor that SST is over
+  struct wsrep_gtid const state_id = {
+      ret_uuid, err ? WSREP_SEQNO_UNDEFINED : ret_seqno
+  };
+  wsrep->sst_sent (wsrep, &state_id, err);
+
+  free (arg->addr);
+  delete arg;
+  return NULL;
+}
+
+static int sst_donate_native (const char*         addr,
+                              const char*         joiner_state,
+                              const wsrep_uuid_t* uuid,
+                              wsrep_seqno_t       seqno,
+                              bool                bypass)
+{
+  sst_native_donor_arg* const arg= new sst_native_donor_arg;
+  arg->addr=   strdup (addr);
+  arg->uuid=   *uuid;
+  arg->seqno=  seqno;
+  arg->bypass= bypass;
+  arg->joiner_uuid=  WSREP_UUID_UNDEFINED;
+  arg->joiner_seqno= WSREP_SEQNO_UNDEFINED;
+  if (joiner_state &&
+      sst_scan_uuid_seqno (joiner_state, &arg->joiner_uuid,
+                           &arg->joiner_seqno))
+    arg->joiner_seqno= WSREP_SEQNO_UNDEFINED;
+
+  if (!arg->addr)
+  {
+    delete arg;
+    return -ENOMEM;
+  }
+
+  if (!bypass && wsrep_sst_donor_rejects_queries) sst_reject_queries(FALSE);
+
+  pthread_t tmp;
+  int const ret= mysql_thread_create (key_thread_wsrep_sst_donor, &tmp, NULL,
+                                      sst_native_donor_thread, arg);
+  if (ret)
+  {
+    WSREP_ERROR("sst_donate_native(): mysql_thread_create() failed: %d (%s)",
+                ret, strerror(ret));
+    free (arg->addr);
+    delete arg;
+    return -ret;
+  }
+  pthread_detach (tmp);
+
+  return 0;
+}
+
 wsrep_cb_status_t wsrep_sst_donate_cb (void* app_ctx, void* recv_ctx,
                                        const void* msg, size_t msg_len,
                                        const wsrep_gtid_t* current_gtid,
@@ -1115,6 +2318,16 @@ wsrep_cb_status_t wsrep_sst_donate_cb (void* app_ctx, void* recv_ctx,
     ret = sst_donate_mysqldump(data, &current_gtid->uuid, uuid_str,
                                current_gtid->seqno, bypass, env());
   }
+  else if (!strcmp (WSREP_SST_NATIVE, method))
+  {
+    /* joiner state follows address, if joiner sent it */
+    const char* const state= data + strlen (data) + 1;
+    size_t const left= (const char*) msg + msg_len - state;
+    bool const has_state= (state < (const char*) msg + msg_len &&
+                           memchr (state, '\0', left));
+    ret = sst_donate_native(data, has_state ? state : NULL,
+                            &current_gtid->uuid, current_gtid->seqno, bypass);
+  }
   else
   {
     ret = sst_donate_other(method, data, uuid_str,
@@ -1148,3 +2361,75 @@ void wsrep_SE_initialized()
 {
   SE_initialized = true;
 }
+
+/*
+  Applies write sets received by native SST on top of the joiner's own data,
+  in an applier thread, see wsrep_sst_replay(). Node can't continue if it
+  fails: its data would be behind the state it reports.
+*/
+static void sst_apply_received_ws ()
+{
+  wsrep_uuid_t  uuid;
+  wsrep_seqno_t seqno;
+  wsrep_get_SE_checkpoint (uuid, seqno);
+
+  if (memcmp (&uuid, &sst_ws_uuid, sizeof(uuid)) || seqno != sst_ws_seqno)
+  {
+    char se_str[37], ws_str[37];
+    wsrep_uuid_print (&uuid, se_str, sizeof(se_str));
+    wsrep_uuid_print (&sst_ws_uuid, ws_str, sizeof(ws_str));
+    WSREP_ERROR("Storage engine state %s:%lld does not match the state "
+                "write sets were received for: %s:%lld. Can't continue.",
+                se_str, (long long) seqno, ws_str, (long long) sst_ws_seqno);
+    unireg_abort (1);
+  }
+
+  if (wsrep_create_sst_replayer ())
+  {
+    WSREP_ERROR("Failed to create thread to apply write sets received by "
+                "SST. Can't continue.");
+    unireg_abort (1);
+  }
+
+  mysql_mutex_lock (&LOCK_wsrep_sst);
+  while (sst_ws_received)
+    mysql_cond_wait (&COND_wsrep_sst, &LOCK_wsrep_sst);
+  int const err= sst_ws_err;
+  mysql_mutex_unlock (&LOCK_wsrep_sst);
+
+  char path[FN_REFLEN];
+  sst_native_ws_path (path);
+  my_delete (path, MYF(0));
+
+  if (err)
+  {
+    WSREP_ERROR("Failed to apply write sets received by SST: %d (%s). "
+                "Can't continue.", -err, strerror (-err));
+    unireg_abort (1);
+  }
+}
+
+void wsrep_sst_replay (THD* thd)
+{
+  char path[FN_REFLEN];
+  sst_native_ws_path (path);
+
+  wsrep_seqno_t last= sst_ws_seqno;
+  int err= -EIO;
+  File const file= my_open (path, O_RDONLY, MYF(MY_WME));
+  if (file >= 0)
+  {
+    err= wsrep_ws_log_replay (thd, file, sst_ws_uuid, sst_ws_seqno + 1, &last);
+    my_close (file, MYF(0));
+  }
+
+  if (!err)
+    WSREP_INFO("Applied write sets %lld - %lld received by SST",
+               (long long) sst_ws_seqno + 1, (long long) last);
+
+  mysql_mutex_lock (&LOCK_wsrep_sst);
+  sst_ws_err= err;
+  sst_ws_received= false;
+  mysql_cond_broadcast (&COND_wsrep_sst);
+  mysql_mutex_unlock (&LOCK_wsrep_sst);
+}
@@ -18,12 +18,21 @@
 
 #include <mysql.h> // my_bool
 
+class THD;
+
 /* system variables */
 extern const char* wsrep_sst_method;
 extern const char* wsrep_sst_receive_address;
 extern const char* wsrep_sst_donor;
 extern       char* wsrep_sst_auth;
 extern    my_bool  wsrep_sst_donor_rejects_queries;
+extern      ulong  wsrep_sst_native_streams;
+extern      ulong  wsrep_sst_native_timeout;
+
+/* InnoDB file locations as configured, filled by wsrep_check_opts() */
+extern char wsrep_innodb_data_home_dir[];
+extern char wsrep_innodb_log_group_home_dir[];
+extern char wsrep_innodb_undo_directory[];
 
 /*! Synchronizes applier thread start with init thread */
 extern void wsrep_sst_grab();
@@ -31,6 +40,8 @@ extern void wsrep_sst_grab();
 extern bool wsrep_sst_wait();
 /*! Signals wsrep that initialization is complete, writesets can be applied */
 extern void wsrep_sst_continue();
+/*! Applies write sets received by native SST, runs in applier thread */
+extern void wsrep_sst_replay(THD* thd);
 
 extern void wsrep_SE_init_grab();   /*! grab init critical section */
 extern void wsrep_SE_init_wait();   /*! wait for SE init to complete */
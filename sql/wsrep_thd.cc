@@ -22,6 +22,8 @@
 #include "global_threads.h" // LOCK_thread_count, etc.
 #include "sql_base.h" // close_thread_tables()
 #include "mysqld.h"   // start_wsrep_THD();
+#include "wsrep_applier.h" // wsrep_nbo_execute(), wsrep_nbo_recover_execute()
+#include "wsrep_sst.h"     // wsrep_sst_replay()
 
 static long long wsrep_bf_aborts_counter = 0;
 
@@ -40,6 +42,7 @@ void wsrep_client_rollback(THD *thd)
               thd->thread_id, thd->query_id, WSREP_QUERY(thd));
 
   my_atomic_add64(&wsrep_bf_aborts_counter, 1);
+  wsrep_hot_key_conflict(thd);
 
   thd->wsrep_conflict_state= ABORTING;
   mysql_mutex_unlock(&thd->LOCK_wsrep_thd);
@@ -403,78 +406,218 @@ void wsrep_create_appliers(long threads)
   }
 }
 
+/*
+  Queue of BF aborted idle transactions waiting for a rollbacker thread.
+  Victims which block an applier are queued at the head so that they are
+  rolled back first, the rest are served in FIFO order. Queue nodes come
+  from a preallocated pool, so enqueueing from lock-holding InnoDB code
+  normally does not hit the allocator.
+  All below is protected by LOCK_wsrep_rollback.
+*/
+#define WSREP_ABORTING_POOL_SIZE 1024
+
+static struct wsrep_aborting_thd wsrep_aborting_pool[WSREP_ABORTING_POOL_SIZE];
+static wsrep_aborting_thd_t wsrep_aborting_free= NULL;
+static bool                 wsrep_aborting_pool_inited= false;
+static wsrep_aborting_thd_t wsrep_aborting_thd= NULL;
+static wsrep_aborting_thd_t wsrep_aborting_tail= NULL;
+
+long      wsrep_rollbacker_count= 0;  // # of running rollbacker threads
+long      wsrep_rollback_queue_len= 0;
+static ulonglong wsrep_rollbacks_done= 0;
+static ulonglong wsrep_rollback_wait_total= 0; // microseconds
+
+static wsrep_aborting_thd_t wsrep_aborting_node_get()
+{
+  mysql_mutex_assert_owner(&LOCK_wsrep_rollback);
+
+  if (!wsrep_aborting_pool_inited)
+  {
+    for (int i= 0; i < WSREP_ABORTING_POOL_SIZE; ++i)
+    {
+      wsrep_aborting_pool[i].next= wsrep_aborting_free;
+      wsrep_aborting_free= &wsrep_aborting_pool[i];
+    }
+    wsrep_aborting_pool_inited= true;
+  }
+
+  if (wsrep_aborting_free)
+  {
+    wsrep_aborting_thd_t node= wsrep_aborting_free;
+    wsrep_aborting_free= node->next;
+    return node;
+  }
+  /* pool exhausted, fall back to heap */
+  return (wsrep_aborting_thd_t) my_malloc(sizeof(struct wsrep_aborting_thd),
+                                          MYF(0));
+}
+
+static void wsrep_aborting_node_put(wsrep_aborting_thd_t node)
+{
+  mysql_mutex_assert_owner(&LOCK_wsrep_rollback);
+
+  if (node >= wsrep_aborting_pool &&
+      node < wsrep_aborting_pool + WSREP_ABORTING_POOL_SIZE)
+  {
+    node->next= wsrep_aborting_free;
+    wsrep_aborting_free= node;
+  }
+  else
+  {
+    my_free(node);
+  }
+}
+
+/*
+  Queue idle victim thd for rollback by rollbacker threads.
+  If priority is set, the victim holds locks an applier is waiting for.
+*/
+void wsrep_thd_enqueue_rollback(THD *thd, my_bool priority)
+{
+  mysql_mutex_lock(&LOCK_wsrep_rollback);
+
+  for (wsrep_aborting_thd_t abortee= wsrep_aborting_thd; abortee;
+       abortee= abortee->next)
+  {
+    /* check if we have a kill message for this already */
+    if (abortee->aborting_thd == thd)
+    {
+      WSREP_WARN("duplicate thd aborter %lu", thd->thread_id);
+      goto signal;
+    }
+  }
+
+  {
+    wsrep_aborting_thd_t aborting= wsrep_aborting_node_get();
+    if (!aborting)
+    {
+      WSREP_ERROR("out of memory queueing rollback for thd %lu",
+                  thd->thread_id);
+      goto signal;
+    }
+    aborting->aborting_thd= thd;
+    aborting->queued_at=    my_micro_time();
+
+    if (priority || !wsrep_aborting_thd)
+    {
+      aborting->next= wsrep_aborting_thd;
+      wsrep_aborting_thd= aborting;
+      if (!wsrep_aborting_tail) wsrep_aborting_tail= aborting;
+    }
+    else
+    {
+      aborting->next= NULL;
+      wsrep_aborting_tail->next= aborting;
+      wsrep_aborting_tail= aborting;
+    }
+    wsrep_rollback_queue_len++;
+
+    DBUG_PRINT("wsrep",("enqueuing trx abort for %lu", thd->thread_id));
+    WSREP_DEBUG("enqueuing trx abort for (%lu)%s", thd->thread_id,
+                priority ? ", blocking applier" : "");
+  }
+
+signal:
+  DBUG_PRINT("wsrep",("signalling wsrep rollbacker"));
+  WSREP_DEBUG("signaling aborter");
+  mysql_cond_signal(&COND_wsrep_rollback);
+  mysql_mutex_unlock(&LOCK_wsrep_rollback);
+}
+
+int wsrep_show_rollback_latency (THD *thd, SHOW_VAR *var, char *buff)
+{
+  mysql_mutex_lock(&LOCK_wsrep_rollback);
+  *(ulonglong*)buff= wsrep_rollbacks_done ?
+    wsrep_rollback_wait_total / wsrep_rollbacks_done : 0;
+  mysql_mutex_unlock(&LOCK_wsrep_rollback);
+  var->type= SHOW_LONGLONG;
+  var->value= buff;
+  return 0;
+}
+
 static void wsrep_rollback_process(THD *thd)
 {
   DBUG_ENTER("wsrep_rollback_process");
 
   mysql_mutex_lock(&LOCK_wsrep_rollback);
-  wsrep_aborting_thd= NULL;
 
   while (thd->killed == THD::NOT_KILLED) {
-    thd_proc_info(thd, "wsrep aborter idle");
-    thd->mysys_var->current_mutex= &LOCK_wsrep_rollback;
-    thd->mysys_var->current_cond=  &COND_wsrep_rollback;
+    if (!wsrep_aborting_thd)
+    {
+      thd_proc_info(thd, "wsrep aborter idle");
+      thd->mysys_var->current_mutex= &LOCK_wsrep_rollback;
+      thd->mysys_var->current_cond=  &COND_wsrep_rollback;
 
-    mysql_cond_wait(&COND_wsrep_rollback,&LOCK_wsrep_rollback);
+      mysql_cond_wait(&COND_wsrep_rollback,&LOCK_wsrep_rollback);
 
-    WSREP_DEBUG("WSREP rollback thread wakes for signal");
+      WSREP_DEBUG("WSREP rollback thread wakes for signal");
 
-    mysql_mutex_lock(&thd->mysys_var->mutex);
-    thd_proc_info(thd, "wsrep aborter active");
-    thd->mysys_var->current_mutex= 0;
-    thd->mysys_var->current_cond=  0;
-    mysql_mutex_unlock(&thd->mysys_var->mutex);
+      mysql_mutex_lock(&thd->mysys_var->mutex);
+      thd_proc_info(thd, "wsrep aborter active");
+      thd->mysys_var->current_mutex= 0;
+      thd->mysys_var->current_cond=  0;
+      mysql_mutex_unlock(&thd->mysys_var->mutex);
 
-    /* check for false alarms */
-    if (!wsrep_aborting_thd)
-    {
-      WSREP_DEBUG("WSREP rollback thread has empty abort queue");
+      /* check for false alarms */
+      if (!wsrep_aborting_thd)
+      {
+        WSREP_DEBUG("WSREP rollback thread has empty abort queue");
+      }
+      continue;
     }
-    /* process all entries in the queue */
-    while (wsrep_aborting_thd) {
-      THD *aborting;
-      wsrep_aborting_thd_t next = wsrep_aborting_thd->next;
-      aborting = wsrep_aborting_thd->aborting_thd;
-      my_free(wsrep_aborting_thd);
-      wsrep_aborting_thd= next;
-      /*
-       * must release mutex, appliers my want to add more
-       * aborting thds in our work queue, while we rollback
-       */
-      mysql_mutex_unlock(&LOCK_wsrep_rollback);
 
-      mysql_mutex_lock(&aborting->LOCK_wsrep_thd);
-      if (aborting->wsrep_conflict_state== ABORTED)
-      {
-        WSREP_DEBUG("WSREP, thd already aborted: %llu state: %d",
-                    (long long)aborting->real_id,
-                    aborting->wsrep_conflict_state);
+    /*
+     * take one entry at a time, so that other rollbacker threads
+     * can work on the rest of the queue in parallel
+     */
+    THD *aborting;
+    wsrep_aborting_thd_t head= wsrep_aborting_thd;
+    ulonglong queued_at= head->queued_at;
+    aborting= head->aborting_thd;
+    wsrep_aborting_thd= head->next;
+    if (!wsrep_aborting_thd) wsrep_aborting_tail= NULL;
+    wsrep_rollback_queue_len--;
+    wsrep_aborting_node_put(head);
+    /*
+     * must release mutex, appliers my want to add more
+     * aborting thds in our work queue, while we rollback
+     */
+    mysql_mutex_unlock(&LOCK_wsrep_rollback);
 
-        mysql_mutex_unlock(&aborting->LOCK_wsrep_thd);
-        mysql_mutex_lock(&LOCK_wsrep_rollback);
-        continue;
-      }
-      aborting->wsrep_conflict_state= ABORTING;
+    mysql_mutex_lock(&aborting->LOCK_wsrep_thd);
+    if (aborting->wsrep_conflict_state== ABORTED)
+    {
+      WSREP_DEBUG("WSREP, thd already aborted: %llu state: %d",
+                  (long long)aborting->real_id,
+                  aborting->wsrep_conflict_state);
 
       mysql_mutex_unlock(&aborting->LOCK_wsrep_thd);
+      mysql_mutex_lock(&LOCK_wsrep_rollback);
+      continue;
+    }
+    aborting->wsrep_conflict_state= ABORTING;
 
-      aborting->store_globals();
+    mysql_mutex_unlock(&aborting->LOCK_wsrep_thd);
 
-      mysql_mutex_lock(&aborting->LOCK_wsrep_thd);
+    aborting->store_globals();
 
-      /* prepare THD for rollback processing */
-      mysql_reset_thd_for_next_command(aborting);
-      aborting->lex->sql_command= SQLCOM_ROLLBACK;
+    mysql_mutex_lock(&aborting->LOCK_wsrep_thd);
 
-      wsrep_client_rollback(aborting);
-      WSREP_DEBUG("WSREP rollbacker aborted thd: (%lu %llu)",
-                  aborting->thread_id, (long long)aborting->real_id);
-      mysql_mutex_unlock(&aborting->LOCK_wsrep_thd);
+    /* prepare THD for rollback processing */
+    mysql_reset_thd_for_next_command(aborting);
+    aborting->lex->sql_command= SQLCOM_ROLLBACK;
 
-      mysql_mutex_lock(&LOCK_wsrep_rollback);
-    }
+    wsrep_client_rollback(aborting);
+    WSREP_DEBUG("WSREP rollbacker aborted thd: (%lu %llu)",
+                aborting->thread_id, (long long)aborting->real_id);
+    mysql_mutex_unlock(&aborting->LOCK_wsrep_thd);
+
+    mysql_mutex_lock(&LOCK_wsrep_rollback);
+    wsrep_rollbacks_done++;
+    wsrep_rollback_wait_total+= my_micro_time() - queued_at;
   }
 
+  wsrep_rollbacker_count--;
   mysql_mutex_unlock(&LOCK_wsrep_rollback);
   sql_print_information("WSREP: rollbacker thread exiting");
 
@@ -486,12 +629,83 @@ void wsrep_create_rollbacker()
 {
   if (wsrep_provider && strcasecmp(wsrep_provider, "none"))
   {
-    /* create rollbacker */
-    if (create_wsrep_THD(wsrep_rollback_process))
-      WSREP_WARN("Can't create thread to manage wsrep rollback");
+    /* create rollbackers */
+    for (ulong i= 0; i < wsrep_rollbacker_threads; ++i)
+    {
+      mysql_mutex_lock(&LOCK_wsrep_rollback);
+      wsrep_rollbacker_count++;
+      mysql_mutex_unlock(&LOCK_wsrep_rollback);
+
+      if (create_wsrep_THD(wsrep_rollback_process))
+      {
+        WSREP_WARN("Can't create thread to manage wsrep rollback");
+        mysql_mutex_lock(&LOCK_wsrep_rollback);
+        wsrep_rollbacker_count--;
+        mysql_mutex_unlock(&LOCK_wsrep_rollback);
+        break;
+      }
+    }
   }
 }
 
+static void wsrep_nbo_process(THD *thd)
+{
+  DBUG_ENTER("wsrep_nbo_process");
+
+  struct wsrep_thd_shadow shadow;
+  wsrep_prepare_bf_thd(thd, &shadow);
+
+  wsrep_nbo_execute(thd);
+
+  wsrep_return_from_bf_mode(thd, &shadow);
+  DBUG_VOID_RETURN;
+}
+
+bool wsrep_create_nbo_worker()
+{
+  return create_wsrep_THD(wsrep_nbo_process);
+}
+
+static void wsrep_nbo_recover_process(THD *thd)
+{
+  DBUG_ENTER("wsrep_nbo_recover_process");
+
+  struct wsrep_thd_shadow shadow;
+  wsrep_prepare_bf_thd(thd, &shadow);
+
+  wsrep_nbo_recover_execute(thd);
+
+  wsrep_return_from_bf_mode(thd, &shadow);
+  DBUG_VOID_RETURN;
+}
+
+bool wsrep_create_nbo_recoverer()
+{
+  return create_wsrep_THD(wsrep_nbo_recover_process);
+}
+
+static void wsrep_sst_replay_process(THD *thd)
+{
+  DBUG_ENTER("wsrep_sst_replay_process");
+
+  struct wsrep_thd_shadow shadow;
+  wsrep_prepare_bf_thd(thd, &shadow);
+
+  /* From trans_begin() */
+  thd->variables.option_bits|= OPTION_BEGIN;
+  thd->server_status|= SERVER_STATUS_IN_TRANS;
+
+  wsrep_sst_replay(thd);
+
+  wsrep_return_from_bf_mode(thd, &shadow);
+  DBUG_VOID_RETURN;
+}
+
+bool wsrep_create_sst_replayer()
+{
+  return create_wsrep_THD(wsrep_sst_replay_process);
+}
+
 void wsrep_thd_set_PA_safe(void *thd_ptr, my_bool safe)
 { 
   if (thd_ptr) 
@@ -19,10 +19,14 @@
 #include "sql_class.h"
 
 int wsrep_show_bf_aborts (THD *thd, SHOW_VAR *var, char *buff);
+int wsrep_show_rollback_latency (THD *thd, SHOW_VAR *var, char *buff);
 void wsrep_client_rollback(THD *thd);
 void wsrep_replay_transaction(THD *thd);
 void wsrep_create_appliers(long threads);
 void wsrep_create_rollbacker();
+bool wsrep_create_nbo_worker();
+bool wsrep_create_nbo_recoverer();
+bool wsrep_create_sst_replayer();
 
 int  wsrep_abort_thd(void *bf_thd_ptr, void *victim_thd_ptr,
                                 my_bool signal);
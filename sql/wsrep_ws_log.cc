@@ -0,0 +1,748 @@
+/* Copyright (C) 2015 Codership Oy <info@codership.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA. */
+
+#include "wsrep_ws_log.h"
+
+#include "mysqld.h"       // mysql_real_data_home
+#include "sql_class.h"    // SHOW_VAR
+#include "wsrep_priv.h"
+#include "wsrep_applier.h"
+#include "wsrep_binlog.h"  // wsrep_write_cache_buf
+
+#include <sys/mman.h>
+
+/*
+  File layout:
+
+  header page:
+    magic(8) ring_size(8) uuid(16) head(8) tail(8) used(8) last(8)
+
+  ring of 8 byte aligned records:
+    magic(4) len(4) seqno(8) crc32(4) flags(4) data(len)
+
+  If a record does not fit before the end of the ring, the rest of the
+  ring is marked with a wrap magic and the record is written at ring start.
+  Header is updated after the record, so after crash recovery scans the
+  ring from head and drops whatever follows the first broken record.
+*/
+
+static const char   ws_log_magic[8]= { 'W','S','R','E','P','L','G','2' };
+static const uint32 ws_log_rec_magic=  0x5253574c; /* "LWSR" */
+static const uint32 ws_log_wrap_magic= 0x5057534c; /* "LSWP" */
+static const size_t ws_log_rec_header= 24;
+
+static inline size_t ws_log_rec_size(size_t len)
+{
+  return ws_log_rec_header + MY_ALIGN(len, 8);
+}
+
+static const size_t ws_stream_rec_header= 20;
+
+namespace wsp
+{
+
+int ws_stream_put(ws_stream_write write, void* ctx, wsrep_seqno_t seqno,
+                  uint32 flags, const void* buf, size_t len)
+{
+  uchar hdr[ws_stream_rec_header];
+  int8store(hdr,      (ulonglong) seqno);
+  int4store(hdr + 8,  flags);
+  int4store(hdr + 12, (uint32) len);
+  int4store(hdr + 16, my_checksum(0, (const uchar*) buf, len));
+
+  int err= write(ctx, hdr, sizeof(hdr));
+  if (!err && len) err= write(ctx, buf, len);
+  return err;
+}
+
+int ws_stream_end(ws_stream_write write, void* ctx)
+{
+  uchar hdr[ws_stream_rec_header]= { 0, };
+  int8store(hdr, (ulonglong) WSREP_SEQNO_UNDEFINED);
+  return write(ctx, hdr, sizeof(hdr));
+}
+
+int ws_stream_get(ws_stream_read read, void* read_ctx, wsrep_seqno_t first,
+                  ws_stream_apply apply, void* apply_ctx,
+                  wsrep_seqno_t* last)
+{
+  uchar  hdr[ws_stream_rec_header];
+  uchar* buf= NULL;
+  size_t buf_size= 0;
+  int    err;
+
+  *last= first - 1;
+
+  while (!(err= read(read_ctx, hdr, sizeof(hdr))))
+  {
+    wsrep_seqno_t const seqno= (wsrep_seqno_t) uint8korr(hdr);
+    if (seqno == WSREP_SEQNO_UNDEFINED) break;
+
+    uint32 const flags= uint4korr(hdr + 8);
+    size_t const len= uint4korr(hdr + 12);
+    if (seqno != *last + 1 || len > wsrep_max_ws_size)
+    {
+      err= -EPROTO;
+      break;
+    }
+
+    if (len > buf_size)
+    {
+      uchar* const tmp= (uchar*) my_realloc(buf, len, MYF(MY_ALLOW_ZERO_PTR));
+      if (!tmp)
+      {
+        err= -ENOMEM;
+        break;
+      }
+      buf= tmp;
+      buf_size= len;
+    }
+
+    if (len && (err= read(read_ctx, buf, len))) break;
+
+    if (my_checksum(0, buf, len) != uint4korr(hdr + 16))
+    {
+      err= -EPROTO;
+      break;
+    }
+
+    if ((err= apply(apply_ctx, seqno, flags, buf, len))) break;
+    *last= seqno;
+  }
+
+  my_free(buf);
+  return err;
+}
+
+int ws_stream_file_write(void* ctx, const void* buf, size_t len)
+{
+  return my_write(*(File*) ctx, (const uchar*) buf, len,
+                  MYF(MY_NABP | MY_WME)) ? -EIO : 0;
+}
+
+int ws_stream_file_read(void* ctx, void* buf, size_t len)
+{
+  return my_read(*(File*) ctx, (uchar*) buf, len, MYF(MY_NABP)) ? -EIO : 0;
+}
+
+ws_log::ws_log()
+  : file_(-1), map_(NULL), map_size_(0), ring_size_(0),
+    head_(0), tail_(0), used_(0), uuid_(WSREP_UUID_UNDEFINED),
+    last_(WSREP_SEQNO_UNDEFINED), index_()
+{
+  mysql_mutex_init(key_LOCK_wsrep_ws_log_append, &append_lock_,
+                   MY_MUTEX_INIT_FAST);
+  mysql_mutex_init(key_LOCK_wsrep_ws_log, &lock_, MY_MUTEX_INIT_FAST);
+}
+
+ws_log::~ws_log()
+{
+  close();
+  mysql_mutex_destroy(&lock_);
+  mysql_mutex_destroy(&append_lock_);
+}
+
+int ws_log::open(const char* path, size_t size)
+{
+  size= MY_ALIGN(size, 8);
+  if (size < 2 * ws_log_rec_size(0)) return -EINVAL;
+
+  mysql_mutex_lock(&append_lock_);
+  mysql_mutex_lock(&lock_);
+
+  int err= 0;
+  File const file= my_open(path, O_RDWR | O_CREAT, MYF(MY_WME));
+  if (file < 0)
+  {
+    mysql_mutex_unlock(&lock_);
+    mysql_mutex_unlock(&append_lock_);
+    return -EIO;
+  }
+
+  size_t const map_size= header_size + size;
+  my_off_t const old_size= my_seek(file, 0, MY_SEEK_END, MYF(0));
+  bool const fresh= (old_size != map_size);
+
+  if (fresh && my_chsize(file, 0, 0, MYF(MY_WME)))
+    err= -EIO;
+  if (!err && fresh && my_chsize(file, map_size, 0, MYF(MY_WME)))
+    err= -EIO;
+
+  uchar* map= NULL;
+  if (!err)
+  {
+    map= (uchar*) my_mmap(0, map_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                          file, 0);
+    if (map == MAP_FAILED)
+    {
+      err= -errno;
+      map= NULL;
+    }
+  }
+
+  if (err)
+  {
+    my_close(file, MYF(0));
+    mysql_mutex_unlock(&lock_);
+    mysql_mutex_unlock(&append_lock_);
+    return err;
+  }
+
+  file_=      file;
+  map_=       map;
+  map_size_=  map_size;
+  ring_size_= size;
+
+  if (fresh || memcmp(map_, ws_log_magic, sizeof(ws_log_magic)) ||
+      uint8korr(map_ + 8) != ring_size_)
+  {
+    reset(WSREP_UUID_UNDEFINED, WSREP_SEQNO_UNDEFINED);
+  }
+  else
+  {
+    recover();
+  }
+
+  mysql_mutex_unlock(&lock_);
+  mysql_mutex_unlock(&append_lock_);
+  return 0;
+}
+
+void ws_log::close()
+{
+  mysql_mutex_lock(&append_lock_);
+  mysql_mutex_lock(&lock_);
+  if (map_)
+  {
+    store_header();
+    my_msync(file_, map_, map_size_, MS_SYNC);
+    my_munmap(map_, map_size_);
+    my_close(file_, MYF(0));
+    map_=  NULL;
+    file_= -1;
+  }
+  index_.clear();
+  mysql_mutex_unlock(&lock_);
+  mysql_mutex_unlock(&append_lock_);
+}
+
+void ws_log::store_header()
+{
+  memcpy(map_, ws_log_magic, sizeof(ws_log_magic));
+  int8store(map_ + 8, (ulonglong) ring_size_);
+  memcpy(map_ + 16, &uuid_, sizeof(uuid_));
+  int8store(map_ + 32, (ulonglong) head_);
+  int8store(map_ + 40, (ulonglong) tail_);
+  int8store(map_ + 48, (ulonglong) used_);
+  int8store(map_ + 56, (ulonglong) last_);
+}
+
+void ws_log::reset(const wsrep_uuid_t& uuid, wsrep_seqno_t seqno)
+{
+  head_= tail_= used_= 0;
+  uuid_= uuid;
+  last_= seqno;
+  index_.clear();
+  store_header();
+}
+
+/* Rebuilds the index from records between head and tail */
+void ws_log::recover()
+{
+  memcpy(&uuid_, map_ + 16, sizeof(uuid_));
+  head_= (size_t) uint8korr(map_ + 32);
+  size_t const used= (size_t) uint8korr(map_ + 48);
+  last_= (wsrep_seqno_t) uint8korr(map_ + 56);
+
+  if (head_ >= ring_size_ || used > ring_size_ || head_ % 8)
+  {
+    reset(WSREP_UUID_UNDEFINED, WSREP_SEQNO_UNDEFINED);
+    return;
+  }
+
+  size_t pos= head_;
+  size_t scanned= 0;
+  while (scanned < used)
+  {
+    if (pos == ring_size_) pos= 0;
+
+    const uchar* const rec= ring() + pos;
+    uint32 const magic= uint4korr(rec);
+
+    if (magic == ws_log_wrap_magic)
+    {
+      scanned+= ring_size_ - pos;
+      pos= 0;
+      continue;
+    }
+
+    if (magic != ws_log_rec_magic || pos + ws_log_rec_header > ring_size_)
+      break;
+
+    size_t const len= uint4korr(rec + 4);
+    size_t const rec_size= ws_log_rec_size(len);
+    if (pos + rec_size > ring_size_ ||
+        my_checksum(0, rec + ws_log_rec_header, len) != uint4korr(rec + 16))
+      break;
+
+    index_[(wsrep_seqno_t) uint8korr(rec + 8)]= pos;
+    pos+= rec_size;
+    scanned+= rec_size;
+  }
+
+  used_= MY_MIN(scanned, used);
+  tail_= pos == ring_size_ ? 0 : pos;
+  if (!used_) head_= tail_= 0;
+  /* log covers up to its last intact record, or nothing if some is lost */
+  if (!index_.empty())
+    last_= index_.rbegin()->first;
+  else if (used)
+    last_= WSREP_SEQNO_UNDEFINED;
+  store_header();
+}
+
+size_t ws_log::contiguous_free() const
+{
+  if (used_ == 0)     return ring_size_ - tail_;
+  if (head_ > tail_)  return head_ - tail_;
+  if (head_ == tail_) return 0;
+  return ring_size_ - tail_;
+}
+
+void ws_log::evict_head()
+{
+  const uchar* const rec= ring() + head_;
+
+  if (uint4korr(rec) == ws_log_wrap_magic)
+  {
+    used_-= ring_size_ - head_;
+    head_= 0;
+  }
+  else
+  {
+    size_t const rec_size= ws_log_rec_size(uint4korr(rec + 4));
+    index_.erase((wsrep_seqno_t) uint8korr(rec + 8));
+    used_-= rec_size;
+    head_+= rec_size;
+    if (head_ == ring_size_) head_= 0;
+  }
+
+  if (used_ == 0) head_= tail_= 0;
+}
+
+/* Makes room for a record at the ring tail and returns its offset */
+size_t ws_log::reserve(size_t rec_size)
+{
+  if (tail_ + rec_size > ring_size_)
+  {
+    /* free the rest of the ring and wrap around */
+    while (used_ > 0 && head_ >= tail_) evict_head();
+
+    if (used_ > 0)
+    {
+      int4store(ring() + tail_, ws_log_wrap_magic);
+      used_+= ring_size_ - tail_;
+    }
+    else
+    {
+      head_= 0;
+    }
+    tail_= 0;
+  }
+
+  while (contiguous_free() < rec_size) evict_head();
+
+  return tail_;
+}
+
+uchar* ws_log::write_header(size_t pos, wsrep_seqno_t seqno, uint32 flags,
+                            size_t len)
+{
+  uchar* const rec= ring() + pos;
+  int4store(rec,      ws_log_rec_magic);
+  int4store(rec + 4,  (uint32) len);
+  int8store(rec + 8,  (ulonglong) seqno);
+  int4store(rec + 20, flags);
+  return rec;
+}
+
+/* Makes reserved and written record visible */
+void ws_log::publish(wsrep_seqno_t seqno, size_t pos, size_t rec_size)
+{
+  index_[seqno]= pos;
+  tail_= pos + rec_size;
+  used_+= rec_size;
+  if (tail_ == ring_size_) tail_= 0;
+  last_= seqno;
+
+  store_header();
+}
+
+void ws_log::position(const wsrep_uuid_t& uuid, wsrep_seqno_t seqno)
+{
+  mysql_mutex_lock(&append_lock_);
+  mysql_mutex_lock(&lock_);
+  if (map_ && (memcmp(&uuid, &uuid_, sizeof(uuid)) || last_ != seqno))
+    reset(uuid, seqno);
+  mysql_mutex_unlock(&lock_);
+  mysql_mutex_unlock(&append_lock_);
+}
+
+int ws_log::append(const wsrep_uuid_t& uuid, wsrep_seqno_t seqno,
+                   uint32 flags, const void* buf, size_t len)
+{
+  size_t const rec_size= ws_log_rec_size(len);
+  size_t const skip_size= ws_log_rec_size(0);
+
+  mysql_mutex_lock(&append_lock_);
+  mysql_mutex_lock(&lock_);
+
+  int err= 0;
+
+  if (!map_)
+  {
+    err= -EBADF;
+  }
+  else if (memcmp(&uuid, &uuid_, sizeof(uuid)) ||
+           last_ == WSREP_SEQNO_UNDEFINED)
+  {
+    reset(uuid, seqno - 1);
+  }
+  else if (seqno <= last_)
+  {
+    /*
+      Write sets are appended in commit order, so this one would have been
+      logged as a skip already. Restart history rather than serve it.
+    */
+    if (flags & flag_skip)
+      err= -EEXIST;
+    else
+    {
+      reset(uuid, last_);
+      err= -ERANGE;
+    }
+  }
+  else if ((ulonglong) (seqno - last_ - 1) * skip_size > ring_size_ / 2)
+  {
+    /* gap is too long to be logged */
+    reset(uuid, seqno - 1);
+  }
+
+  if (!err && (rec_size > ring_size_ / 2 || len > UINT_MAX32))
+  {
+    reset(uuid, seqno);
+    err= -EMSGSIZE;
+  }
+
+  if (err)
+  {
+    mysql_mutex_unlock(&lock_);
+    mysql_mutex_unlock(&append_lock_);
+    return err;
+  }
+
+  /* seqnos which committed nothing since the last append */
+  for (wsrep_seqno_t skip= last_ + 1; skip < seqno; ++skip)
+  {
+    size_t const pos= reserve(skip_size);
+    uchar* const rec= write_header(pos, skip, flag_skip, 0);
+    int4store(rec + 16, my_checksum(0, NULL, 0));
+    publish(skip, pos, skip_size);
+  }
+
+  size_t const pos= reserve(rec_size);
+
+  /* reserved space is invisible to readers, copy write set unlocked */
+  mysql_mutex_unlock(&lock_);
+
+  uchar* const rec= write_header(pos, seqno, flags, len);
+  if (len) memcpy(rec + ws_log_rec_header, buf, len);
+  int4store(rec + 16, my_checksum(0, rec + ws_log_rec_header, len));
+
+  mysql_mutex_lock(&lock_);
+  publish(seqno, pos, rec_size);
+  mysql_mutex_unlock(&lock_);
+
+  mysql_mutex_unlock(&append_lock_);
+  return 0;
+}
+
+int ws_log::read(wsrep_seqno_t seqno, uchar** buf, size_t* len,
+                 uint32* flags)
+{
+  int err= 0;
+
+  mysql_mutex_lock(&lock_);
+
+  index_t::const_iterator const i(index_.find(seqno));
+  if (i == index_.end())
+  {
+    err= -ENOENT;
+  }
+  else
+  {
+    const uchar* const rec= ring() + i->second;
+    *len= uint4korr(rec + 4);
+    *flags= uint4korr(rec + 20);
+    *buf= (uchar*) my_malloc(*len ? *len : 1, MYF(0));
+    if (*buf)
+      memcpy(*buf, rec + ws_log_rec_header, *len);
+    else
+      err= -ENOMEM;
+  }
+
+  mysql_mutex_unlock(&lock_);
+  return err;
+}
+
+bool ws_log::covers(const wsrep_uuid_t& uuid,
+                    wsrep_seqno_t first, wsrep_seqno_t last)
+{
+  mysql_mutex_lock(&lock_);
+  bool const ret(map_ && !memcmp(&uuid, &uuid_, sizeof(uuid)) &&
+                 last_ != WSREP_SEQNO_UNDEFINED && last <= last_ &&
+                 (first > last ||
+                  (!index_.empty() && index_.begin()->first <= first)));
+  mysql_mutex_unlock(&lock_);
+  return ret;
+}
+
+int ws_log::serve(wsrep_seqno_t first, wsrep_seqno_t last,
+                  ws_stream_write write, void* ctx)
+{
+  int err= 0;
+
+  for (wsrep_seqno_t seqno= first; !err && seqno <= last; ++seqno)
+  {
+    uchar* buf;
+    size_t len;
+    uint32 flags;
+    if (!(err= read(seqno, &buf, &len, &flags)))
+    {
+      err= ws_stream_put(write, ctx, seqno, flags, buf, len);
+      my_free(buf);
+    }
+  }
+
+  return err ? err : ws_stream_end(write, ctx);
+}
+
+wsrep_seqno_t ws_log::first()
+{
+  mysql_mutex_lock(&lock_);
+  wsrep_seqno_t const ret(index_.empty() ?
+                          WSREP_SEQNO_UNDEFINED : index_.begin()->first);
+  mysql_mutex_unlock(&lock_);
+  return ret;
+}
+
+wsrep_seqno_t ws_log::last()
+{
+  mysql_mutex_lock(&lock_);
+  wsrep_seqno_t const ret(index_.empty() ?
+                          WSREP_SEQNO_UNDEFINED : index_.rbegin()->first);
+  mysql_mutex_unlock(&lock_);
+  return ret;
+}
+
+void ws_log::uuid(wsrep_uuid_t* uuid)
+{
+  mysql_mutex_lock(&lock_);
+  *uuid= uuid_;
+  mysql_mutex_unlock(&lock_);
+}
+
+} /* namespace wsp */
+
+
+#define WSREP_WS_LOG_NAME "wsrep_ws.log"
+
+ulonglong wsrep_ws_log_size= 0;   // 0 - write set log disabled
+
+static wsp::ws_log* ws_log= NULL;
+
+void wsrep_ws_log_init()
+{
+  if (!wsrep_ws_log_size || ws_log) return;
+
+  char path[FN_REFLEN];
+  fn_format(path, WSREP_WS_LOG_NAME, mysql_real_data_home, "",
+            MY_UNPACK_FILENAME | MY_SAFE_PATH);
+
+  ws_log= new wsp::ws_log();
+  int const err= ws_log->open(path, wsrep_ws_log_size);
+  if (err)
+  {
+    WSREP_WARN("Failed to open write set log '%s': %d (%s), "
+               "write sets will not be logged", path, -err, strerror(-err));
+    delete ws_log;
+    ws_log= NULL;
+    return;
+  }
+
+  WSREP_INFO("Write set log '%s' covers seqnos %lld - %lld", path,
+             (long long) ws_log->first(), (long long) ws_log->last());
+}
+
+void wsrep_ws_log_deinit()
+{
+  delete ws_log;
+  ws_log= NULL;
+}
+
+void wsrep_ws_log_position(const wsrep_uuid_t& uuid, wsrep_seqno_t seqno)
+{
+  if (ws_log) ws_log->position(uuid, seqno);
+}
+
+/*
+  Must be called in commit order: a seqno which is not appended before the
+  next one is logged as having committed nothing.
+*/
+void wsrep_ws_log_append(const wsrep_trx_meta_t* meta, uint32 flags,
+                         const void* buf, size_t len)
+{
+  if (!ws_log || meta->gtid.seqno < 0) return;
+
+  int const err= ws_log->append(meta->gtid.uuid, meta->gtid.seqno, flags,
+                                buf, len);
+  if (err)
+  {
+    WSREP_DEBUG("write set %lld of %zu bytes not logged: %d, "
+                "write set log history restarts",
+                (long long) meta->gtid.seqno, len, -err);
+  }
+}
+
+/*
+  Local transaction is logged once pre_commit() has put it in commit order.
+  Its write set is read back from the binlog cache.
+*/
+void wsrep_ws_log_local(THD* thd, st_io_cache* cache, uint32 flags)
+{
+  if (!ws_log) return;
+
+  uchar* buf= NULL;
+  size_t len= 0;
+  if (wsrep_write_cache_buf(cache, &buf, &len))
+    ws_log->position(thd->wsrep_trx_meta.gtid.uuid,
+                     thd->wsrep_trx_meta.gtid.seqno);
+  else
+    wsrep_ws_log_append(&thd->wsrep_trx_meta, flags, buf, len);
+  my_free(buf);
+}
+
+/*
+  Applied write set is logged when it commits, in commit order. Provider
+  does not promise that its buffer outlives apply_cb, so it is copied.
+*/
+void wsrep_ws_log_stage(THD* thd, const void* buf, size_t len)
+{
+  if (!ws_log) return;
+  thd->wsrep_ws_log_buf= thd->memdup(buf, len ? len : 1);
+  thd->wsrep_ws_log_len= len;
+}
+
+void wsrep_ws_log_commit(THD* thd, uint32 flags, bool commit)
+{
+  if (ws_log && commit)
+  {
+    if (thd->wsrep_ws_log_buf)
+      wsrep_ws_log_append(&thd->wsrep_trx_meta, flags,
+                          thd->wsrep_ws_log_buf, thd->wsrep_ws_log_len);
+    else
+      ws_log->position(thd->wsrep_trx_meta.gtid.uuid,
+                       thd->wsrep_trx_meta.gtid.seqno);
+  }
+  thd->wsrep_ws_log_buf= NULL;
+  thd->wsrep_ws_log_len= 0;
+}
+
+/*
+  Donor calls this when all write sets up to seqno have committed, so that
+  the ones which committed nothing are logged as such.
+*/
+void wsrep_ws_log_sync(const wsrep_uuid_t& uuid, wsrep_seqno_t seqno)
+{
+  if (ws_log && seqno >= 0)
+    ws_log->append(uuid, seqno, wsp::ws_log::flag_skip, NULL, 0);
+}
+
+bool wsrep_ws_log_covers(const wsrep_uuid_t& uuid,
+                         wsrep_seqno_t first, wsrep_seqno_t last)
+{
+  return ws_log && ws_log->covers(uuid, first, last);
+}
+
+int wsrep_ws_log_serve(wsrep_seqno_t first, wsrep_seqno_t last,
+                       wsp::ws_stream_write write, void* ctx)
+{
+  return ws_log ? ws_log->serve(first, last, write, ctx) : -ENOENT;
+}
+
+struct wsrep_ws_replay_ctx
+{
+  THD*         thd;
+  wsrep_uuid_t uuid;
+};
+
+static int wsrep_ws_replay_apply(void* ctx, wsrep_seqno_t seqno,
+                                 uint32 flags, const void* buf, size_t len)
+{
+  if (flags & wsp::ws_log::flag_skip) return 0;
+
+  wsrep_ws_replay_ctx* const replay((wsrep_ws_replay_ctx*) ctx);
+  wsrep_trx_meta_t meta;
+  meta.gtid.uuid=  replay->uuid;
+  meta.gtid.seqno= seqno;
+  meta.depends_on= seqno - 1;
+
+  wsrep_cb_status_t const rcode(wsrep_apply_cb(replay->thd, buf, len, flags,
+                                               &meta));
+  wsrep_bool_t exit= false;
+  wsrep_cb_status_t const ccode(wsrep_commit_cb(replay->thd, flags, &meta,
+                                                &exit,
+                                                WSREP_CB_SUCCESS == rcode));
+
+  return (WSREP_CB_SUCCESS == rcode && WSREP_CB_SUCCESS == ccode) ? 0 : -EIO;
+}
+
+int wsrep_ws_log_replay(THD* thd, File file, const wsrep_uuid_t& uuid,
+                        wsrep_seqno_t first, wsrep_seqno_t* last)
+{
+  wsrep_ws_replay_ctx ctx= { thd, uuid };
+  return wsp::ws_stream_get(wsp::ws_stream_file_read, &file, first,
+                            wsrep_ws_replay_apply, &ctx, last);
+}
+
+static int wsrep_show_ws_log_seqno(SHOW_VAR* var, char* buff, bool first)
+{
+  longlong seqno= WSREP_SEQNO_UNDEFINED;
+  if (ws_log) seqno= first ? ws_log->first() : ws_log->last();
+  *(longlong*) buff= seqno;
+  var->type= SHOW_LONGLONG;
+  var->value= buff;
+  return 0;
+}
+
+int wsrep_show_ws_log_first(THD* thd, SHOW_VAR* var, char* buff)
+{
+  return wsrep_show_ws_log_seqno(var, buff, true);
+}
+
+int wsrep_show_ws_log_last(THD* thd, SHOW_VAR* var, char* buff)
+{
+  return wsrep_show_ws_log_seqno(var, buff, false);
+}
@@ -0,0 +1,192 @@
+/* Copyright (C) 2015 Codership Oy <info@codership.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA. */
+
+#ifndef WSREP_WS_LOG_H
+#define WSREP_WS_LOG_H
+
+#include "my_global.h"
+#include "my_pthread.h"
+#include "mysql/psi/mysql_thread.h"
+#include "../wsrep/wsrep_api.h"
+
+#include <map>
+
+class THD;
+struct st_mysql_show_var;
+struct st_io_cache;
+
+namespace wsp
+{
+
+/*
+  Write set stream: a sequence of records
+    seqno(8) flags(4) len(4) crc32(4) data(len)
+  for consecutive seqnos, terminated by a record with seqno -1.
+  It is what a donor serves from its write set log and what a joiner stores
+  and replays, so the same code handles a socket and a file as transport.
+  I/O callbacks transfer exactly len bytes and return 0 or -errno.
+*/
+typedef int (*ws_stream_write)(void* ctx, const void* buf, size_t len);
+typedef int (*ws_stream_read) (void* ctx, void* buf, size_t len);
+typedef int (*ws_stream_apply)(void* ctx, wsrep_seqno_t seqno, uint32 flags,
+                               const void* buf, size_t len);
+
+int ws_stream_put (ws_stream_write write, void* ctx, wsrep_seqno_t seqno,
+                   uint32 flags, const void* buf, size_t len);
+int ws_stream_end (ws_stream_write write, void* ctx);
+
+/*
+  Reads stream records, verifies that they are intact and continue from
+  seqno first, and passes them to apply.
+  @param last  seqno of the last record read, first - 1 if none
+  @return 0, -EPROTO if stream is broken or an error of read or apply
+*/
+int ws_stream_get (ws_stream_read read, void* read_ctx, wsrep_seqno_t first,
+                   ws_stream_apply apply, void* apply_ctx,
+                   wsrep_seqno_t* last);
+
+/* stream I/O over a File, ctx is a File* */
+int ws_stream_file_write (void* ctx, const void* buf, size_t len);
+int ws_stream_file_read  (void* ctx, void* buf, size_t len);
+
+/*
+  Persistent ring log of replicated write sets indexed by seqno.
+
+  The log is a memory mapped file: a header page followed by a ring of
+  records. When the ring is full, oldest records are evicted, so the log
+  keeps as long a history as its size permits and survives restarts.
+
+  Write sets are appended in seqno order as they commit. A seqno which
+  commits nothing (e.g. failed certification) is logged as an empty skip
+  record when the next one is appended, so the log covers every seqno from
+  first() to last() and any such range can be served to a joiner.
+  All methods are thread safe.
+*/
+class ws_log
+{
+public:
+
+  /* flag of a skip record, not a wsrep flag */
+  static const uint32 flag_skip= 1U << 31;
+
+  ws_log();
+  ~ws_log();
+
+  /* Opens (creating if needed) log of ring size bytes, 0 or -errno */
+  int  open (const char* path, size_t size);
+  void close ();
+  bool is_open () const { return map_ != NULL; }
+
+  /*
+    Sets the position write sets are going to be appended from, i.e. the
+    state of the node. Log history is restarted unless it ends right there.
+  */
+  void position (const wsrep_uuid_t& uuid, wsrep_seqno_t seqno);
+
+  /*
+    Appends write set, or a skip record if flags is flag_skip. Seqnos
+    between last() and seqno are logged as skips. Log history is restarted
+    if the uuid differs from the one of records already in the log.
+    @return 0, -EEXIST if skip seqno is already covered, -ERANGE if write
+            set seqno is already covered or -EMSGSIZE if write set does not
+            fit in the ring. History is restarted on the last two.
+  */
+  int  append (const wsrep_uuid_t& uuid, wsrep_seqno_t seqno, uint32 flags,
+               const void* buf, size_t len);
+
+  /*
+    Copies logged write set to my_malloc()'ed *buf.
+    @return 0, -ENOENT if seqno is not in the log or -ENOMEM
+  */
+  int  read (wsrep_seqno_t seqno, uchar** buf, size_t* len, uint32* flags);
+
+  /* Whether write sets first..last of history uuid are all in the log */
+  bool covers (const wsrep_uuid_t& uuid,
+               wsrep_seqno_t first, wsrep_seqno_t last);
+
+  /*
+    Writes write sets first..last to stream.
+    @return 0, -ENOENT if some got evicted meanwhile or an error of write
+  */
+  int  serve (wsrep_seqno_t first, wsrep_seqno_t last,
+              ws_stream_write write, void* ctx);
+
+  /* lowest and highest logged seqno, WSREP_SEQNO_UNDEFINED if empty */
+  wsrep_seqno_t first ();
+  wsrep_seqno_t last ();
+  void          uuid (wsrep_uuid_t* uuid);
+
+private:
+
+  ws_log (const ws_log&);
+  ws_log& operator= (const ws_log&);
+
+  uchar* ring () const { return map_ + header_size; }
+  size_t contiguous_free () const;
+  void   evict_head ();
+  size_t reserve (size_t rec_size);
+  uchar* write_header (size_t pos, wsrep_seqno_t seqno, uint32 flags,
+                       size_t len);
+  void   publish (wsrep_seqno_t seqno, size_t pos, size_t rec_size);
+  void   reset (const wsrep_uuid_t& uuid, wsrep_seqno_t seqno);
+  void   store_header ();
+  void   recover ();
+
+  static const size_t header_size= 4096;
+
+  typedef std::map<wsrep_seqno_t, size_t> index_t;
+
+  /*
+    Appends are serialized by append_lock_ and copy write set into the ring
+    without holding lock_, which only guards ring state against readers.
+  */
+  mysql_mutex_t append_lock_;
+  mysql_mutex_t lock_;
+  File          file_;
+  uchar*        map_;
+  size_t        map_size_;
+  size_t        ring_size_;
+  size_t        head_;  /* ring offset of the oldest record      */
+  size_t        tail_;  /* ring offset to write next record at   */
+  size_t        used_;  /* bytes between head_ and tail_          */
+  wsrep_uuid_t  uuid_;
+  wsrep_seqno_t last_;  /* highest seqno covered by the log       */
+  index_t       index_; /* seqno -> ring offset of the record     */
+};
+
+} /* namespace wsp */
+
+extern ulonglong wsrep_ws_log_size;
+
+void wsrep_ws_log_init();
+void wsrep_ws_log_deinit();
+void wsrep_ws_log_position(const wsrep_uuid_t& uuid, wsrep_seqno_t seqno);
+void wsrep_ws_log_append(const wsrep_trx_meta_t* meta, uint32 flags,
+                         const void* buf, size_t len);
+void wsrep_ws_log_local(THD* thd, st_io_cache* cache, uint32 flags);
+void wsrep_ws_log_stage(THD* thd, const void* buf, size_t len);
+void wsrep_ws_log_commit(THD* thd, uint32 flags, bool commit);
+void wsrep_ws_log_sync(const wsrep_uuid_t& uuid, wsrep_seqno_t seqno);
+bool wsrep_ws_log_covers(const wsrep_uuid_t& uuid,
+                         wsrep_seqno_t first, wsrep_seqno_t last);
+int  wsrep_ws_log_serve(wsrep_seqno_t first, wsrep_seqno_t last,
+                        wsp::ws_stream_write write, void* ctx);
+/* Applies write set stream from file in thd, see ws_stream_get() */
+int  wsrep_ws_log_replay(THD* thd, File file, const wsrep_uuid_t& uuid,
+                         wsrep_seqno_t first, wsrep_seqno_t* last);
+int  wsrep_show_ws_log_first(THD* thd, st_mysql_show_var* var, char* buff);
+int  wsrep_show_ws_log_last(THD* thd, st_mysql_show_var* var, char* buff);
+
+#endif /* WSREP_WS_LOG_H */
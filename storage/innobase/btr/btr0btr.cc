@@ -2012,7 +2012,7 @@ btr_page_reorganize(
 	dict_index_t*	index,	/*!< in: the index tree of the page */
 	mtr_t*		mtr)	/*!< in/out: mini-transaction */
 {
-	return(btr_page_reorganize_low(false, page_zip_level,
+	return(btr_page_reorganize_low(false, page_zip_get_level(),
 				       cursor, index, mtr));
 }
 #endif /* !UNIV_HOTBACKUP */
@@ -2046,10 +2046,10 @@ btr_parse_page_reorganize(
 
 		level = mach_read_from_1(ptr);
 
-		ut_a(level <= 9);
+		ut_a((level & PAGE_ZIP_LEVEL_MASK) <= 9);
 		++ptr;
 	} else {
-		level = page_zip_level;
+		level = page_zip_get_level();
 	}
 
 	if (block != NULL) {
@@ -5091,7 +5091,8 @@ btr_can_merge_with_page(
 		/* We have to reorganize mpage */
 
 		if (!btr_page_reorganize_block(
-			    false, page_zip_level, mblock, index, mtr)) {
+			    false, page_zip_get_level(), mblock, index,
+			    mtr)) {
 
 			goto error;
 		}
@@ -49,6 +49,66 @@ UNIV_INTERN buf_dblwr_t*	buf_dblwr = NULL;
 /** Set to TRUE when the doublewrite buffer is being created */
 UNIV_INTERN ibool	buf_dblwr_being_created = FALSE;
 
+/** Prefix of the names of the doublewrite files */
+#define BUF_DBLWR_FILE_PREFIX	"ib_dblwr_"
+
+/** @name Header page of a doublewrite file, followed by the pages of the
+batch last written to the file */
+/* @{ */
+#define BUF_DBLWR_FILE_MAGIC	0	/*!< BUF_DBLWR_FILE_MAGIC_N */
+#define BUF_DBLWR_FILE_ID	4	/*!< TRX_SYS_DOUBLEWRITE_FILES_ID of
+					the system tablespace */
+#define BUF_DBLWR_FILE_CHECKPOINT_LSN 12/*!< last checkpoint lsn when the
+					batch was written */
+#define BUF_DBLWR_FILE_N_PAGES	20	/*!< number of pages in the batch */
+#define BUF_DBLWR_FILE_CHECKSUM	24	/*!< buf_dblwr_file_checksum() */
+#define BUF_DBLWR_FILE_MAGIC_N	1146760023
+/* @} */
+
+/****************************************************************//**
+Gets the number of the batch partition that serves a buffer pool instance
+and flush type.
+@return	partition number */
+UNIV_INLINE
+ulint
+buf_dblwr_part_no(
+/*==============*/
+	ulint		instance_no,	/*!< in: buffer pool instance */
+	buf_flush_t	flush_type)	/*!< in: BUF_FLUSH_LRU or
+					BUF_FLUSH_LIST */
+{
+	ut_ad(flush_type == BUF_FLUSH_LRU || flush_type == BUF_FLUSH_LIST);
+
+	return(instance_no * 2 + (flush_type == BUF_FLUSH_LIST));
+}
+
+/****************************************************************//**
+Builds the path of the doublewrite file of a batch partition.
+@return	own: path, to be freed with mem_free() */
+static
+char*
+buf_dblwr_part_path(
+/*================*/
+	ulint	part_no)	/*!< in: partition number */
+{
+	ulint	dirnamelen = strlen(srv_data_home);
+	ulint	len = dirnamelen + sizeof BUF_DBLWR_FILE_PREFIX + 32;
+	char*	path = static_cast<char*>(mem_alloc(len));
+
+	memcpy(path, srv_data_home, dirnamelen);
+
+	/* Add a path separator if needed. */
+	if (dirnamelen && path[dirnamelen - 1] != SRV_PATH_SEPARATOR) {
+		path[dirnamelen++] = SRV_PATH_SEPARATOR;
+	}
+
+	ut_snprintf(path + dirnamelen, len - dirnamelen,
+		    BUF_DBLWR_FILE_PREFIX "%lu_%s",
+		    (ulong) (part_no / 2), (part_no & 1) ? "list" : "lru");
+
+	return(path);
+}
+
 /****************************************************************//**
 Determines if a page number is located inside the doublewrite buffer.
 @return TRUE if the location is inside the two blocks of the
@@ -156,6 +216,16 @@ buf_dblwr_init(
 	buf_dblwr->block2 = mach_read_from_4(
 		doublewrite + TRX_SYS_DOUBLEWRITE_BLOCK2);
 
+	buf_dblwr->files_id = mach_read_from_8(
+		doublewrite + TRX_SYS_DOUBLEWRITE_FILES_ID);
+
+	if (buf_dblwr->files_id == 0) {
+		/* The identity is written to the trx sys page by
+		buf_dblwr_reset_files(). Until then, the files are not
+		used in crash recovery. */
+		buf_dblwr->files_id = ut_time_us(NULL);
+	}
+
 	buf_dblwr->in_use = static_cast<bool*>(
 		mem_zalloc(buf_size * sizeof(bool)));
 
@@ -170,6 +240,307 @@ buf_dblwr_init(
 		mem_zalloc(buf_size * sizeof(void*)));
 }
 
+/****************************************************************//**
+Opens or creates the doublewrite files and sets up one batch partition
+per buffer pool instance and flush type. Does nothing if batches are to
+be doublewritten to the system tablespace. */
+static
+void
+buf_dblwr_init_parts(void)
+/*======================*/
+{
+	ut_ad(buf_dblwr->n_parts == 0);
+
+	if (!srv_use_doublewrite_buf
+	    || !srv_parallel_doublewrite
+	    || srv_read_only_mode) {
+
+		return;
+	}
+
+	const ulint	n_parts = srv_buf_pool_instances * 2;
+	const os_offset_t size
+		= (1 + srv_doublewrite_batch_size) * UNIV_PAGE_SIZE;
+
+	buf_dblwr->parts = static_cast<buf_dblwr_part_t*>(
+		mem_zalloc(n_parts * sizeof(buf_dblwr_part_t)));
+
+	for (ulint i = 0; i < n_parts; i++) {
+		buf_dblwr_part_t*	part = &buf_dblwr->parts[i];
+		ibool			exists;
+		ibool			success;
+		os_file_type_t		type;
+
+		part->path = buf_dblwr_part_path(i);
+
+		if (!os_file_status(part->path, &exists, &type)) {
+			exists = FALSE;
+		}
+
+		part->file = os_file_create(
+			innodb_file_data_key, part->path,
+			exists ? OS_FILE_OPEN : OS_FILE_CREATE,
+			OS_FILE_NORMAL, OS_DATA_FILE, &success);
+
+		if (success && os_file_get_size(part->file) < size) {
+			success = os_file_set_size(
+				part->path, part->file, size);
+		}
+
+		if (!success) {
+			ib_logf(IB_LOG_LEVEL_ERROR,
+				"Cannot create doublewrite file %s. "
+				"Cannot continue operation.", part->path);
+
+			exit(EXIT_FAILURE);
+		}
+
+		mutex_create(buf_dblwr_mutex_key,
+			     &part->mutex, SYNC_DOUBLEWRITE);
+
+		part->b_event = os_event_create();
+
+		/* The header page and the pages of a batch */
+		part->write_buf_unaligned = static_cast<byte*>(
+			ut_malloc((2 + srv_doublewrite_batch_size)
+				  * UNIV_PAGE_SIZE));
+
+		part->write_buf = static_cast<byte*>(
+			ut_align(part->write_buf_unaligned,
+				 UNIV_PAGE_SIZE));
+
+		part->buf_block_arr = static_cast<buf_page_t**>(
+			mem_zalloc(srv_doublewrite_batch_size
+				   * sizeof(void*)));
+	}
+
+	buf_dblwr->n_parts = n_parts;
+}
+
+/****************************************************************//**
+Calculates the checksum of the header page of a doublewrite file.
+@return	checksum */
+UNIV_INLINE
+ulint
+buf_dblwr_file_checksum(
+/*====================*/
+	const byte*	header)	/*!< in: header page */
+{
+	return(ut_fold_binary(header, BUF_DBLWR_FILE_CHECKSUM)
+	       & 0xFFFFFFFFUL);
+}
+
+/****************************************************************//**
+Reads the header page of a doublewrite file and checks that the file
+belongs to this system tablespace.
+@return	number of pages in the batch of the file, or 0 if the file is
+not to be used */
+static
+ulint
+buf_dblwr_read_file_header(
+/*=======================*/
+	pfs_os_file_t	file,		/*!< in: doublewrite file */
+	const char*	path,		/*!< in: path of the file */
+	os_offset_t	size,		/*!< in: size of the file */
+	byte*		header,		/*!< out: header page */
+	lsn_t*		checkpoint_lsn)	/*!< out: checkpoint lsn stamped
+					to the file */
+{
+	if (size == (os_offset_t) -1
+	    || size < UNIV_PAGE_SIZE
+	    || !os_file_read(file, header, 0, UNIV_PAGE_SIZE)
+	    || mach_read_from_4(header + BUF_DBLWR_FILE_MAGIC)
+	    != BUF_DBLWR_FILE_MAGIC_N) {
+
+		/* Never written, or written by a version without the
+		header */
+		return(0);
+	}
+
+	if (mach_read_from_4(header + BUF_DBLWR_FILE_CHECKSUM)
+	    != buf_dblwr_file_checksum(header)) {
+
+		/* The batch write was torn: the data file writes of the
+		batch had not been posted yet. */
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"Ignoring doublewrite file %s with a corrupted "
+			"header", path);
+		return(0);
+	}
+
+	if (mach_read_from_8(header + BUF_DBLWR_FILE_ID)
+	    != buf_dblwr->files_id) {
+
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"Ignoring doublewrite file %s which belongs to "
+			"another system tablespace", path);
+		return(0);
+	}
+
+	ulint	n_pages = mach_read_from_4(header + BUF_DBLWR_FILE_N_PAGES);
+
+	if (n_pages > ulint(size / UNIV_PAGE_SIZE) - 1) {
+
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"Ignoring doublewrite file %s of %lu pages which "
+			"claims to hold a batch of %lu pages",
+			path, (ulong) (size / UNIV_PAGE_SIZE),
+			(ulong) n_pages);
+		return(0);
+	}
+
+	*checkpoint_lsn = mach_read_from_8(
+		header + BUF_DBLWR_FILE_CHECKPOINT_LSN);
+
+	return(n_pages);
+}
+
+/****************************************************************//**
+Reads the pages in the doublewrite files left by any previous run into
+memory. The files are not necessarily those of the current configuration:
+the number of buffer pool instances may have changed since the files were
+written. buf_dblwr_process() hands the pages to crash recovery, once the
+checkpoint to recover from is known. */
+static
+void
+buf_dblwr_load_files(void)
+/*======================*/
+{
+	const ulint	n_files = MAX_BUFFER_POOLS * 2;
+	pfs_os_file_t*	files;
+	ulint*		n_pages;
+	lsn_t*		checkpoint_lsn;
+	ulint		n_total = 0;
+	byte*		unaligned_header;
+	byte*		header;
+	byte*		page;
+
+	files = static_cast<pfs_os_file_t*>(
+		mem_zalloc(n_files * sizeof *files));
+	n_pages = static_cast<ulint*>(mem_zalloc(n_files * sizeof *n_pages));
+	checkpoint_lsn = static_cast<lsn_t*>(
+		mem_zalloc(n_files * sizeof *checkpoint_lsn));
+
+	/* The files may be opened with O_DIRECT, which requires an
+	aligned buffer. */
+	unaligned_header = static_cast<byte*>(ut_malloc(2 * UNIV_PAGE_SIZE));
+	header = static_cast<byte*>(
+		ut_align(unaligned_header, UNIV_PAGE_SIZE));
+
+	for (ulint i = 0; i < n_files; i++) {
+		char*		path = buf_dblwr_part_path(i);
+		ibool		exists;
+		ibool		success;
+		os_file_type_t	type;
+
+		if (os_file_status(path, &exists, &type) && exists) {
+
+			files[i] = os_file_create_simple_no_error_handling(
+				innodb_file_data_key, path, OS_FILE_OPEN,
+				OS_FILE_READ_ONLY, &success);
+
+			if (success) {
+				n_pages[i] = buf_dblwr_read_file_header(
+					files[i], path,
+					os_file_get_size(files[i]), header,
+					&checkpoint_lsn[i]);
+
+				if (n_pages[i] == 0) {
+					os_file_close(files[i]);
+				}
+
+				n_total += n_pages[i];
+			} else {
+				ib_logf(IB_LOG_LEVEL_WARN,
+					"Cannot open doublewrite file %s",
+					path);
+			}
+		}
+
+		mem_free(path);
+	}
+
+	ut_free(unaligned_header);
+
+	if (n_total == 0) {
+		goto func_exit;
+	}
+
+	buf_dblwr->loaded_buf = static_cast<byte*>(
+		ut_malloc((1 + n_total) * UNIV_PAGE_SIZE));
+	buf_dblwr->loaded_checkpoint_lsn = static_cast<lsn_t*>(
+		mem_alloc(n_total * sizeof(lsn_t)));
+
+	page = static_cast<byte*>(
+		ut_align(buf_dblwr->loaded_buf, UNIV_PAGE_SIZE));
+
+	for (ulint i = 0; i < n_files; i++) {
+
+		if (n_pages[i] == 0) {
+			continue;
+		}
+
+		if (!os_file_read(files[i], page, UNIV_PAGE_SIZE,
+				  n_pages[i] * UNIV_PAGE_SIZE)) {
+			memset(page, 0, n_pages[i] * UNIV_PAGE_SIZE);
+		}
+
+		os_file_close(files[i]);
+
+		for (ulint j = 0; j < n_pages[i]; j++) {
+			buf_dblwr->loaded_checkpoint_lsn[buf_dblwr->n_loaded++]
+				= checkpoint_lsn[i];
+		}
+
+		page += n_pages[i] * UNIV_PAGE_SIZE;
+	}
+
+func_exit:
+	mem_free(checkpoint_lsn);
+	mem_free(n_pages);
+	mem_free(files);
+}
+
+/****************************************************************//**
+Hands the pages read from the doublewrite files to crash recovery. A file
+stamped with a checkpoint newer than the one recovery starts from was not
+written in the history of this redo log, for example if it was left over
+by the data directory that a state snapshot transfer replaced, and its
+pages are ignored. */
+static
+void
+buf_dblwr_add_loaded_pages(void)
+/*============================*/
+{
+	ulint	n_ignored = 0;
+	byte*	page;
+
+	if (buf_dblwr == NULL || buf_dblwr->n_loaded == 0) {
+		return;
+	}
+
+	page = static_cast<byte*>(
+		ut_align(buf_dblwr->loaded_buf, UNIV_PAGE_SIZE));
+
+	for (ulint i = 0; i < buf_dblwr->n_loaded; i++) {
+
+		if (buf_dblwr->loaded_checkpoint_lsn[i] > srv_start_lsn) {
+			n_ignored++;
+		} else {
+			recv_sys->dblwr.add(page);
+		}
+
+		page += UNIV_PAGE_SIZE;
+	}
+
+	if (n_ignored > 0) {
+		ib_logf(IB_LOG_LEVEL_WARN,
+			"Ignoring %lu pages of the doublewrite files which "
+			"were written after checkpoint " LSN_PF,
+			(ulong) n_ignored, srv_start_lsn);
+	}
+}
+
 /****************************************************************//**
 Creates the doublewrite buffer to a new InnoDB installation. The header of the
 doublewrite buffer is placed on the trx system header page. */
@@ -205,6 +576,7 @@ start_again:
 		just read in some numbers */
 
 		buf_dblwr_init(doublewrite);
+		buf_dblwr_init_parts();
 
 		mtr_commit(&mtr);
 		buf_dblwr_being_created = FALSE;
@@ -464,10 +836,145 @@ buf_dblwr_init_or_load_pages(
 		os_file_flush(file);
 	}
 
+	/* Only open the doublewrite files for writing after they have
+	been read: the read handles must be closed by then, which would
+	otherwise release the file locks of the write handles. */
+	if (load_corrupt_pages) {
+		buf_dblwr_load_files();
+	}
+
+	buf_dblwr_init_parts();
+
 leave_func:
 	ut_free(unaligned_read_buf);
 }
 
+/****************************************************************//**
+Frees the copies of pages that buf_dblwr_init_or_load_pages() read from
+the doublewrite files. */
+UNIV_INTERN
+void
+buf_dblwr_free_loaded_pages(void)
+/*=============================*/
+{
+	if (buf_dblwr != NULL && buf_dblwr->loaded_buf != NULL) {
+		ut_free(buf_dblwr->loaded_buf);
+		buf_dblwr->loaded_buf = NULL;
+		mem_free(buf_dblwr->loaded_checkpoint_lsn);
+		buf_dblwr->loaded_checkpoint_lsn = NULL;
+		buf_dblwr->n_loaded = 0;
+	}
+}
+
+/****************************************************************//**
+Cleans up the doublewrite files once crash recovery no longer needs them:
+removes the files that the current number of buffer pool instances does
+not use and marks the others empty. Stores the identity stamped to the
+files in the trx sys page if it was assigned at this startup. */
+UNIV_INTERN
+void
+buf_dblwr_reset_files(void)
+/*=======================*/
+{
+	if (buf_dblwr == NULL || srv_read_only_mode) {
+		return;
+	}
+
+	if (buf_dblwr->n_parts > 0) {
+		mtr_t	mtr;
+		byte*	doublewrite;
+		bool	changed = false;
+
+		mtr_start(&mtr);
+
+		doublewrite = buf_dblwr_get(&mtr);
+
+		if (mach_read_from_8(doublewrite + TRX_SYS_DOUBLEWRITE_FILES_ID)
+		    != buf_dblwr->files_id) {
+
+			mlog_write_ull(doublewrite
+				       + TRX_SYS_DOUBLEWRITE_FILES_ID,
+				       buf_dblwr->files_id, &mtr);
+			changed = true;
+		}
+
+		mtr_commit(&mtr);
+
+		if (changed) {
+			log_buffer_flush_to_disk();
+		}
+	}
+
+	for (ulint i = buf_dblwr->n_parts; i < MAX_BUFFER_POOLS * 2; i++) {
+		char*	path = buf_dblwr_part_path(i);
+
+		os_file_delete_if_exists(innodb_file_data_key, path);
+
+		mem_free(path);
+	}
+
+	for (ulint i = 0; i < buf_dblwr->n_parts; i++) {
+		buf_dblwr_part_t*	part = &buf_dblwr->parts[i];
+
+		mutex_enter(&part->mutex);
+
+		/* A batch that is being written stamps the header
+		itself. The header page is not used otherwise. */
+		if (!part->batch_running && part->first_free == 0) {
+			memset(part->write_buf, 0, UNIV_PAGE_SIZE);
+
+			if (os_file_write(part->path, part->file,
+					  part->write_buf, 0,
+					  UNIV_PAGE_SIZE)) {
+				os_file_flush(part->file);
+			}
+		}
+
+		mutex_exit(&part->mutex);
+	}
+}
+
+/****************************************************************//**
+Looks for the copy of a page to restore a corrupted data file page from.
+A page can have several copies in the doublewrite buffer, for example one
+written by an LRU batch and a later one written by a flush list batch. We
+pick the newest copy that is not itself corrupted.
+@return	the copy, or NULL if there is no usable copy */
+static
+byte*
+buf_dblwr_find_valid_copy(
+/*======================*/
+	ulint	space_id,	/*!< in: tablespace id */
+	ulint	page_no,	/*!< in: page number */
+	ulint	zip_size)	/*!< in: compressed page size, or 0 */
+{
+	recv_dblwr_t&	recv_dblwr = recv_sys->dblwr;
+	byte*		result = NULL;
+	lsn_t		max_lsn = 0;
+
+	for (std::list<byte*>::iterator i = recv_dblwr.pages.begin();
+	     i != recv_dblwr.pages.end(); ++i) {
+
+		byte*	page = *i;
+
+		if (mach_read_from_4(page + FIL_PAGE_OFFSET) != page_no
+		    || mach_read_from_4(page + FIL_PAGE_SPACE_ID) != space_id
+		    || buf_page_is_corrupted(true, page, zip_size)) {
+
+			continue;
+		}
+
+		lsn_t	lsn = mach_read_from_8(page + FIL_PAGE_LSN);
+
+		if (result == NULL || lsn > max_lsn) {
+			result = page;
+			max_lsn = lsn;
+		}
+	}
+
+	return(result);
+}
+
 /****************************************************************//**
 Process the double write buffer pages. */
 void
@@ -482,6 +989,8 @@ buf_dblwr_process()
 	byte*	unaligned_read_buf;
 	recv_dblwr_t& recv_dblwr = recv_sys->dblwr;
 
+	buf_dblwr_add_loaded_pages();
+
 	unaligned_read_buf = static_cast<byte*>(ut_malloc(2 * UNIV_PAGE_SIZE));
 
 	read_buf = static_cast<byte*>(
@@ -520,6 +1029,9 @@ buf_dblwr_process()
 
 			if (buf_page_is_corrupted(true, read_buf, zip_size)) {
 
+				byte*	copy = buf_dblwr_find_valid_copy(
+					space_id, page_no, zip_size);
+
 				fprintf(stderr,
 					"InnoDB: Warning: database page"
 					" corruption or a failed\n"
@@ -529,8 +1041,7 @@ buf_dblwr_process()
 					" the doublewrite buffer.\n",
 					(ulong) space_id, (ulong) page_no);
 
-				if (buf_page_is_corrupted(true,
-							  page, zip_size)) {
+				if (copy == NULL) {
 					fprintf(stderr,
 						"InnoDB: Dump of the page:\n");
 					buf_page_print(
@@ -566,7 +1077,7 @@ buf_dblwr_process()
 				fil_io(OS_FILE_WRITE, true, space_id,
 				       zip_size, page_no, 0,
 				       zip_size ? zip_size : UNIV_PAGE_SIZE,
-				       page, NULL);
+				       copy, NULL);
 
 				ib_logf(IB_LOG_LEVEL_INFO,
 					"Recovered the page from"
@@ -574,9 +1085,11 @@ buf_dblwr_process()
 
 			} else if (buf_page_is_zeroes(read_buf, zip_size)) {
 
-				if (!buf_page_is_zeroes(page, zip_size)
-				    && !buf_page_is_corrupted(true, page,
-							      zip_size)) {
+				byte*	copy = buf_dblwr_find_valid_copy(
+					space_id, page_no, zip_size);
+
+				if (copy != NULL
+				    && !buf_page_is_zeroes(copy, zip_size)) {
 
 					/* Database page contained only
 					zeroes, while a valid copy is
@@ -586,7 +1099,7 @@ buf_dblwr_process()
 					       zip_size, page_no, 0,
 					       zip_size ? zip_size
 							: UNIV_PAGE_SIZE,
-					       page, NULL);
+					       copy, NULL);
 				}
 			}
 		}
@@ -619,11 +1132,83 @@ buf_dblwr_free(void)
 	mem_free(buf_dblwr->in_use);
 	buf_dblwr->in_use = NULL;
 
+	for (ulint i = 0; i < buf_dblwr->n_parts; i++) {
+		buf_dblwr_part_t*	part = &buf_dblwr->parts[i];
+
+		ut_ad(part->b_reserved == 0);
+
+		os_file_close(part->file);
+		mem_free(part->path);
+		os_event_free(part->b_event);
+		ut_free(part->write_buf_unaligned);
+		mem_free(part->buf_block_arr);
+		mutex_free(&part->mutex);
+	}
+
+	if (buf_dblwr->parts != NULL) {
+		mem_free(buf_dblwr->parts);
+		buf_dblwr->parts = NULL;
+	}
+
+	buf_dblwr_free_loaded_pages();
+
 	mutex_free(&buf_dblwr->mutex);
 	mem_free(buf_dblwr);
 	buf_dblwr = NULL;
 }
 
+/********************************************************************//**
+Gets the batch partition of a buffer pool instance and flush type.
+@return	partition */
+UNIV_INLINE
+buf_dblwr_part_t*
+buf_dblwr_get_part(
+/*===============*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
+	buf_flush_t		flush_type)	/*!< in: BUF_FLUSH_LRU or
+						BUF_FLUSH_LIST */
+{
+	ulint	part_no = buf_dblwr_part_no(
+		buf_pool_index(buf_pool), flush_type);
+
+	ut_ad(part_no < buf_dblwr->n_parts);
+
+	return(&buf_dblwr->parts[part_no]);
+}
+
+/********************************************************************//**
+Updates a batch partition when the write of one of its pages to the data
+file has completed. */
+static
+void
+buf_dblwr_part_update(
+/*==================*/
+	buf_dblwr_part_t*	part)	/*!< in/out: batch partition */
+{
+	mutex_enter(&part->mutex);
+
+	ut_ad(part->batch_running);
+	ut_ad(part->b_reserved > 0);
+	ut_ad(part->b_reserved <= part->first_free);
+
+	part->b_reserved--;
+
+	if (part->b_reserved == 0) {
+		mutex_exit(&part->mutex);
+		/* This will finish the batch. Sync data files
+		to the disk. */
+		fil_flush_file_spaces(FIL_TABLESPACE);
+		mutex_enter(&part->mutex);
+
+		/* We can now reuse the partition: */
+		part->first_free = 0;
+		part->batch_running = false;
+		os_event_set(part->b_event);
+	}
+
+	mutex_exit(&part->mutex);
+}
+
 /********************************************************************//**
 Updates the doublewrite buffer when an IO request is completed. */
 UNIV_INTERN
@@ -640,6 +1225,14 @@ buf_dblwr_update(
 	switch (flush_type) {
 	case BUF_FLUSH_LIST:
 	case BUF_FLUSH_LRU:
+		if (buf_dblwr->n_parts > 0) {
+			buf_dblwr_part_update(
+				buf_dblwr_get_part(
+					buf_pool_from_bpage(bpage),
+					flush_type));
+			break;
+		}
+
 		mutex_enter(&buf_dblwr->mutex);
 
 		ut_ad(buf_dblwr->batch_running);
@@ -814,16 +1407,165 @@ buf_dblwr_write_block_to_datafile(
 
 }
 
+/********************************************************************//**
+Checks the pages of a batch before it is written to the doublewrite
+buffer on disk. */
+static
+void
+buf_dblwr_check_batch(
+/*==================*/
+	buf_page_t**	buf_block_arr,	/*!< in: blocks of the batch */
+	const byte*	write_buf,	/*!< in: copies of the blocks */
+	ulint		n)		/*!< in: number of blocks */
+{
+	for (ulint len2 = 0, i = 0; i < n; len2 += UNIV_PAGE_SIZE, i++) {
+
+		const buf_block_t*	block;
+
+		block = (buf_block_t*) buf_block_arr[i];
+
+		if (buf_block_get_state(block) != BUF_BLOCK_FILE_PAGE
+		    || block->page.zip.data) {
+			/* No simple validate for compressed
+			pages exists. */
+			continue;
+		}
+
+		/* Check that the actual page in the buffer pool is
+		not corrupt and the LSN values are sane. */
+		buf_dblwr_check_block(block);
+
+		/* Check that the page as written to the doublewrite
+		buffer has sane LSN values. */
+		buf_dblwr_check_page_lsn(write_buf + len2);
+	}
+}
+
+/********************************************************************//**
+Copies a page to a slot of a doublewrite write buffer. A compressed page
+is padded with zeroes. */
+static
+void
+buf_dblwr_copy_page(
+/*================*/
+	byte*			slot,	/*!< out: UNIV_PAGE_SIZE bytes */
+	const buf_page_t*	bpage)	/*!< in: page to copy */
+{
+	ulint	zip_size = buf_page_get_zip_size(bpage);
+
+	if (zip_size) {
+		UNIV_MEM_ASSERT_RW(bpage->zip.data, zip_size);
+		/* Copy the compressed page and clear the rest. */
+		memcpy(slot, bpage->zip.data, zip_size);
+		memset(slot + zip_size, 0, UNIV_PAGE_SIZE - zip_size);
+	} else {
+		ut_a(buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE);
+		UNIV_MEM_ASSERT_RW(((buf_block_t*) bpage)->frame,
+				   UNIV_PAGE_SIZE);
+
+		memcpy(slot, ((buf_block_t*) bpage)->frame, UNIV_PAGE_SIZE);
+	}
+}
+
+/********************************************************************//**
+Writes the batch of a partition to its doublewrite file with one write,
+syncs the file and then posts the writes to the data files. Partitions
+do not share any state, so the batches of different buffer pool
+instances are written and synced in parallel. */
+static
+void
+buf_dblwr_flush_part(
+/*=================*/
+	buf_dblwr_part_t*	part)	/*!< in/out: batch partition */
+{
+	ulint	first_free;
+
+try_again:
+	mutex_enter(&part->mutex);
+
+	if (part->first_free == 0) {
+
+		mutex_exit(&part->mutex);
+
+		return;
+	}
+
+	if (part->batch_running) {
+		/* Another thread is writing the batch of this
+		partition right now. Wait for it to finish. */
+		ib_int64_t	sig_count = os_event_reset(part->b_event);
+		mutex_exit(&part->mutex);
+
+		os_event_wait_low(part->b_event, sig_count);
+		goto try_again;
+	}
+
+	ut_ad(part->first_free == part->b_reserved);
+
+	/* Disallow anyone else to post to this partition or to start
+	another batch of writing it. */
+	part->batch_running = true;
+	first_free = part->first_free;
+
+	mutex_exit(&part->mutex);
+
+	buf_dblwr_check_batch(part->buf_block_arr,
+			      part->write_buf + UNIV_PAGE_SIZE, first_free);
+
+	/* Stamp the header, which is written together with the batch.
+	The checkpoint lsn is read without log_sys->mutex: a stale value
+	is older, which only makes recovery accept the file. */
+	byte*	header = part->write_buf;
+
+	memset(header, 0, UNIV_PAGE_SIZE);
+	mach_write_to_4(header + BUF_DBLWR_FILE_MAGIC, BUF_DBLWR_FILE_MAGIC_N);
+	mach_write_to_8(header + BUF_DBLWR_FILE_ID, buf_dblwr->files_id);
+	mach_write_to_8(header + BUF_DBLWR_FILE_CHECKPOINT_LSN,
+			log_sys->last_checkpoint_lsn);
+	mach_write_to_4(header + BUF_DBLWR_FILE_N_PAGES, first_free);
+	mach_write_to_4(header + BUF_DBLWR_FILE_CHECKSUM,
+			buf_dblwr_file_checksum(header));
+
+	if (!os_file_write(part->path, part->file, part->write_buf, 0,
+			   (1 + first_free) * UNIV_PAGE_SIZE)) {
+
+		ib_logf(IB_LOG_LEVEL_FATAL,
+			"Cannot write to doublewrite file %s", part->path);
+	}
+
+	srv_stats.dblwr_pages_written.add(first_free);
+	srv_stats.dblwr_writes.inc();
+
+	os_file_flush(part->file);
+
+	/* The batch is now durable in the doublewrite file. Next do
+	the writes to the intended positions. As in
+	buf_dblwr_flush_buffered_writes(), we must not look at
+	part->first_free any more, as the batch may complete and a
+	new one may be started before this loop terminates. */
+	for (ulint i = 0; i < first_free; i++) {
+		buf_dblwr_write_block_to_datafile(
+			part->buf_block_arr[i], false);
+	}
+
+	os_aio_simulated_wake_handler_threads();
+}
+
 /********************************************************************//**
 Flushes possible buffered writes from the doublewrite memory buffer to disk,
 and also wakes up the aio thread if simulated aio is used. It is very
 important to call this function after a batch of writes has been posted,
 and also when we may have to wait for a page latch! Otherwise a deadlock
-of threads can occur. */
+of threads can occur. When the doublewrite files are used, only the batch
+of the given buffer pool instance and flush type is written. */
 UNIV_INTERN
 void
-buf_dblwr_flush_buffered_writes(void)
-/*=================================*/
+buf_dblwr_flush_buffered_writes(
+/*============================*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance
+						whose batch to write */
+	buf_flush_t		flush_type)	/*!< in: BUF_FLUSH_LRU or
+						BUF_FLUSH_LIST */
 {
 	byte*		write_buf;
 	ulint		first_free;
@@ -835,6 +1577,11 @@ buf_dblwr_flush_buffered_writes(void)
 		return;
 	}
 
+	if (buf_dblwr->n_parts > 0) {
+		buf_dblwr_flush_part(buf_dblwr_get_part(buf_pool, flush_type));
+		return;
+	}
+
 try_again:
 	mutex_enter(&buf_dblwr->mutex);
 
@@ -875,29 +1622,8 @@ try_again:
 
 	write_buf = buf_dblwr->write_buf;
 
-	for (ulint len2 = 0, i = 0;
-	     i < buf_dblwr->first_free;
-	     len2 += UNIV_PAGE_SIZE, i++) {
-
-		const buf_block_t*	block;
-
-		block = (buf_block_t*) buf_dblwr->buf_block_arr[i];
-
-		if (buf_block_get_state(block) != BUF_BLOCK_FILE_PAGE
-		    || block->page.zip.data) {
-			/* No simple validate for compressed
-			pages exists. */
-			continue;
-		}
-
-		/* Check that the actual page in the buffer pool is
-		not corrupt and the LSN values are sane. */
-		buf_dblwr_check_block(block);
-
-		/* Check that the page as written to the doublewrite
-		buffer has sane LSN values. */
-		buf_dblwr_check_page_lsn(write_buf + len2);
-	}
+	buf_dblwr_check_batch(buf_dblwr->buf_block_arr, write_buf,
+			      first_free);
 
 	/* Write out the first block of the doublewrite buffer */
 	len = ut_min(TRX_SYS_DOUBLEWRITE_BLOCK_SIZE,
@@ -959,6 +1685,59 @@ flush:
 	os_aio_simulated_wake_handler_threads();
 }
 
+/********************************************************************//**
+Posts a buffer page to the batch of a partition. If the partition is
+full, writes its batch and waits for free space to appear. */
+static
+void
+buf_dblwr_part_add(
+/*===============*/
+	buf_dblwr_part_t*	part,	/*!< in/out: batch partition */
+	buf_page_t*		bpage)	/*!< in: buffer block to write */
+{
+try_again:
+	mutex_enter(&part->mutex);
+
+	ut_a(part->first_free <= srv_doublewrite_batch_size);
+
+	if (part->batch_running) {
+
+		ib_int64_t	sig_count = os_event_reset(part->b_event);
+		mutex_exit(&part->mutex);
+
+		os_event_wait_low(part->b_event, sig_count);
+		goto try_again;
+	}
+
+	if (part->first_free == srv_doublewrite_batch_size) {
+		mutex_exit(&part->mutex);
+
+		buf_dblwr_flush_part(part);
+
+		goto try_again;
+	}
+
+	buf_dblwr_copy_page(part->write_buf
+			    + UNIV_PAGE_SIZE * (1 + part->first_free), bpage);
+
+	part->buf_block_arr[part->first_free] = bpage;
+
+	part->first_free++;
+	part->b_reserved++;
+
+	ut_ad(part->first_free == part->b_reserved);
+
+	if (part->first_free == srv_doublewrite_batch_size) {
+		mutex_exit(&part->mutex);
+
+		buf_dblwr_flush_part(part);
+
+		return;
+	}
+
+	mutex_exit(&part->mutex);
+}
+
 /********************************************************************//**
 Posts a buffer page for writing. If the doublewrite memory buffer is
 full, calls buf_dblwr_flush_buffered_writes and waits for for free
@@ -969,10 +1748,17 @@ buf_dblwr_add_to_batch(
 /*====================*/
 	buf_page_t*	bpage)	/*!< in: buffer block to write */
 {
-	ulint	zip_size;
+	const buf_pool_t*	buf_pool = buf_pool_from_bpage(bpage);
+	const buf_flush_t	flush_type = buf_page_get_flush_type(bpage);
 
 	ut_a(buf_page_in_file(bpage));
 
+	if (buf_dblwr->n_parts > 0) {
+		buf_dblwr_part_add(
+			buf_dblwr_get_part(buf_pool, flush_type), bpage);
+		return;
+	}
+
 try_again:
 	mutex_enter(&buf_dblwr->mutex);
 
@@ -996,31 +1782,13 @@ try_again:
 	if (buf_dblwr->first_free == srv_doublewrite_batch_size) {
 		mutex_exit(&(buf_dblwr->mutex));
 
-		buf_dblwr_flush_buffered_writes();
+		buf_dblwr_flush_buffered_writes(buf_pool, flush_type);
 
 		goto try_again;
 	}
 
-	zip_size = buf_page_get_zip_size(bpage);
-
-	if (zip_size) {
-		UNIV_MEM_ASSERT_RW(bpage->zip.data, zip_size);
-		/* Copy the compressed page and clear the rest. */
-		memcpy(buf_dblwr->write_buf
-		       + UNIV_PAGE_SIZE * buf_dblwr->first_free,
-		       bpage->zip.data, zip_size);
-		memset(buf_dblwr->write_buf
-		       + UNIV_PAGE_SIZE * buf_dblwr->first_free
-		       + zip_size, 0, UNIV_PAGE_SIZE - zip_size);
-	} else {
-		ut_a(buf_page_get_state(bpage) == BUF_BLOCK_FILE_PAGE);
-		UNIV_MEM_ASSERT_RW(((buf_block_t*) bpage)->frame,
-				   UNIV_PAGE_SIZE);
-
-		memcpy(buf_dblwr->write_buf
-		       + UNIV_PAGE_SIZE * buf_dblwr->first_free,
-		       ((buf_block_t*) bpage)->frame, UNIV_PAGE_SIZE);
-	}
+	buf_dblwr_copy_page(buf_dblwr->write_buf
+			    + UNIV_PAGE_SIZE * buf_dblwr->first_free, bpage);
 
 	buf_dblwr->buf_block_arr[buf_dblwr->first_free] = bpage;
 
@@ -1034,7 +1802,7 @@ try_again:
 	if (buf_dblwr->first_free == srv_doublewrite_batch_size) {
 		mutex_exit(&(buf_dblwr->mutex));
 
-		buf_dblwr_flush_buffered_writes();
+		buf_dblwr_flush_buffered_writes(buf_pool, flush_type);
 
 		return;
 	}
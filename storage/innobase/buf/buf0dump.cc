@@ -30,8 +30,10 @@ Created April 08, 2011 Vasil Dimov
 
 #include "buf0buf.h" /* buf_pool_mutex_enter(), srv_buf_pool_instances */
 #include "buf0dump.h"
+#include "buf0rea.h" /* buf_read_load_pages() */
 #include "db0err.h"
 #include "dict0dict.h" /* dict_operation_lock */
+#include "mach0data.h" /* mach_write_compressed() */
 #include "os0file.h" /* OS_FILE_MAX_PATH */
 #include "os0sync.h" /* os_event* */
 #include "os0thread.h" /* os_thread_* */
@@ -39,6 +41,7 @@ Created April 08, 2011 Vasil Dimov
 #include "srv0start.h" /* srv_shutdown_state */
 #include "sync0rw.h" /* rw_lock_s_lock() */
 #include "ut0byte.h" /* ut_ull_create() */
+#include "ut0crc32.h" /* ut_crc32() */
 #include "ut0sort.h" /* UT_SORT_FUNCTION_BODY */
 #ifdef WITH_WSREP
 extern my_bool wsrep_recovery;
@@ -189,21 +192,572 @@ get_buf_dump_dir()
 	return(dump_dir);
 }
 
+/*****************************************************************//**
+Compare two buffer pool dump entries, used to sort the dump on
+space_no,page_no before loading in order to increase the chance for
+sequential IO.
+@return -1/0/1 if entry 1 is smaller/equal/bigger than entry 2 */
+static
+lint
+buf_dump_cmp(
+/*=========*/
+	const buf_dump_t	d1,	/*!< in: buffer pool dump entry 1 */
+	const buf_dump_t	d2)	/*!< in: buffer pool dump entry 2 */
+{
+	if (d1 < d2) {
+		return(-1);
+	} else if (d1 == d2) {
+		return(0);
+	} else {
+		return(1);
+	}
+}
+
+/*****************************************************************//**
+Sort a buffer pool dump on space_no, page_no. */
+static
+void
+buf_dump_sort(
+/*==========*/
+	buf_dump_t*	dump,	/*!< in/out: buffer pool dump to sort */
+	buf_dump_t*	tmp,	/*!< in/out: temp storage */
+	ulint		low,	/*!< in: lowest index (inclusive) */
+	ulint		high)	/*!< in: highest index (non-inclusive) */
+{
+	UT_SORT_FUNCTION_BODY(buf_dump_sort, dump, tmp, low, high,
+			      buf_dump_cmp);
+}
+
+#define SHOULD_QUIT()	(SHUTTING_DOWN() && obey_shutdown)
+
+/** Magic string at the start of a buffer pool dump in the binary format.
+A dump in the text format starts with a digit instead. */
+#define BUF_DUMP_MAGIC		"IBBPDUMP"
+#define BUF_DUMP_MAGIC_LEN	8
+
+/* A binary dump consists of BUF_DUMP_MAGIC followed by a full record,
+which may in turn be followed by incremental records appended by the
+periodic dumps. Each record is stored as:
+type (1 byte), payload length (4 bytes), payload,
+CRC-32 of the type, length and payload (4 bytes).
+A truncated or corrupted record at the end of the file is ignored. */
+#define BUF_DUMP_REC_FULL	'F'	/*!< full record */
+#define BUF_DUMP_REC_INCR	'I'	/*!< incremental record */
+#define BUF_DUMP_REC_HDR_SIZE	5	/*!< size of type and length */
+#define BUF_DUMP_REC_CRC_SIZE	4	/*!< size of the checksum */
+
+/** Maximum size of a list of n entries in a binary record: the number of
+entries and the delta encoded entries */
+#define BUF_DUMP_LIST_MAX_SIZE(n)	(5 + 11 * (n))
+
+/** The lists stored in a binary record. A full record stores the pages
+in the young and in the old sublist of the LRU, sorted on space_no,page_no.
+An incremental record stores for each sublist the pages removed from it
+and the pages added to it since the previous record. */
+enum buf_dump_list_t {
+	BUF_DUMP_YOUNG = 0,	/*!< the young sublist of the LRU */
+	BUF_DUMP_OLD,		/*!< the old sublist of the LRU */
+	BUF_DUMP_N_LISTS
+};
+
+/** Snapshot of the LRU lists of all the buffer pool instances */
+struct buf_dump_snap_t {
+	buf_dump_t*	mem;		/*!< memory holding the lists */
+	buf_dump_t*	list[BUF_DUMP_N_LISTS];
+					/*!< sorted lists of pages */
+	ulint		n[BUF_DUMP_N_LISTS];
+					/*!< number of pages in list[] */
+};
+
+/** State of the last binary dump, kept by the buffer pool dump/load thread
+in order to append incremental records to the dump file */
+struct buf_dump_last_t {
+	buf_dump_snap_t	snap;		/*!< LRU lists as of the last record,
+					snap.mem == NULL if there is none */
+	char		filename[OS_FILE_MAX_PATH];
+					/*!< the file the records were
+					written to */
+	long		file_size;	/*!< size of the file after the
+					last record */
+	ulint		full_size;	/*!< size of the full record */
+	ulint		incr_size;	/*!< total size of the incremental
+					records after the full record */
+};
+
+static buf_dump_last_t	buf_dump_last;
+
+/*****************************************************************//**
+Frees the lists of a buffer pool snapshot. */
+static
+void
+buf_dump_snap_free(
+/*===============*/
+	buf_dump_snap_t*	snap)	/*!< in/out: snapshot */
+{
+	ut_free(snap->mem);
+	memset(snap, 0, sizeof(*snap));
+}
+
+/*****************************************************************//**
+Forgets the last binary dump, so that the next periodic dump writes
+a full record. */
+static
+void
+buf_dump_forget()
+/*=============*/
+{
+	buf_dump_snap_free(&buf_dump_last.snap);
+	buf_dump_last.filename[0] = '\0';
+}
+
+/*****************************************************************//**
+Takes a snapshot of the LRU lists of all the buffer pool instances and
+sorts each of its lists on space_no,page_no.
+@return true on success, false if out of memory */
+static
+bool
+buf_dump_snap_take(
+/*===============*/
+	buf_dump_snap_t*	snap)	/*!< out: snapshot */
+{
+	buf_dump_t*	tmp;
+	ulint		capacity = 0;
+	ulint		n_young = 0;
+	ulint		n_old = 0;
+	ulint		i;
+
+	memset(snap, 0, sizeof(*snap));
+
+	/* The lengths are read without holding the buffer pool mutexes.
+	Leave some slack for the LRU lists to grow meanwhile; any pages that
+	do not fit are left out of the dump. */
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		capacity += UT_LIST_GET_LEN(buf_pool_from_array(i)->LRU);
+	}
+
+	capacity += capacity / 8 + 1;
+
+	snap->mem = static_cast<buf_dump_t*>(
+		ut_malloc(capacity * sizeof(*snap->mem)));
+
+	if (snap->mem == NULL) {
+		return(false);
+	}
+
+	/* Fill the young pages from the start and the old pages from the
+	end of the array. */
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*		buf_pool = buf_pool_from_array(i);
+		const buf_page_t*	bpage;
+
+		buf_pool_mutex_enter(buf_pool);
+
+		for (bpage = UT_LIST_GET_FIRST(buf_pool->LRU);
+		     bpage != NULL && n_young + n_old < capacity;
+		     bpage = UT_LIST_GET_NEXT(LRU, bpage)) {
+
+			buf_dump_t	id;
+
+			ut_a(buf_page_in_file(bpage));
+
+			id = BUF_DUMP_CREATE(buf_page_get_space(bpage),
+					     buf_page_get_page_no(bpage));
+
+			if (buf_page_is_old(bpage)) {
+				snap->mem[capacity - ++n_old] = id;
+			} else {
+				snap->mem[n_young++] = id;
+			}
+		}
+
+		buf_pool_mutex_exit(buf_pool);
+	}
+
+	snap->list[BUF_DUMP_YOUNG] = snap->mem;
+	snap->n[BUF_DUMP_YOUNG] = n_young;
+	snap->list[BUF_DUMP_OLD] = snap->mem + capacity - n_old;
+	snap->n[BUF_DUMP_OLD] = n_old;
+
+	tmp = static_cast<buf_dump_t*>(
+		ut_malloc((ut_max(n_young, n_old) + 1) * sizeof(*tmp)));
+
+	if (tmp == NULL) {
+		buf_dump_snap_free(snap);
+		return(false);
+	}
+
+	for (i = 0; i < BUF_DUMP_N_LISTS; i++) {
+		if (snap->n[i] > 1) {
+			buf_dump_sort(snap->list[i], tmp, 0, snap->n[i]);
+		}
+	}
+
+	ut_free(tmp);
+
+	return(true);
+}
+
+/*****************************************************************//**
+Writes a sorted list of pages in a binary record. The pages are delta
+encoded, so that a page that follows another page of the same tablespace
+usually takes one or two bytes.
+@return end of the written list */
+static
+byte*
+buf_dump_write_list(
+/*================*/
+	byte*			ptr,	/*!< out: where to write */
+	const buf_dump_t*	list,	/*!< in: sorted list of pages */
+	ulint			n)	/*!< in: number of pages in list */
+{
+	buf_dump_t	prev = 0;
+
+	ptr += mach_write_compressed(ptr, n);
+
+	for (ulint i = 0; i < n; i++) {
+		ptr += mach_ull_write_much_compressed(ptr, list[i] - prev);
+		prev = list[i];
+	}
+
+	return(ptr);
+}
+
+/*****************************************************************//**
+Writes the pages that are in the sorted list a but not in the sorted
+list b in a binary record, in the same format as buf_dump_write_list().
+@return end of the written list */
+static
+byte*
+buf_dump_write_diff(
+/*================*/
+	byte*			ptr,	/*!< out: where to write */
+	const buf_dump_t*	a,	/*!< in: sorted list of pages */
+	ulint			n_a,	/*!< in: number of pages in a */
+	const buf_dump_t*	b,	/*!< in: sorted list of pages */
+	ulint			n_b)	/*!< in: number of pages in b */
+{
+	buf_dump_t	prev = 0;
+	ulint		n = 0;
+	ulint		i;
+	ulint		j;
+
+	/* First count the pages, for the length of the list */
+	for (i = 0, j = 0; i < n_a; i++) {
+		while (j < n_b && b[j] < a[i]) {
+			j++;
+		}
+
+		if (j == n_b || b[j] != a[i]) {
+			n++;
+		}
+	}
+
+	ptr += mach_write_compressed(ptr, n);
+
+	for (i = 0, j = 0; i < n_a; i++) {
+		while (j < n_b && b[j] < a[i]) {
+			j++;
+		}
+
+		if (j == n_b || b[j] != a[i]) {
+			ptr += mach_ull_write_much_compressed(
+				ptr, a[i] - prev);
+			prev = a[i];
+		}
+	}
+
+	return(ptr);
+}
+
+/*****************************************************************//**
+Fills in the header and the checksum of a binary record.
+@return total size of the record */
+static
+ulint
+buf_dump_close_rec(
+/*===============*/
+	byte*		rec,	/*!< in/out: record */
+	byte		type,	/*!< in: BUF_DUMP_REC_FULL or
+				BUF_DUMP_REC_INCR */
+	byte*		end)	/*!< in: end of the payload */
+{
+	ulint	len = end - rec;
+
+	mach_write_to_1(rec, type);
+	mach_write_to_4(rec + 1, len - BUF_DUMP_REC_HDR_SIZE);
+	mach_write_to_4(end, ut_crc32(rec, len));
+
+	return(len + BUF_DUMP_REC_CRC_SIZE);
+}
+
+/*****************************************************************//**
+Replaces the buffer pool dump file with a newly written one.
+@return true on success */
+static
+bool
+buf_dump_install(
+/*=============*/
+	const char*	tmp_filename,	/*!< in: the new dump */
+	const char*	full_filename)	/*!< in: the dump file */
+{
+	int	ret;
+
+	ret = unlink(full_filename);
+	if (ret != 0 && errno != ENOENT) {
+		buf_dump_status(STATUS_ERR,
+				"Cannot delete '%s': %s",
+				full_filename, strerror(errno));
+		/* leave tmp_filename to exist */
+		return(false);
+	}
+	/* else */
+
+	ret = rename(tmp_filename, full_filename);
+	if (ret != 0) {
+		buf_dump_status(STATUS_ERR,
+				"Cannot rename '%s' to '%s': %s",
+				tmp_filename, full_filename,
+				strerror(errno));
+		/* leave tmp_filename to exist */
+		return(false);
+	}
+
+	return(true);
+}
+
+/*****************************************************************//**
+Appends an incremental record with the changes of the LRU lists since
+the last binary dump to the dump file.
+@return true on success, false if a full dump must be written instead */
+static
+bool
+buf_dump_binary_incr(
+/*=================*/
+	const char*		full_filename,	/*!< in: the dump file */
+	const buf_dump_snap_t*	snap)		/*!< in: current LRU lists */
+{
+	const buf_dump_snap_t*	last = &buf_dump_last.snap;
+	byte*			rec;
+	byte*			ptr;
+	ulint			size;
+	ulint			i;
+	FILE*			f;
+	bool			success;
+
+	if (last->mem == NULL
+	    || strcmp(buf_dump_last.filename, full_filename) != 0) {
+		return(false);
+	}
+
+	size = BUF_DUMP_REC_HDR_SIZE + BUF_DUMP_REC_CRC_SIZE;
+
+	for (i = 0; i < BUF_DUMP_N_LISTS; i++) {
+		size += 2 * BUF_DUMP_LIST_MAX_SIZE(0)
+			+ BUF_DUMP_LIST_MAX_SIZE(last->n[i] + snap->n[i]);
+	}
+
+	rec = static_cast<byte*>(ut_malloc(size));
+
+	if (rec == NULL) {
+		return(false);
+	}
+
+	ptr = rec + BUF_DUMP_REC_HDR_SIZE;
+
+	for (i = 0; i < BUF_DUMP_N_LISTS; i++) {
+		/* The pages removed from the list */
+		ptr = buf_dump_write_diff(ptr, last->list[i], last->n[i],
+					  snap->list[i], snap->n[i]);
+		/* The pages added to the list */
+		ptr = buf_dump_write_diff(ptr, snap->list[i], snap->n[i],
+					  last->list[i], last->n[i]);
+	}
+
+	size = buf_dump_close_rec(rec, BUF_DUMP_REC_INCR, ptr);
+
+	/* Once the incremental records outweigh the full record, loading
+	the dump gets more expensive than rewriting it. */
+	if (buf_dump_last.incr_size + size > buf_dump_last.full_size) {
+		ut_free(rec);
+		return(false);
+	}
+
+	f = fopen(full_filename, "ab");
+
+	if (f == NULL) {
+		ut_free(rec);
+		return(false);
+	}
+
+	/* Check that nobody else has modified the file since the last
+	record was written. */
+	success = fseek(f, 0, SEEK_END) == 0
+		&& ftell(f) == buf_dump_last.file_size
+		&& fwrite(rec, 1, size, f) == size;
+
+	if (fclose(f) != 0) {
+		success = false;
+	}
+
+	ut_free(rec);
+
+	if (!success) {
+		/* A full dump will rewrite the file, including any
+		partially written record. */
+		return(false);
+	}
+
+	buf_dump_last.file_size += size;
+	buf_dump_last.incr_size += size;
+
+	return(true);
+}
+
+/*****************************************************************//**
+Perform a buffer pool dump in the binary format into the file specified by
+innodb_buffer_pool_filename. A periodic dump appends the changes since the
+previous binary dump to the file, unless a full dump is cheaper to load. */
+static
+void
+buf_dump_binary(
+/*============*/
+	const char*	full_filename,	/*!< in: the dump file */
+	ibool		obey_shutdown,	/*!< in: quit if we are in a shutting
+					down state */
+	bool		periodic)	/*!< in: true if this is a periodic
+					dump */
+{
+	char		tmp_filename[OS_FILE_MAX_PATH];
+	char		now[32];
+	buf_dump_snap_t	snap;
+	byte*		rec;
+	byte*		ptr;
+	ulint		size;
+	FILE*		f;
+	bool		success;
+
+	if (!buf_dump_snap_take(&snap)) {
+		buf_dump_status(STATUS_ERR,
+				"Cannot allocate memory for the dump: %s",
+				strerror(errno));
+		return;
+	}
+
+	if (SHOULD_QUIT()) {
+		buf_dump_snap_free(&snap);
+		return;
+	}
+
+	if (periodic && buf_dump_binary_incr(full_filename, &snap)) {
+		buf_dump_snap_free(&buf_dump_last.snap);
+		buf_dump_last.snap = snap;
+
+		ut_sprintf_timestamp(now);
+
+		buf_dump_status(STATUS_INFO,
+				"Buffer pool(s) incremental dump completed"
+				" at %s", now);
+		return;
+	}
+
+	buf_dump_forget();
+
+	ut_snprintf(tmp_filename, sizeof(tmp_filename),
+		    "%s.incomplete", full_filename);
+
+	size = BUF_DUMP_REC_HDR_SIZE + BUF_DUMP_REC_CRC_SIZE
+		+ BUF_DUMP_LIST_MAX_SIZE(snap.n[BUF_DUMP_YOUNG])
+		+ BUF_DUMP_LIST_MAX_SIZE(snap.n[BUF_DUMP_OLD]);
+
+	rec = static_cast<byte*>(ut_malloc(size));
+
+	if (rec == NULL) {
+		buf_dump_snap_free(&snap);
+		buf_dump_status(STATUS_ERR,
+				"Cannot allocate " ULINTPF " bytes: %s",
+				size, strerror(errno));
+		return;
+	}
+
+	ptr = rec + BUF_DUMP_REC_HDR_SIZE;
+
+	for (ulint i = 0; i < BUF_DUMP_N_LISTS; i++) {
+		ptr = buf_dump_write_list(ptr, snap.list[i], snap.n[i]);
+	}
+
+	size = buf_dump_close_rec(rec, BUF_DUMP_REC_FULL, ptr);
+
+	f = fopen(tmp_filename, "wb");
+	if (f == NULL) {
+		ut_free(rec);
+		buf_dump_snap_free(&snap);
+		buf_dump_status(STATUS_ERR,
+				"Cannot open '%s' for writing: %s",
+				tmp_filename, strerror(errno));
+		return;
+	}
+
+	success = fwrite(BUF_DUMP_MAGIC, 1, BUF_DUMP_MAGIC_LEN, f)
+		== BUF_DUMP_MAGIC_LEN
+		&& fwrite(rec, 1, size, f) == size;
+
+	ut_free(rec);
+
+	if (!success) {
+		fclose(f);
+		buf_dump_snap_free(&snap);
+		buf_dump_status(STATUS_ERR,
+				"Cannot write to '%s': %s",
+				tmp_filename, strerror(errno));
+		/* leave tmp_filename to exist */
+		return;
+	}
+
+	if (fclose(f) != 0) {
+		buf_dump_snap_free(&snap);
+		buf_dump_status(STATUS_ERR,
+				"Cannot close '%s': %s",
+				tmp_filename, strerror(errno));
+		return;
+	}
+
+	if (!buf_dump_install(tmp_filename, full_filename)) {
+		buf_dump_snap_free(&snap);
+		return;
+	}
+
+	/* success */
+
+	buf_dump_last.snap = snap;
+	ut_strlcpy(buf_dump_last.filename, full_filename,
+		   sizeof(buf_dump_last.filename));
+	buf_dump_last.file_size = BUF_DUMP_MAGIC_LEN + size;
+	buf_dump_last.full_size = size;
+	buf_dump_last.incr_size = 0;
+
+	ut_sprintf_timestamp(now);
+
+	buf_dump_status(periodic ? STATUS_INFO : STATUS_NOTICE,
+			"Buffer pool(s) dump completed at %s", now);
+}
+
 /*****************************************************************//**
 Perform a buffer pool dump into the file specified by
 innodb_buffer_pool_filename. If any errors occur then the value of
 innodb_buffer_pool_dump_status will be set accordingly, see buf_dump_status().
 The dump filename can be specified by (relative to srv_data_home):
-SET GLOBAL innodb_buffer_pool_filename='filename'; */
+SET GLOBAL innodb_buffer_pool_filename='filename';
+The dump is written in the binary format if innodb_buffer_pool_dump_binary
+is set, see buf_dump_binary(). */
 static
 void
 buf_dump(
 /*=====*/
-	ibool	obey_shutdown)	/*!< in: quit if we are in a shutting down
+	ibool	obey_shutdown,	/*!< in: quit if we are in a shutting down
 				state */
+	bool	periodic)	/*!< in: true if this is a periodic dump,
+				triggered by innodb_buffer_pool_dump_interval */
 {
-#define SHOULD_QUIT()	(SHUTTING_DOWN() && obey_shutdown)
-
 	char	full_filename[OS_FILE_MAX_PATH];
 	char	tmp_filename[OS_FILE_MAX_PATH];
 	char	now[32];
@@ -215,12 +769,20 @@ buf_dump(
 		    "%s%c%s", get_buf_dump_dir(), SRV_PATH_SEPARATOR,
 		    srv_buf_dump_filename);
 
+	buf_dump_status(periodic ? STATUS_INFO : STATUS_NOTICE,
+			"Dumping buffer pool(s) to %s", full_filename);
+
+	if (srv_buffer_pool_dump_binary) {
+		buf_dump_binary(full_filename, obey_shutdown, periodic);
+		return;
+	}
+
+	/* A text dump replaces any binary dump */
+	buf_dump_forget();
+
 	ut_snprintf(tmp_filename, sizeof(tmp_filename),
 		    "%s.incomplete", full_filename);
 
-	buf_dump_status(STATUS_NOTICE, "Dumping buffer pool(s) to %s",
-			full_filename);
-
 	f = fopen(tmp_filename, "w");
 	if (f == NULL) {
 		buf_dump_status(STATUS_ERR,
@@ -252,150 +814,399 @@ buf_dump(
 			continue;
 		}
 
-		dump = static_cast<buf_dump_t*>(
-			ut_malloc(n_pages * sizeof(*dump))) ;
+		dump = static_cast<buf_dump_t*>(
+			ut_malloc(n_pages * sizeof(*dump))) ;
+
+		if (dump == NULL) {
+			buf_pool_mutex_exit(buf_pool);
+			fclose(f);
+			buf_dump_status(STATUS_ERR,
+					"Cannot allocate " ULINTPF " bytes: %s",
+					(ulint) (n_pages * sizeof(*dump)),
+					strerror(errno));
+			/* leave tmp_filename to exist */
+			return;
+		}
+
+		for (bpage = UT_LIST_GET_LAST(buf_pool->LRU), j = 0;
+		     bpage != NULL;
+		     bpage = UT_LIST_GET_PREV(LRU, bpage), j++) {
+
+			ut_a(buf_page_in_file(bpage));
+
+			dump[j] = BUF_DUMP_CREATE(buf_page_get_space(bpage),
+						  buf_page_get_page_no(bpage));
+		}
+
+		ut_a(j == n_pages);
+
+		buf_pool_mutex_exit(buf_pool);
+
+		for (j = 0; j < n_pages && !SHOULD_QUIT(); j++) {
+			ret = fprintf(f, ULINTPF "," ULINTPF "\n",
+				      BUF_DUMP_SPACE(dump[j]),
+				      BUF_DUMP_PAGE(dump[j]));
+			if (ret < 0) {
+				ut_free(dump);
+				fclose(f);
+				buf_dump_status(STATUS_ERR,
+						"Cannot write to '%s': %s",
+						tmp_filename, strerror(errno));
+				/* leave tmp_filename to exist */
+				return;
+			}
+
+			if (j % 128 == 0) {
+				buf_dump_status(
+					STATUS_INFO,
+					"Dumping buffer pool "
+					ULINTPF "/" ULINTPF ", "
+					"page " ULINTPF "/" ULINTPF,
+					i + 1, srv_buf_pool_instances,
+					j + 1, n_pages);
+			}
+		}
+
+		ut_free(dump);
+	}
+
+	ret = fclose(f);
+	if (ret != 0) {
+		buf_dump_status(STATUS_ERR,
+				"Cannot close '%s': %s",
+				tmp_filename, strerror(errno));
+		return;
+	}
+	/* else */
+
+	if (!buf_dump_install(tmp_filename, full_filename)) {
+		return;
+	}
+	/* else */
+
+	/* success */
+
+	ut_sprintf_timestamp(now);
+
+	buf_dump_status(periodic ? STATUS_INFO : STATUS_NOTICE,
+			"Buffer pool(s) dump completed at %s", now);
+}
+
+/*****************************************************************//**
+Reads a list of pages written by buf_dump_write_list() or
+buf_dump_write_diff() from a binary record.
+@return end of the list, or NULL if the list is corrupted */
+static
+const byte*
+buf_load_read_list(
+/*===============*/
+	const byte*	ptr,	/*!< in: start of the list */
+	const byte*	end,	/*!< in: end of the payload */
+	buf_dump_t**	list,	/*!< out: sorted list of pages, to be
+				freed with ut_free() */
+	ulint*		n)	/*!< out: number of pages in list */
+{
+	buf_dump_t	prev = 0;
+	ulint		i;
+
+	*list = NULL;
+
+	ptr = mach_parse_compressed(const_cast<byte*>(ptr),
+				    const_cast<byte*>(end), n);
+
+	/* Every entry takes at least one byte */
+	if (ptr == NULL || *n > static_cast<ulint>(end - ptr)) {
+		return(NULL);
+	}
+
+	*list = static_cast<buf_dump_t*>(
+		ut_malloc((*n + 1) * sizeof(**list)));
+
+	if (*list == NULL) {
+		return(NULL);
+	}
+
+	for (i = 0; i < *n; i++) {
+		ulint	high = 0;
+		ulint	low;
+
+		/* See mach_ull_write_much_compressed() */
+		if (ptr < end && *ptr == 0xFF) {
+			ptr = mach_parse_compressed(
+				const_cast<byte*>(ptr) + 1,
+				const_cast<byte*>(end), &high);
+		}
+
+		if (ptr != NULL) {
+			ptr = mach_parse_compressed(
+				const_cast<byte*>(ptr),
+				const_cast<byte*>(end), &low);
+		}
+
+		/* The list must be strictly increasing */
+		if (ptr == NULL || (i > 0 && high == 0 && low == 0)) {
+			ut_free(*list);
+			*list = NULL;
+			return(NULL);
+		}
+
+		prev += ut_ull_create(high, low);
+		(*list)[i] = prev;
+	}
+
+	return(ptr);
+}
+
+/*****************************************************************//**
+Applies an incremental record to a sorted list of pages: removes the
+pages in del and adds the pages in add.
+@return true on success, false if out of memory */
+static
+bool
+buf_load_apply_diff(
+/*================*/
+	buf_dump_t**		list,	/*!< in/out: sorted list of pages */
+	ulint*			n,	/*!< in/out: number of pages in list */
+	const buf_dump_t*	del,	/*!< in: sorted pages to remove */
+	ulint			n_del,	/*!< in: number of pages in del */
+	const buf_dump_t*	add,	/*!< in: sorted pages to add */
+	ulint			n_add)	/*!< in: number of pages in add */
+{
+	buf_dump_t*	res;
+	ulint		n_res = 0;
+	ulint		i = 0;
+	ulint		j = 0;
+	ulint		k = 0;
+
+	res = static_cast<buf_dump_t*>(
+		ut_malloc((*n + n_add + 1) * sizeof(*res)));
+
+	if (res == NULL) {
+		return(false);
+	}
+
+	/* Merge (list \ del) with add */
+	while (i < *n || k < n_add) {
+		if (k == n_add || (i < *n && (*list)[i] < add[k])) {
+			while (j < n_del && del[j] < (*list)[i]) {
+				j++;
+			}
+
+			if (j == n_del || del[j] != (*list)[i]) {
+				res[n_res++] = (*list)[i];
+			}
+
+			i++;
+		} else {
+			if (i < *n && (*list)[i] == add[k]) {
+				i++;
+			}
+
+			res[n_res++] = add[k++];
+		}
+	}
+
+	ut_free(*list);
+	*list = res;
+	*n = n_res;
+
+	return(true);
+}
+
+/*****************************************************************//**
+Reads a buffer pool dump in the binary format. Replays the incremental
+records on top of the full record and returns the pages of the young
+sublist of the LRU, followed by the pages of the old sublist.
+@return true on success; on failure the load status is set */
+static
+bool
+buf_load_binary(
+/*============*/
+	FILE*		f,		/*!< in: the dump file, positioned
+					after BUF_DUMP_MAGIC */
+	const char*	full_filename,	/*!< in: name of the dump file */
+	buf_dump_t**	dump,		/*!< out: pages to load, to be freed
+					with ut_free() */
+	ulint*		dump_n)		/*!< out: number of pages in dump */
+{
+	buf_dump_t*	lists[BUF_DUMP_N_LISTS] = { NULL, NULL };
+	ulint		n[BUF_DUMP_N_LISTS] = { 0, 0 };
+	byte*		buf;
+	const byte*	ptr;
+	const byte*	end;
+	long		size;
+	ulint		i;
+	bool		success = true;
+	bool		is_first = true;
+	const char*	what = "parsing";
+
+	if (fseek(f, 0, SEEK_END) != 0
+	    || (size = ftell(f)) < BUF_DUMP_MAGIC_LEN
+	    || fseek(f, BUF_DUMP_MAGIC_LEN, SEEK_SET) != 0) {
+
+		buf_load_status(STATUS_ERR, "Error reading '%s', "
+				"unable to load buffer pool",
+				full_filename);
+		return(false);
+	}
+
+	size -= BUF_DUMP_MAGIC_LEN;
+
+	buf = static_cast<byte*>(ut_malloc(size + 1));
+
+	if (buf == NULL) {
+		buf_load_status(STATUS_ERR,
+				"Cannot allocate " ULINTPF " bytes: %s",
+				(ulint) size, strerror(errno));
+		return(false);
+	}
+
+	if (fread(buf, 1, size, f) != static_cast<size_t>(size)) {
+		ut_free(buf);
+		buf_load_status(STATUS_ERR, "Error reading '%s', "
+				"unable to load buffer pool",
+				full_filename);
+		return(false);
+	}
+
+	ptr = buf;
+	end = buf + size;
 
-		if (dump == NULL) {
-			buf_pool_mutex_exit(buf_pool);
-			fclose(f);
-			buf_dump_status(STATUS_ERR,
-					"Cannot allocate " ULINTPF " bytes: %s",
-					(ulint) (n_pages * sizeof(*dump)),
-					strerror(errno));
-			/* leave tmp_filename to exist */
-			return;
+	while (success && !SHUTTING_DOWN()) {
+		const byte*	payload;
+		const byte*	payload_end;
+		ulint		len;
+		byte		type;
+
+		if (end - ptr < BUF_DUMP_REC_HDR_SIZE
+		    + BUF_DUMP_REC_CRC_SIZE) {
+			/* Truncated record */
+			success = !is_first;
+			break;
 		}
 
-		for (bpage = UT_LIST_GET_LAST(buf_pool->LRU), j = 0;
-		     bpage != NULL;
-		     bpage = UT_LIST_GET_PREV(LRU, bpage), j++) {
+		type = mach_read_from_1(ptr);
+		len = mach_read_from_4(ptr + 1);
 
-			ut_a(buf_page_in_file(bpage));
+		if (len > static_cast<ulint>(end - ptr)
+		    - BUF_DUMP_REC_HDR_SIZE - BUF_DUMP_REC_CRC_SIZE
+		    || ut_crc32(ptr, BUF_DUMP_REC_HDR_SIZE + len)
+		    != mach_read_from_4(ptr + BUF_DUMP_REC_HDR_SIZE + len)) {
 
-			dump[j] = BUF_DUMP_CREATE(buf_page_get_space(bpage),
-						  buf_page_get_page_no(bpage));
+			/* A periodic dump was interrupted while appending
+			this record: ignore it. The full record must be
+			intact, though. */
+			success = !is_first;
+			break;
 		}
 
-		ut_a(j == n_pages);
+		payload = ptr + BUF_DUMP_REC_HDR_SIZE;
+		payload_end = payload + len;
 
-		buf_pool_mutex_exit(buf_pool);
+		if (is_first != (type == BUF_DUMP_REC_FULL)) {
+			success = false;
+			break;
+		}
 
-		for (j = 0; j < n_pages && !SHOULD_QUIT(); j++) {
-			ret = fprintf(f, ULINTPF "," ULINTPF "\n",
-				      BUF_DUMP_SPACE(dump[j]),
-				      BUF_DUMP_PAGE(dump[j]));
-			if (ret < 0) {
-				ut_free(dump);
-				fclose(f);
-				buf_dump_status(STATUS_ERR,
-						"Cannot write to '%s': %s",
-						tmp_filename, strerror(errno));
-				/* leave tmp_filename to exist */
-				return;
+		if (type == BUF_DUMP_REC_FULL) {
+			for (i = 0; i < BUF_DUMP_N_LISTS && success; i++) {
+				payload = buf_load_read_list(
+					payload, payload_end,
+					&lists[i], &n[i]);
+				success = payload != NULL;
 			}
-
-			if (j % 128 == 0) {
-				buf_dump_status(
-					STATUS_INFO,
-					"Dumping buffer pool "
-					ULINTPF "/" ULINTPF ", "
-					"page " ULINTPF "/" ULINTPF,
-					i + 1, srv_buf_pool_instances,
-					j + 1, n_pages);
+		} else if (type == BUF_DUMP_REC_INCR) {
+			for (i = 0; i < BUF_DUMP_N_LISTS && success; i++) {
+				buf_dump_t*	del = NULL;
+				buf_dump_t*	add = NULL;
+				ulint		n_del;
+				ulint		n_add;
+
+				payload = buf_load_read_list(
+					payload, payload_end, &del, &n_del);
+
+				if (payload != NULL) {
+					payload = buf_load_read_list(
+						payload, payload_end,
+						&add, &n_add);
+				}
+
+				success = payload != NULL
+					&& buf_load_apply_diff(
+						&lists[i], &n[i],
+						del, n_del, add, n_add);
+
+				ut_free(del);
+				ut_free(add);
 			}
+		} else {
+			success = false;
 		}
 
-		ut_free(dump);
-	}
+		if (success && payload != payload_end) {
+			success = false;
+		}
 
-	ret = fclose(f);
-	if (ret != 0) {
-		buf_dump_status(STATUS_ERR,
-				"Cannot close '%s': %s",
-				tmp_filename, strerror(errno));
-		return;
+		ptr += BUF_DUMP_REC_HDR_SIZE + len + BUF_DUMP_REC_CRC_SIZE;
+		is_first = false;
 	}
-	/* else */
 
-	ret = unlink(full_filename);
-	if (ret != 0 && errno != ENOENT) {
-		buf_dump_status(STATUS_ERR,
-				"Cannot delete '%s': %s",
-				full_filename, strerror(errno));
-		/* leave tmp_filename to exist */
-		return;
+	ut_free(buf);
+
+	if (is_first) {
+		/* The file had no full record */
+		success = false;
 	}
-	/* else */
 
-	ret = rename(tmp_filename, full_filename);
-	if (ret != 0) {
-		buf_dump_status(STATUS_ERR,
-				"Cannot rename '%s' to '%s': %s",
-				tmp_filename, full_filename,
-				strerror(errno));
-		/* leave tmp_filename to exist */
-		return;
+	*dump = NULL;
+
+	if (success) {
+		*dump = static_cast<buf_dump_t*>(
+			ut_malloc((n[BUF_DUMP_YOUNG] + n[BUF_DUMP_OLD] + 1)
+				  * sizeof(**dump)));
+
+		if (*dump == NULL) {
+			what = "allocating memory for";
+			success = false;
+		}
 	}
-	/* else */
 
-	/* success */
+	if (success) {
+		*dump_n = n[BUF_DUMP_YOUNG] + n[BUF_DUMP_OLD];
 
-	ut_sprintf_timestamp(now);
+		memcpy(*dump, lists[BUF_DUMP_YOUNG],
+		       n[BUF_DUMP_YOUNG] * sizeof(**dump));
+		memcpy(*dump + n[BUF_DUMP_YOUNG], lists[BUF_DUMP_OLD],
+		       n[BUF_DUMP_OLD] * sizeof(**dump));
+	}
 
-	buf_dump_status(STATUS_NOTICE,
-			"Buffer pool(s) dump completed at %s", now);
-}
+	for (i = 0; i < BUF_DUMP_N_LISTS; i++) {
+		ut_free(lists[i]);
+	}
 
-/*****************************************************************//**
-Compare two buffer pool dump entries, used to sort the dump on
-space_no,page_no before loading in order to increase the chance for
-sequential IO.
-@return -1/0/1 if entry 1 is smaller/equal/bigger than entry 2 */
-static
-lint
-buf_dump_cmp(
-/*=========*/
-	const buf_dump_t	d1,	/*!< in: buffer pool dump entry 1 */
-	const buf_dump_t	d2)	/*!< in: buffer pool dump entry 2 */
-{
-	if (d1 < d2) {
-		return(-1);
-	} else if (d1 == d2) {
-		return(0);
-	} else {
-		return(1);
+	if (!success) {
+		buf_load_status(STATUS_ERR, "Error %s '%s', "
+				"unable to load buffer pool",
+				what, full_filename);
 	}
-}
 
-/*****************************************************************//**
-Sort a buffer pool dump on space_no, page_no. */
-static
-void
-buf_dump_sort(
-/*==========*/
-	buf_dump_t*	dump,	/*!< in/out: buffer pool dump to sort */
-	buf_dump_t*	tmp,	/*!< in/out: temp storage */
-	ulint		low,	/*!< in: lowest index (inclusive) */
-	ulint		high)	/*!< in: highest index (non-inclusive) */
-{
-	UT_SORT_FUNCTION_BODY(buf_dump_sort, dump, tmp, low, high,
-			      buf_dump_cmp);
+	return(success);
 }
 
 /*****************************************************************//**
-Perform a buffer pool load from the file specified by
-innodb_buffer_pool_filename. If any errors occur then the value of
-innodb_buffer_pool_load_status will be set accordingly, see buf_load_status().
-The dump filename can be specified by (relative to srv_data_home):
-SET GLOBAL innodb_buffer_pool_filename='filename'; */
+Reads a buffer pool dump in the text format, one space_no,page_no pair
+per line, and sorts it on space_no,page_no.
+@return true on success; on failure the load status is set */
 static
-void
-buf_load()
-/*======*/
+bool
+buf_load_text(
+/*==========*/
+	FILE*		f,		/*!< in: the dump file */
+	const char*	full_filename,	/*!< in: name of the dump file */
+	buf_dump_t**	dump_out,	/*!< out: pages to load, to be freed
+					with ut_free() */
+	ulint*		dump_n_out)	/*!< out: number of pages in dump */
 {
-	char		full_filename[OS_FILE_MAX_PATH];
-	char		now[32];
-	FILE*		f;
 	buf_dump_t*	dump;
 	buf_dump_t*	dump_tmp;
 	ulint		dump_n;
@@ -405,25 +1216,6 @@ buf_load()
 	ulint		page_no;
 	int		fscanf_ret;
 
-	/* Ignore any leftovers from before */
-	buf_load_abort_flag = FALSE;
-
-	ut_snprintf(full_filename, sizeof(full_filename),
-		    "%s%c%s", get_buf_dump_dir(), SRV_PATH_SEPARATOR,
-		    srv_buf_dump_filename);
-
-	buf_load_status(STATUS_NOTICE,
-			"Loading buffer pool(s) from %s", full_filename);
-
-	f = fopen(full_filename, "r");
-	if (f == NULL) {
-		buf_load_status(STATUS_ERR,
-				"Cannot open '%s' for reading: %s",
-				full_filename, strerror(errno));
-		return;
-	}
-	/* else */
-
 	/* First scan the file to estimate how many entries are in it.
 	This file is tiny (approx 500KB per 1GB buffer pool), reading it
 	two times is fine. */
@@ -441,11 +1233,10 @@ buf_load()
 		} else {
 			what = "parsing";
 		}
-		fclose(f);
 		buf_load_status(STATUS_ERR, "Error %s '%s', "
 				"unable to load buffer pool (stage 1)",
 				what, full_filename);
-		return;
+		return(false);
 	}
 
 	/* If dump is larger than the buffer pool(s), then we ignore the
@@ -460,12 +1251,11 @@ buf_load()
 	dump = static_cast<buf_dump_t*>(ut_malloc(dump_n * sizeof(*dump)));
 
 	if (dump == NULL) {
-		fclose(f);
 		buf_load_status(STATUS_ERR,
 				"Cannot allocate " ULINTPF " bytes: %s",
 				(ulint) (dump_n * sizeof(*dump)),
 				strerror(errno));
-		return;
+		return(false);
 	}
 
 	dump_tmp = static_cast<buf_dump_t*>(
@@ -473,12 +1263,11 @@ buf_load()
 
 	if (dump_tmp == NULL) {
 		ut_free(dump);
-		fclose(f);
 		buf_load_status(STATUS_ERR,
 				"Cannot allocate " ULINTPF " bytes: %s",
 				(ulint) (dump_n * sizeof(*dump_tmp)),
 				strerror(errno));
-		return;
+		return(false);
 	}
 
 	rewind(f);
@@ -495,18 +1284,16 @@ buf_load()
 
 			ut_free(dump);
 			ut_free(dump_tmp);
-			fclose(f);
 			buf_load_status(STATUS_ERR,
 					"Error parsing '%s', unable "
 					"to load buffer pool (stage 2)",
 					full_filename);
-			return;
+			return(false);
 		}
 
 		if (space_id > ULINT32_MASK || page_no > ULINT32_MASK) {
 			ut_free(dump);
 			ut_free(dump_tmp);
-			fclose(f);
 			buf_load_status(STATUS_ERR,
 					"Error parsing '%s': bogus "
 					"space,page " ULINTPF "," ULINTPF
@@ -515,7 +1302,7 @@ buf_load()
 					full_filename,
 					space_id, page_no,
 					i);
-			return;
+			return(false);
 		}
 
 		dump[i] = BUF_DUMP_CREATE(space_id, page_no);
@@ -526,50 +1313,157 @@ buf_load()
 	we read it the first time. */
 	dump_n = i;
 
-	fclose(f);
-
-	if (dump_n == 0) {
-		ut_free(dump);
-		ut_sprintf_timestamp(now);
-		buf_load_status(STATUS_NOTICE,
-				"Buffer pool(s) load completed at %s "
-				"(%s was empty)", now, full_filename);
-		return;
-	}
-
-	if (!SHUTTING_DOWN()) {
+	if (dump_n > 0 && !SHUTTING_DOWN()) {
 		buf_dump_sort(dump, dump_tmp, 0, dump_n);
 	}
 
 	ut_free(dump_tmp);
 
-	for (i = 0; i < dump_n && !SHUTTING_DOWN(); i++) {
+	*dump_out = dump;
+	*dump_n_out = dump_n;
 
-		buf_read_page_async(BUF_DUMP_SPACE(dump[i]),
-				    BUF_DUMP_PAGE(dump[i]));
+	return(true);
+}
 
-		if (i % 64 == 63) {
-			os_aio_simulated_wake_handler_threads();
-		}
+/** Maximum number of pages of a tablespace that a buffer pool load
+submits to the i/o handler threads at a time */
+#define BUF_LOAD_BATCH	64
 
-		if (i % 128 == 0) {
-			buf_load_status(STATUS_INFO,
-					"Loaded " ULINTPF "/" ULINTPF " pages",
-					i + 1, dump_n);
-		}
+/*****************************************************************//**
+Reads the pages of a buffer pool dump into the buffer pool, in batches of
+asynchronous reads of pages of the same tablespace. The reads of a batch
+are served in parallel by the i/o handler threads.
+@return false if the load was aborted */
+static
+bool
+buf_load_pages(
+/*===========*/
+	const buf_dump_t*	dump,	/*!< in: pages to load, sorted on
+					space_no,page_no within each group */
+	ulint			dump_n)	/*!< in: number of pages in dump */
+{
+	ulint	page_nos[BUF_LOAD_BATCH];
+	ulint	i = 0;
+
+	while (i < dump_n && !SHUTTING_DOWN()) {
+		ulint	space = BUF_DUMP_SPACE(dump[i]);
+		ulint	n = 0;
+
+		do {
+			page_nos[n++] = BUF_DUMP_PAGE(dump[i++]);
+		} while (i < dump_n && n < BUF_LOAD_BATCH
+			 && BUF_DUMP_SPACE(dump[i]) == space);
+
+		buf_read_load_pages(space, page_nos, n);
+
+		buf_load_status(STATUS_INFO,
+				"Loaded " ULINTPF "/" ULINTPF " pages",
+				i, dump_n);
 
 		if (buf_load_abort_flag) {
-			buf_load_abort_flag = FALSE;
-			ut_free(dump);
-			buf_load_status(
-				STATUS_NOTICE,
-				"Buffer pool(s) load aborted on request");
-			return;
+			return(false);
 		}
 	}
 
+	/* Wait for the reads to complete, so that the pages are in the
+	buffer pool when the load is reported as completed. Give up after
+	a while, in case a concurrent workload keeps reads pending. */
+	for (ulint count = 0;
+	     count < 1000 && buf_get_n_pending_read_ios() > 0
+	     && !SHUTTING_DOWN() && !buf_load_abort_flag;
+	     count++) {
+		os_thread_sleep(10000);
+	}
+
+	return(!buf_load_abort_flag);
+}
+
+/*****************************************************************//**
+Perform a buffer pool load from the file specified by
+innodb_buffer_pool_filename. If any errors occur then the value of
+innodb_buffer_pool_load_status will be set accordingly, see buf_load_status().
+The dump filename can be specified by (relative to srv_data_home):
+SET GLOBAL innodb_buffer_pool_filename='filename';
+Both the text and the binary dump formats are accepted. The pages that
+were in the young sublist of the LRU at the time of a binary dump are read
+first. */
+static
+void
+buf_load()
+/*======*/
+{
+	char		full_filename[OS_FILE_MAX_PATH];
+	char		magic[BUF_DUMP_MAGIC_LEN];
+	char		now[32];
+	FILE*		f;
+	buf_dump_t*	dump;
+	ulint		dump_n;
+	ulint		total_buffer_pools_pages;
+	bool		success;
+
+	/* Ignore any leftovers from before */
+	buf_load_abort_flag = FALSE;
+
+	ut_snprintf(full_filename, sizeof(full_filename),
+		    "%s%c%s", get_buf_dump_dir(), SRV_PATH_SEPARATOR,
+		    srv_buf_dump_filename);
+
+	buf_load_status(STATUS_NOTICE,
+			"Loading buffer pool(s) from %s", full_filename);
+
+	f = fopen(full_filename, "rb");
+	if (f == NULL) {
+		buf_load_status(STATUS_ERR,
+				"Cannot open '%s' for reading: %s",
+				full_filename, strerror(errno));
+		return;
+	}
+	/* else */
+
+	if (fread(magic, 1, sizeof(magic), f) == sizeof(magic)
+	    && memcmp(magic, BUF_DUMP_MAGIC, sizeof(magic)) == 0) {
+		success = buf_load_binary(f, full_filename,
+					  &dump, &dump_n);
+	} else {
+		rewind(f);
+		success = buf_load_text(f, full_filename, &dump, &dump_n);
+	}
+
+	fclose(f);
+
+	if (!success) {
+		return;
+	}
+
+	/* If dump is larger than the buffer pool(s), then we ignore the
+	extra trailing, that is, the old pages. */
+	total_buffer_pools_pages = buf_pool_get_n_pages()
+		* srv_buf_pool_instances;
+	if (dump_n > total_buffer_pools_pages) {
+		dump_n = total_buffer_pools_pages;
+	}
+
+	if (dump_n == 0) {
+		ut_free(dump);
+		ut_sprintf_timestamp(now);
+		buf_load_status(STATUS_NOTICE,
+				"Buffer pool(s) load completed at %s "
+				"(%s was empty)", now, full_filename);
+		return;
+	}
+
+	success = buf_load_pages(dump, dump_n);
+
 	ut_free(dump);
 
+	if (!success) {
+		buf_load_abort_flag = FALSE;
+		buf_load_status(
+			STATUS_NOTICE,
+			"Buffer pool(s) load aborted on request");
+		return;
+	}
+
 	ut_sprintf_timestamp(now);
 
 	buf_load_status(STATUS_NOTICE,
@@ -600,6 +1494,8 @@ DECLARE_THREAD(buf_dump_thread)(
 	void*	arg MY_ATTRIBUTE((unused)))	/*!< in: a dummy parameter
 						required by os_thread_create */
 {
+	ib_time_t	next_dump = 0;	/*!< time of the next periodic dump */
+
 	my_thread_init();
 	ut_ad(!srv_read_only_mode);
 
@@ -620,11 +1516,35 @@ DECLARE_THREAD(buf_dump_thread)(
 
 	while (!SHUTTING_DOWN()) {
 
-		os_event_wait(srv_buf_dump_event);
+		if (srv_buffer_pool_dump_interval == 0) {
+			next_dump = 0;
+
+			os_event_wait(srv_buf_dump_event);
+		} else {
+			ib_time_t	interval = srv_buffer_pool_dump_interval;
+			ib_time_t	now = ut_time();
+
+			/* The interval may have been shortened meanwhile */
+			if (next_dump == 0 || next_dump > now + interval) {
+				next_dump = now + interval;
+			}
+
+			if (now < next_dump) {
+				os_event_wait_time(
+					srv_buf_dump_event,
+					(next_dump - now) * 1000000);
+			}
+
+			if (ut_time() >= next_dump && !SHUTTING_DOWN()) {
+				buf_dump(TRUE /* quit on shutdown */,
+					 true /* periodic */);
+				next_dump = ut_time() + interval;
+			}
+		}
 
 		if (buf_dump_should_start) {
 			buf_dump_should_start = FALSE;
-			buf_dump(TRUE /* quit on shutdown */);
+			buf_dump(TRUE /* quit on shutdown */, false);
 		}
 
 		if (buf_load_should_start) {
@@ -640,12 +1560,14 @@ DECLARE_THREAD(buf_dump_thread)(
 		if (!wsrep_recovery) {
 #endif /* WITH_WSREP */
 		buf_dump(FALSE /* ignore shutdown down flag,
-		keep going even if we are in a shutdown state */);
+		keep going even if we are in a shutdown state */, false);
 #ifdef WITH_WSREP
 		}
 #endif /* WITH_WSREP */
 	}
 
+	buf_dump_forget();
+
 	srv_buf_dump_thread_active = FALSE;
 
 	my_thread_end();
@@ -65,8 +65,87 @@ reduce the wait time for the threads waiting for a clean block */
 
 #ifdef UNIV_PFS_THREAD
 UNIV_INTERN mysql_pfs_key_t buf_page_cleaner_thread_key;
+UNIV_INTERN mysql_pfs_key_t buf_page_cleaner_worker_thread_key;
 #endif /* UNIV_PFS_THREAD */
 
+#ifdef UNIV_PFS_MUTEX
+UNIV_INTERN mysql_pfs_key_t page_cleaner_mutex_key;
+#endif /* UNIV_PFS_MUTEX */
+
+/** State of a buffer pool instance in a page cleaner round */
+enum page_cleaner_state_t {
+	PAGE_CLEANER_STATE_NONE = 0,	/*!< not requested to be flushed */
+	PAGE_CLEANER_STATE_REQUESTED,	/*!< waiting for a page cleaner
+					thread */
+	PAGE_CLEANER_STATE_FLUSHING,	/*!< being flushed by a page
+					cleaner thread */
+	PAGE_CLEANER_STATE_FINISHED	/*!< flushed in this round */
+};
+
+/** The request and the result of flushing one buffer pool instance in
+a page cleaner round. The slot of a buffer pool instance has the same
+index as the instance in buf_pool_ptr. */
+struct page_cleaner_slot_t {
+	page_cleaner_state_t	state;	/*!< protected by
+					page_cleaner_t::mutex */
+	ulint			n_pages_requested;
+					/*!< number of pages to flush from
+					the flush list of the instance */
+	ulint			n_flushed;
+					/*!< number of pages flushed in the
+					round */
+	ullint			flush_time;
+					/*!< microseconds spent in flushing
+					the instance in the round */
+	bool			by_worker;
+					/*!< true if a worker thread, not
+					the coordinator, flushed the
+					instance */
+};
+
+/** The page cleaner threads: buf_flush_page_cleaner_thread coordinates
+the flushing and requests rounds in which all the buffer pool instances
+are flushed, and innodb_page_cleaners - 1 buf_flush_page_cleaner_worker
+threads flush the instances in parallel with the coordinator. */
+struct page_cleaner_t {
+	ib_mutex_t		mutex;	/*!< protects the fields below
+					and the slot states */
+	os_event_t		is_requested;
+					/*!< set while there are
+					instances waiting to be
+					flushed in the round */
+	os_event_t		is_finished;
+					/*!< set when all the instances
+					have been flushed in the round */
+	ulint			n_workers;
+					/*!< number of running worker
+					threads */
+	bool			is_running;
+					/*!< false when the worker
+					threads must exit */
+	bool			flush_LRU;
+					/*!< true if the round flushes the
+					LRU list tails, false if it
+					flushes the flush lists */
+	lsn_t			lsn_limit;
+					/*!< the flush lists are flushed up
+					to this lsn in the round */
+	ulint			n_slots;
+					/*!< number of slots, that is,
+					srv_buf_pool_instances */
+	ulint			n_slots_requested;
+					/*!< number of slots in
+					PAGE_CLEANER_STATE_REQUESTED */
+	ulint			n_slots_finished;
+					/*!< number of slots in
+					PAGE_CLEANER_STATE_FINISHED */
+	page_cleaner_slot_t*	slots;	/*!< the slots of the buffer pool
+					instances */
+};
+
+/** The page cleaner threads, NULL when they have not been started */
+static page_cleaner_t*	page_cleaner = NULL;
+
 /** If LRU list of a buf_pool is less than this size then LRU eviction
 should not happen. This is because when we do LRU flushing we also put
 the blocks on free list. If LRU list is very small then we can end up
@@ -1057,7 +1136,8 @@ buf_flush_page(
 			/* avoiding deadlock possibility involves doublewrite
 			buffer, should flush it, because it might hold the
 			another block->lock. */
-			buf_dblwr_flush_buffered_writes();
+			buf_dblwr_flush_buffered_writes(
+				buf_pool, BUF_FLUSH_LIST);
 
 			rw_lock_s_lock_gen(rw_lock, BUF_IO_WRITE);
                 }
@@ -1723,10 +1803,11 @@ static
 void
 buf_flush_common(
 /*=============*/
+	buf_pool_t*	buf_pool,	/*!< in: buffer pool instance */
 	buf_flush_t	flush_type,	/*!< in: type of flush */
 	ulint		page_count)	/*!< in: number of pages flushed */
 {
-	buf_dblwr_flush_buffered_writes();
+	buf_dblwr_flush_buffered_writes(buf_pool, flush_type);
 
 	ut_a(flush_type == BUF_FLUSH_LRU || flush_type == BUF_FLUSH_LIST);
 
@@ -1861,7 +1942,7 @@ buf_flush_LRU(
 
 	buf_flush_end(buf_pool, BUF_FLUSH_LRU);
 
-	buf_flush_common(BUF_FLUSH_LRU, page_count);
+	buf_flush_common(buf_pool, BUF_FLUSH_LRU, page_count);
 
 	if (n_processed) {
 		*n_processed = page_count;
@@ -1870,6 +1951,55 @@ buf_flush_LRU(
 	return(true);
 }
 
+/*******************************************************************//**
+This utility flushes dirty blocks from the end of the flush list of a
+buffer pool instance.
+NOTE: The calling thread is not allowed to own any latches on pages!
+@return true if a batch was queued successfully, false if another batch
+of the same type was already running in the instance */
+static
+bool
+buf_flush_list_instance(
+/*====================*/
+	buf_pool_t*	buf_pool,	/*!< in/out: buffer pool instance */
+	ulint		min_n,		/*!< in: wished minimum mumber of blocks
+					flushed (it is not guaranteed that the
+					actual number is that big, though) */
+	lsn_t		lsn_limit,	/*!< in: all blocks whose
+					oldest_modification is smaller than
+					this should be flushed (if their number
+					does not exceed min_n) */
+	ulint*		n_processed)	/*!< out: the number of pages
+					which were processed */
+{
+	ulint	page_count;
+
+	*n_processed = 0;
+
+	if (!buf_flush_start(buf_pool, BUF_FLUSH_LIST)) {
+		return(false);
+	}
+
+	page_count = buf_flush_batch(
+		buf_pool, BUF_FLUSH_LIST, min_n, lsn_limit);
+
+	buf_flush_end(buf_pool, BUF_FLUSH_LIST);
+
+	buf_flush_common(buf_pool, BUF_FLUSH_LIST, page_count);
+
+	*n_processed = page_count;
+
+	if (page_count) {
+		MONITOR_INC_VALUE_CUMULATIVE(
+			MONITOR_FLUSH_BATCH_TOTAL_PAGE,
+			MONITOR_FLUSH_BATCH_COUNT,
+			MONITOR_FLUSH_BATCH_PAGES,
+			page_count);
+	}
+
+	return(true);
+}
+
 /*******************************************************************//**
 This utility flushes dirty blocks from the end of the flush list of
 all buffer pool instances.
@@ -1912,12 +2042,10 @@ buf_flush_list(
 
 	/* Flush to lsn_limit in all buffer pool instances */
 	for (i = 0; i < srv_buf_pool_instances; i++) {
-		buf_pool_t*	buf_pool;
 		ulint		page_count = 0;
 
-		buf_pool = buf_pool_from_array(i);
-
-		if (!buf_flush_start(buf_pool, BUF_FLUSH_LIST)) {
+		if (!buf_flush_list_instance(buf_pool_from_array(i),
+					     min_n, lsn_limit, &page_count)) {
 			/* We have two choices here. If lsn_limit was
 			specified then skipping an instance of buffer
 			pool means we cannot guarantee that all pages
@@ -1933,24 +2061,9 @@ buf_flush_list(
 			continue;
 		}
 
-		page_count = buf_flush_batch(
-			buf_pool, BUF_FLUSH_LIST, min_n, lsn_limit);
-
-		buf_flush_end(buf_pool, BUF_FLUSH_LIST);
-
-		buf_flush_common(BUF_FLUSH_LIST, page_count);
-
 		if (n_processed) {
 			*n_processed += page_count;
 		}
-
-		if (page_count) {
-			MONITOR_INC_VALUE_CUMULATIVE(
-				MONITOR_FLUSH_BATCH_TOTAL_PAGE,
-				MONITOR_FLUSH_BATCH_COUNT,
-				MONITOR_FLUSH_BATCH_PAGES,
-				page_count);
-		}
 	}
 
 	return(success);
@@ -2053,6 +2166,64 @@ buf_flush_single_page_from_LRU(
 	return(freed);
 }
 
+/*********************************************************************//**
+Clears up tail of the LRU list of a buffer pool instance:
+* Put replaceable pages at the tail of LRU to the free list
+* Flush dirty pages at the tail of LRU to the disk
+The depth to which we scan the buffer pool is controlled by dynamic
+config parameter innodb_LRU_scan_depth.
+@return number of pages flushed */
+static
+ulint
+buf_flush_LRU_tail_instance(
+/*========================*/
+	buf_pool_t*	buf_pool)	/*!< in/out: buffer pool instance */
+{
+	ulint	total_flushed = 0;
+	ulint	scan_depth;
+
+	/* srv_LRU_scan_depth can be arbitrarily large value.
+	We cap it with current LRU size. */
+	buf_pool_mutex_enter(buf_pool);
+	scan_depth = UT_LIST_GET_LEN(buf_pool->LRU);
+	buf_pool_mutex_exit(buf_pool);
+
+	scan_depth = ut_min(srv_LRU_scan_depth, scan_depth);
+
+	/* We divide LRU flush into smaller chunks because
+	there may be user threads waiting for the flush to
+	end in buf_LRU_get_free_block(). */
+	for (ulint j = 0;
+	     j < scan_depth;
+	     j += PAGE_CLEANER_LRU_BATCH_CHUNK_SIZE) {
+
+		ulint	n_flushed = 0;
+
+		/* Currently page_cleaner is the only thread
+		that can trigger an LRU flush. It is possible
+		that a batch triggered during last iteration is
+		still running, */
+		if (buf_flush_LRU(buf_pool,
+				  PAGE_CLEANER_LRU_BATCH_CHUNK_SIZE,
+				  &n_flushed)) {
+
+			/* Allowed only one batch per
+			buffer pool instance. */
+			buf_flush_wait_batch_end(
+				buf_pool, BUF_FLUSH_LRU);
+		}
+
+		if (n_flushed) {
+			total_flushed += n_flushed;
+		} else {
+			/* Nothing to flush */
+			break;
+		}
+	}
+
+	return(total_flushed);
+}
+
 /*********************************************************************//**
 Clears up tail of the LRU lists:
 * Put replaceable pages at the tail of LRU to the free list
@@ -2069,47 +2240,8 @@ buf_flush_LRU_tail(void)
 
 	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
 
-		buf_pool_t*	buf_pool = buf_pool_from_array(i);
-		ulint		scan_depth;
-
-		/* srv_LRU_scan_depth can be arbitrarily large value.
-		We cap it with current LRU size. */
-		buf_pool_mutex_enter(buf_pool);
-		scan_depth = UT_LIST_GET_LEN(buf_pool->LRU);
-		buf_pool_mutex_exit(buf_pool);
-
-		scan_depth = ut_min(srv_LRU_scan_depth, scan_depth);
-
-		/* We divide LRU flush into smaller chunks because
-		there may be user threads waiting for the flush to
-		end in buf_LRU_get_free_block(). */
-		for (ulint j = 0;
-		     j < scan_depth;
-		     j += PAGE_CLEANER_LRU_BATCH_CHUNK_SIZE) {
-
-			ulint	n_flushed = 0;
-
-			/* Currently page_cleaner is the only thread
-			that can trigger an LRU flush. It is possible
-			that a batch triggered during last iteration is
-			still running, */
-			if (buf_flush_LRU(buf_pool,
-					  PAGE_CLEANER_LRU_BATCH_CHUNK_SIZE,
-					  &n_flushed)) {
-
-				/* Allowed only one batch per
-				buffer pool instance. */
-				buf_flush_wait_batch_end(
-					buf_pool, BUF_FLUSH_LRU);
-			}
-
-			if (n_flushed) {
-				total_flushed += n_flushed;
-			} else {
-				/* Nothing to flush */
-				break;
-			}
-		}
+		total_flushed += buf_flush_LRU_tail_instance(
+			buf_pool_from_array(i));
 	}
 
 	if (total_flushed) {
@@ -2148,6 +2280,251 @@ buf_flush_wait_LRU_batch_end(void)
 	}
 }
 
+/******************************************************************//**
+Creates the state shared by the page cleaner threads. Must be called
+before buf_flush_page_cleaner_thread and the worker threads are created. */
+UNIV_INTERN
+void
+buf_flush_page_cleaner_init(
+/*========================*/
+	ulint	n_workers)	/*!< in: number of
+				buf_flush_page_cleaner_worker threads
+				that will be created */
+{
+	ut_ad(page_cleaner == NULL);
+
+	page_cleaner = static_cast<page_cleaner_t*>(
+		mem_zalloc(sizeof(*page_cleaner)));
+
+	mutex_create(page_cleaner_mutex_key, &page_cleaner->mutex,
+		     SYNC_ANY_LATCH);
+
+	page_cleaner->is_requested = os_event_create();
+	page_cleaner->is_finished = os_event_create();
+	page_cleaner->n_workers = n_workers;
+	page_cleaner->is_running = true;
+
+	page_cleaner->n_slots = srv_buf_pool_instances;
+	page_cleaner->slots = static_cast<page_cleaner_slot_t*>(
+		mem_zalloc(page_cleaner->n_slots
+			   * sizeof(*page_cleaner->slots)));
+}
+
+/******************************************************************//**
+Makes the page cleaner worker threads exit and frees the state shared by
+the page cleaner threads. */
+static
+void
+buf_flush_page_cleaner_close(void)
+/*==============================*/
+{
+	mutex_enter(&page_cleaner->mutex);
+
+	page_cleaner->is_running = false;
+
+	while (page_cleaner->n_workers > 0) {
+		os_event_set(page_cleaner->is_requested);
+
+		mutex_exit(&page_cleaner->mutex);
+
+		os_thread_sleep(10000);
+
+		mutex_enter(&page_cleaner->mutex);
+	}
+
+	mutex_exit(&page_cleaner->mutex);
+
+	mutex_free(&page_cleaner->mutex);
+	os_event_free(page_cleaner->is_requested);
+	os_event_free(page_cleaner->is_finished);
+	mem_free(page_cleaner->slots);
+	mem_free(page_cleaner);
+
+	page_cleaner = NULL;
+}
+
+/******************************************************************//**
+Flushes one of the buffer pool instances that are waiting to be flushed
+in the current page cleaner round.
+@return false if no instance was waiting */
+static
+bool
+page_cleaner_flush_slot(
+/*====================*/
+	bool	by_worker)	/*!< in: true if called by a worker
+				thread */
+{
+	page_cleaner_t*		pc = page_cleaner;
+	page_cleaner_slot_t*	slot = NULL;
+	bool			flush_LRU;
+	lsn_t			lsn_limit;
+	ullint			start_time;
+	ulint			i;
+
+	mutex_enter(&pc->mutex);
+
+	if (pc->n_slots_requested == 0) {
+		mutex_exit(&pc->mutex);
+
+		return(false);
+	}
+
+	for (i = 0; i < pc->n_slots; i++) {
+		if (pc->slots[i].state == PAGE_CLEANER_STATE_REQUESTED) {
+			slot = &pc->slots[i];
+			break;
+		}
+	}
+
+	ut_a(slot != NULL);
+
+	slot->state = PAGE_CLEANER_STATE_FLUSHING;
+
+	if (--pc->n_slots_requested == 0) {
+		os_event_reset(pc->is_requested);
+	}
+
+	flush_LRU = pc->flush_LRU;
+	lsn_limit = pc->lsn_limit;
+
+	mutex_exit(&pc->mutex);
+
+	start_time = ut_time_us(NULL);
+
+	if (flush_LRU) {
+		slot->n_flushed = buf_flush_LRU_tail_instance(
+			buf_pool_from_array(i));
+	} else if (slot->n_pages_requested > 0) {
+		buf_flush_list_instance(buf_pool_from_array(i),
+					slot->n_pages_requested, lsn_limit,
+					&slot->n_flushed);
+	} else {
+		slot->n_flushed = 0;
+	}
+
+	slot->flush_time = ut_time_us(NULL) - start_time;
+	slot->by_worker = by_worker;
+
+	mutex_enter(&pc->mutex);
+
+	slot->state = PAGE_CLEANER_STATE_FINISHED;
+
+	if (++pc->n_slots_finished == pc->n_slots) {
+		os_event_set(pc->is_finished);
+	}
+
+	mutex_exit(&pc->mutex);
+
+	return(true);
+}
+
+/******************************************************************//**
+Runs a page cleaner round: requests all the buffer pool instances to be
+flushed, flushes instances in the coordinator thread until none is left
+waiting, and then waits until the worker threads have flushed the others.
+When the flush lists are flushed, the caller must have set
+n_pages_requested in the slots.
+@return number of pages flushed in the round */
+static
+ulint
+page_cleaner_flush_round(
+/*=====================*/
+	bool	flush_LRU,	/*!< in: true to flush the LRU list tails,
+				false to flush the flush lists */
+	lsn_t	lsn_limit)	/*!< in: when flushing the flush lists,
+				lsn up to which to flush */
+{
+	page_cleaner_t*	pc = page_cleaner;
+	ullint		counter_time = ut_time_us(NULL);
+	ullint		flush_time = 0;
+	ulint		n_flushed = 0;
+	ulint		n_by_worker = 0;
+	ulint		i;
+
+	mutex_enter(&pc->mutex);
+
+	ut_ad(pc->n_slots_requested == 0);
+
+	pc->flush_LRU = flush_LRU;
+	pc->lsn_limit = lsn_limit;
+
+	for (i = 0; i < pc->n_slots; i++) {
+		ut_ad(pc->slots[i].state == PAGE_CLEANER_STATE_NONE);
+		pc->slots[i].state = PAGE_CLEANER_STATE_REQUESTED;
+	}
+
+	pc->n_slots_requested = pc->n_slots;
+	pc->n_slots_finished = 0;
+
+	os_event_reset(pc->is_finished);
+	os_event_set(pc->is_requested);
+
+	mutex_exit(&pc->mutex);
+
+	while (page_cleaner_flush_slot(false)) {
+		/* Flush instances until none is left waiting */
+	}
+
+	os_event_wait(pc->is_finished);
+
+	mutex_enter(&pc->mutex);
+
+	ut_ad(pc->n_slots_finished == pc->n_slots);
+
+	for (i = 0; i < pc->n_slots; i++) {
+		page_cleaner_slot_t*	slot = &pc->slots[i];
+
+		ut_ad(slot->state == PAGE_CLEANER_STATE_FINISHED);
+		slot->state = PAGE_CLEANER_STATE_NONE;
+
+		n_flushed += slot->n_flushed;
+		flush_time += slot->flush_time;
+
+		if (slot->by_worker) {
+			n_by_worker++;
+		}
+	}
+
+	mutex_exit(&pc->mutex);
+
+	if (flush_LRU) {
+		MONITOR_INC_VALUE(MONITOR_FLUSH_PC_LRU_MICROSECOND,
+				  flush_time);
+	} else {
+		MONITOR_INC_VALUE(MONITOR_FLUSH_PC_LIST_MICROSECOND,
+				  flush_time);
+	}
+
+	MONITOR_INC(MONITOR_FLUSH_PC_ROUNDS);
+	MONITOR_INC_VALUE(MONITOR_FLUSH_PC_WORKER_INSTANCES, n_by_worker);
+	MONITOR_INC_TIME_IN_MICRO_SECS(
+		MONITOR_FLUSH_PC_ROUND_MICROSECOND, counter_time);
+
+	return(n_flushed);
+}
+
+/*********************************************************************//**
+Clears up the tails of the LRU lists of all buffer pool instances in
+parallel, like buf_flush_LRU_tail() does sequentially.
+@return total pages flushed */
+static
+ulint
+page_cleaner_flush_LRU_tail(void)
+/*=============================*/
+{
+	ulint	n_flushed = page_cleaner_flush_round(true, 0);
+
+	if (n_flushed) {
+		MONITOR_INC_VALUE_CUMULATIVE(
+			MONITOR_LRU_BATCH_TOTAL_PAGE,
+			MONITOR_LRU_BATCH_COUNT,
+			MONITOR_LRU_BATCH_PAGES,
+			n_flushed);
+	}
+
+	return(n_flushed);
+}
+
 /*********************************************************************//**
 Flush a batch of dirty pages from the flush list
 @return number of pages flushed, 0 if no page is flushed or if another
@@ -2161,11 +2538,18 @@ page_cleaner_do_flush_batch(
 	lsn_t		lsn_limit)	/*!< in: LSN up to which flushing
 					must happen */
 {
-	ulint n_flushed;
+	if (n_to_flush != ULINT_MAX) {
+		/* Spread the flushing evenly amongst the buffer pool
+		instances, like buf_flush_list() does. */
+		n_to_flush = (n_to_flush + srv_buf_pool_instances - 1)
+			     / srv_buf_pool_instances;
+	}
 
-	buf_flush_list(n_to_flush, lsn_limit, &n_flushed);
+	for (ulint i = 0; i < srv_buf_pool_instances; i++) {
+		page_cleaner->slots[i].n_pages_requested = n_to_flush;
+	}
 
-	return(n_flushed);
+	return(page_cleaner_flush_round(false, lsn_limit));
 }
 
 /*********************************************************************//**
@@ -2244,6 +2628,75 @@ af_get_pct_for_lsn(
 		/ 7.5));
 }
 
+/*********************************************************************//**
+Distributes the pages to flush from the flush lists over the buffer pool
+instances and flushes them in a page cleaner round. An instance gets a
+share that grows with the percentage of io capacity af_get_pct_for_lsn()
+recommends for the age of its oldest modification, because the
+checkpoint cannot advance before the oldest pages are flushed.
+@return number of pages flushed */
+static
+ulint
+page_cleaner_flush_instances(
+/*=========================*/
+	ulint	n_pages,	/*!< in: number of pages to flush */
+	lsn_t	cur_lsn,	/*!< in: current lsn */
+	ulint	pct_for_dirty,	/*!< in: af_get_pct_for_dirty() */
+	lsn_t	lsn_limit)	/*!< in: lsn up to which to flush */
+{
+	page_cleaner_slot_t*	slots = page_cleaner->slots;
+	lsn_t			weight_sum = 0;
+	ulint			i;
+
+	if (n_pages == 0) {
+		return(0);
+	}
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		buf_pool_t*		buf_pool = buf_pool_from_array(i);
+		const buf_page_t*	bpage;
+		lsn_t			oldest_lsn = 0;
+
+		buf_flush_list_mutex_enter(buf_pool);
+
+		bpage = UT_LIST_GET_LAST(buf_pool->flush_list);
+
+		if (bpage != NULL) {
+			ut_ad(bpage->in_flush_list);
+			oldest_lsn = bpage->oldest_modification;
+		}
+
+		buf_flush_list_mutex_exit(buf_pool);
+
+		if (oldest_lsn == 0) {
+			/* Nothing to flush in this instance */
+			slots[i].n_pages_requested = 0;
+			continue;
+		}
+
+		slots[i].n_pages_requested = 1 + ut_max(
+			pct_for_dirty,
+			af_get_pct_for_lsn(cur_lsn > oldest_lsn
+					   ? cur_lsn - oldest_lsn : 0));
+
+		weight_sum += slots[i].n_pages_requested;
+	}
+
+	if (weight_sum == 0) {
+		/* All the flush lists were empty */
+		return(0);
+	}
+
+	for (i = 0; i < srv_buf_pool_instances; i++) {
+		lsn_t	weight = slots[i].n_pages_requested;
+
+		slots[i].n_pages_requested = static_cast<ulint>(
+			(n_pages * weight + weight_sum - 1) / weight_sum);
+	}
+
+	return(page_cleaner_flush_round(false, lsn_limit));
+}
+
 /*********************************************************************//**
 This function is called approximately once every second by the
 page_cleaner thread. Based on various factors it decides if there is a
@@ -2330,8 +2783,9 @@ page_cleaner_flush_pages_if_needed(void)
 	MONITOR_SET(MONITOR_FLUSH_N_TO_FLUSH_REQUESTED, n_pages);
 
 	prev_pages = n_pages;
-	n_pages = page_cleaner_do_flush_batch(
-		n_pages, oldest_lsn + lsn_avg_rate * (age_factor + 1));
+	n_pages = page_cleaner_flush_instances(
+		n_pages, cur_lsn, pct_for_dirty,
+		oldest_lsn + lsn_avg_rate * (age_factor + 1));
 
 	last_lsn= cur_lsn;
 	last_pages= n_pages + 1;
@@ -2378,7 +2832,8 @@ page_cleaner_sleep_if_needed(
 
 /******************************************************************//**
 page_cleaner thread tasked with flushing dirty pages from the buffer
-pools. As of now we'll have only one instance of this thread.
+pools. It decides what to flush and flushes the buffer pool instances
+together with the buf_flush_page_cleaner_worker threads.
 @return a dummy parameter */
 extern "C" UNIV_INTERN
 os_thread_ret_t
@@ -2423,7 +2878,7 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 			last_activity = srv_get_activity_count();
 
 			/* Flush pages from end of LRU if required */
-			n_flushed = buf_flush_LRU_tail();
+			n_flushed = page_cleaner_flush_LRU_tail();
 
 			/* Flush pages from flush_list if required */
 			n_flushed += page_cleaner_flush_pages_if_needed();
@@ -2505,6 +2960,8 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 	/* We have lived our life. Time to die. */
 
 thread_exit:
+	buf_flush_page_cleaner_close();
+
 	buf_page_cleaner_is_active = FALSE;
 
 	my_thread_end();
@@ -2515,6 +2972,48 @@ thread_exit:
 	OS_THREAD_DUMMY_RETURN;
 }
 
+/******************************************************************//**
+Worker thread of the page cleaner: flushes buffer pool instances in the
+rounds requested by buf_flush_page_cleaner_thread.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_flush_page_cleaner_worker)(
+/*==========================================*/
+	void*	arg MY_ATTRIBUTE((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	my_thread_init();
+
+	ut_ad(!srv_read_only_mode);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(buf_page_cleaner_worker_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	for (;;) {
+		os_event_wait(page_cleaner->is_requested);
+
+		if (!page_cleaner->is_running) {
+			break;
+		}
+
+		page_cleaner_flush_slot(true);
+	}
+
+	mutex_enter(&page_cleaner->mutex);
+	page_cleaner->n_workers--;
+	mutex_exit(&page_cleaner->mutex);
+
+	my_thread_end();
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 #if defined UNIV_DEBUG || defined UNIV_BUF_DEBUG
 
 /** Functor to validate the flush list. */
@@ -469,6 +469,68 @@ buf_read_page_async(
 	return(count > 0);
 }
 
+/********************************************************************//**
+Issues asynchronous read requests for a batch of pages of one tablespace
+that a buffer pool load wants to read in. Unlike buf_read_page_async(),
+this does not wait for the reads to complete, so that the i/o handler
+threads can serve the batch in parallel.
+@return	number of page read requests issued */
+UNIV_INTERN
+ulint
+buf_read_load_pages(
+/*================*/
+	ulint		space,		/*!< in: space id */
+	const ulint*	page_nos,	/*!< in: array of page numbers
+					to read */
+	ulint		n_stored)	/*!< in: number of elements
+					in the array */
+{
+	ulint		zip_size;
+	ib_int64_t	tablespace_version;
+	ulint		space_size;
+	ulint		count = 0;
+	dberr_t		err;
+
+	zip_size = fil_space_get_zip_size(space);
+
+	if (zip_size == ULINT_UNDEFINED) {
+		/* The tablespace does not exist anymore */
+		return(0);
+	}
+
+	tablespace_version = fil_space_get_version(space);
+
+	/* Unlike a synchronous read, an asynchronous read looks up the
+	insert buffer bitmap of the page, which must thus be within the
+	tablespace, and a dump may refer to pages that no longer exist. */
+	space_size = fil_space_get_size(space);
+
+	for (ulint i = 0; i < n_stored; i++) {
+		if (page_nos[i] >= space_size) {
+			continue;
+		}
+
+		count += buf_read_page_low(&err, false, BUF_READ_ANY_PAGE
+					   | OS_AIO_SIMULATED_WAKE_LATER
+					   | BUF_READ_IGNORE_NONEXISTENT_PAGES,
+					   space, zip_size, FALSE,
+					   tablespace_version, page_nos[i]);
+
+		if (err == DB_TABLESPACE_DELETED) {
+			break;
+		}
+	}
+
+	os_aio_simulated_wake_handler_threads();
+
+	srv_stats.buf_pool_reads.add(count);
+
+	/* As in buf_read_page_async(), these deliberate reads are not
+	counted in buf_LRU_stat_inc_io(). */
+
+	return(count);
+}
+
 /********************************************************************//**
 Applies linear read-ahead if in the buf_pool the page is a border page of
 a linear read-ahead area and all the pages in the area have been accessed.
@@ -109,14 +109,13 @@ enum_tx_isolation thd_get_trx_isolation(const THD* thd);
 #ifdef WITH_WSREP
 #include "../storage/innobase/include/ut0byte.h"
 #include <wsrep_mysqld.h>
+#include <wsrep_hotkey.h>
 #include <my_md5.h>
+#include <my_murmur3.h>
 extern my_bool wsrep_certify_nonPK;
 class  binlog_trx_data;
 extern handlerton *binlog_hton;
 
-extern MYSQL_PLUGIN_IMPORT mysql_mutex_t LOCK_wsrep_rollback;
-extern MYSQL_PLUGIN_IMPORT mysql_cond_t COND_wsrep_rollback;
-extern MYSQL_PLUGIN_IMPORT wsrep_aborting_thd_t wsrep_aborting_thd;
 
 static inline wsrep_ws_handle_t*
 wsrep_ws_handle(THD* thd, const trx_t* trx) {
@@ -259,6 +258,24 @@ static TYPELIB innodb_checksum_algorithm_typelib = {
 	NULL
 };
 
+/** Possible values for system variable "innodb_compression_algorithm",
+in the order of page_zip_codec_t. */
+static const char* innodb_compression_algorithm_names[] = {
+	"zlib",
+	"lz4",
+	"zstd",
+	NullS
+};
+
+/** Used to define an enumerate type of the system variable
+innodb_compression_algorithm. */
+static TYPELIB innodb_compression_algorithm_typelib = {
+	array_elements(innodb_compression_algorithm_names) - 1,
+	"innodb_compression_algorithm_typelib",
+	innodb_compression_algorithm_names,
+	NULL
+};
+
 /* The following counter is used to convey information to InnoDB
 about server activity: in case of normal DML ops it is not
 sensible to call srv_active_wake_master_thread after each
@@ -349,6 +366,7 @@ static PSI_mutex_info all_innodb_mutexes[] = {
 	{&purge_sys_bh_mutex_key, "purge_sys_bh_mutex", 0},
 	{&recv_sys_mutex_key, "recv_sys_mutex", 0},
 	{&recv_writer_mutex_key, "recv_writer_mutex", 0},
+	{&page_cleaner_mutex_key, "page_cleaner_mutex", 0},
 	{&rseg_mutex_key, "rseg_mutex", 0},
 #  ifdef UNIV_SYNC_DEBUG
 	{&rw_lock_debug_mutex_key, "rw_lock_debug_mutex", 0},
@@ -411,6 +429,7 @@ static PSI_rwlock_info all_innodb_rwlocks[] = {
 	{&index_tree_rw_lock_key, "index_tree_rw_lock", 0},
 	{&index_online_log_key, "index_online_log", 0},
 	{&dict_table_stats_key, "dict_table_stats", 0},
+	{&lock_sys_latch_key, "lock_sys_latch", 0},
 	{&hash_table_rw_lock_key, "hash_table_locks", 0}
 };
 # endif /* UNIV_PFS_RWLOCK */
@@ -423,12 +442,17 @@ static PSI_thread_info	all_innodb_threads[] = {
 	{&trx_rollback_clean_thread_key, "trx_rollback_clean_thread", 0},
 	{&io_handler_thread_key, "io_handler_thread", 0},
 	{&srv_lock_timeout_thread_key, "srv_lock_timeout_thread", 0},
+	{&srv_lock_deadlock_thread_key, "srv_lock_deadlock_thread", 0},
+	{&log_writer_thread_key, "log_writer_thread", 0},
+	{&log_flusher_thread_key, "log_flusher_thread", 0},
 	{&srv_error_monitor_thread_key, "srv_error_monitor_thread", 0},
 	{&srv_monitor_thread_key, "srv_monitor_thread", 0},
 	{&srv_master_thread_key, "srv_master_thread", 0},
 	{&srv_purge_thread_key, "srv_purge_thread", 0},
 	{&buf_page_cleaner_thread_key, "page_cleaner_thread", 0},
-	{&recv_writer_thread_key, "recv_writer_thread", 0}
+	{&buf_page_cleaner_worker_thread_key, "page_cleaner_worker_thread", 0},
+	{&recv_writer_thread_key, "recv_writer_thread", 0},
+	{&recv_apply_thread_key, "recv_apply_thread", 0}
 };
 # endif /* UNIV_PFS_THREAD */
 
@@ -1092,7 +1116,9 @@ static
 bool
 innobase_flush_logs(
 /*================*/
-	handlerton*	hton);		/*!< in: InnoDB handlerton */
+	handlerton*	hton,		/*!< in: InnoDB handlerton */
+	bool		group_flush);	/*!< in: true if flushing on behalf
+					of a group of committed transactions */
 
 /************************************************************************//**
 Implements the SHOW ENGINE INNODB STATUS command. Sends the output of the
@@ -1328,7 +1354,8 @@ innobase_srv_conc_exit_innodb(
 	trx_t*	trx)	/*!< in: transaction handle */
 {
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!sync_thread_levels_nonempty_trx(trx->has_search_latch));
+	ut_ad(!sync_thread_levels_nonempty_trx(
+		trx->has_search_latch != NULL));
 #endif /* UNIV_SYNC_DEBUG */
 #ifdef WITH_WSREP
 	if (wsrep_on(trx->mysql_thd) && 
@@ -1352,7 +1379,8 @@ innobase_srv_conc_force_exit_innodb(
 	trx_t*	trx)	/*!< in: transaction handle */
 {
 #ifdef UNIV_SYNC_DEBUG
-	ut_ad(!sync_thread_levels_nonempty_trx(trx->has_search_latch));
+	ut_ad(!sync_thread_levels_nonempty_trx(
+		trx->has_search_latch != NULL));
 #endif /* UNIV_SYNC_DEBUG */
 
 	/* This is to avoid making an unnecessary function call. */
@@ -2427,6 +2455,9 @@ ha_innobase::ha_innobase(
 		  HA_CAN_FULLTEXT_EXT | HA_CAN_EXPORT),
 	start_of_scan(0),
 	num_write_row(0)
+#ifdef WITH_WSREP
+	, wsrep_key_plan_built(false)
+#endif /* WITH_WSREP */
 {}
 
 /*********************************************************************//**
@@ -3386,6 +3417,15 @@ innobase_change_buffering_inited_ok:
 		srv_checksum_algorithm = SRV_CHECKSUM_ALGORITHM_NONE;
 	}
 
+	if (!page_zip_codec_is_available(page_zip_codec)) {
+		ut_print_timestamp(stderr);
+		fprintf(stderr,
+			" InnoDB: Warning: innodb_compression_algorithm=%s"
+			" is not available in this build. Using zlib.\n",
+			innodb_compression_algorithm_names[page_zip_codec]);
+		page_zip_codec = PAGE_ZIP_CODEC_ZLIB;
+	}
+
 #ifdef HAVE_LARGE_PAGES
 	if ((os_use_large_pages = (ibool) my_use_large_pages)) {
 		os_large_page_size = (ulint) opt_large_page_size;
@@ -3597,15 +3637,28 @@ static
 bool
 innobase_flush_logs(
 /*================*/
-	handlerton*	hton)	/*!< in/out: InnoDB handlerton */
+	handlerton*	hton,		/*!< in/out: InnoDB handlerton */
+	bool		group_flush)	/*!< in: true if flushing on behalf
+					of a group of committed transactions,
+					whose commit skipped the log flush */
 {
 	bool	result = 0;
 
 	DBUG_ENTER("innobase_flush_logs");
 	DBUG_ASSERT(hton == innodb_hton_ptr);
 
-	if (!srv_read_only_mode) {
+	if (srv_read_only_mode) {
+		/* Nothing to flush */
+	} else if (!group_flush) {
 		log_buffer_flush_to_disk();
+	} else if (srv_flush_log_at_trx_commit != 0) {
+		/* Do what the commits of the group would have done by
+		themselves: write the log, and flush it only with
+		innodb_flush_log_at_trx_commit=1, like
+		trx_flush_log_if_needed() does. */
+		log_buffer_flush_to_disk(
+			srv_flush_log_at_trx_commit == 1
+			&& srv_unix_file_flush_method != SRV_UNIX_NOSYNC);
 	}
 
 	DBUG_RETURN(result);
@@ -4669,6 +4722,35 @@ innobase_match_index_columns(
 	DBUG_RETURN(TRUE);
 }
 
+/*******************************************************************//**
+Checks whether the comment of an index contains the hint
+ADAPTIVE_HASH_INDEX=OFF (case insensitive), which tells that no
+adaptive hash index entries are to be built for the index.
+@return true if the adaptive hash index is disabled for the index */
+static
+bool
+innobase_index_comment_disables_ahi(
+/*================================*/
+	const KEY*	key_info)	/*!< in: index definition */
+{
+	static const char	hint[] = "ADAPTIVE_HASH_INDEX=OFF";
+	const size_t		len = sizeof hint - 1;
+
+	if (!(key_info->flags & HA_USES_COMMENT)) {
+		return(false);
+	}
+
+	for (size_t i = 0; i + len <= key_info->comment.length; i++) {
+		if (!my_strnncoll(system_charset_info,
+				  (const uchar*) key_info->comment.str + i,
+				  len, (const uchar*) hint, len)) {
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
 /*******************************************************************//**
 This function builds a translation table in INNOBASE_SHARE
 structure for fast index location with mysql array number from its
@@ -4773,6 +4855,10 @@ innobase_build_index_translation(
 			ret = FALSE;
 			goto func_exit;
 		}
+
+		index_mapping[count]->disable_ahi
+			= innobase_index_comment_disables_ahi(
+				&table->key_info[count]);
 	}
 
 	/* Successfully built the translation table */
@@ -4953,8 +5039,8 @@ ha_innobase::open(
 	thd = ha_thd();
 
 	/* Under some cases MySQL seems to call this function while
-	holding btr_search_latch. This breaks the latching order as
-	we acquire dict_sys->mutex below and leads to a deadlock. */
+	holding an adaptive hash index latch. This breaks the latching
+	order as we acquire dict_sys->mutex below and leads to a deadlock. */
 	if (thd != NULL) {
 		innobase_release_temporary_latches(ht, thd);
 	}
@@ -4972,6 +5058,11 @@ ha_innobase::open(
 	upd_buf = NULL;
 	upd_buf_size = 0;
 
+#ifdef WITH_WSREP
+	/* Will be built if it is needed in ::wsrep_append_keys() */
+	wsrep_key_plan_built = false;
+#endif /* WITH_WSREP */
+
 	/* We look for pattern #P# to see if the table is partitioned
 	MySQL table. */
 #ifdef __WIN__
@@ -5433,7 +5524,7 @@ wsrep_innobase_mysql_sort(
 	case MYSQL_TYPE_LONG_BLOB:
 	case MYSQL_TYPE_VARCHAR:
 	{
-		uchar tmp_str[REC_VERSION_56_MAX_INDEX_COL_LEN] = {'\0'};
+		uchar tmp_str[REC_VERSION_56_MAX_INDEX_COL_LEN];
 		uint tmp_length = REC_VERSION_56_MAX_INDEX_COL_LEN;
 
 		/* Use the charset number to pick the right charset struct for
@@ -5461,6 +5552,9 @@ wsrep_innobase_mysql_sort(
 		memcpy(tmp_str, str, str_length);
 
 		if (wsrep_protocol_version < 3) {
+			/* the whole of tmp_str is the source here */
+			memset(tmp_str + str_length, 0,
+			       tmp_length - str_length);
 			tmp_length = charset->coll->strnxfrm(
 				charset, str, str_length,
 				str_length, tmp_str, tmp_length, 0);
@@ -6015,10 +6109,33 @@ innobase_read_from_2_little_endian(
 	return((uint) ((ulint)(buf[0]) + 256 * ((ulint)(buf[1]))));
 }
 
+#ifdef WITH_WSREP
+/*******************************************************************//**
+Zero-fills a wsrep key buffer up to the given position unless it has
+been written or zeroed that far already. Key values are built as if
+the whole buffer was zeroed up front, without paying for clearing all
+of it for every key. */
+static inline
+void
+wsrep_key_buf_zero(
+/*===============*/
+	char**		zeroed,	/*!< in/out: end of the zeroed prefix */
+	char*		end,	/*!< in: end of the region to be used */
+	char*		limit)	/*!< in: end of the buffer */
+{
+	if (end > limit) {
+		end = limit;
+	}
+
+	if (end > *zeroed) {
+		memset(*zeroed, 0, end - *zeroed);
+		*zeroed = end;
+	}
+}
+
 /*******************************************************************//**
 Stores a key value for a row to a buffer.
 @return	key value length as stored in buff */
-#ifdef WITH_WSREP
 UNIV_INTERN
 uint
 wsrep_store_key_val_for_row(
@@ -6036,22 +6153,25 @@ wsrep_store_key_val_for_row(
 	KEY_PART_INFO*	end		=
 		key_part + key_info->user_defined_key_parts;
 	char*		buff_start	= buff;
+	char*		buff_limit	= buff + buff_len;
+	char*		buff_zeroed	= buff;
 	enum_field_types mysql_type;
 	Field*		field;
 	uint buff_space = buff_len;
 
 	DBUG_ENTER("wsrep_store_key_val_for_row");
 
-	memset(buff, 0, buff_len);
 	*key_is_null = TRUE;
 
 	for (; key_part != end; key_part++) {
 
-		uchar sorted[REC_VERSION_56_MAX_INDEX_COL_LEN] = {'\0'};
+		uchar sorted[REC_VERSION_56_MAX_INDEX_COL_LEN];
 		ibool part_is_null = FALSE;
 
 		if (key_part->null_bit) {
 			if (buff_space > 0) {
+				wsrep_key_buf_zero(&buff_zeroed, buff + 1,
+						   buff_limit);
 				if (record[key_part->null_offset]
 				    & key_part->null_bit) {
 					*buff = 1;
@@ -6091,6 +6211,9 @@ wsrep_store_key_val_for_row(
 						 wsrep_thd_query(thd));
 					true_len = buff_space;
 				}
+				wsrep_key_buf_zero(&buff_zeroed,
+						   buff + true_len,
+						   buff_limit);
 				buff       += true_len;
 				buff_space -= true_len;
 				continue;
@@ -6142,10 +6265,16 @@ wsrep_store_key_val_for_row(
 						 wsrep_thd_query(thd));
 					true_len = buff_space;
 				}
+				wsrep_key_buf_zero(&buff_zeroed,
+						   buff + true_len,
+						   buff_limit);
  				memcpy(buff, sorted, true_len);
                                 buff       += true_len;
 				buff_space -= true_len;
                         } else {
+				wsrep_key_buf_zero(&buff_zeroed,
+						   buff + key_len,
+						   buff_limit);
                                 buff += key_len;
                         }
 		} else if (mysql_type == MYSQL_TYPE_TINY_BLOB
@@ -6175,6 +6304,9 @@ wsrep_store_key_val_for_row(
 						 wsrep_thd_query(thd));
 					true_len = buff_space;
 				}
+				wsrep_key_buf_zero(&buff_zeroed,
+						   buff + true_len,
+						   buff_limit);
 				buff       += true_len;
 				buff_space -= true_len;
 
@@ -6228,11 +6360,19 @@ wsrep_store_key_val_for_row(
 						 wsrep_thd_query(thd));
 					true_len = buff_space;
 				}
+				wsrep_key_buf_zero(&buff_zeroed,
+						   buff + true_len,
+						   buff_limit);
 				buff       += true_len;
 				buff_space -= true_len;
 			} else {
+				wsrep_key_buf_zero(&buff_zeroed,
+						   buff + key_len,
+						   buff_limit);
 				buff += key_len;
 			}
+			wsrep_key_buf_zero(&buff_zeroed, buff + true_len,
+					   buff_limit);
 			memcpy(buff, sorted, true_len);
 		} else {
 			/* Here we handle all other data types except the
@@ -6257,6 +6397,9 @@ wsrep_store_key_val_for_row(
 						 wsrep_thd_query(thd));
 					true_len = buff_space;
 				}
+				wsrep_key_buf_zero(&buff_zeroed,
+						   buff + true_len,
+						   buff_limit);
 				buff       += true_len;
 				buff_space -= true_len;
 
@@ -6304,8 +6447,14 @@ wsrep_store_key_val_for_row(
 						 wsrep_thd_query(thd));
 					true_len   = buff_space;
 				}
+				wsrep_key_buf_zero(&buff_zeroed,
+						   buff + true_len,
+						   buff_limit);
 				memcpy(buff, sorted, true_len);
 			} else {
+				wsrep_key_buf_zero(&buff_zeroed,
+						   buff + true_len,
+						   buff_limit);
 				memcpy(buff, src_start, true_len);
 			}
 			buff       += true_len;
@@ -7517,7 +7666,7 @@ func_exit:
 static
 int
 wsrep_calc_row_hash(
-	byte*		digest,		/*!< in/out: md5 sum */
+	byte*		digest,		/*!< in/out: 16 byte row digest */
 	const uchar*	row,		/*!< in: row in MySQL format */
 	TABLE*		table,		/*!< in: table in MySQL data
 					dictionary */
@@ -7531,9 +7680,19 @@ wsrep_calc_row_hash(
 	const byte*	ptr;
 	ulint		col_type;
 	uint		i;
-
-
-	void *ctx = wsrep_md5_init();
+	/* Starting from protocol 4 all nodes hash rows with 128-bit
+	MurmurHash3, which is several times cheaper than MD5 on wide
+	rows. Older protocols must stick to MD5 so that keys of mixed
+	version clusters still match. */
+	const bool	use_murmur = wsrep_protocol_version >= 4;
+	murmur3_128_ctx	murmur_ctx;
+	void*		ctx = NULL;
+
+	if (use_murmur) {
+		murmur3_128_init(&murmur_ctx, 0);
+	} else {
+		ctx = wsrep_md5_init();
+	}
 
 	n_fields = table->s->fields;
 
@@ -7577,14 +7736,27 @@ wsrep_calc_row_hash(
 			;
 		}
 
-		if (field->is_null_in_record(row)) {
+		if (use_murmur) {
+			if (field->is_null_in_record(row)) {
+				murmur3_128_update(&murmur_ctx, &null_byte, 1);
+			} else {
+				murmur3_128_update(&murmur_ctx, &true_byte, 1);
+				murmur3_128_update(&murmur_ctx, ptr, len);
+			}
+		} else if (field->is_null_in_record(row)) {
 			wsrep_md5_update(ctx, (char*)&null_byte, 1);
 		} else {
 			wsrep_md5_update(ctx, (char*)&true_byte, 1);
 			wsrep_md5_update(ctx, (char*)ptr, len);
 		}
 	}
-	wsrep_compute_md5_hash((char*)digest, ctx);
+
+	if (use_murmur) {
+		compile_time_assert(MURMUR3_128_HASH_SIZE == 16);
+		murmur3_128_final(&murmur_ctx, digest);
+	} else {
+		wsrep_compute_md5_hash((char*)digest, ctx);
+	}
 	return(0);
 }
 #endif /* WITH_WSREP */
@@ -9485,6 +9657,9 @@ wsrep_append_key(
 			   wsrep_thd_query(thd) : "void", rcode);
 		DBUG_RETURN(-1);
 	}
+	if (!shared) {
+		wsrep_hot_key_append(thd, wkey_part, wkey.key_parts_num);
+	}
 	DBUG_RETURN(0);
 }
 
@@ -9510,6 +9685,39 @@ wsrep_is_FK_index(dict_table_t* table,
         return false;
 }
 
+/********************************************************************//**
+Builds the certification key plan of the handle: InnoDB indexes matching
+MySQL keys and whether the table has a unique key at all. The plan depends
+only on the table definition, so it is kept until the handle is reopened
+instead of being worked out again for every row. */
+UNIV_INTERN
+void
+ha_innobase::wsrep_build_key_plan()
+/*================================*/
+{
+	uint	i;
+
+	wsrep_key_plan_unique = false;
+
+	for (i = 0; i < table->s->keys; ++i) {
+		KEY*	key_info = table->key_info + i;
+
+		if (key_info->flags & HA_NOSAME) {
+			wsrep_key_plan_unique = true;
+		}
+
+		wsrep_key_plan_index[i] = innobase_get_index(i);
+
+		if (!wsrep_key_plan_index[i]) {
+			WSREP_WARN("MySQL-InnoDB key mismatch %s %s",
+				   table->s->table_name.str,
+				   key_info->name);
+		}
+	}
+
+	wsrep_key_plan_built = true;
+}
+
 int
 ha_innobase::wsrep_append_keys(
 	THD 		*thd,
@@ -9534,7 +9742,7 @@ ha_innobase::wsrep_append_keys(
 
 	if (wsrep_protocol_version == 0) {
 		uint	len;
-		char 	keyval[WSREP_MAX_SUPPORTED_KEY_LENGTH+1] = {'\0'};
+		char 	keyval[WSREP_MAX_SUPPORTED_KEY_LENGTH+1];
 		char 	*key 		= &keyval[0];
 		ibool    is_null;
 
@@ -9556,49 +9764,46 @@ ha_innobase::wsrep_append_keys(
 	} else {
 		ut_a(table->s->keys <= 256);
 		uint i;
-		bool hasPK= false;
 
-		for (i=0; i<table->s->keys; ++i) {
-			KEY*  key_info	= table->key_info + i;
-			if (key_info->flags & HA_NOSAME) {
-				hasPK = true;
-			}
+		if (!wsrep_key_plan_built) {
+			wsrep_build_key_plan();
 		}
 
+		bool const hasPK = wsrep_key_plan_unique;
+
+		/* Referencing foreign keys are looked up only when there
+		are any, not for every index of every row. */
+		bool const referenced = !prebuilt->table->referenced_set.empty();
+
 		for (i=0; i<table->s->keys; ++i) {
-			uint  len;
-			char  keyval0[WSREP_MAX_SUPPORTED_KEY_LENGTH+1] = {'\0'};
-			char  keyval1[WSREP_MAX_SUPPORTED_KEY_LENGTH+1] = {'\0'};
+			uint  len0;
+			uint  len1;
+			char  keyval0[WSREP_MAX_SUPPORTED_KEY_LENGTH+1];
+			char  keyval1[WSREP_MAX_SUPPORTED_KEY_LENGTH+1];
 			char* key0 		= &keyval0[1];
 			char* key1 		= &keyval1[1];
 			KEY*  key_info	= table->key_info + i;
 			ibool is_null;
 
-			dict_index_t* idx  = innobase_get_index(i);
+			dict_index_t* idx  = wsrep_key_plan_index[i];
 			dict_table_t* tab  = (idx) ? idx->table : NULL;
 
-			keyval0[0] = (char)i;
-			keyval1[0] = (char)i;
-
-			if (!tab) {
-				WSREP_WARN("MySQL-InnoDB key mismatch %s %s",
-					   table->s->table_name.str,
-					   key_info->name);
-			}
 			/* !hasPK == table with no PK,
                            must append all non-unique keys */
 			if (!hasPK || key_info->flags & HA_NOSAME ||
-			    ((tab && wsrep_is_FK_index(tab, idx)) ||
+			    ((tab && referenced && wsrep_is_FK_index(tab, idx)) ||
 			     (!tab && referenced_by_foreign_key()))) {
 
-				len = wsrep_store_key_val_for_row(
+				keyval0[0] = (char)i;
+
+				len0 = wsrep_store_key_val_for_row(
 					thd, table, i, key0,
 					WSREP_MAX_SUPPORTED_KEY_LENGTH,
 					record0, &is_null);
 				if (!is_null) {
 					rcode = wsrep_append_key(
 						thd, trx, table_share, table,
-						keyval0, len+1, shared);
+						keyval0, len0+1, shared);
 					if (rcode) DBUG_RETURN(rcode);
 
 					if (key_info->flags & HA_NOSAME || shared)
@@ -9610,15 +9815,19 @@ ha_innobase::wsrep_append_keys(
 						    wsrep_thd_query(thd));
 				}
 				if (record1) {
-					len = wsrep_store_key_val_for_row(
+					keyval1[0] = (char)i;
+
+					len1 = wsrep_store_key_val_for_row(
 						thd, table, i, key1,
 						WSREP_MAX_SUPPORTED_KEY_LENGTH,
 						record1, &is_null);
-					if (!is_null && memcmp(key0, key1, len)) {
+					if (!is_null
+					    && (len0 != len1
+						|| memcmp(key0, key1, len1))) {
 						rcode = wsrep_append_key(
 							thd, trx, table_share,
 							table,
-							keyval1, len+1, shared);
+							keyval1, len1+1, shared);
 						if (rcode) DBUG_RETURN(rcode);
 					}
 				}
@@ -13671,7 +13880,7 @@ ha_innobase::external_lock(
 			/* At low transaction isolation levels we let
 			each consistent read set its own snapshot */
 
-			read_view_close_for_mysql(trx);
+			read_view_close_for_mysql(trx, false);
 		}
 	}
 
@@ -14226,7 +14435,7 @@ ha_innobase::store_lock(
 			/* At low transaction isolation levels we let
 			each consistent read set its own snapshot */
 
-			read_view_close_for_mysql(trx);
+			read_view_close_for_mysql(trx, false);
 		}
 	}
 
@@ -15782,6 +15991,68 @@ innodb_cmp_per_index_update(
 	srv_cmp_per_index_enabled = !!(*(my_bool*) save);
 }
 
+/*************************************************************//**
+Check if it is a valid value of innodb_compression_algorithm. Codecs
+that were not compiled in are rejected. This function is registered
+as a callback with MySQL.
+@return	0 for valid innodb_compression_algorithm */
+static
+int
+innodb_compression_algorithm_validate(
+/*==================================*/
+	THD*				thd,	/*!< in: thread handle */
+	struct st_mysql_sys_var*	var,	/*!< in: pointer to system
+						variable */
+	void*				save,	/*!< out: immediate result
+						for update function */
+	struct st_mysql_value*		value)	/*!< in: incoming string
+						or number */
+{
+	ulint		codec = PAGE_ZIP_CODEC_N;
+	char		buff[STRING_BUFFER_USUAL_SIZE];
+	int		len = sizeof(buff);
+
+	ut_a(save != NULL);
+	ut_a(value != NULL);
+
+	if (value->value_type(value) == MYSQL_VALUE_TYPE_STRING) {
+		const char*	input = value->val_str(value, buff, &len);
+
+		for (ulint i = 0; input != NULL && i < PAGE_ZIP_CODEC_N; i++) {
+			if (!innobase_strcasecmp(
+				    input,
+				    innodb_compression_algorithm_names[i])) {
+				codec = i;
+				break;
+			}
+		}
+	} else {
+		long long	tmp;
+
+		if (!value->val_int(value, &tmp)
+		    && tmp >= 0 && tmp < PAGE_ZIP_CODEC_N) {
+			codec = static_cast<ulint>(tmp);
+		}
+	}
+
+	if (codec == PAGE_ZIP_CODEC_N) {
+		return(1);
+	}
+
+	if (!page_zip_codec_is_available(codec)) {
+		push_warning_printf(thd, Sql_condition::WARN_LEVEL_WARN,
+				    ER_WRONG_ARGUMENTS,
+				    "InnoDB: innodb_compression_algorithm"
+				    " %s is not available in this build.",
+				    innodb_compression_algorithm_names[codec]);
+		return(1);
+	}
+
+	*static_cast<ulong*>(save) = codec;
+
+	return(0);
+}
+
 /****************************************************************//**
 Update the system variable innodb_old_blocks_pct using the "saved"
 value. This function is registered as a callback with MySQL. */
@@ -16984,6 +17255,32 @@ buffer_pool_dump_now(
 	}
 }
 
+/****************************************************************//**
+Update innodb_buffer_pool_dump_interval and wake up the buffer pool
+dump/load thread, so that it notices the new interval. This function is
+registered as a callback with MySQL. */
+static
+void
+buffer_pool_dump_interval_update(
+/*=============================*/
+	THD*				thd	/*!< in: thread handle */
+					MY_ATTRIBUTE((unused)),
+	struct st_mysql_sys_var*	var	/*!< in: pointer to system
+						variable */
+					MY_ATTRIBUTE((unused)),
+	void*				var_ptr	/*!< out: where the formal
+						string goes */
+					MY_ATTRIBUTE((unused)),
+	const void*			save)	/*!< in: immediate result from
+						check function */
+{
+	srv_buffer_pool_dump_interval = *static_cast<const ulong*>(save);
+
+	if (!srv_read_only_mode) {
+		os_event_set(srv_buf_dump_event);
+	}
+}
+
 /****************************************************************//**
 Trigger a load of the buffer pool if innodb_buffer_pool_load_now is set
 to ON. This function is registered as a callback with MySQL. */
@@ -17230,9 +17527,6 @@ wsrep_innobase_kill_one_trx(void * const bf_thd_ptr,
 		break;
 	case QUERY_IDLE:
 	{
-		bool skip_abort= false;
-		wsrep_aborting_thd_t abortees;
-
 		WSREP_DEBUG("kill IDLE for %llu", (long long)victim_trx->id);
 
 		if (wsrep_thd_exec_mode(thd) == REPL_RECV) {
@@ -17246,35 +17540,9 @@ wsrep_innobase_kill_one_trx(void * const bf_thd_ptr,
                 /* This will lock thd from proceeding after net_read() */
 		wsrep_thd_set_conflict_state(thd, ABORTING);
 
-		mysql_mutex_lock(&LOCK_wsrep_rollback);
-
-		abortees = wsrep_aborting_thd;
-		while (abortees && !skip_abort) {
-			/* check if we have a kill message for this already */
-			if (abortees->aborting_thd == thd) {
-				skip_abort = true;
-				WSREP_WARN("duplicate thd aborter %lu", 
-					  wsrep_thd_thread_id(thd));
-			}
-			abortees = abortees->next;
-		}
-		if (!skip_abort) {
-			wsrep_aborting_thd_t aborting = (wsrep_aborting_thd_t)
-				my_malloc(sizeof(struct wsrep_aborting_thd), 
-					  MYF(0));
-			aborting->aborting_thd  = thd;
-			aborting->next          = wsrep_aborting_thd;
-			wsrep_aborting_thd      = aborting;
- 			DBUG_PRINT("wsrep",("enqueuing trx abort for %lu",
-                                             wsrep_thd_thread_id(thd)));
-			WSREP_DEBUG("enqueuing trx abort for (%lu)",
-				    wsrep_thd_thread_id(thd));
-		}
-
-		DBUG_PRINT("wsrep",("signalling wsrep rollbacker"));
-		WSREP_DEBUG("signaling aborter");
-		mysql_cond_signal(&COND_wsrep_rollback);
-		mysql_mutex_unlock(&LOCK_wsrep_rollback);
+		/* victims holding up an applier go to the queue head */
+		wsrep_thd_enqueue_rollback(
+			thd, bf_thd && wsrep_thd_exec_mode(bf_thd) == REPL_RECV);
 
 		break;
 	}
@@ -17329,7 +17597,7 @@ static int innobase_wsrep_set_checkpoint(handlerton* hton, const XID* xid)
                 trx_sysf_t* sys_header = trx_sysf_get(&mtr);
                 trx_sys_update_wsrep_checkpoint(xid, sys_header, &mtr);
                 mtr_commit(&mtr);
-                innobase_flush_logs(hton);
+                innobase_flush_logs(hton, false);
                 return 0;
         } else {
                 return 1;
@@ -17401,6 +17669,12 @@ static MYSQL_SYSVAR_BOOL(doublewrite, innobase_use_doublewrite,
   "Disable with --skip-innodb-doublewrite.",
   NULL, NULL, TRUE);
 
+static MYSQL_SYSVAR_BOOL(parallel_doublewrite, srv_parallel_doublewrite,
+  PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
+  "Doublewrite batch flushes to one file per buffer pool instance and"
+  " flush type, so that they can be written in parallel (on by default).",
+  NULL, NULL, TRUE);
+
 static MYSQL_SYSVAR_BOOL(stats_include_delete_marked,
   srv_stats_include_delete_marked,
   PLUGIN_VAR_OPCMDARG,
@@ -17457,6 +17731,30 @@ static MYSQL_SYSVAR_ULONG(purge_threads, srv_n_purge_threads,
   1,			/* Minimum value */
   32, 0);		/* Maximum value */
 
+static MYSQL_SYSVAR_ULONG(page_cleaners, srv_n_page_cleaners,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Number of page cleaner threads flushing the buffer pool instances in"
+  " parallel, at most innodb_buffer_pool_instances.",
+  NULL, NULL,
+  4,			/* Default setting */
+  1,			/* Minimum value */
+  MAX_BUFFER_POOLS, 0);	/* Maximum value */
+
+static MYSQL_SYSVAR_ULONG(recovery_apply_threads, srv_n_recv_apply_threads,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Number of threads applying redo log records to pages in crash recovery.",
+  NULL, NULL,
+  4,			/* Default setting */
+  1,			/* Minimum value */
+  64, 0);		/* Maximum value */
+
+static MYSQL_SYSVAR_ULONG(recovery_max_memory, srv_recv_max_memory,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Maximum memory in bytes for parsed redo log records in crash recovery"
+  " before they are applied to the pages in a batch."
+  " 0 (the default) means limited by the buffer pool size only.",
+  NULL, NULL, 0, 0, ULONG_MAX, 0);
+
 static MYSQL_SYSVAR_ULONG(sync_array_size, srv_sync_array_size,
   PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
   "Size of the mutex/lock wait array.",
@@ -17465,6 +17763,15 @@ static MYSQL_SYSVAR_ULONG(sync_array_size, srv_sync_array_size,
   1,			/* Minimum value */
   1024, 0);		/* Maximum value */
 
+static MYSQL_SYSVAR_ULONG(lock_sys_partitions, srv_n_lock_sys_partitions,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Number of mutexes protecting the record lock hash table. Rounded up to "
+  "the next power of 2.",
+  NULL, NULL,
+  16,			/* Default setting */
+  1,			/* Minimum value */
+  1024, 0);		/* Maximum value */
+
 static MYSQL_SYSVAR_ULONG(fast_shutdown, innobase_fast_shutdown,
   PLUGIN_VAR_OPCMDARG,
   "Speeds up the shutdown process of the InnoDB storage engine. Possible "
@@ -17653,6 +17960,15 @@ static MYSQL_SYSVAR_BOOL(adaptive_hash_index, btr_search_enabled,
   "Disable with --skip-innodb-adaptive-hash-index.",
   NULL, innodb_adaptive_hash_index_update, TRUE);
 
+static MYSQL_SYSVAR_ULONG(adaptive_hash_index_parts, btr_ahi_parts,
+  PLUGIN_VAR_OPCMDARG | PLUGIN_VAR_READONLY,
+  "Number of partitions of the InnoDB adaptive hash index, each with its "
+  "own latch. Indexes are mapped to partitions by index id.",
+  NULL, NULL,
+  8,			/* Default setting */
+  1,			/* Minimum value */
+  BTR_SEARCH_MAX_PARTS, 0);	/* Maximum value */
+
 static MYSQL_SYSVAR_ULONG(replication_delay, srv_replication_delay,
   PLUGIN_VAR_RQCMDARG,
   "Replication thread delay (ms) on the slave server if "
@@ -17665,6 +17981,14 @@ static MYSQL_SYSVAR_UINT(compression_level, page_zip_level,
   ", 1 is fastest, 9 is best compression and default is 6.",
   NULL, NULL, DEFAULT_COMPRESSION_LEVEL, 0, 9, 0);
 
+static MYSQL_SYSVAR_ENUM(compression_algorithm, page_zip_codec,
+  PLUGIN_VAR_RQCMDARG,
+  "Codec used for compressing pages of ROW_FORMAT=COMPRESSED tables:"
+  " zlib (the default), lz4 or zstd, if compiled in. Each page records"
+  " its codec, so that pages compressed with another codec remain readable.",
+  innodb_compression_algorithm_validate, NULL, PAGE_ZIP_CODEC_ZLIB,
+  &innodb_compression_algorithm_typelib);
+
 static MYSQL_SYSVAR_BOOL(log_compressed_pages, page_zip_log_pages,
        PLUGIN_VAR_OPCMDARG,
   "Enables/disables the logging of entire compressed page images."
@@ -17724,6 +18048,16 @@ static MYSQL_SYSVAR_BOOL(buffer_pool_dump_at_shutdown, srv_buffer_pool_dump_at_s
   "Dump the buffer pool into a file named @@innodb_buffer_pool_filename",
   NULL, NULL, FALSE);
 
+static MYSQL_SYSVAR_BOOL(buffer_pool_dump_binary, srv_buffer_pool_dump_binary,
+  PLUGIN_VAR_RQCMDARG,
+  "Dump the buffer pool in a compact binary format that periodic dumps can append to. Loads accept either format",
+  NULL, NULL, FALSE);
+
+static MYSQL_SYSVAR_ULONG(buffer_pool_dump_interval, srv_buffer_pool_dump_interval,
+  PLUGIN_VAR_RQCMDARG,
+  "Dump the buffer pool every this many seconds, 0 disables the periodic dumps. With @@innodb_buffer_pool_dump_binary a periodic dump only appends the changes since the previous dump",
+  NULL, buffer_pool_dump_interval_update, 0, 0, 86400, 0);
+
 #ifdef UNIV_DEBUG
 static MYSQL_SYSVAR_STR(buffer_pool_evict, srv_buffer_pool_evict,
   PLUGIN_VAR_RQCMDARG,
@@ -17832,6 +18166,18 @@ static MYSQL_SYSVAR_ULONG(sort_buffer_size, srv_sort_buf_size,
   "Memory buffer size for index creation",
   NULL, NULL, 1048576, 65536, 64<<20, 0);
 
+static MYSQL_SYSVAR_ULONG(merge_sort_ways, srv_merge_sort_ways,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of sorted runs merged at a time in index creation. Each merge"
+  " thread uses one innodb_sort_buffer_size buffer per run and one for"
+  " the output.",
+  NULL, NULL, 8, 2, 64, 0);
+
+static MYSQL_SYSVAR_ULONG(merge_sort_threads, srv_merge_sort_threads,
+  PLUGIN_VAR_RQCMDARG,
+  "Number of threads sorting the records in memory and merging sorted runs in index creation.",
+  NULL, NULL, 4, 1, 64, 0);
+
 static MYSQL_SYSVAR_ULONGLONG(online_alter_log_max_size, srv_online_max_size,
   PLUGIN_VAR_RQCMDARG,
   "Maximum modification log file size for online index creation",
@@ -17875,6 +18221,12 @@ static MYSQL_SYSVAR_LONG(log_buffer_size, innobase_log_buffer_size,
   "The size of the buffer which InnoDB uses to write log to the log files on disk.",
   NULL, NULL, 8*1024*1024L, 256*1024L, LONG_MAX, 1024);
 
+static MYSQL_SYSVAR_BOOL(log_writer_threads, srv_log_writer_threads,
+  PLUGIN_VAR_NOCMDARG | PLUGIN_VAR_READONLY,
+  "Write and flush the log in dedicated background threads, which"
+  " committing transactions wait for (on by default).",
+  NULL, NULL, TRUE);
+
 static MYSQL_SYSVAR_LONGLONG(log_file_size, innobase_log_file_size,
   PLUGIN_VAR_RQCMDARG | PLUGIN_VAR_READONLY,
   "Size of each log file in a log group.",
@@ -18163,6 +18515,12 @@ static MYSQL_SYSVAR_BOOL(print_all_deadlocks, srv_print_all_deadlocks,
   "Print all deadlocks to MySQL error log (off by default)",
   NULL, NULL, FALSE);
 
+static MYSQL_SYSVAR_ULONG(deadlock_detect_interval,
+  srv_deadlock_detect_interval, PLUGIN_VAR_OPCMDARG,
+  "Milliseconds between deadlock searches of a background thread."
+  " 0 (the default) checks every lock wait for deadlocks when it starts.",
+  NULL, NULL, 0, 0, 10000, 0);
+
 static MYSQL_SYSVAR_ULONG(compression_failure_threshold_pct,
   zip_failure_threshold_pct, PLUGIN_VAR_OPCMDARG,
   "If the compression failure rate of a table is greater than this number"
@@ -18226,6 +18584,8 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(buffer_pool_filename),
   MYSQL_SYSVAR(buffer_pool_dump_now),
   MYSQL_SYSVAR(buffer_pool_dump_at_shutdown),
+  MYSQL_SYSVAR(buffer_pool_dump_binary),
+  MYSQL_SYSVAR(buffer_pool_dump_interval),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(buffer_pool_evict),
 #endif /* UNIV_DEBUG */
@@ -18239,9 +18599,11 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(commit_concurrency),
   MYSQL_SYSVAR(concurrency_tickets),
   MYSQL_SYSVAR(compression_level),
+  MYSQL_SYSVAR(compression_algorithm),
   MYSQL_SYSVAR(data_file_path),
   MYSQL_SYSVAR(data_home_dir),
   MYSQL_SYSVAR(doublewrite),
+  MYSQL_SYSVAR(parallel_doublewrite),
   MYSQL_SYSVAR(stats_include_delete_marked),
   MYSQL_SYSVAR(api_enable_binlog),
   MYSQL_SYSVAR(api_enable_mdl),
@@ -18279,6 +18641,7 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
 #endif /* UNIV_LOG_ARCHIVE */
   MYSQL_SYSVAR(page_size),
   MYSQL_SYSVAR(log_buffer_size),
+  MYSQL_SYSVAR(log_writer_threads),
   MYSQL_SYSVAR(log_file_size),
   MYSQL_SYSVAR(log_files_in_group),
   MYSQL_SYSVAR(log_group_home_dir),
@@ -18308,12 +18671,15 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(stats_persistent_sample_pages),
   MYSQL_SYSVAR(stats_auto_recalc),
   MYSQL_SYSVAR(adaptive_hash_index),
+  MYSQL_SYSVAR(adaptive_hash_index_parts),
   MYSQL_SYSVAR(stats_method),
   MYSQL_SYSVAR(replication_delay),
   MYSQL_SYSVAR(status_file),
   MYSQL_SYSVAR(strict_mode),
   MYSQL_SYSVAR(support_xa),
   MYSQL_SYSVAR(sort_buffer_size),
+  MYSQL_SYSVAR(merge_sort_ways),
+  MYSQL_SYSVAR(merge_sort_threads),
   MYSQL_SYSVAR(online_alter_log_max_size),
   MYSQL_SYSVAR(sync_spin_loops),
   MYSQL_SYSVAR(spin_wait_delay),
@@ -18349,6 +18715,9 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(monitor_reset),
   MYSQL_SYSVAR(monitor_reset_all),
   MYSQL_SYSVAR(purge_threads),
+  MYSQL_SYSVAR(page_cleaners),
+  MYSQL_SYSVAR(recovery_apply_threads),
+  MYSQL_SYSVAR(recovery_max_memory),
   MYSQL_SYSVAR(purge_batch_size),
 #ifdef UNIV_DEBUG
   MYSQL_SYSVAR(purge_run_now),
@@ -18363,12 +18732,14 @@ static struct st_mysql_sys_var* innobase_system_variables[]= {
   MYSQL_SYSVAR(status_output),
   MYSQL_SYSVAR(status_output_locks),
   MYSQL_SYSVAR(print_all_deadlocks),
+  MYSQL_SYSVAR(deadlock_detect_interval),
   MYSQL_SYSVAR(cmp_per_index_enabled),
   MYSQL_SYSVAR(undo_logs),
   MYSQL_SYSVAR(rollback_segments),
   MYSQL_SYSVAR(undo_directory),
   MYSQL_SYSVAR(undo_tablespaces),
   MYSQL_SYSVAR(sync_array_size),
+  MYSQL_SYSVAR(lock_sys_partitions),
   MYSQL_SYSVAR(compression_failure_threshold_pct),
   MYSQL_SYSVAR(compression_pad_pct_max),
 #ifdef UNIV_DEBUG
@@ -96,6 +96,17 @@ class ha_innobase: public handler
 	dict_index_t* innobase_get_index(uint keynr);
 
 #ifdef WITH_WSREP
+	bool		wsrep_key_plan_built;
+					/*!< true if the certification key
+					plan below is up to date */
+	bool		wsrep_key_plan_unique;
+					/*!< table has a primary or a
+					unique key */
+	dict_index_t*	wsrep_key_plan_index[MAX_KEY];
+					/*!< InnoDB index of each MySQL
+					key */
+
+	void wsrep_build_key_plan();
 	int wsrep_append_keys(THD *thd, bool shared,
 				  const uchar* record0, const uchar* record1);
 #endif
@@ -479,6 +490,7 @@ extern "C" char * wsrep_thd_query(THD *thd);
 extern "C" query_id_t wsrep_thd_wsrep_last_query_id(THD *thd);
 extern "C" void wsrep_thd_set_wsrep_last_query_id(THD *thd, query_id_t id);
 extern "C" void wsrep_thd_awake(THD *thd, my_bool signal);
+extern "C" void wsrep_thd_enqueue_rollback(THD *thd, my_bool priority);
 #endif
 struct trx_t;
 
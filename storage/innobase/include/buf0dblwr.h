@@ -59,6 +59,25 @@ buf_dblwr_init_or_load_pages(
 	char*		path,
 	bool		load_corrupt_pages);
 
+/****************************************************************//**
+Frees the copies of pages that buf_dblwr_init_or_load_pages() read from
+the doublewrite files. Must be called once crash recovery no longer
+needs recv_sys->dblwr. */
+UNIV_INTERN
+void
+buf_dblwr_free_loaded_pages(void);
+/*=============================*/
+
+/****************************************************************//**
+Cleans up the doublewrite files once crash recovery no longer needs them:
+removes the files that the current number of buffer pool instances does
+not use and marks the others empty. Stores the identity stamped to the
+files in the trx sys page if it was assigned at this startup. */
+UNIV_INTERN
+void
+buf_dblwr_reset_files(void);
+/*=======================*/
+
 /****************************************************************//**
 Process the double write buffer pages. */
 void
@@ -102,11 +121,16 @@ Flushes possible buffered writes from the doublewrite memory buffer to disk,
 and also wakes up the aio thread if simulated aio is used. It is very
 important to call this function after a batch of writes has been posted,
 and also when we may have to wait for a page latch! Otherwise a deadlock
-of threads can occur. */
+of threads can occur. When the doublewrite files are used, only the batch
+of the given buffer pool instance and flush type is written. */
 UNIV_INTERN
 void
-buf_dblwr_flush_buffered_writes(void);
-/*=================================*/
+buf_dblwr_flush_buffered_writes(
+/*============================*/
+	const buf_pool_t*	buf_pool,	/*!< in: buffer pool instance
+						whose batch to write */
+	buf_flush_t		flush_type);	/*!< in: BUF_FLUSH_LRU or
+						BUF_FLUSH_LIST */
 /********************************************************************//**
 Writes a page to the doublewrite buffer on disk, sync it, then write
 the page to the datafile and sync the datafile. This function is used
@@ -122,6 +146,30 @@ buf_dblwr_write_single_page(
 	buf_page_t*	bpage,	/*!< in: buffer block to write */
 	bool		sync);	/*!< in: true if sync IO requested */
 
+/** Batch area of the doublewrite buffer that serves one buffer pool
+instance and one flush type. Each partition lives in a file of its own
+so that the page cleaners of different instances can write and sync
+their batches in parallel. */
+struct buf_dblwr_part_t{
+	ib_mutex_t	mutex;	/*!< mutex protecting the fields below */
+	char*		path;	/*!< path of the doublewrite file */
+	pfs_os_file_t	file;	/*!< handle of the doublewrite file */
+	ulint		first_free;/*!< first free position in write_buf
+				measured in units of UNIV_PAGE_SIZE */
+	ulint		b_reserved;/*!< number of slots currently reserved
+				for the batch */
+	os_event_t	b_event;/*!< event where threads wait for the
+				batch of this partition to end */
+	bool		batch_running;/*!< set to true if currently a batch
+				is being written from this partition */
+	byte*		write_buf;/*!< write buffer of the header page
+				and srv_doublewrite_batch_size pages,
+				aligned to UNIV_PAGE_SIZE */
+	byte*		write_buf_unaligned;/*!< pointer to write_buf,
+				but unaligned */
+	buf_page_t**	buf_block_arr;/*!< blocks cached to write_buf */
+};
+
 /** Doublewrite control struct */
 struct buf_dblwr_t{
 	ib_mutex_t	mutex;	/*!< mutex protecting the first_free
@@ -154,6 +202,20 @@ struct buf_dblwr_t{
 	buf_page_t**	buf_block_arr;/*!< array to store pointers to
 				the buffer blocks which have been
 				cached to write_buf */
+	ulint		n_parts;/*!< number of batch partitions, or 0
+				if batches go to block1 and block2 of
+				the system tablespace */
+	buf_dblwr_part_t* parts;/*!< batch partitions, indexed by
+				buf_dblwr_part_no() */
+	ib_uint64_t	files_id;/*!< identity of the system tablespace,
+				stamped to the doublewrite files */
+	byte*		loaded_buf;/*!< unaligned buffer holding the
+				pages read from the doublewrite files at
+				startup, or NULL */
+	ulint		n_loaded;/*!< number of pages in loaded_buf */
+	lsn_t*		loaded_checkpoint_lsn;/*!< checkpoint lsn
+				stamped to the file of each page in
+				loaded_buf */
 };
 
 
@@ -175,7 +175,8 @@ buf_flush_ready_for_replace(
 				buf_page_in_file(bpage) and in the LRU list */
 /******************************************************************//**
 page_cleaner thread tasked with flushing dirty pages from the buffer
-pools. As of now we'll have only one instance of this thread.
+pools. It decides what to flush and flushes the buffer pool instances
+together with the buf_flush_page_cleaner_worker threads.
 @return a dummy parameter */
 extern "C" UNIV_INTERN
 os_thread_ret_t
@@ -183,6 +184,26 @@ DECLARE_THREAD(buf_flush_page_cleaner_thread)(
 /*==========================================*/
 	void*	arg);		/*!< in: a dummy parameter required by
 				os_thread_create */
+/******************************************************************//**
+Worker thread of the page cleaner: flushes buffer pool instances in the
+rounds requested by buf_flush_page_cleaner_thread.
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(buf_flush_page_cleaner_worker)(
+/*==========================================*/
+	void*	arg);		/*!< in: a dummy parameter required by
+				os_thread_create */
+/******************************************************************//**
+Creates the state shared by the page cleaner threads. Must be called
+before buf_flush_page_cleaner_thread and the worker threads are created. */
+UNIV_INTERN
+void
+buf_flush_page_cleaner_init(
+/*========================*/
+	ulint	n_workers);	/*!< in: number of
+				buf_flush_page_cleaner_worker threads
+				that will be created */
 /*********************************************************************//**
 Clears up tail of the LRU lists:
 * Put replaceable pages at the tail of LRU to the free list
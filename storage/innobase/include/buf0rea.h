@@ -55,6 +55,21 @@ buf_read_page_async(
 	ulint	space,	/*!< in: space id */
 	ulint	offset);/*!< in: page number */
 /********************************************************************//**
+Issues asynchronous read requests for a batch of pages of one tablespace
+that a buffer pool load wants to read in. Unlike buf_read_page_async(),
+this does not wait for the reads to complete, so that the i/o handler
+threads can serve the batch in parallel.
+@return	number of page read requests issued */
+UNIV_INTERN
+ulint
+buf_read_load_pages(
+/*================*/
+	ulint		space,		/*!< in: space id */
+	const ulint*	page_nos,	/*!< in: array of page numbers
+					to read */
+	ulint		n_stored);	/*!< in: number of elements
+					in the array */
+/********************************************************************//**
 Applies a random read-ahead in buf_pool if there are at least a threshold
 value of accessed pages from the random read-ahead area. Does not read any
 page, not even the one at the position (space, offset), if the read-ahead
@@ -616,6 +616,11 @@ struct dict_index_t{
 			indexes;/*!< list of indexes of the table */
 	btr_search_t*	search_info;
 				/*!< info used in optimistic searches */
+	bool		disable_ahi;
+				/*!< true if no new adaptive hash index
+				entries should be built for this index;
+				set from the index comment when the
+				table is opened */
 	row_log_t*	online_log;
 				/*!< the log of modifications
 				during online index creation;
@@ -1206,7 +1211,9 @@ struct dict_table_t{
 				/*!< Count of the number of record locks on
 				this table. We use this to determine whether
 				we can evict the table from the dictionary
-				cache. It is protected by lock_sys->mutex. */
+				cache. It is protected by lock_sys->mutex,
+				it is incremented atomically under a
+				lock_sys->rec_hash partition mutex. */
 	ulint		n_ref_count;
 				/*!< count of how many handles are opened
 				to this table; dropping of the table is
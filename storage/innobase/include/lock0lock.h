@@ -758,6 +758,26 @@ DECLARE_THREAD(lock_wait_timeout_thread)(
 	void*	arg);	/*!< in: a dummy parameter required by
 			os_thread_create */
 
+/*********************************************************************//**
+A thread which periodically searches the lock waits for deadlocks when
+innodb_deadlock_detect_interval is set.
+@return	a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(lock_deadlock_thread)(
+/*=================================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+
+/*********************************************************************//**
+Searches the waits-for graph of the suspended transactions for cycles,
+starting from the lock waits that were enqueued without a deadlock check,
+and resolves the deadlocks found by rolling back a victim in each. */
+UNIV_INTERN
+void
+lock_deadlock_check_waits(void);
+/*===========================*/
+
 /********************************************************************//**
 Releases a user OS thread waiting for a lock to be released, if the
 thread is already suspended. */
@@ -911,8 +931,18 @@ struct lock_op_t{
 struct lock_sys_t{
 	ib_mutex_t	mutex;			/*!< Mutex protecting the
 						locks */
+	rw_lock_t	latch;			/*!< X-latched together with
+						the above mutex; S-latched
+						by the threads which access
+						a single page through its
+						rec_hash partition mutex */
 	hash_table_t*	rec_hash;		/*!< hash table of the record
-						locks */
+						locks; the record lock queue
+						of a page is protected by
+						either the above mutex or
+						the S-latch and the rec_hash
+						partition mutex of the page,
+						see lock_rec_mutex_own() */
 	ib_mutex_t	wait_mutex;		/*!< Mutex protecting the
 						next two fields */
 	srv_slot_t*	waiting_threads;	/*!< Array  of user threads
@@ -938,27 +968,50 @@ struct lock_sys_t{
 
 	bool		timeout_thread_active;	/*!< True if the timeout thread
 						is running */
+
+	os_event_t	deadlock_event;		/*!< Set to wake up
+						lock_deadlock_thread at
+						shutdown */
+
+	bool		deadlock_thread_active;	/*!< True if the deadlock
+						thread is running */
 };
 
 /** The lock system */
 extern lock_sys_t*	lock_sys;
 
-/** Test if lock_sys->mutex can be acquired without waiting. */
-#define lock_mutex_enter_nowait() mutex_enter_nowait(&lock_sys->mutex)
+/** Test if lock_sys->mutex can be acquired without waiting.
+On success lock_sys->latch is X-latched as well. */
+#define lock_mutex_enter_nowait()				\
+	(mutex_enter_nowait(&lock_sys->mutex)			\
+	 || (!rw_lock_x_lock_nowait(&lock_sys->latch)		\
+	     && (mutex_exit(&lock_sys->mutex), 1)))
 
 /** Test if lock_sys->mutex is owned. */
 #define lock_mutex_own() mutex_own(&lock_sys->mutex)
 
-/** Acquire the lock_sys->mutex. */
+/** Acquire the lock_sys->mutex. The X-latch on lock_sys->latch excludes
+all the threads which are operating on a single lock_sys->rec_hash
+partition, thus the owner may access any record lock queue. */
 #define lock_mutex_enter() do {			\
 	mutex_enter(&lock_sys->mutex);		\
+	rw_lock_x_lock(&lock_sys->latch);	\
 } while (0)
 
 /** Release the lock_sys->mutex. */
 #define lock_mutex_exit() do {			\
+	rw_lock_x_unlock(&lock_sys->latch);	\
 	mutex_exit(&lock_sys->mutex);		\
 } while (0)
 
+/** Test if the record lock queue of a page may be accessed, that is,
+if either lock_sys->mutex or the lock_sys->rec_hash partition mutex of
+the page is owned. */
+#define lock_rec_mutex_own(space, page_no)			\
+	(lock_mutex_own()					\
+	 || mutex_own(hash_get_mutex(lock_sys->rec_hash,	\
+				     lock_rec_fold(space, page_no))))
+
 /** Test if lock_sys->wait_mutex is owned. */
 #define lock_wait_mutex_own() mutex_own(&lock_sys->wait_mutex)
 
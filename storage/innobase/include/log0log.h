@@ -89,16 +89,19 @@ log_calc_where_lsn_is(
 						(including the header) */
 #ifndef UNIV_HOTBACKUP
 /************************************************************//**
-Writes to the log the string given. The log must be released with
-log_release.
+Reserves space for the string given in the log buffer, if it fits within
+the current log block. The log must be released with log_release, and the
+string copied to the reserved space with log_buffer_write(), after which
+the lsn range of the string must be passed to log_buffer_link().
 @return	end lsn of the log record, zero if did not succeed */
 UNIV_INLINE
 lsn_t
-log_reserve_and_write_fast(
-/*=======================*/
+log_reserve_fast(
+/*=============*/
 	const void*	str,	/*!< in: string */
 	ulint		len,	/*!< in: string length */
-	lsn_t*		start_lsn);/*!< out: start lsn of the log record */
+	lsn_t*		start_lsn,/*!< out: start lsn of the log record */
+	byte**		ptr);	/*!< out: where to copy the string */
 /***********************************************************************//**
 Releases the log mutex. */
 UNIV_INLINE
@@ -124,6 +127,60 @@ log_reserve_and_open(
 /*=================*/
 	ulint	len);	/*!< in: length of data to be catenated */
 /************************************************************//**
+Reserves space for the string given in the log buffer, advancing the lsn
+and initializing the headers of the log blocks the string spans. The string
+must be copied to the reserved space with log_buffer_write(), after which
+the reserved lsn range must be passed to log_buffer_link(). It is assumed
+that the caller holds the log mutex and has checked
+log_buffer_can_reserve().
+@return	pointer to the start of the reserved space */
+UNIV_INTERN
+byte*
+log_buffer_reserve(
+/*===============*/
+	ulint	str_len);	/*!< in: string length */
+/************************************************************//**
+Copies the string given to space reserved with log_buffer_reserve() or
+log_reserve_fast(), skipping the log block headers and trailers. The caller
+does not need to hold the log mutex.
+@return	pointer to the end of the copied string */
+UNIV_INTERN
+byte*
+log_buffer_write(
+/*=============*/
+	byte*		ptr,	/*!< in: where to copy the string */
+	const byte*	str,	/*!< in: string */
+	ulint		str_len);/*!< in: string length */
+/************************************************************//**
+Marks an lsn range reserved in the log buffer as copied to. The log
+records below log_sys->buf_ready_lsn may be written to the log files once
+all the ranges below it have been linked. The caller does not need to hold
+the log mutex if atomic builtins are available. */
+UNIV_INTERN
+void
+log_buffer_link(
+/*============*/
+	lsn_t	start_lsn,	/*!< in: start lsn of the range */
+	lsn_t	end_lsn);	/*!< in: end lsn of the range */
+/************************************************************//**
+Checks if space can be reserved in the log buffer, that is, if log_sys->lsn
+is less than LOG_RECENT_WRITTEN_SIZE bytes ahead of log_sys->buf_ready_lsn.
+The caller must hold the log mutex.
+@return	true if log_buffer_reserve() may be called */
+UNIV_INTERN
+bool
+log_buffer_can_reserve(void);
+/*========================*/
+/************************************************************//**
+Waits until all the mini-transactions that have reserved space in the log
+buffer have copied their log records to it. The mini-transactions do not
+need the log mutex for that, which the caller must hold.
+@return	log_sys->lsn, up to which the log buffer is complete */
+UNIV_INTERN
+lsn_t
+log_buffer_wait_ready(void);
+/*=======================*/
+/************************************************************//**
 Writes to the log the string given. It is assumed that the caller holds the
 log mutex. */
 UNIV_INTERN
@@ -195,8 +252,10 @@ log_io_complete(
 /******************************************************//**
 This function is called, e.g., when a transaction wants to commit. It checks
 that the log has been written to the log file up to the last log entry written
-by the transaction. If there is a flush running, it waits and checks if the
-flush flushed enough. If not, starts a new flush. */
+by the transaction. If log_writer_thread and log_flusher_thread are running,
+it wakes them up and waits until they have written or flushed enough.
+Otherwise, if there is a flush running, it waits and checks if the flush
+flushed enough. If not, starts a new flush. */
 UNIV_INTERN
 void
 log_write_up_to(
@@ -208,12 +267,36 @@ log_write_up_to(
 	ibool	flush_to_disk);
 			/*!< in: TRUE if we want the written log
 			also to be flushed to disk */
+/******************************************************************//**
+The log writer thread: writes the log buffer to the log files when
+log_write_up_to() asks for it, and passes the written lsn to
+log_flusher_thread when a flush to disk has been requested.
+@return	a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_writer_thread)(
+/*==============================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
+/******************************************************************//**
+The log flusher thread: flushes the log files to disk up to the lsn
+written by log_writer_thread, while log_writer_thread may already write
+the next batch of log records.
+@return	a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_flusher_thread)(
+/*===============================*/
+	void*	arg);	/*!< in: a dummy parameter required by
+			os_thread_create */
 /****************************************************************//**
-Does a syncronous flush of the log buffer to disk. */
+Writes the log buffer to the log files and, unless sync is false, waits
+for it to be flushed to disk. */
 UNIV_INTERN
 void
-log_buffer_flush_to_disk(void);
-/*==========================*/
+log_buffer_flush_to_disk(
+/*=====================*/
+	bool	sync = true);	/*!< in: whether to flush the log files */
 /****************************************************************//**
 This functions writes the log buffer to the log file and if 'flush'
 is set it forces a flush of the log file as well. This is meant to be
@@ -574,6 +657,16 @@ extern log_t*	log_sys;
 /* The counting of lsn's starts from this value: this must be non-zero */
 #define LOG_START_LSN		((lsn_t) (16 * OS_FILE_LOG_BLOCK_SIZE))
 
+/** Number of slots in log_sys->recent_written. Space can be reserved in
+the log buffer only if log_sys->lsn is less than this many bytes ahead of
+log_sys->buf_ready_lsn. */
+#define LOG_RECENT_WRITTEN_SIZE	(64 * 1024)
+
+/** Number of events in log_sys->write_events and log_sys->flush_events.
+A thread waiting for the log to be written or flushed up to an lsn waits
+on the event of the log block of the lsn modulo this. */
+#define LOG_N_WAIT_EVENTS	64
+
 #define LOG_BUFFER_SIZE		(srv_log_buffer_size * UNIV_PAGE_SIZE)
 #define LOG_ARCHIVE_BUF_SIZE	(srv_log_buffer_size * UNIV_PAGE_SIZE / 4)
 
@@ -819,6 +912,17 @@ struct log_t{
 					groups */
 	volatile bool	is_extending;	/*!< this is set to true during extend
 					the log buffer size */
+	volatile ulint*	recent_written;	/*!< the lsn ranges that have been
+					reserved in the log buffer and to
+					which the log records have been
+					copied: the slot of the start lsn of
+					a range modulo LOG_RECENT_WRITTEN_SIZE
+					holds the length of the range, until
+					buf_ready_lsn passes the range */
+	lsn_t		buf_ready_lsn;	/*!< all the log records below this
+					lsn have been copied to the log
+					buffer; advanced over the ranges in
+					recent_written under the log mutex */
 	lsn_t		written_to_some_lsn;
 					/*!< first log sequence number not yet
 					written to any log group; for this to
@@ -878,6 +982,42 @@ struct log_t{
 					but NOTE that to set or reset this
 					event, the thread MUST own the log
 					mutex! */
+	/** Fields used by log_writer_thread and log_flusher_thread @{ */
+	os_event_t	writer_event;	/*!< set to wake up log_writer_thread
+					after a write has been requested */
+	os_event_t	flusher_event;	/*!< set by log_writer_thread to
+					wake up log_flusher_thread */
+	bool		writer_thread_active;
+					/*!< true if log_writer_thread is
+					running and log_write_up_to()
+					leaves the log writes to it */
+	bool		flusher_thread_active;
+					/*!< true if log_flusher_thread is
+					running and log_write_up_to()
+					leaves the log flushes to it */
+	ulint		n_flush_requests;
+					/*!< number of flushes to disk
+					requested from log_writer_thread;
+					incremented atomically, or under
+					the log mutex without atomic
+					builtins */
+	lsn_t		flush_target_lsn;
+					/*!< log_flusher_thread flushes the
+					log to disk up to this lsn; only
+					written by log_writer_thread, after
+					the log has been written up to it */
+	os_event_t	write_events[LOG_N_WAIT_EVENTS];
+					/*!< a thread waiting for the log to
+					be written up to an lsn waits on
+					write_events[(lsn / block size) %
+					LOG_N_WAIT_EVENTS]; log_writer_thread
+					sets the events of the log blocks
+					that it has written */
+	os_event_t	flush_events[LOG_N_WAIT_EVENTS];
+					/*!< the same as write_events, for
+					the threads waiting for the log to
+					be flushed to disk */
+	/* @} */
 	ulint		n_log_ios;	/*!< number of log i/os initiated thus
 					far */
 	ulint		n_log_ios_old;	/*!< number of log i/o's at the
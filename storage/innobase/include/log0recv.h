@@ -329,9 +329,11 @@ struct recv_data_t{
 /** Stored log record struct */
 struct recv_t{
 	byte		type;	/*!< log record type */
-	ulint		len;	/*!< log record body length in bytes */
-	recv_data_t*	data;	/*!< chain of blocks containing the log record
-				body */
+	ib_uint32_t	len;	/*!< log record body length in bytes */
+	recv_data_t*	data;	/*!< chain of blocks containing the part of
+				the log record body that did not fit
+				immediately after this struct, see
+				RECV_DATA_INLINE_SIZE */
 	lsn_t		start_lsn;/*!< start lsn of the log segment written by
 				the mtr which generated this log record: NOTE
 				that this is not necessarily the start lsn of
@@ -444,6 +446,13 @@ struct recv_sys_t{
 	hash_table_t*	addr_hash;/*!< hash table of file addresses of pages */
 	ulint		n_addrs;/*!< number of not processed hashed file
 				addresses in the hash table */
+	ulint		n_apply_threads;
+				/*!< number of threads applying the
+				current batch of log records */
+	ulint		n_apply_threads_active;
+				/*!< number of recv_apply_thread
+				instances that have not yet applied their
+				share of the current batch */
 
 	recv_dblwr_t	dblwr;
 };
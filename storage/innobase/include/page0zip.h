@@ -46,6 +46,25 @@ extern uint	page_zip_level;
 /* Default compression level. */
 #define DEFAULT_COMPRESSION_LEVEL	6
 
+/** Codecs for compressing the payload of compressed pages */
+enum page_zip_codec_t {
+	PAGE_ZIP_CODEC_ZLIB = 0,	/*!< zlib deflate, the original
+					format */
+	PAGE_ZIP_CODEC_LZ4,		/*!< LZ4 */
+	PAGE_ZIP_CODEC_ZSTD,		/*!< Zstandard */
+	PAGE_ZIP_CODEC_N		/*!< number of codecs */
+};
+
+/* Codec to be used for compressing pages. Settable by user. */
+extern ulong	page_zip_codec;
+
+/** The compression level that is passed to page_zip_compress() and
+written to the redo log carries the codec in the bits above
+PAGE_ZIP_LEVEL_MASK.  The codec of the original format is 0. */
+#define PAGE_ZIP_CODEC_SHIFT		4
+/** Mask of the zlib compression level */
+#define PAGE_ZIP_LEVEL_MASK		((1 << PAGE_ZIP_CODEC_SHIFT) - 1)
+
 /* Whether or not to log compressed page images to avoid possible
 compression algorithm changes in zlib. */
 extern my_bool	page_zip_log_pages;
@@ -104,6 +123,24 @@ page_zip_des_init(
 	page_zip_des_t*	page_zip);	/*!< in/out: compressed page
 					descriptor */
 
+/**********************************************************************//**
+Determine the compression level and codec for compressing pages.
+@return	page_zip_level combined with page_zip_codec */
+UNIV_INLINE
+ulint
+page_zip_get_level(void);
+/*====================*/
+
+/**********************************************************************//**
+Determine if a codec was compiled in.
+@return	true if pages can be compressed and decompressed with the codec */
+UNIV_INTERN
+bool
+page_zip_codec_is_available(
+/*========================*/
+	ulint	codec)	/*!< in: codec, PAGE_ZIP_CODEC_ZLIB, ... */
+	MY_ATTRIBUTE((const));
+
 /**********************************************************************//**
 Configure the zlib allocator to use the given memory heap. */
 UNIV_INTERN
@@ -125,7 +162,8 @@ page_zip_compress(
 				m_start, m_end, m_nonempty */
 	const page_t*	page,	/*!< in: uncompressed page */
 	dict_index_t*	index,	/*!< in: index of the B-tree node */
-	ulint		level,	/*!< in: compression level */
+	ulint		level,	/*!< in: compression level and codec,
+				see page_zip_get_level() */
 	mtr_t*		mtr)	/*!< in: mini-transaction, or NULL */
 	MY_ATTRIBUTE((nonnull(1,2,3)));
 
@@ -480,7 +518,7 @@ UNIV_INLINE
 void
 page_zip_compress_write_log_no_data(
 /*================================*/
-	ulint		level,	/*!< in: compression level */
+	ulint		level,	/*!< in: compression level and codec */
 	const page_t*	page,	/*!< in: page that is compressed */
 	dict_index_t*	index,	/*!< in: index */
 	mtr_t*		mtr);	/*!< in: mtr */
@@ -35,17 +35,18 @@ Created 2/16/1997 Heikki Tuuri
 #include "read0types.h"
 
 /*********************************************************************//**
-Opens a read view where exactly the transactions serialized before this
-point in time are seen in the view.
-@return	own: read view struct */
+Opens a read view for a MySQL transaction where exactly the transactions
+serialized before this point in time are seen in the view. The memory of
+the previous view of the transaction is reused if it is large enough. A
+closed view of an auto-commit non-locking transaction is reused as is,
+without acquiring trx_sys->mutex, if no read-write transaction has been
+started, serialised or committed since it was created.
+@return	read view struct */
 UNIV_INTERN
 read_view_t*
-read_view_open_now(
-/*===============*/
-	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
-					transaction, or 0 used in purge */
-	mem_heap_t*	heap);		/*!< in: memory heap from which
-					allocated */
+read_view_open_for_mysql(
+/*=====================*/
+	trx_t*		trx);	/*!< in/out: transaction */
 /*********************************************************************//**
 Makes a copy of the oldest existing read view, or opens a new. The view
 must be closed with ..._close.
@@ -67,12 +68,25 @@ read_view_remove(
 					trx_sys_t::mutex */
 /*********************************************************************//**
 Closes a consistent read view for MySQL. This function is called at an SQL
-statement end if the trx isolation level is <= TRX_ISO_READ_COMMITTED. */
+statement end if the trx isolation level is <= TRX_ISO_READ_COMMITTED and
+at transaction commit. The memory of the view is kept for the next view of
+the transaction. The view of an auto-commit non-locking transaction is left
+in trx_sys->view_list, marked closed. */
 UNIV_INTERN
 void
 read_view_close_for_mysql(
 /*======================*/
-	trx_t*	trx);	/*!< in: trx which has a read view */
+	trx_t*		trx,		/*!< in: trx which has a read view */
+	bool		own_mutex);	/*!< in: true if caller owns the
+					trx_sys_t::mutex */
+/*********************************************************************//**
+Frees the cached read view of a MySQL transaction, removing it from
+trx_sys->view_list if it is still there. */
+UNIV_INTERN
+void
+read_view_free_for_mysql(
+/*=====================*/
+	trx_t*		trx);	/*!< in/out: transaction */
 /*********************************************************************//**
 Checks if a read view sees the specified transaction.
 @return	true if sees */
@@ -145,17 +159,27 @@ struct read_view_t{
 				this is the "low water mark". */
 	ulint		n_trx_ids;
 				/*!< Number of cells in the trx_ids array */
+	ulint		max_trx_ids;
+				/*!< Number of cells allocated for the
+				trx_ids array */
 	trx_id_t*	trx_ids;/*!< Additional trx ids which the read should
 				not see: typically, these are the read-write
 				active transactions at the time when the read
 				is serialized, except the reading transaction
-				itself; the trx ids in this array are in a
-				descending order. These trx_ids should be
+				itself; the trx ids in this array are in an
+				ascending order. These trx_ids should be
 				between the "low" and "high" water marks,
 				that is, up_limit_id and low_limit_id. */
 	trx_id_t	creator_trx_id;
 				/*!< trx id of creating transaction, or
 				0 used in purge */
+	ulint		version;/*!< trx_sys->rw_trx_version when the
+				trx_ids array was copied */
+	volatile ulint	closed;	/*!< TRUE if the view has been closed
+				but is kept in trx_sys->view_list for
+				reuse by the next statement of an
+				auto-commit non-locking transaction.
+				Purge ignores closed views */
 	UT_LIST_NODE_T(read_view_t) view_list;
 				/*!< List of read views in trx_sys */
 };
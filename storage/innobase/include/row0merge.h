@@ -325,8 +325,11 @@ void
 row_merge_buf_sort(
 /*===============*/
 	row_merge_buf_t*	buf,	/*!< in/out: sort buffer */
-	row_merge_dup_t*	dup)	/*!< in/out: reporter of duplicates
+	row_merge_dup_t*	dup,	/*!< in/out: reporter of duplicates
 					(NULL if non-unique index) */
+	ulint			n_threads)/*!< in: maximum number of
+					threads to sort a non-unique
+					index with */
 	MY_ATTRIBUTE((nonnull(1)));
 /********************************************************************//**
 Write a merge block to the file system.
@@ -371,8 +374,9 @@ row_merge_sort(
 					index being created */
 	merge_file_t*		file,	/*!< in/out: file containing
 					index entries */
-	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
-	int*			tmpfd)	/*!< in/out: temporary file handle */
+	int*			tmpfd,	/*!< in/out: temporary file handle */
+	ulint			n_threads)/*!< in: maximum number of
+					merge threads */
 	MY_ATTRIBUTE((nonnull));
 /*********************************************************************//**
 Allocate a sort buffer.
@@ -191,6 +191,11 @@ enum monitor_id_t {
 	MONITOR_FLUSH_BACKGROUND_TOTAL_PAGE,
 	MONITOR_FLUSH_BACKGROUND_COUNT,
 	MONITOR_FLUSH_BACKGROUND_PAGES,
+	MONITOR_FLUSH_PC_ROUNDS,
+	MONITOR_FLUSH_PC_ROUND_MICROSECOND,
+	MONITOR_FLUSH_PC_WORKER_INSTANCES,
+	MONITOR_FLUSH_PC_LRU_MICROSECOND,
+	MONITOR_FLUSH_PC_LIST_MICROSECOND,
 	MONITOR_LRU_BATCH_SCANNED,
 	MONITOR_LRU_BATCH_SCANNED_NUM_CALL,
 	MONITOR_LRU_BATCH_SCANNED_PER_CALL,
@@ -297,6 +302,12 @@ enum monitor_id_t {
 	MONITOR_OVLD_LOG_WAITS,
 	MONITOR_OVLD_LOG_WRITE_REQUEST,
 	MONITOR_OVLD_LOG_WRITES,
+	MONITOR_LOG_WRITER_WRITES,
+	MONITOR_LOG_FLUSHER_FLUSHES,
+	MONITOR_LOG_FLUSHER_MICROSECOND,
+	MONITOR_LOG_WRITE_WAITS,
+	MONITOR_LOG_FLUSH_WAITS,
+	MONITOR_LOG_WAIT_MICROSECOND,
 
 	/* Page Manager related counters */
 	MONITOR_MODULE_PAGE,
@@ -324,9 +335,12 @@ enum monitor_id_t {
 	MONITOR_ADAPTIVE_HASH_ROW_REMOVED,
 	MONITOR_ADAPTIVE_HASH_ROW_REMOVE_NOT_FOUND,
 	MONITOR_ADAPTIVE_HASH_ROW_UPDATED,
+	/* One counter for each of the BTR_SEARCH_MAX_PARTS partitions */
+	MONITOR_ADAPTIVE_HASH_PART_HITS,
+	MONITOR_ADAPTIVE_HASH_PART_MISSES = MONITOR_ADAPTIVE_HASH_PART_HITS + 16,
 
 	/* Tablespace related counters */
-	MONITOR_MODULE_FIL_SYSTEM,
+	MONITOR_MODULE_FIL_SYSTEM = MONITOR_ADAPTIVE_HASH_PART_MISSES + 16,
 	MONITOR_OVLD_N_FILE_OPENED,
 
 	/* InnoDB Change Buffer related counters */
@@ -150,6 +150,14 @@ and/or load it during startup. */
 extern char		srv_buffer_pool_dump_at_shutdown;
 extern char		srv_buffer_pool_load_at_startup;
 
+/** If TRUE, the buffer pool is dumped in the compact binary format */
+extern char		srv_buffer_pool_dump_binary;
+
+/** Interval in seconds between periodic buffer pool dumps, 0 disables
+them. A periodic binary dump only appends the changes of the LRU lists
+since the previous dump to the dump file. */
+extern ulong		srv_buffer_pool_dump_interval;
+
 /* Whether to disable file system cache if it is defined */
 extern char		srv_disable_sort_file_cache;
 
@@ -212,6 +220,11 @@ extern ibool	srv_locks_unsafe_for_binlog;
 
 /** Sort buffer size in index creation */
 extern ulong	srv_sort_buf_size;
+/** Number of sorted runs merged at a time in index creation */
+extern ulong	srv_merge_sort_ways;
+/** Number of threads sorting the records in memory and merging
+sorted runs in index creation */
+extern ulong	srv_merge_sort_threads;
 /** Maximum modification log file size for online index creation */
 extern unsigned long long	srv_online_max_size;
 
@@ -257,6 +270,8 @@ extern ulong	srv_n_log_files;
 extern ib_uint64_t	srv_log_file_size;
 extern ib_uint64_t	srv_log_file_size_requested;
 extern ulint	srv_log_buffer_size;
+/* write and flush the log in log_writer_thread and log_flusher_thread */
+extern my_bool	srv_log_writer_threads;
 extern ulong	srv_flush_log_at_trx_commit;
 extern uint	srv_flush_log_at_timeout;
 extern char	srv_adaptive_flushing;
@@ -282,6 +297,8 @@ extern ulint	srv_buf_pool_size;	/*!< requested size in bytes */
 extern ulint    srv_buf_pool_instances; /*!< requested number of buffer pool instances */
 extern ulong	srv_n_page_hash_locks;	/*!< number of locks to
 					protect buf_pool->page_hash */
+extern ulong	srv_n_lock_sys_partitions;/*!< number of mutexes to
+					protect lock_sys->rec_hash */
 extern ulong	srv_LRU_scan_depth;	/*!< Scan depth for LRU
 					flush batch */
 extern ulong	srv_flush_neighbors;	/*!< whether or not to flush
@@ -355,6 +372,7 @@ extern my_bool			srv_stats_include_delete_marked;
 
 extern ibool	srv_use_doublewrite_buf;
 extern ulong	srv_doublewrite_batch_size;
+extern my_bool	srv_parallel_doublewrite;
 extern ulong	srv_checksum_algorithm;
 
 extern ulong	srv_max_buf_pool_modified_pct;
@@ -436,6 +454,15 @@ extern const char* srv_io_thread_function[];
 /* the number of purge threads to use from the worker pool (currently 0 or 1) */
 extern ulong srv_n_purge_threads;
 
+/* the number of threads applying redo log records in crash recovery */
+extern ulong srv_n_recv_apply_threads;
+
+/* the number of page cleaner threads, including the coordinator */
+extern ulong srv_n_page_cleaners;
+
+/* maximum memory for parsed redo log records in crash recovery */
+extern ulong srv_recv_max_memory;
+
 /* the number of pages to purge in one batch */
 extern ulong srv_purge_batch_size;
 
@@ -445,6 +472,10 @@ extern ulong srv_sync_array_size;
 /* print all user-level transactions deadlocks to mysqld stderr */
 extern my_bool srv_print_all_deadlocks;
 
+/* milliseconds between deadlock searches of lock_deadlock_thread,
+0 means lock waits are checked for deadlocks when they are enqueued */
+extern ulong srv_deadlock_detect_interval;
+
 extern my_bool	srv_cmp_per_index_enabled;
 
 /** Status variables to be passed to MySQL */
@@ -456,14 +487,19 @@ extern srv_stats_t	srv_stats;
 # ifdef UNIV_PFS_THREAD
 /* Keys to register InnoDB threads with performance schema */
 extern mysql_pfs_key_t	buf_page_cleaner_thread_key;
+extern mysql_pfs_key_t	buf_page_cleaner_worker_thread_key;
 extern mysql_pfs_key_t	trx_rollback_clean_thread_key;
 extern mysql_pfs_key_t	io_handler_thread_key;
 extern mysql_pfs_key_t	srv_lock_timeout_thread_key;
+extern mysql_pfs_key_t	srv_lock_deadlock_thread_key;
+extern mysql_pfs_key_t	log_writer_thread_key;
+extern mysql_pfs_key_t	log_flusher_thread_key;
 extern mysql_pfs_key_t	srv_error_monitor_thread_key;
 extern mysql_pfs_key_t	srv_monitor_thread_key;
 extern mysql_pfs_key_t	srv_master_thread_key;
 extern mysql_pfs_key_t	srv_purge_thread_key;
 extern mysql_pfs_key_t	recv_writer_thread_key;
+extern mysql_pfs_key_t	recv_apply_thread_key;
 
 /* This macro register the current thread and its key with performance
 schema */
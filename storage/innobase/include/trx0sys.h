@@ -389,6 +389,40 @@ UNIV_INLINE
 ulint
 trx_sys_get_n_rw_trx(void);
 /*======================*/
+/*****************************************************************//**
+Looks for a transaction id in trx_sys->rw_trx_ids.
+@return position of the first id that is not smaller than id, or
+trx_sys->n_rw_trx_ids if there is none */
+UNIV_INLINE
+ulint
+trx_sys_rw_trx_ids_find(
+/*====================*/
+	trx_id_t	id);	/*!< in: transaction id */
+/*****************************************************************//**
+Adds the id of a read-write transaction that has just been started to
+trx_sys->rw_trx_ids. The id must be bigger than any id in the array. */
+UNIV_INTERN
+void
+trx_sys_rw_trx_id_add(
+/*==================*/
+	trx_id_t	id);	/*!< in: transaction id */
+/*****************************************************************//**
+Removes a read-write transaction from trx_sys->rw_trx_ids and from
+trx_sys->serialisation_list. Called before the transaction becomes
+committed in memory, so that read views created after that see its
+modifications. */
+UNIV_INTERN
+void
+trx_sys_rw_trx_id_remove(
+/*=====================*/
+	trx_t*		trx);	/*!< in/out: read-write transaction */
+/*****************************************************************//**
+Builds trx_sys->rw_trx_ids and trx_sys->serialisation_list from the
+recovered transactions in trx_sys->rw_trx_list at database start. */
+UNIV_INTERN
+void
+trx_sys_rw_trx_ids_init(void);
+/*=========================*/
 
 /*********************************************************************
 Check if there are any active (non-prepared) transactions.
@@ -602,6 +636,10 @@ we must reset the doublewrite buffer, because starting from 4.1.x the
 space id of a data page is stored into
 FIL_PAGE_ARCH_LOG_NO_OR_SPACE_ID. */
 #define TRX_SYS_DOUBLEWRITE_SPACE_ID_STORED (24 + FSEG_HEADER_SIZE)
+/** 8-byte identity of the system tablespace, stamped to the headers of
+the doublewrite files so that files of another instance are not used in
+crash recovery; 0 if not yet assigned */
+#define TRX_SYS_DOUBLEWRITE_FILES_ID	(28 + FSEG_HEADER_SIZE)
 
 /*-------------------------------------------------------------*/
 /** Contents of TRX_SYS_DOUBLEWRITE_MAGIC */
@@ -692,12 +730,36 @@ struct trx_sys_t{
 	UT_LIST_BASE_NODE_T(read_view_t) view_list;
 					/*!< List of read views sorted
 					on trx no, biggest first */
+	trx_id_t*	rw_trx_ids;	/*!< Ids of the read-write
+					transactions in rw_trx_list that are
+					not committed in memory, sorted
+					ascending; read views copy this array
+					instead of walking rw_trx_list.
+					Aligned to CACHE_LINE_SIZE */
+	void*		rw_trx_ids_mem;	/*!< memory from which rw_trx_ids
+					is allocated */
+	ulint		n_rw_trx_ids;	/*!< number of ids in rw_trx_ids */
+	ulint		rw_trx_ids_size;/*!< number of slots allocated in
+					rw_trx_ids */
+	trx_list_t	serialisation_list;
+					/*!< Transactions in rw_trx_ids that
+					have been assigned a serialisation
+					number trx_t::no, sorted on trx_t::no,
+					smallest first */
+	volatile ulint	rw_trx_version;	/*!< Incremented whenever rw_trx_ids
+					or serialisation_list changes.
+					Modified while holding mutex, read
+					without it to decide whether a closed
+					read view can be reused */
 };
 
 /** When a trx id which is zero modulo this number (which must be a power of
 two) is assigned, the field TRX_SYS_TRX_ID_STORE on the transaction system
 page is updated */
 #define TRX_SYS_TRX_ID_WRITE_MARGIN	256
+
+/** Initial number of slots in trx_sys_t::rw_trx_ids */
+#define TRX_SYS_RW_TRX_IDS_MIN		1024
 #endif /* !UNIV_HOTBACKUP */
 
 #ifndef UNIV_NONINL
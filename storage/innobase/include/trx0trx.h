@@ -608,6 +608,12 @@ struct trx_lock_t {
 					transaction as a victim in deadlock
 					resolution, it sets this to TRUE.
 					Protected by trx->mutex. */
+	bool		deadlock_unchecked;
+					/*!< true if the current lock wait
+					was enqueued without a deadlock check
+					and lock_deadlock_thread has not yet
+					searched it; protected by
+					lock_sys->mutex */
 	time_t		wait_started;	/*!< lock wait started at this time,
 					protected only by lock_sys->mutex */
 
@@ -813,9 +819,10 @@ struct trx_t{
 					flush the log in
 					trx_commit_complete_for_mysql() */
 	ulint		duplicates;	/*!< TRX_DUP_IGNORE | TRX_DUP_REPLACE */
-	ulint		has_search_latch;
-					/*!< TRUE if this trx has latched the
-					search system latch in S-mode */
+	rw_lock_t*	has_search_latch;
+					/*!< the adaptive hash index partition
+					latch that this trx has latched in
+					S-mode, or NULL */
 	ulint		search_latch_timeout;
 					/*!< If we notice that someone is
 					waiting for our S-lock on the search
@@ -897,6 +904,9 @@ struct trx_t{
 	ibool		in_rw_trx_list;	/*!< TRUE if in trx_sys->rw_trx_list */
 	/* @} */
 #endif /* UNIV_DEBUG */
+	UT_LIST_NODE_T(trx_t)
+			no_list;	/*!< trx_sys_t::serialisation_list;
+					protected by trx_sys->mutex */
 	UT_LIST_NODE_T(trx_t)
 			mysql_trx_list;	/*!< list of transactions created for
 					MySQL; protected by trx_sys->mutex */
@@ -936,6 +946,12 @@ struct trx_t{
 					associated to a transaction (i.e.
 					same as global_read_view) or read view
 					associated to a cursor */
+	read_view_t*	cached_read_view;
+					/*!< the last global read view of the
+					transaction, kept for reuse by the
+					next one, or NULL. If the view is
+					closed, it is still in
+					trx_sys->view_list */
 	/*------------------------------*/
 	UT_LIST_BASE_NODE_T(trx_named_savept_t)
 			trx_savepoints;	/*!< savepoints set with SAVEPOINT ...,
@@ -1110,24 +1126,6 @@ struct commit_node_t{
 	mutex_exit(&t->mutex);			\
 } while (0)
 
-/** @brief The latch protecting the adaptive search system
-
-This latch protects the
-(1) hash index;
-(2) columns of a record to which we have a pointer in the hash index;
-
-but does NOT protect:
-
-(3) next record offset field in a record;
-(4) next or previous records on the same page.
-
-Bear in mind (3) and (4) when using the hash index.
-*/
-extern rw_lock_t*	btr_search_latch_temp;
-
-/** The latch protecting the adaptive search system */
-#define btr_search_latch	(*btr_search_latch_temp)
-
 #ifndef UNIV_NONINL
 #include "trx0trx.ic"
 #endif
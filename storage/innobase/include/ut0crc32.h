@@ -48,4 +48,26 @@ extern ib_ut_crc32_t	ut_crc32;
 
 extern bool	ut_crc32_sse2_enabled;
 
+extern bool	ut_crc32_pclmul_enabled;
+
+/********************************************************************//**
+The implementations that ut_crc32 can point to, for testing. They
+calculate the same CRC32 as ut_crc32. ut_crc32_sse42() requires
+ut_crc32_sse2_enabled, and ut_crc32_sse42_3way() requires both
+ut_crc32_sse2_enabled and ut_crc32_pclmul_enabled.
+@param ptr	- data over which to calculate CRC32.
+@param len	- data length in bytes.
+@return CRC32 */
+UNIV_INTERN
+ib_uint32_t
+ut_crc32_slice8(const byte* ptr, ulint len);
+
+UNIV_INTERN
+ib_uint32_t
+ut_crc32_sse42(const byte* ptr, ulint len);
+
+UNIV_INTERN
+ib_uint32_t
+ut_crc32_sse42_3way(const byte* ptr, ulint len);
+
 #endif /* ut0crc32_h */
@@ -62,6 +62,11 @@ graph of transactions */
 transactions */
 #define LOCK_MAX_DEPTH_IN_DEADLOCK_CHECK 200
 
+/* When lock_deadlock_thread has taken this many steps in the waits-for
+graph, it releases the lock mutex for a moment to give also others access
+to it, and resumes the search afterwards */
+#define LOCK_MAX_N_STEPS_IN_DEADLOCK_PASS 10000
+
 /* When releasing transaction locks, this specifies how often we release
 the lock mutex for a moment to give also others access to it */
 
@@ -394,6 +399,11 @@ UNIV_INTERN mysql_pfs_key_t	lock_sys_mutex_key;
 UNIV_INTERN mysql_pfs_key_t	lock_sys_wait_mutex_key;
 #endif /* UNIV_PFS_MUTEX */
 
+#ifdef UNIV_PFS_RWLOCK
+/* Key to register rwlock with performance schema */
+UNIV_INTERN mysql_pfs_key_t	lock_sys_latch_key;
+#endif /* UNIV_PFS_RWLOCK */
+
 #ifdef UNIV_DEBUG
 UNIV_INTERN ibool	lock_print_waits	= FALSE;
 
@@ -614,13 +624,28 @@ lock_sys_create(
 
 	mutex_create(lock_sys_mutex_key, &lock_sys->mutex, SYNC_LOCK_SYS);
 
+	rw_lock_create(lock_sys_latch_key, &lock_sys->latch,
+		       SYNC_LOCK_SYS_LATCH);
+
 	mutex_create(lock_sys_wait_mutex_key,
 		     &lock_sys->wait_mutex, SYNC_LOCK_WAIT_SYS);
 
 	lock_sys->timeout_event = os_event_create();
 
+	lock_sys->deadlock_event = os_event_create();
+
 	lock_sys->rec_hash = hash_create(n_cells);
 
+	/* Partition the record lock hash table, so that the lock
+	queue of a page can be accessed without acquiring
+	lock_sys->mutex, see lock_rec_page_enter(). */
+	srv_n_lock_sys_partitions = static_cast<ulong>(
+		ut_2_power_up(srv_n_lock_sys_partitions));
+	ut_a(srv_n_lock_sys_partitions != 0);
+
+	hash_create_sync_obj(lock_sys->rec_hash, HASH_TABLE_SYNC_MUTEX,
+			     srv_n_lock_sys_partitions, SYNC_LOCK_REC_HASH);
+
 	if (!srv_read_only_mode) {
 		lock_latest_err_file = os_file_create_tmpfile(NULL);
 		ut_a(lock_latest_err_file);
@@ -639,8 +664,15 @@ lock_sys_close(void)
 		lock_latest_err_file = NULL;
 	}
 
+	for (ulint i = 0; i < lock_sys->rec_hash->n_sync_obj; i++) {
+		mutex_free(hash_get_nth_mutex(lock_sys->rec_hash, i));
+	}
+
+	mem_free(lock_sys->rec_hash->sync_obj.mutexes);
+
 	hash_table_free(lock_sys->rec_hash);
 
+	rw_lock_free(&lock_sys->latch);
 	mutex_free(&lock_sys->mutex);
 	mutex_free(&lock_sys->wait_mutex);
 
@@ -831,6 +863,63 @@ func_exit:
 	return(ok);
 }
 
+/*********************************************************************//**
+Acquires the lock_sys->rec_hash partition mutex of a page, after S-latching
+lock_sys->latch. The record lock queue of the page may then be accessed,
+and locks on it may be created, granted and released, but no other lock
+queue may be accessed. Without atomic builtins dict_table_t::n_rec_locks
+needs lock_sys->mutex, which is then acquired instead. */
+UNIV_INLINE
+void
+lock_rec_page_enter(
+/*================*/
+	ulint	fold)	/*!< in: lock_rec_fold() of the page */
+{
+	ut_ad(!lock_mutex_own());
+
+#ifdef HAVE_ATOMIC_BUILTINS
+	rw_lock_s_lock(&lock_sys->latch);
+	hash_mutex_enter(lock_sys->rec_hash, fold);
+#else
+	lock_mutex_enter();
+#endif /* HAVE_ATOMIC_BUILTINS */
+}
+
+/*********************************************************************//**
+Releases the latches acquired by lock_rec_page_enter(). */
+UNIV_INLINE
+void
+lock_rec_page_exit(
+/*===============*/
+	ulint	fold)	/*!< in: lock_rec_fold() of the page */
+{
+#ifdef HAVE_ATOMIC_BUILTINS
+	hash_mutex_exit(lock_sys->rec_hash, fold);
+	rw_lock_s_unlock(&lock_sys->latch);
+#else
+	lock_mutex_exit();
+#endif /* HAVE_ATOMIC_BUILTINS */
+}
+
+#ifdef UNIV_DEBUG
+/*********************************************************************//**
+Checks if the queue of a lock may be accessed, that is, if lock_sys->mutex
+is owned, or if the lock is a record lock and the lock_sys->rec_hash
+partition mutex of its page is owned.
+@return	true if the lock queue may be accessed */
+static
+bool
+lock_queue_mutex_own(
+/*=================*/
+	const lock_t*	lock)	/*!< in: lock */
+{
+	return(lock_mutex_own()
+	       || (lock_get_type_low(lock) == LOCK_REC
+		   && lock_rec_mutex_own(lock->un_member.rec_lock.space,
+					 lock->un_member.rec_lock.page_no)));
+}
+#endif /* UNIV_DEBUG */
+
 /*********************************************************************//**
 Sets the wait flag of a lock and the back pointer in trx to lock. */
 UNIV_INLINE
@@ -843,7 +932,7 @@ lock_set_lock_and_trx_wait(
 	ut_ad(lock);
 	ut_ad(lock->trx == trx);
 	ut_ad(trx->lock.wait_lock == NULL);
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(lock));
 	ut_ad(trx_mutex_own(trx));
 
 	trx->lock.wait_lock = lock;
@@ -861,7 +950,7 @@ lock_reset_lock_and_trx_wait(
 {
 	ut_ad(lock->trx->lock.wait_lock == lock);
 	ut_ad(lock_get_wait(lock));
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(lock));
 
 	lock->trx->lock.wait_lock = NULL;
 	lock->type_mode &= ~LOCK_WAIT;
@@ -1215,12 +1304,13 @@ lock_rec_get_next_on_page_const(
 	ulint	space;
 	ulint	page_no;
 
-	ut_ad(lock_mutex_own());
 	ut_ad(lock_get_type_low(lock) == LOCK_REC);
 
 	space = lock->un_member.rec_lock.space;
 	page_no = lock->un_member.rec_lock.page_no;
 
+	ut_ad(lock_rec_mutex_own(space, page_no));
+
 	for (;;) {
 		lock = static_cast<const lock_t*>(HASH_GET_NEXT(hash, lock));
 
@@ -1264,7 +1354,7 @@ lock_rec_get_first_on_page_addr(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(space, page_no));
 
 	for (lock = static_cast<lock_t*>(
 			HASH_GET_FIRST(lock_sys->rec_hash,
@@ -1316,7 +1406,7 @@ lock_rec_get_first_on_page(
 	ulint	space	= buf_block_get_space(block);
 	ulint	page_no	= buf_block_get_page_no(block);
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(space, page_no));
 
 	hash = buf_block_get_lock_hash_val(block);
 
@@ -1345,7 +1435,8 @@ lock_rec_get_next(
 	ulint	heap_no,/*!< in: heap number of the record */
 	lock_t*	lock)	/*!< in: lock */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(lock->un_member.rec_lock.space,
+				 lock->un_member.rec_lock.page_no));
 
 	do {
 		ut_ad(lock_get_type_low(lock) == LOCK_REC);
@@ -1380,7 +1471,8 @@ lock_rec_get_first(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(buf_block_get_space(block),
+				 buf_block_get_page_no(block)));
 
 	for (lock = lock_rec_get_first_on_page(block); lock;
 	     lock = lock_rec_get_next_on_page(lock)) {
@@ -1547,7 +1639,8 @@ lock_rec_has_expl(
 {
 	lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(buf_block_get_space(block),
+				 buf_block_get_page_no(block)));
 	ut_ad((precise_mode & LOCK_MODE_MASK) == LOCK_S
 	      || (precise_mode & LOCK_MODE_MASK) == LOCK_X);
 	ut_ad(!(precise_mode & LOCK_INSERT_INTENTION));
@@ -1606,7 +1699,8 @@ lock_rec_other_has_expl_req(
 {
 	const lock_t*	lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(buf_block_get_space(block),
+				 buf_block_get_page_no(block)));
 	ut_ad(mode == LOCK_X || mode == LOCK_S);
 	ut_ad(gap == 0 || gap == LOCK_GAP);
 	ut_ad(wait == 0 || wait == LOCK_WAIT);
@@ -1704,7 +1798,8 @@ lock_rec_other_has_conflicting(
 	const lock_t*		lock;
 	ibool			is_supremum;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(buf_block_get_space(block),
+				 buf_block_get_page_no(block)));
 
 	is_supremum = (heap_no == PAGE_HEAP_NO_SUPREMUM);
 
@@ -1743,7 +1838,9 @@ lock_rec_find_similar_on_page(
 	lock_t*		lock,		/*!< in: lock_rec_get_first_on_page() */
 	const trx_t*	trx)		/*!< in: transaction */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock == NULL
+	      || lock_rec_mutex_own(lock->un_member.rec_lock.space,
+				    lock->un_member.rec_lock.page_no));
 
 	for (/* No op */;
 	     lock != NULL;
@@ -1956,7 +2053,6 @@ lock_rec_create(
 	ulint		n_bytes;
 	const page_t*	page;
 
-	ut_ad(lock_mutex_own());
 	ut_ad(caller_owns_trx_mutex == trx_mutex_own(trx));
 	ut_ad(dict_index_is_clust(index) || !dict_index_is_online_ddl(index));
 
@@ -1968,6 +2064,8 @@ lock_rec_create(
 	page_no	= buf_block_get_page_no(block);
 	page = block->frame;
 
+	ut_ad(lock_rec_mutex_own(space, page_no));
+
 	btr_assert_not_corrupted(block, index);
 
 	/* If rec is the supremum record, then we reset the gap and
@@ -2004,7 +2102,14 @@ lock_rec_create(
 	/* Set the bit corresponding to rec */
 	lock_rec_set_nth_bit(lock, heap_no);
 
+	/* Threads holding different lock_sys->rec_hash partitions
+	may create locks on the same table concurrently */
+#ifdef HAVE_ATOMIC_BUILTINS
+	os_atomic_increment_ulint(&index->table->n_rec_locks, 1);
+#else
+	ut_ad(lock_mutex_own());
 	index->table->n_rec_locks++;
+#endif /* HAVE_ATOMIC_BUILTINS */
 
 	ut_ad(index->table->n_ref_count > 0 || !index->table->can_be_evicted);
 
@@ -2106,7 +2211,7 @@ lock_rec_create(
 
 /*********************************************************************//**
 Enqueues a waiting request for a lock which cannot be granted immediately.
-Checks for deadlocks.
+Checks for deadlocks, unless they are searched by lock_deadlock_thread.
 @return DB_LOCK_WAIT, DB_DEADLOCK, or DB_QUE_THR_SUSPENDED, or
 DB_SUCCESS_LOCKED_REC; DB_SUCCESS_LOCKED_REC means that
 there was a deadlock, but another transaction was chosen as a victim,
@@ -2131,13 +2236,19 @@ lock_rec_enqueue_waiting(
 					the record */
 	ulint			heap_no,/*!< in: heap number of the record */
 	dict_index_t*		index,	/*!< in: index of record */
-	que_thr_t*		thr)	/*!< in: query thread */
+	que_thr_t*		thr,	/*!< in: query thread */
+	bool			partitioned)
+					/*!< in: true if the caller holds
+					the latches acquired by
+					lock_rec_page_enter() instead of
+					lock_sys->mutex */
 {
 	trx_t*			trx;
 	lock_t*			lock;
 	trx_id_t		victim_trx_id;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(buf_block_get_space(block),
+				 buf_block_get_page_no(block)));
 	ut_ad(!srv_read_only_mode);
 	ut_ad(dict_index_is_clust(index) || !dict_index_is_online_ddl(index));
 
@@ -2194,11 +2305,21 @@ lock_rec_enqueue_waiting(
 	its state can only be changed by this thread, which is
 	currently associated with the transaction. */
 
-	trx_mutex_exit(trx);
+	if (partitioned || srv_deadlock_detect_interval) {
+		/* Leave the search to lock_deadlock_thread, so that the
+		cost of enqueueing a wait does not depend on the number
+		of waiting transactions. Without lock_sys->mutex the
+		waits-for graph cannot be searched here anyway, see
+		lock_rec_lock_slow(). */
+		trx->lock.deadlock_unchecked = true;
+		victim_trx_id = 0;
+	} else {
+		trx_mutex_exit(trx);
 
-	victim_trx_id = lock_deadlock_check_and_resolve(lock, trx);
+		victim_trx_id = lock_deadlock_check_and_resolve(lock, trx);
 
-	trx_mutex_enter(trx);
+		trx_mutex_enter(trx);
+	}
 
 	if (victim_trx_id != 0) {
 
@@ -2265,7 +2386,8 @@ lock_rec_add_to_queue(
 	lock_t*	lock;
 	lock_t*	first_lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(buf_block_get_space(block),
+				 buf_block_get_page_no(block)));
 	ut_ad(caller_owns_trx_mutex == trx_mutex_own(trx));
 	ut_ad(dict_index_is_clust(index)
 	      || dict_index_get_online_status(index) != ONLINE_INDEX_CREATION);
@@ -2407,7 +2529,8 @@ lock_rec_lock_fast(
 	trx_t*			trx;
 	enum lock_rec_req_status status = LOCK_REC_SUCCESS;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(buf_block_get_space(block),
+				 buf_block_get_page_no(block)));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
@@ -2467,8 +2590,12 @@ This is the general, and slower, routine for locking a record. This is a
 low-level function which does NOT look at implicit locks! Checks lock
 compatibility within explicit locks. This function sets a normal next-key
 lock, or in the case of a page supremum record, a gap type lock.
+The caller must hold either lock_sys->mutex or the latches acquired by
+lock_rec_page_enter(). In the latter case a waiting lock request is only
+enqueued if deadlocks are searched by lock_deadlock_thread, otherwise
+nothing is done and DB_FAIL is returned.
 @return	DB_SUCCESS, DB_SUCCESS_LOCKED_REC, DB_LOCK_WAIT, DB_DEADLOCK,
-or DB_QUE_THR_SUSPENDED */
+DB_QUE_THR_SUSPENDED, or DB_FAIL */
 static
 dberr_t
 lock_rec_lock_slow(
@@ -2484,7 +2611,12 @@ lock_rec_lock_slow(
 					the record */
 	ulint			heap_no,/*!< in: heap number of record */
 	dict_index_t*		index,	/*!< in: index of record */
-	que_thr_t*		thr)	/*!< in: query thread */
+	que_thr_t*		thr,	/*!< in: query thread */
+	bool			partitioned)
+					/*!< in: true if the caller holds
+					the latches acquired by
+					lock_rec_page_enter() instead of
+					lock_sys->mutex */
 {
 	trx_t*			trx;
 #ifdef WITH_WSREP
@@ -2492,7 +2624,8 @@ lock_rec_lock_slow(
 #endif
 	dberr_t			err = DB_SUCCESS;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_rec_mutex_own(buf_block_get_space(block),
+				 buf_block_get_page_no(block)));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
@@ -2528,16 +2661,24 @@ lock_rec_lock_slow(
 		have a lock strong enough already granted on the
 		record, we have to wait. */
 
+		if (partitioned && !srv_deadlock_detect_interval) {
+			/* The wait has to be checked for deadlocks,
+			which needs lock_sys->mutex */
+			err = DB_FAIL;
+		} else {
 #ifdef WITH_WSREP
-		/* c_lock is NULL here if jump to enqueue_waiting happened
-		but it's ok because lock is not NULL in that case and c_lock
-		is not used. */
-		err = lock_rec_enqueue_waiting(c_lock,
-			mode, block, heap_no, index, thr);
+			/* c_lock is NULL here if jump to enqueue_waiting
+			happened but it's ok because lock is not NULL in
+			that case and c_lock is not used. */
+			err = lock_rec_enqueue_waiting(c_lock,
+				mode, block, heap_no, index, thr,
+				partitioned);
 #else
-		err = lock_rec_enqueue_waiting(
-			mode, block, heap_no, index, thr);
+			err = lock_rec_enqueue_waiting(
+				mode, block, heap_no, index, thr,
+				partitioned);
 #endif /* WITH_WSREP */
+		}
 	} else if (!impl) {
 		/* Set the requested lock on the record, note that
 		we already own the transaction mutex. */
@@ -2558,7 +2699,11 @@ Tries to lock the specified record in the mode requested. If not immediately
 possible, enqueues a waiting lock request. This is a low-level function
 which does NOT look at implicit locks! Checks lock compatibility within
 explicit locks. This function sets a normal next-key lock, or in the case
-of a page supremum record, a gap type lock.
+of a page supremum record, a gap type lock. The caller must not hold
+lock_sys->mutex: the request is handled under the lock_sys->rec_hash
+partition mutex of the page, see lock_rec_page_enter(), and lock_sys->mutex
+is only acquired if a lock wait has to be checked for deadlocks, or if a
+conflict of high priority transactions has to be resolved.
 @return	DB_SUCCESS, DB_SUCCESS_LOCKED_REC, DB_LOCK_WAIT, DB_DEADLOCK,
 or DB_QUE_THR_SUSPENDED */
 static
@@ -2578,7 +2723,10 @@ lock_rec_lock(
 	dict_index_t*		index,	/*!< in: index of record */
 	que_thr_t*		thr)	/*!< in: query thread */
 {
-	ut_ad(lock_mutex_own());
+	dberr_t	err;
+	ulint	fold;
+
+	ut_ad(!lock_mutex_own());
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_S
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IS));
 	ut_ad((LOCK_MODE_MASK & mode) != LOCK_X
@@ -2590,20 +2738,51 @@ lock_rec_lock(
 	      || mode - (LOCK_MODE_MASK & mode) == 0);
 	ut_ad(dict_index_is_clust(index) || !dict_index_is_online_ddl(index));
 
+	fold = lock_rec_fold(buf_block_get_space(block),
+			     buf_block_get_page_no(block));
+
+	lock_rec_page_enter(fold);
+
 	/* We try a simplified and faster subroutine for the most
 	common cases */
 	switch (lock_rec_lock_fast(impl, mode, block, heap_no, index, thr)) {
 	case LOCK_REC_SUCCESS:
-		return(DB_SUCCESS);
+		err = DB_SUCCESS;
+		break;
 	case LOCK_REC_SUCCESS_CREATED:
-		return(DB_SUCCESS_LOCKED_REC);
+		err = DB_SUCCESS_LOCKED_REC;
+		break;
 	case LOCK_REC_FAIL:
-		return(lock_rec_lock_slow(impl, mode, block,
-					  heap_no, index, thr));
+#ifdef WITH_WSREP
+		if (wsrep_on(thr_get_trx(thr)->mysql_thd)) {
+			/* Conflicts of high priority transactions are
+			resolved under lock_sys->mutex */
+			err = DB_FAIL;
+			break;
+		}
+#endif /* WITH_WSREP */
+		err = lock_rec_lock_slow(impl, mode, block,
+					 heap_no, index, thr, true);
+		break;
+	default:
+		ut_error;
+		err = DB_ERROR;
 	}
 
-	ut_error;
-	return(DB_ERROR);
+	lock_rec_page_exit(fold);
+
+	if (err == DB_FAIL) {
+		/* Nothing was changed, start over with the whole
+		lock system latched. */
+		lock_mutex_enter();
+		err = lock_rec_lock_slow(impl, mode, block,
+					 heap_no, index, thr, false);
+		lock_mutex_exit();
+
+		ut_ad(err != DB_FAIL);
+	}
+
+	return(err);
 }
 
 /*********************************************************************//**
@@ -2622,7 +2801,7 @@ lock_rec_has_to_wait_in_queue(
 	ulint		bit_mask;
 	ulint		bit_offset;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(wait_lock));
 	ut_ad(lock_get_wait(wait_lock));
 	ut_ad(lock_get_type_low(wait_lock) == LOCK_REC);
 
@@ -2658,14 +2837,16 @@ lock_rec_has_to_wait_in_queue(
 
 /*************************************************************//**
 Grants a lock to a waiting lock request and releases the waiting transaction.
-The caller must hold lock_sys->mutex but not lock->trx->mutex. */
+The caller must hold lock_sys->mutex, or for a record lock the latches
+acquired by lock_rec_page_enter(), but not lock->trx->mutex. */
 static
 void
 lock_grant(
 /*=======*/
 	lock_t*	lock)	/*!< in/out: waiting lock request */
 {
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(lock));
+	ut_ad(!trx_mutex_own(lock->trx));
 
 	lock_reset_lock_and_trx_wait(lock);
 
@@ -2748,7 +2929,9 @@ lock_rec_cancel(
 /*************************************************************//**
 Removes a record lock request, waiting or granted, from the queue and
 grants locks to other transactions in the queue if they now are entitled
-to a lock. NOTE: all record locks contained in in_lock are removed. */
+to a lock. NOTE: all record locks contained in in_lock are removed.
+The caller must hold lock_sys->mutex or the latches acquired by
+lock_rec_page_enter() for the page of in_lock. */
 static
 void
 lock_rec_dequeue_from_page(
@@ -2765,7 +2948,7 @@ lock_rec_dequeue_from_page(
 	lock_t*		lock;
 	trx_lock_t*	trx_lock;
 
-	ut_ad(lock_mutex_own());
+	ut_ad(lock_queue_mutex_own(in_lock));
 	ut_ad(lock_get_type_low(in_lock) == LOCK_REC);
 	/* We may or may not be holding in_lock->trx->mutex here. */
 
@@ -2774,7 +2957,13 @@ lock_rec_dequeue_from_page(
 	space = in_lock->un_member.rec_lock.space;
 	page_no = in_lock->un_member.rec_lock.page_no;
 
+	/* Threads holding different lock_sys->rec_hash partitions
+	may release locks on the same table concurrently */
+#ifdef HAVE_ATOMIC_BUILTINS
+	os_atomic_decrement_ulint(&in_lock->index->table->n_rec_locks, 1);
+#else
 	in_lock->index->table->n_rec_locks--;
+#endif /* HAVE_ATOMIC_BUILTINS */
 
 	HASH_DELETE(lock_t, hash, lock_sys->rec_hash,
 		    lock_rec_fold(space, page_no), in_lock);
@@ -4362,6 +4551,441 @@ lock_deadlock_check_and_resolve(
 	return(victim_trx_id);
 }
 
+/*=========== BACKGROUND DEADLOCK CHECKING ============================*/
+
+/********************************************************************//**
+Get the next lock ahead of a waiting lock request in its queue that the
+request has to wait for. These are the edges of the waits-for graph that
+lock_deadlock_thread searches.
+@return next conflicting lock or NULL if wait_lock was reached */
+static
+const lock_t*
+lock_deadlock_get_next_edge(
+/*========================*/
+	const lock_t*	wait_lock,	/*!< in: waiting lock request */
+	const lock_t*	lock,		/*!< in: lock in the queue, or NULL
+					to start from the head of the queue */
+	ulint		heap_no)	/*!< in: heap no if rec lock else
+					ULINT_UNDEFINED */
+{
+	ut_ad(lock_mutex_own());
+
+	do {
+		if (lock_get_type_low(wait_lock) == LOCK_TABLE) {
+			lock = (lock == NULL)
+				? UT_LIST_GET_FIRST(
+					wait_lock->un_member.tab_lock.table
+					->locks)
+				: UT_LIST_GET_NEXT(
+					un_member.tab_lock.locks, lock);
+		} else if (lock != NULL) {
+			lock = lock_rec_get_next_const(heap_no, lock);
+		} else {
+			lock = lock_rec_get_first_on_page_addr(
+				wait_lock->un_member.rec_lock.space,
+				wait_lock->un_member.rec_lock.page_no);
+
+			if (!lock_rec_get_nth_bit(lock, heap_no)) {
+				lock = lock_rec_get_next_const(heap_no, lock);
+			}
+		}
+
+		/* Only the locks ahead of the waiting request in the
+		queue can block it. */
+		if (lock == wait_lock) {
+			return(NULL);
+		}
+
+	} while (lock != NULL && !lock_has_to_wait(wait_lock, lock));
+
+	return(lock);
+}
+
+/********************************************************************//**
+Get the heap number of a waiting lock request.
+@return heap no if rec lock else ULINT_UNDEFINED */
+UNIV_INLINE
+ulint
+lock_deadlock_get_heap_no(
+/*======================*/
+	const lock_t*	wait_lock)	/*!< in: waiting lock request */
+{
+	if (lock_get_type_low(wait_lock) == LOCK_REC) {
+		return(lock_rec_find_set_bit(wait_lock));
+	}
+
+	return(ULINT_UNDEFINED);
+}
+
+/********************************************************************//**
+Select the victim among the transactions of a cycle in the waits-for
+graph: the transaction with the least weight, as in
+lock_deadlock_select_victim(). Brute force transactions of wsrep are
+never chosen, they must be able to commit in the order of the cluster.
+@return victim transaction, or NULL if all the transactions of the
+cycle are brute force */
+static
+trx_t*
+lock_deadlock_select_cycle_victim(
+/*==============================*/
+	const lock_stack_t*	cycle,	/*!< in: stack slots of the
+					transactions of the cycle */
+	ulint			n)	/*!< in: number of slots */
+{
+	trx_t*	victim = NULL;
+
+	ut_ad(lock_mutex_own());
+
+	for (ulint i = 0; i < n; ++i) {
+		trx_t*	trx = cycle[i].wait_lock->trx;
+
+#ifdef WITH_WSREP
+		if (wsrep_thd_is_BF(trx->mysql_thd, TRUE)) {
+			continue;
+		}
+#endif /* WITH_WSREP */
+
+		if (victim == NULL || trx_weight_ge(victim, trx)) {
+			victim = trx;
+		}
+	}
+
+	return(victim);
+}
+
+/********************************************************************//**
+Print the transactions of a cycle in the waits-for graph to the deadlock
+file. */
+static
+void
+lock_deadlock_cycle_print(
+/*======================*/
+	const lock_stack_t*	cycle,	/*!< in: stack slots of the
+					transactions of the cycle */
+	ulint			n,	/*!< in: number of slots */
+	const trx_t*		victim)	/*!< in: victim of the cycle */
+{
+	char	buf[64];
+	ulint	victim_no = 0;
+
+	ut_ad(lock_mutex_own());
+	ut_ad(!srv_read_only_mode);
+
+	lock_deadlock_start_print();
+
+	for (ulint i = 0; i < n; ++i) {
+		const lock_t*	held = cycle[i == 0 ? n - 1 : i - 1].lock;
+		const trx_t*	trx = cycle[i].wait_lock->trx;
+
+		if (trx == victim) {
+			victim_no = i + 1;
+		}
+
+		ut_snprintf(buf, sizeof buf, "\n*** (%lu) TRANSACTION:\n",
+			    (ulong) i + 1);
+		lock_deadlock_fputs(buf);
+
+		lock_deadlock_trx_print(trx, 3000);
+
+		ut_snprintf(buf, sizeof buf,
+			    "*** (%lu) HOLDS THE LOCK(S):\n", (ulong) i + 1);
+		lock_deadlock_fputs(buf);
+
+		lock_deadlock_lock_print(held);
+
+		ut_snprintf(buf, sizeof buf,
+			    "*** (%lu) WAITING FOR THIS LOCK TO BE GRANTED:\n",
+			    (ulong) i + 1);
+		lock_deadlock_fputs(buf);
+
+		lock_deadlock_lock_print(cycle[i].wait_lock);
+	}
+
+	ut_snprintf(buf, sizeof buf, "*** WE ROLL BACK TRANSACTION (%lu)\n",
+		    (ulong) victim_no);
+	lock_deadlock_fputs(buf);
+}
+
+/********************************************************************//**
+Rolls back the victim of a deadlock found by lock_deadlock_thread: its
+lock wait is cancelled and the suspended thread will return
+DB_DEADLOCK. */
+static
+void
+lock_deadlock_cancel_victim(
+/*========================*/
+	trx_t*	victim)	/*!< in/out: victim transaction */
+{
+	ut_ad(lock_mutex_own());
+
+	trx_mutex_enter(victim);
+
+	if (victim->lock.wait_lock != NULL) {
+		victim->lock.was_chosen_as_deadlock_victim = TRUE;
+
+		lock_cancel_waiting_and_release(victim->lock.wait_lock);
+	}
+
+	trx_mutex_exit(victim);
+
+	lock_deadlock_found = TRUE;
+
+	MONITOR_INC(MONITOR_DEADLOCK);
+}
+
+/********************************************************************//**
+Searches the waits-for graph depth first from a waiting transaction. The
+vertices are colored with trx_lock_t::deadlock_mark: a mark below grey
+means not visited, grey means on the search stack and black means that
+all the paths from the vertex were searched without finding a cycle.
+Black vertices are not searched again from another start, so that a
+round of lock_deadlock_check_waits() visits every edge at most once.
+
+The search is interrupted when *n_steps exceeds
+LOCK_MAX_N_STEPS_IN_DEADLOCK_PASS, unless it was the first search since
+the lock mutex was acquired (*n_steps was 0). That one is only restricted
+by LOCK_MAX_N_STEPS_IN_DEADLOCK_CHECK, and if it exceeds that, start is
+rolled back, as lock_deadlock_check_and_resolve() does.
+@return victim transaction to roll back, or NULL if no deadlock found
+or if the search was interrupted */
+static
+trx_t*
+lock_deadlock_search_from(
+/*======================*/
+	trx_t*		start,	/*!< in: waiting transaction */
+	ib_uint64_t	grey,	/*!< in: mark of vertices on the stack */
+	ib_uint64_t	black,	/*!< in: mark of searched vertices */
+	ulint*		n_steps,/*!< in/out: steps taken in the graph
+				since the lock mutex was acquired */
+	bool*		interrupted)
+				/*!< out: true if the search has to be
+				started again after the lock mutex was
+				released */
+{
+	const lock_t*	wait_lock = start->lock.wait_lock;
+	ulint		heap_no = lock_deadlock_get_heap_no(wait_lock);
+	const lock_t*	lock = lock_deadlock_get_next_edge(
+		wait_lock, NULL, heap_no);
+	ulint		depth = 0;
+	const bool	first_search = (*n_steps == 0);
+
+	ut_ad(lock_mutex_own());
+	ut_ad(grey < black);
+
+	*interrupted = false;
+
+	start->lock.deadlock_mark = grey;
+
+	for (;;) {
+		++*n_steps;
+
+		if (!first_search
+		    && *n_steps > LOCK_MAX_N_STEPS_IN_DEADLOCK_PASS) {
+			*interrupted = true;
+			return(NULL);
+		} else if (*n_steps > LOCK_MAX_N_STEPS_IN_DEADLOCK_CHECK) {
+			/* The search is too long: roll back the
+			transaction the search started from, unless it
+			is a brute force transaction of wsrep. */
+			goto too_long;
+		}
+
+		while (lock == NULL) {
+			/* All the edges from wait_lock->trx were searched. */
+
+			wait_lock->trx->lock.deadlock_mark = black;
+
+			if (depth == 0) {
+				return(NULL);
+			}
+
+			--depth;
+
+			lock = lock_stack[depth].lock;
+			wait_lock = lock_stack[depth].wait_lock;
+			heap_no = lock_stack[depth].heap_no;
+
+			lock = lock_deadlock_get_next_edge(
+				wait_lock, lock, heap_no);
+		}
+
+		const trx_t*	trx = lock->trx;
+
+		if (trx->lock.deadlock_mark == grey) {
+
+			/* Found a cycle: it consists of the vertices on
+			the stack starting from trx. */
+
+			lock_stack[depth].lock = lock;
+			lock_stack[depth].wait_lock = wait_lock;
+			lock_stack[depth].heap_no = heap_no;
+
+			ulint	first = 0;
+
+			while (lock_stack[first].wait_lock->trx != trx) {
+				++first;
+				ut_a(first <= depth);
+			}
+
+			trx_t*	victim = lock_deadlock_select_cycle_victim(
+				lock_stack + first, depth + 1 - first);
+
+#ifdef WITH_WSREP
+			if (victim == NULL) {
+				/* The brute force transactions have to
+				resolve the conflict in their commit
+				order, see lock_rec_has_to_wait(). */
+				if (wsrep_debug) {
+					fprintf(stderr, "WSREP: deadlock of"
+						" brute force transactions,"
+						" no victim chosen\n");
+				}
+
+				return(NULL);
+			}
+#endif /* WITH_WSREP */
+
+			if (!srv_read_only_mode) {
+				lock_deadlock_cycle_print(
+					lock_stack + first, depth + 1 - first,
+					victim);
+			}
+
+			return(victim);
+
+		} else if (trx->lock.deadlock_mark == black
+			   || trx->lock.que_state != TRX_QUE_LOCK_WAIT
+			   || trx->lock.wait_lock == NULL) {
+
+			/* No cycle through trx, next edge */
+			lock = lock_deadlock_get_next_edge(
+				wait_lock, lock, heap_no);
+
+		} else if (depth + 1 >= LOCK_STACK_SIZE) {
+
+			/* The search stack is exhausted: roll back the
+			transaction the search started from, unless it
+			is a brute force transaction of wsrep. */
+			goto too_long;
+
+		} else {
+			/* Descend to the lock wait of trx. */
+
+			lock_stack[depth].lock = lock;
+			lock_stack[depth].wait_lock = wait_lock;
+			lock_stack[depth].heap_no = heap_no;
+			++depth;
+
+			lock->trx->lock.deadlock_mark = grey;
+
+			wait_lock = trx->lock.wait_lock;
+			heap_no = lock_deadlock_get_heap_no(wait_lock);
+			lock = lock_deadlock_get_next_edge(
+				wait_lock, NULL, heap_no);
+		}
+	}
+
+too_long:
+#ifdef WITH_WSREP
+	if (wsrep_thd_is_BF(start->mysql_thd, TRUE)) {
+		return(NULL);
+	}
+#endif /* WITH_WSREP */
+	if (!srv_read_only_mode) {
+		lock_deadlock_joining_trx_print(start, start->lock.wait_lock);
+	}
+
+	return(start);
+}
+
+/*********************************************************************//**
+Searches the waits-for graph of the suspended transactions for cycles,
+starting from the lock waits that were enqueued without a deadlock check,
+and resolves the deadlocks found by rolling back a victim in each.
+
+Any cycle in the waits-for graph was closed by a lock wait which was
+enqueued after the previous round, because edges are only added when a
+lock wait is enqueued. Thus the search only needs to start from the
+unchecked waits. */
+UNIV_INTERN
+void
+lock_deadlock_check_waits(void)
+/*===========================*/
+{
+	ib_uint64_t	grey;
+	ib_uint64_t	black;
+	ulint		n_steps;
+
+	lock_wait_mutex_enter();
+
+	lock_mutex_enter();
+
+resume:
+	grey = ++lock_mark_counter;
+	black = ++lock_mark_counter;
+	n_steps = 0;
+
+	for (srv_slot_t* slot = lock_sys->waiting_threads;
+	     slot < lock_sys->last_slot;
+	     ++slot) {
+
+		if (!slot->in_use) {
+			continue;
+		}
+
+		trx_t*	trx = thr_get_trx(slot->thr);
+
+		if (!trx->lock.deadlock_unchecked) {
+			continue;
+		}
+
+		trx->lock.deadlock_unchecked = false;
+
+		while (trx->lock.wait_lock != NULL
+		       && trx->lock.deadlock_mark < grey) {
+
+			bool	interrupted;
+			trx_t*	victim = lock_deadlock_search_from(
+				trx, grey, black, &n_steps, &interrupted);
+
+			if (interrupted) {
+				/* Release the mutexes for a moment, so
+				that we do not monopolize them. The graph
+				may change meanwhile, thus the marks are
+				renewed and the slots are scanned again
+				for the waits which are left unchecked. */
+				trx->lock.deadlock_unchecked = true;
+
+				lock_mutex_exit();
+				lock_wait_mutex_exit();
+
+				os_thread_yield();
+
+				lock_wait_mutex_enter();
+				lock_mutex_enter();
+
+				goto resume;
+			}
+
+			if (victim == NULL) {
+				break;
+			}
+
+			lock_deadlock_cancel_victim(victim);
+
+			/* The search was abandoned with transactions
+			marked grey. Start over from trx with new marks,
+			as it may be part of another cycle. */
+			grey = ++lock_mark_counter;
+			black = ++lock_mark_counter;
+		}
+	}
+
+	lock_mutex_exit();
+
+	lock_wait_mutex_exit();
+}
+
 /*========================= TABLE LOCKS ==============================*/
 
 /*********************************************************************//**
@@ -4684,11 +5308,19 @@ lock_table_enqueue_waiting(
 	its state can only be changed by this thread, which is
 	currently associated with the transaction. */
 
-	trx_mutex_exit(trx);
+	if (srv_deadlock_detect_interval) {
+		/* Leave the search to lock_deadlock_thread, so that the
+		cost of enqueueing a wait does not depend on the number
+		of waiting transactions. */
+		trx->lock.deadlock_unchecked = true;
+		victim_trx_id = 0;
+	} else {
+		trx_mutex_exit(trx);
 
-	victim_trx_id = lock_deadlock_check_and_resolve(lock, trx);
+		victim_trx_id = lock_deadlock_check_and_resolve(lock, trx);
 
-	trx_mutex_enter(trx);
+		trx_mutex_enter(trx);
+	}
 
 	if (victim_trx_id != 0) {
 		ut_ad(victim_trx_id == trx->id);
@@ -4963,6 +5595,7 @@ lock_rec_unlock(
 	lock_t*		first_lock;
 	lock_t*		lock;
 	ulint		heap_no;
+	ulint		fold;
 	const char*	stmt;
 	size_t		stmt_len;
 
@@ -4973,8 +5606,10 @@ lock_rec_unlock(
 	ut_ad(trx_state_eq(trx, TRX_STATE_ACTIVE));
 
 	heap_no = page_rec_get_heap_no(rec);
+	fold = lock_rec_fold(buf_block_get_space(block),
+			     buf_block_get_page_no(block));
 
-	lock_mutex_enter();
+	lock_rec_page_enter(fold);
 	trx_mutex_enter(trx);
 
 	first_lock = lock_rec_get_first(block, heap_no);
@@ -4989,8 +5624,8 @@ lock_rec_unlock(
 		}
 	}
 
-	lock_mutex_exit();
 	trx_mutex_exit(trx);
+	lock_rec_page_exit(fold);
 
 	stmt = innobase_get_stmt(trx->mysql_thd, &stmt_len);
 	ut_print_timestamp(stderr);
@@ -5008,6 +5643,10 @@ released:
 	ut_a(!lock_get_wait(lock));
 	lock_rec_reset_nth_bit(lock, heap_no);
 
+	/* lock_grant() acquires the mutex of the waiting transaction,
+	and only the owner of lock_sys->mutex may hold two of them. */
+	trx_mutex_exit(trx);
+
 	/* Check if we can now grant waiting lock requests */
 
 	for (lock = first_lock; lock != NULL;
@@ -5021,8 +5660,64 @@ released:
 		}
 	}
 
-	lock_mutex_exit();
-	trx_mutex_exit(trx);
+	lock_rec_page_exit(fold);
+}
+
+/*********************************************************************//**
+Releases the record locks of a transaction that has been committed in memory,
+and releases possible other transactions waiting because of these locks.
+Only the lock_sys->rec_hash partition mutex of one page at a time is held,
+the locks which are left are released by lock_release(). */
+static
+void
+lock_release_rec_locks(
+/*===================*/
+	trx_t*	trx)	/*!< in/out: transaction */
+{
+#ifdef HAVE_ATOMIC_BUILTINS
+	lock_t*	lock;
+	ulint	count = 0;
+
+	ut_ad(!lock_mutex_own());
+	ut_ad(!trx_mutex_own(trx));
+	ut_ad(trx_state_eq(trx, TRX_STATE_COMMITTED_IN_MEMORY));
+
+	rw_lock_s_lock(&lock_sys->latch);
+
+	/* While lock_sys->latch is S-latched only this thread modifies
+	trx->lock.trx_locks. The owner of lock_sys->mutex may create
+	locks for trx or discard them, therefore the list is scanned
+	from the start again after the latch was released. */
+	lock = UT_LIST_GET_LAST(trx->lock.trx_locks);
+
+	while (lock != NULL) {
+		lock_t*	prev_lock = UT_LIST_GET_PREV(trx_locks, lock);
+
+		if (lock_get_type_low(lock) == LOCK_REC) {
+			ulint	fold = lock_rec_fold(
+				lock->un_member.rec_lock.space,
+				lock->un_member.rec_lock.page_no);
+
+			hash_mutex_enter(lock_sys->rec_hash, fold);
+			lock_rec_dequeue_from_page(lock);
+			hash_mutex_exit(lock_sys->rec_hash, fold);
+
+			if (++count == LOCK_RELEASE_INTERVAL) {
+				/* Let lock_mutex_enter() in for a while */
+				rw_lock_s_unlock(&lock_sys->latch);
+				rw_lock_s_lock(&lock_sys->latch);
+
+				prev_lock = UT_LIST_GET_LAST(
+					trx->lock.trx_locks);
+				count = 0;
+			}
+		}
+
+		lock = prev_lock;
+	}
+
+	rw_lock_s_unlock(&lock_sys->latch);
+#endif /* HAVE_ATOMIC_BUILTINS */
 }
 
 /*********************************************************************//**
@@ -5996,7 +6691,7 @@ lock_rec_queue_validate(
 
 		ut_ad(lock_mutex_own());
 		/* impl_trx cannot be committed until lock_mutex_exit()
-		because lock_trx_release_locks() acquires lock_sys->mutex */
+		because lock_trx_release_locks() latches lock_sys->latch */
 
 		if (impl_trx != NULL
 		    && lock_rec_other_has_expl_req(LOCK_S, 0, LOCK_WAIT,
@@ -6410,11 +7105,11 @@ lock_rec_insert_check_and_lock(
 #ifdef WITH_WSREP
 		err = lock_rec_enqueue_waiting(c_lock,
 			LOCK_X | LOCK_GAP | LOCK_INSERT_INTENTION,
-			block, next_rec_heap_no, index, thr);
+			block, next_rec_heap_no, index, thr, false);
 #else
 		err = lock_rec_enqueue_waiting(
 			LOCK_X | LOCK_GAP | LOCK_INSERT_INTENTION,
-			block, next_rec_heap_no, index, thr);
+			block, next_rec_heap_no, index, thr, false);
 #endif /* WITH_WSREP */
 
 		trx_mutex_exit(trx);
@@ -6512,7 +7207,7 @@ lock_rec_convert_impl_to_expl(
 		impl_trx = trx_rw_is_active(trx_id, NULL);
 
 		/* impl_trx cannot be committed until lock_mutex_exit()
-		because lock_trx_release_locks() acquires lock_sys->mutex */
+		because lock_trx_release_locks() latches lock_sys->latch */
 
 		if (impl_trx != NULL
 		    && !lock_rec_has_expl(LOCK_X | LOCK_REC_NOT_GAP, block,
@@ -6571,8 +7266,6 @@ lock_clust_rec_modify_check_and_lock(
 
 	lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 
-	lock_mutex_enter();
-
 	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 
 	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
@@ -6580,8 +7273,6 @@ lock_clust_rec_modify_check_and_lock(
 
 	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
 
-	lock_mutex_exit();
-
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
 	if (UNIV_UNLIKELY(err == DB_SUCCESS_LOCKED_REC)) {
@@ -6631,8 +7322,6 @@ lock_sec_rec_modify_check_and_lock(
 	index record, and this would not have been possible if another active
 	transaction had modified this secondary index record. */
 
-	lock_mutex_enter();
-
 	ut_ad(lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 
 	err = lock_rec_lock(TRUE, LOCK_X | LOCK_REC_NOT_GAP,
@@ -6640,8 +7329,6 @@ lock_sec_rec_modify_check_and_lock(
 
 	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
 
-	lock_mutex_exit();
-
 #ifdef UNIV_DEBUG
 	{
 		mem_heap_t*	heap		= NULL;
@@ -6730,8 +7417,6 @@ lock_sec_rec_read_check_and_lock(
 		lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 	}
 
-	lock_mutex_enter();
-
 	ut_ad(mode != LOCK_X
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 	ut_ad(mode != LOCK_S
@@ -6742,8 +7427,6 @@ lock_sec_rec_read_check_and_lock(
 
 	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
 
-	lock_mutex_exit();
-
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
 	return(err);
@@ -6802,8 +7485,6 @@ lock_clust_rec_read_check_and_lock(
 		lock_rec_convert_impl_to_expl(block, rec, index, offsets);
 	}
 
-	lock_mutex_enter();
-
 	ut_ad(mode != LOCK_X
 	      || lock_table_has(thr_get_trx(thr), index->table, LOCK_IX));
 	ut_ad(mode != LOCK_S
@@ -6814,8 +7495,6 @@ lock_clust_rec_read_check_and_lock(
 
 	MONITOR_INC(MONITOR_NUM_RECLOCK_REQ);
 
-	lock_mutex_exit();
-
 	ut_ad(lock_rec_queue_validate(FALSE, block, rec, index, offsets));
 
 	return(err);
@@ -7256,8 +7935,9 @@ lock_trx_release_locks(
 	}
 
 	/* The transition of trx->state to TRX_STATE_COMMITTED_IN_MEMORY
-	is protected by both the lock_sys->mutex and the trx->mutex. */
-	lock_mutex_enter();
+	is protected by both the lock_sys->latch and the trx->mutex, thus
+	the owner of lock_sys->mutex sees a stable state. */
+	rw_lock_s_lock(&lock_sys->latch);
 	trx_mutex_enter(trx);
 
 	/* The following assignment makes the transaction committed in memory
@@ -7292,6 +7972,13 @@ lock_trx_release_locks(
 	trx->is_recovered = FALSE;
 
 	trx_mutex_exit(trx);
+	rw_lock_s_unlock(&lock_sys->latch);
+
+	lock_release_rec_locks(trx);
+
+	/* Release the table locks, and the record locks which were
+	created for trx by lock_sys->mutex owners in the meantime. */
+	lock_mutex_enter();
 
 	lock_release(trx);
 
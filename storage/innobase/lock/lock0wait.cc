@@ -427,13 +427,13 @@ lock_wait_release_thread_if_suspended(
 	que_thr_t*	thr)	/*!< in: query thread associated with the
 				user OS thread	 */
 {
-	ut_ad(lock_mutex_own());
 	ut_ad(trx_mutex_own(thr_get_trx(thr)));
 
-	/* We own both the lock mutex and the trx_t::mutex but not the
-	lock wait mutex. This is OK because other threads will see the state
-	of this slot as being in use and no other thread can change the state
-	of the slot to free unless that thread also owns the lock mutex. */
+	/* We own the trx_t::mutex and either the lock mutex or an S-latch
+	on lock_sys->latch, but not the lock wait mutex. This is OK because
+	other threads will see the state of this slot as being in use and
+	no other thread can change the state of the slot to free unless that
+	thread also owns the lock mutex. */
 
 	if (thr->slot != NULL && thr->slot->in_use && thr->slot->thr == thr) {
 		trx_t*	trx = thr_get_trx(thr);
@@ -577,3 +577,63 @@ DECLARE_THREAD(lock_wait_timeout_thread)(
 
 	OS_THREAD_DUMMY_RETURN;
 }
+
+/*********************************************************************//**
+A thread which periodically searches the lock waits for deadlocks when
+innodb_deadlock_detect_interval is set.
+@return	a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(lock_deadlock_thread)(
+/*=================================*/
+	void*	arg MY_ATTRIBUTE((unused)))
+			/* in: a dummy parameter required by
+			os_thread_create */
+{
+	ib_int64_t	sig_count = 0;
+	os_event_t	event = lock_sys->deadlock_event;
+	ulong		interval = 0;
+
+	ut_ad(!srv_read_only_mode);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(srv_lock_deadlock_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	lock_sys->deadlock_thread_active = true;
+
+	for (;;) {
+		/* While deadlocks are checked when lock waits are
+		enqueued, only look once a second whether the interval
+		has been set. */
+
+		os_event_wait_time_low(
+			event, interval ? interval * 1000 : 1000000,
+			sig_count);
+		sig_count = os_event_reset(event);
+
+		if (srv_shutdown_state >= SRV_SHUTDOWN_CLEANUP) {
+			break;
+		}
+
+		ulong	prev_interval = interval;
+
+		interval = srv_deadlock_detect_interval;
+
+		/* After the interval was reset to 0, search the waits
+		that were enqueued without a check one more time. */
+
+		if (interval || prev_interval) {
+			lock_deadlock_check_waits();
+		}
+	}
+
+	lock_sys->deadlock_thread_active = false;
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
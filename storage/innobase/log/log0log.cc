@@ -228,6 +228,9 @@ log_buffer_extend(
 		mutex_enter(&(log_sys->mutex));
 	}
 
+	/* The last log block may still be being copied to */
+	log_buffer_wait_ready();
+
 	move_start = ut_calc_align_down(
 		log_sys->buf_free,
 		OS_FILE_LOG_BLOCK_SIZE);
@@ -336,6 +339,18 @@ loop:
 		goto loop;
 	}
 
+	if (!log_buffer_can_reserve()) {
+
+		mutex_exit(&(log->mutex));
+
+		/* Too many mini-transactions are still copying their log
+		records to the log buffer */
+
+		os_thread_yield();
+
+		goto loop;
+	}
+
 #ifdef UNIV_LOG_ARCHIVE
 	if (log->archiving_state != LOG_ARCH_OFF) {
 
@@ -366,21 +381,27 @@ loop:
 }
 
 /************************************************************//**
-Writes to the log the string given. It is assumed that the caller holds the
-log mutex. */
+Reserves space for the string given in the log buffer, advancing the lsn
+and initializing the headers of the log blocks the string spans. The string
+must be copied to the reserved space with log_buffer_write(), after which
+the reserved lsn range must be passed to log_buffer_link(). It is assumed
+that the caller holds the log mutex and has checked
+log_buffer_can_reserve().
+@return	pointer to the start of the reserved space */
 UNIV_INTERN
-void
-log_write_low(
-/*==========*/
-	byte*	str,		/*!< in: string */
+byte*
+log_buffer_reserve(
+/*===============*/
 	ulint	str_len)	/*!< in: string length */
 {
 	log_t*	log	= log_sys;
+	byte*	ptr	= log->buf + log->buf_free;
 	ulint	len;
 	ulint	data_len;
 	byte*	log_block;
 
 	ut_ad(mutex_own(&(log->mutex)));
+	ut_ad(log->lsn - log->buf_ready_lsn < LOG_RECENT_WRITTEN_SIZE);
 part_loop:
 	ut_ad(!recv_no_log_write);
 	/* Calculate a part length */
@@ -400,10 +421,7 @@ part_loop:
 			- LOG_BLOCK_TRL_SIZE;
 	}
 
-	ut_memcpy(log->buf + log->buf_free, str, len);
-
 	str_len -= len;
-	str = str + len;
 
 	log_block = static_cast<byte*>(
 		ut_align_down(
@@ -435,6 +453,193 @@ part_loop:
 	}
 
 	srv_stats.log_write_requests.inc();
+
+	return(ptr);
+}
+
+/************************************************************//**
+Copies the string given to space reserved with log_buffer_reserve() or
+log_reserve_fast(), skipping the log block headers and trailers. The caller
+does not need to hold the log mutex.
+@return	pointer to the end of the copied string */
+UNIV_INTERN
+byte*
+log_buffer_write(
+/*=============*/
+	byte*		ptr,	/*!< in: where to copy the string */
+	const byte*	str,	/*!< in: string */
+	ulint		str_len)/*!< in: string length */
+{
+	while (str_len > 0) {
+		ulint	len = OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE
+			- ut_align_offset(ptr, OS_FILE_LOG_BLOCK_SIZE);
+
+		ut_ad(len <= OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_HDR_SIZE
+		      - LOG_BLOCK_TRL_SIZE);
+
+		if (len > str_len) {
+			len = str_len;
+		}
+
+		memcpy(ptr, str, len);
+
+		ptr += len;
+		str += len;
+		str_len -= len;
+
+		if (ut_align_offset(ptr, OS_FILE_LOG_BLOCK_SIZE)
+		    == OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE) {
+			/* Skip to the data of the next block */
+			ptr += LOG_BLOCK_TRL_SIZE + LOG_BLOCK_HDR_SIZE;
+		}
+	}
+
+	return(ptr);
+}
+
+/************************************************************//**
+Marks an lsn range reserved in the log buffer as copied to. The log
+records below log_sys->buf_ready_lsn may be written to the log files once
+all the ranges below it have been linked. The caller does not need to hold
+the log mutex if atomic builtins are available. */
+UNIV_INTERN
+void
+log_buffer_link(
+/*============*/
+	lsn_t	start_lsn,	/*!< in: start lsn of the range */
+	lsn_t	end_lsn)	/*!< in: end lsn of the range */
+{
+	volatile ulint*	slot;
+
+	ut_ad(end_lsn >= start_lsn);
+	ut_ad(end_lsn - start_lsn < log_sys->buf_size);
+
+	if (end_lsn == start_lsn) {
+
+		return;
+	}
+
+	slot = &log_sys->recent_written[
+		start_lsn % LOG_RECENT_WRITTEN_SIZE];
+
+	ut_ad(*slot == 0);
+
+#ifdef HAVE_ATOMIC_BUILTINS
+	/* This is a full memory barrier: the log records copied to the
+	range will be visible to the thread that sees the slot set. */
+	os_atomic_increment_ulint(slot, (ulint) (end_lsn - start_lsn));
+#else
+	ut_ad(mutex_own(&(log_sys->mutex)));
+	*slot = (ulint) (end_lsn - start_lsn);
+#endif /* HAVE_ATOMIC_BUILTINS */
+}
+
+/************************************************************//**
+Advances log_sys->buf_ready_lsn over the lsn ranges that have been linked
+with log_buffer_link(). */
+static
+void
+log_buffer_advance_ready_lsn(void)
+/*==============================*/
+{
+	ut_ad(mutex_own(&(log_sys->mutex)));
+
+	while (log_sys->buf_ready_lsn < log_sys->lsn) {
+		volatile ulint*	slot;
+		ulint		len;
+
+		slot = &log_sys->recent_written[
+			log_sys->buf_ready_lsn % LOG_RECENT_WRITTEN_SIZE];
+
+		len = *slot;
+
+		if (len == 0) {
+			/* The range starting here is still being copied */
+			break;
+		}
+
+#ifdef HAVE_ATOMIC_BUILTINS
+		/* A full memory barrier as well, see log_buffer_link() */
+		ut_a(os_compare_and_swap_ulint(slot, len, 0));
+#else
+		*slot = 0;
+#endif /* HAVE_ATOMIC_BUILTINS */
+
+		log_sys->buf_ready_lsn += len;
+	}
+
+	ut_ad(log_sys->buf_ready_lsn <= log_sys->lsn);
+}
+
+/************************************************************//**
+Checks if space can be reserved in the log buffer, that is, if log_sys->lsn
+is less than LOG_RECENT_WRITTEN_SIZE bytes ahead of log_sys->buf_ready_lsn.
+The caller must hold the log mutex.
+@return	true if log_buffer_reserve() may be called */
+UNIV_INTERN
+bool
+log_buffer_can_reserve(void)
+/*========================*/
+{
+	ut_ad(mutex_own(&(log_sys->mutex)));
+
+	if (log_sys->lsn - log_sys->buf_ready_lsn < LOG_RECENT_WRITTEN_SIZE) {
+
+		return(true);
+	}
+
+	log_buffer_advance_ready_lsn();
+
+	return(log_sys->lsn - log_sys->buf_ready_lsn
+	       < LOG_RECENT_WRITTEN_SIZE);
+}
+
+/************************************************************//**
+Waits until all the mini-transactions that have reserved space in the log
+buffer have copied their log records to it. The mini-transactions do not
+need the log mutex for that, which the caller must hold.
+@return	log_sys->lsn, up to which the log buffer is complete */
+UNIV_INTERN
+lsn_t
+log_buffer_wait_ready(void)
+/*=======================*/
+{
+	ulint	i = 0;
+
+	ut_ad(mutex_own(&(log_sys->mutex)));
+
+	for (;;) {
+		log_buffer_advance_ready_lsn();
+
+		if (log_sys->buf_ready_lsn == log_sys->lsn) {
+
+			return(log_sys->lsn);
+		}
+
+		if (i < srv_n_spin_wait_rounds) {
+			ut_delay(ut_rnd_interval(0, srv_spin_wait_delay));
+			i++;
+		} else {
+			os_thread_yield();
+		}
+	}
+}
+
+/************************************************************//**
+Writes to the log the string given. It is assumed that the caller holds the
+log mutex. */
+UNIV_INTERN
+void
+log_write_low(
+/*==========*/
+	byte*	str,		/*!< in: string */
+	ulint	str_len)	/*!< in: string length */
+{
+	lsn_t	start_lsn	= log_sys->lsn;
+
+	log_buffer_write(log_buffer_reserve(str_len), str, str_len);
+
+	log_buffer_link(start_lsn, log_sys->lsn);
 }
 
 /************************************************************//**
@@ -523,11 +728,6 @@ log_close(void)
 	}
 function_exit:
 
-#ifdef UNIV_LOG_DEBUG
-	log_check_log_recs(log->buf + log->old_buf_free,
-			   log->buf_free - log->old_buf_free, log->old_lsn);
-#endif
-
 	return(lsn);
 }
 
@@ -866,6 +1066,9 @@ log_init(void)
 	log_sys->buf_size = LOG_BUFFER_SIZE;
 	log_sys->is_extending = false;
 
+	log_sys->recent_written = static_cast<ulint*>(
+		mem_zalloc(LOG_RECENT_WRITTEN_SIZE * sizeof(ulint)));
+
 	log_sys->max_buf_free = log_sys->buf_size / LOG_BUF_FLUSH_RATIO
 		- LOG_BUF_FLUSH_MARGIN;
 	log_sys->check_flush_or_checkpoint = TRUE;
@@ -896,6 +1099,18 @@ log_init(void)
 
 	os_event_set(log_sys->one_flushed_event);
 
+	log_sys->writer_event = os_event_create();
+	log_sys->flusher_event = os_event_create();
+	log_sys->writer_thread_active = false;
+	log_sys->flusher_thread_active = false;
+	log_sys->n_flush_requests = 0;
+	log_sys->flush_target_lsn = 0;
+
+	for (ulint i = 0; i < LOG_N_WAIT_EVENTS; i++) {
+		log_sys->write_events[i] = os_event_create();
+		log_sys->flush_events[i] = os_event_create();
+	}
+
 	/*----------------------------*/
 
 	log_sys->next_checkpoint_no = 0;
@@ -945,6 +1160,7 @@ log_init(void)
 
 	log_sys->buf_free = LOG_BLOCK_HDR_SIZE;
 	log_sys->lsn = LOG_START_LSN + LOG_BLOCK_HDR_SIZE;
+	log_sys->buf_ready_lsn = log_sys->lsn;
 
 	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE,
 		    log_sys->lsn - log_sys->last_checkpoint_lsn);
@@ -1136,6 +1352,8 @@ log_sys_check_flush_completion(void)
 			/* Move the log buffer content to the start of the
 			buffer */
 
+			log_buffer_wait_ready();
+
 			move_start = ut_calc_align_down(
 				log_sys->write_end_offset,
 				OS_FILE_LOG_BLOCK_SIZE);
@@ -1420,14 +1638,13 @@ loop:
 }
 
 /******************************************************//**
-This function is called, e.g., when a transaction wants to commit. It checks
-that the log has been written to the log file up to the last log entry written
-by the transaction. If there is a flush running, it waits and checks if the
-flush flushed enough. If not, starts a new flush. */
-UNIV_INTERN
+Checks that the log has been written to the log file up to the given lsn.
+If there is a flush running, it waits and checks if the flush flushed
+enough. If not, starts a new flush in the calling thread. */
+static
 void
-log_write_up_to(
-/*============*/
+log_write_up_to_low(
+/*================*/
 	lsn_t	lsn,	/*!< in: log sequence number up to which
 			the log should be written,
 			LSN_MAX if not specified */
@@ -1519,6 +1736,10 @@ loop:
 		goto loop;
 	}
 
+	/* Wait for the log records of the mini-transactions that have
+	reserved space in the log buffer before us */
+	log_buffer_wait_ready();
+
 	if (!flush_to_disk
 	    && log_sys->buf_free == log_sys->buf_next_to_write) {
 		/* Nothing to write and no flush to disk requested */
@@ -1554,6 +1775,12 @@ loop:
 
 	ut_ad(area_end - area_start > 0);
 
+#ifdef UNIV_LOG_DEBUG
+	log_check_log_recs(log_sys->buf + start_offset,
+			   end_offset - start_offset,
+			   log_sys->written_to_all_lsn);
+#endif /* UNIV_LOG_DEBUG */
+
 	log_sys->write_lsn = log_sys->lsn;
 
 	if (flush_to_disk) {
@@ -1650,12 +1877,372 @@ do_waits:
 	}
 }
 
+/******************************************************//**
+Gets the event on which a thread waits for the log to be written or flushed
+up to an lsn.
+@return	write or flush event of the log block of lsn */
+UNIV_INLINE
+os_event_t
+log_wait_event(
+/*===========*/
+	lsn_t	lsn,		/*!< in: lsn */
+	ibool	flush_to_disk)	/*!< in: TRUE to wait for a flush to disk */
+{
+	ulint	i = (ulint) ((lsn / OS_FILE_LOG_BLOCK_SIZE)
+			     % LOG_N_WAIT_EVENTS);
+
+	return(flush_to_disk
+	       ? log_sys->flush_events[i] : log_sys->write_events[i]);
+}
+
+/******************************************************//**
+Wakes up the threads waiting for the log to be written or flushed up to an
+lsn in the range (start_lsn, end_lsn]. */
+static
+void
+log_wake_waiters(
+/*=============*/
+	os_event_t*	events,		/*!< in: log_sys->write_events or
+					log_sys->flush_events */
+	lsn_t		start_lsn,	/*!< in: lsn reached before */
+	lsn_t		end_lsn)	/*!< in: lsn reached now */
+{
+	lsn_t	block = start_lsn / OS_FILE_LOG_BLOCK_SIZE;
+	lsn_t	end_block = end_lsn / OS_FILE_LOG_BLOCK_SIZE;
+
+	if (end_block - block >= LOG_N_WAIT_EVENTS) {
+		end_block = block + LOG_N_WAIT_EVENTS - 1;
+	}
+
+	for (; block <= end_block; block++) {
+		os_event_set(events[block % LOG_N_WAIT_EVENTS]);
+	}
+}
+
+/******************************************************//**
+Checks if the log has been written or flushed up to an lsn. This may be
+called without holding the log mutex.
+@return	true if the log is written or flushed far enough */
+UNIV_INLINE
+bool
+log_is_written_up_to(
+/*=================*/
+	lsn_t	lsn,		/*!< in: lsn */
+	ibool	flush_to_disk)	/*!< in: TRUE to check the flush to disk */
+{
+	/* We have only one log group */
+	return(flush_to_disk
+	       ? log_sys->flushed_to_disk_lsn >= lsn
+	       : log_sys->written_to_all_lsn >= lsn);
+}
+
+/******************************************************//**
+Checks if log_writer_thread and log_flusher_thread take care of the log
+writes and flushes.
+@return	true if log_write_up_to() should leave the writes to them */
+UNIV_INLINE
+bool
+log_writer_threads_active(void)
+/*===========================*/
+{
+	return(log_sys->writer_thread_active
+	       && log_sys->flusher_thread_active);
+}
+
+/******************************************************//**
+This function is called, e.g., when a transaction wants to commit. It checks
+that the log has been written to the log file up to the last log entry written
+by the transaction. If log_writer_thread and log_flusher_thread are running,
+it wakes them up and waits until they have written or flushed enough.
+Otherwise, if there is a flush running, it waits and checks if the flush
+flushed enough. If not, starts a new flush. */
+UNIV_INTERN
+void
+log_write_up_to(
+/*============*/
+	lsn_t	lsn,	/*!< in: log sequence number up to which
+			the log should be written,
+			LSN_MAX if not specified */
+	ulint	wait,	/*!< in: LOG_NO_WAIT, LOG_WAIT_ONE_GROUP,
+			or LOG_WAIT_ALL_GROUPS */
+	ibool	flush_to_disk)
+			/*!< in: TRUE if we want the written log
+			also to be flushed to disk */
+{
+	os_event_t	event;
+	ullint		counter_time;
+
+	ut_ad(!srv_read_only_mode);
+
+	if (recv_no_ibuf_operations || !log_writer_threads_active()) {
+
+		log_write_up_to_low(lsn, wait, flush_to_disk);
+
+		return;
+	}
+
+	if (lsn == LSN_MAX) {
+		mutex_enter(&log_sys->mutex);
+		lsn = log_sys->lsn;
+		mutex_exit(&log_sys->mutex);
+	}
+
+	if (log_is_written_up_to(lsn, flush_to_disk)) {
+
+		return;
+	}
+
+	/* Every thread that asks for a flush counts as a request, so that
+	log_writer_thread hands over the next write to log_flusher_thread
+	even if it has already started that write. */
+
+	if (flush_to_disk) {
+#ifdef HAVE_ATOMIC_BUILTINS
+		os_atomic_increment_ulint(&log_sys->n_flush_requests, 1);
+#else /* HAVE_ATOMIC_BUILTINS */
+		mutex_enter(&log_sys->mutex);
+		log_sys->n_flush_requests++;
+		mutex_exit(&log_sys->mutex);
+#endif /* HAVE_ATOMIC_BUILTINS */
+	}
+
+	os_event_set(log_sys->writer_event);
+
+	if (wait == LOG_NO_WAIT) {
+
+		return;
+	}
+
+	/* All the threads waiting for lsns in the same log block share the
+	event, and the log threads only set the events of the blocks that
+	they have written or flushed. Spurious wakeups are possible because
+	the events are shared modulo LOG_N_WAIT_EVENTS. */
+
+	event = log_wait_event(lsn, flush_to_disk);
+	counter_time = ut_time_us(NULL);
+
+	if (flush_to_disk) {
+		MONITOR_INC(MONITOR_LOG_FLUSH_WAITS);
+	} else {
+		MONITOR_INC(MONITOR_LOG_WRITE_WAITS);
+	}
+
+	for (;;) {
+		ib_int64_t	sig_count = os_event_reset(event);
+
+		if (log_is_written_up_to(lsn, flush_to_disk)) {
+			break;
+		}
+
+		if (!log_writer_threads_active()) {
+			/* The log threads have exited at shutdown */
+
+			log_write_up_to_low(lsn, wait, flush_to_disk);
+
+			break;
+		}
+
+		os_event_wait_low(event, sig_count);
+	}
+
+	MONITOR_INC_TIME_IN_MICRO_SECS(
+		MONITOR_LOG_WAIT_MICROSECOND, counter_time);
+}
+
+/******************************************************************//**
+The log writer thread: writes the log buffer to the log files when
+log_write_up_to() asks for it, and passes the written lsn to
+log_flusher_thread when a flush to disk has been requested.
+@return	a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_writer_thread)(
+/*==============================*/
+	void*	arg MY_ATTRIBUTE((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	ulint	n_flush_requests = 0;
+	lsn_t	written_lsn;
+	lsn_t	flushed_lsn;
+
+	ut_ad(!srv_read_only_mode);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(log_writer_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	mutex_enter(&log_sys->mutex);
+	written_lsn = log_sys->written_to_all_lsn;
+	flushed_lsn = log_sys->flushed_to_disk_lsn;
+	log_sys->writer_thread_active = true;
+	mutex_exit(&log_sys->mutex);
+
+	for (;;) {
+		ib_int64_t	sig_count;
+		ulint		requests;
+
+		sig_count = os_event_reset(log_sys->writer_event);
+
+		if (srv_shutdown_state >= SRV_SHUTDOWN_CLEANUP) {
+			break;
+		}
+
+		/* Read the flush requests before the write: the log
+		records of the requesting threads are then all included
+		in it. */
+
+		requests = log_sys->n_flush_requests;
+
+		log_write_up_to_low(LSN_MAX, LOG_WAIT_ALL_GROUPS, FALSE);
+
+		if (log_sys->written_to_all_lsn > written_lsn) {
+			lsn_t	lsn = log_sys->written_to_all_lsn;
+
+			MONITOR_INC(MONITOR_LOG_WRITER_WRITES);
+
+			log_wake_waiters(log_sys->write_events,
+					 written_lsn, lsn);
+			written_lsn = lsn;
+		}
+
+		if (srv_unix_file_flush_method == SRV_UNIX_O_DSYNC
+		    && log_sys->flushed_to_disk_lsn > flushed_lsn) {
+			/* The write flushed the log too */
+
+			lsn_t	lsn = log_sys->flushed_to_disk_lsn;
+
+			log_wake_waiters(log_sys->flush_events,
+					 flushed_lsn, lsn);
+			flushed_lsn = lsn;
+		}
+
+		if (requests != n_flush_requests) {
+			n_flush_requests = requests;
+
+			if (written_lsn > log_sys->flush_target_lsn) {
+				log_sys->flush_target_lsn = written_lsn;
+			}
+
+			os_event_set(log_sys->flusher_event);
+		}
+
+		/* This returns at once if a write has been requested
+		since the event was reset. */
+
+		os_event_wait_low(log_sys->writer_event, sig_count);
+	}
+
+	mutex_enter(&log_sys->mutex);
+	log_sys->writer_thread_active = false;
+	mutex_exit(&log_sys->mutex);
+
+	/* The waiting threads write the log themselves from now on */
+
+	for (ulint i = 0; i < LOG_N_WAIT_EVENTS; i++) {
+		os_event_set(log_sys->write_events[i]);
+		os_event_set(log_sys->flush_events[i]);
+	}
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/******************************************************************//**
+The log flusher thread: flushes the log files to disk up to the lsn
+written by log_writer_thread, while log_writer_thread may already write
+the next batch of log records.
+@return	a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(log_flusher_thread)(
+/*===============================*/
+	void*	arg MY_ATTRIBUTE((unused)))
+			/*!< in: a dummy parameter required by
+			os_thread_create */
+{
+	ut_ad(!srv_read_only_mode);
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(log_flusher_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	log_sys->flusher_thread_active = true;
+
+	for (;;) {
+		ib_int64_t	sig_count;
+		lsn_t		flush_lsn;
+		lsn_t		flushed_lsn;
+
+		sig_count = os_event_reset(log_sys->flusher_event);
+
+		if (srv_shutdown_state >= SRV_SHUTDOWN_CLEANUP) {
+			break;
+		}
+
+		flush_lsn = log_sys->flush_target_lsn;
+		flushed_lsn = log_sys->flushed_to_disk_lsn;
+
+		if (flush_lsn <= flushed_lsn) {
+			os_event_wait_low(log_sys->flusher_event, sig_count);
+
+			continue;
+		}
+
+		/* The log has been written up to flush_lsn before
+		log_writer_thread set it. fil_flush() serializes with the
+		flushes of other threads on the same file node. */
+
+		ullint	counter_time = ut_time_us(NULL);
+
+		fil_flush(UT_LIST_GET_FIRST(log_sys->log_groups)->space_id);
+
+		MONITOR_INC(MONITOR_LOG_FLUSHER_FLUSHES);
+		MONITOR_INC_TIME_IN_MICRO_SECS(
+			MONITOR_LOG_FLUSHER_MICROSECOND, counter_time);
+
+		mutex_enter(&log_sys->mutex);
+
+		flushed_lsn = log_sys->flushed_to_disk_lsn;
+
+		if (flush_lsn > flushed_lsn) {
+			log_sys->flushed_to_disk_lsn = flush_lsn;
+		}
+
+		mutex_exit(&log_sys->mutex);
+
+		if (flush_lsn > flushed_lsn) {
+			log_wake_waiters(log_sys->flush_events,
+					 flushed_lsn, flush_lsn);
+		}
+	}
+
+	log_sys->flusher_thread_active = false;
+
+	for (ulint i = 0; i < LOG_N_WAIT_EVENTS; i++) {
+		os_event_set(log_sys->flush_events[i]);
+	}
+
+	/* We count the number of threads in os_thread_exit(). A created
+	thread should always use that to exit and not use return() to exit. */
+
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /****************************************************************//**
-Does a syncronous flush of the log buffer to disk. */
+Writes the log buffer to the log files and, unless sync is false, waits
+for it to be flushed to disk. */
 UNIV_INTERN
 void
-log_buffer_flush_to_disk(void)
-/*==========================*/
+log_buffer_flush_to_disk(
+/*=====================*/
+	bool	sync)	/*!< in: whether to flush the log files */
 {
 	lsn_t	lsn;
 
@@ -1666,7 +2253,7 @@ log_buffer_flush_to_disk(void)
 
 	mutex_exit(&(log_sys->mutex));
 
-	log_write_up_to(lsn, LOG_WAIT_ALL_GROUPS, TRUE);
+	log_write_up_to(lsn, LOG_WAIT_ALL_GROUPS, sync);
 }
 
 /****************************************************************//**
@@ -3700,12 +4287,21 @@ log_shutdown(void)
 	mem_free(log_sys->buf_ptr);
 	log_sys->buf_ptr = NULL;
 	log_sys->buf = NULL;
+	mem_free((void*) log_sys->recent_written);
+	log_sys->recent_written = NULL;
 	mem_free(log_sys->checkpoint_buf_ptr);
 	log_sys->checkpoint_buf_ptr = NULL;
 	log_sys->checkpoint_buf = NULL;
 
 	os_event_free(log_sys->no_flush_event);
 	os_event_free(log_sys->one_flushed_event);
+	os_event_free(log_sys->writer_event);
+	os_event_free(log_sys->flusher_event);
+
+	for (ulint i = 0; i < LOG_N_WAIT_EVENTS; i++) {
+		os_event_free(log_sys->write_events[i]);
+		os_event_free(log_sys->flush_events[i]);
+	}
 
 	rw_lock_free(&log_sys->checkpoint_lock);
 
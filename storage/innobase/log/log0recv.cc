@@ -68,6 +68,11 @@ UNIV_INTERN ibool	recv_replay_file_ops	= TRUE;
 this must be less than UNIV_PAGE_SIZE as it is stored in the buffer pool */
 #define RECV_DATA_BLOCK_SIZE	(MEM_MAX_ALLOC_IN_BUF - sizeof(recv_data_t))
 
+/** The first this many bytes of a log record body are stored immediately
+after its recv_t, in the same allocation from recv_sys->heap. Most log
+records fit there entirely and need no recv_data_t chunk. */
+#define RECV_DATA_INLINE_SIZE	(MEM_MAX_ALLOC_IN_BUF - sizeof(recv_t))
+
 /** Read-ahead area in applying log records to file pages */
 #define RECV_READ_AHEAD_AREA	32
 
@@ -166,6 +171,7 @@ UNIV_INTERN mysql_pfs_key_t	recv_sys_mutex_key;
 #ifndef UNIV_HOTBACKUP
 # ifdef UNIV_PFS_THREAD
 UNIV_INTERN mysql_pfs_key_t	recv_writer_thread_key;
+UNIV_INTERN mysql_pfs_key_t	recv_apply_thread_key;
 # endif /* UNIV_PFS_THREAD */
 
 # ifdef UNIV_PFS_MUTEX
@@ -1461,6 +1467,7 @@ recv_add_to_hash_table(
 {
 	recv_t*		recv;
 	ulint		len;
+	ulint		inline_len;
 	recv_data_t*	recv_data;
 	recv_data_t**	prev_field;
 	recv_addr_t*	recv_addr;
@@ -1474,14 +1481,20 @@ recv_add_to_hash_table(
 
 	len = rec_end - body;
 
+	inline_len = ut_min(len, RECV_DATA_INLINE_SIZE);
+
 	recv = static_cast<recv_t*>(
-		mem_heap_alloc(recv_sys->heap, sizeof(recv_t)));
+		mem_heap_alloc(recv_sys->heap, sizeof(recv_t) + inline_len));
 
 	recv->type = type;
-	recv->len = rec_end - body;
+	recv->len = static_cast<ib_uint32_t>(len);
 	recv->start_lsn = start_lsn;
 	recv->end_lsn = end_lsn;
 
+	memcpy(recv + 1, body, inline_len);
+
+	body += inline_len;
+
 	recv_addr = recv_get_fil_addr_struct(space, page_no);
 
 	if (recv_addr == NULL) {
@@ -1507,9 +1520,9 @@ recv_add_to_hash_table(
 
 	prev_field = &(recv->data);
 
-	/* Store the log record body in chunks of less than UNIV_PAGE_SIZE:
-	recv_sys->heap grows into the buffer pool, and bigger chunks could not
-	be allocated */
+	/* Store the rest of the log record body in chunks of less than
+	UNIV_PAGE_SIZE: recv_sys->heap grows into the buffer pool, and
+	bigger chunks could not be allocated */
 
 	while (rec_end > body) {
 
@@ -1548,7 +1561,12 @@ recv_data_copy_to_buf(
 	ulint		part_len;
 	ulint		len;
 
-	len = recv->len;
+	part_len = ut_min(recv->len, RECV_DATA_INLINE_SIZE);
+
+	ut_memcpy(buf, recv + 1, part_len);
+	buf += part_len;
+
+	len = recv->len - part_len;
 	recv_data = recv->data;
 
 	while (len > 0) {
@@ -1680,7 +1698,7 @@ recv_recover_page_func(
 	while (recv) {
 		end_lsn = recv->end_lsn;
 
-		if (recv->len > RECV_DATA_BLOCK_SIZE) {
+		if (recv->len > RECV_DATA_INLINE_SIZE) {
 			/* We have to copy the record body to a separate
 			buffer */
 
@@ -1688,7 +1706,7 @@ recv_recover_page_func(
 
 			recv_data_copy_to_buf(buf, recv);
 		} else {
-			buf = ((byte*)(recv->data)) + sizeof(recv_data_t);
+			buf = reinterpret_cast<byte*>(recv + 1);
 		}
 
 		if (recv->type == MLOG_INIT_FILE_PAGE) {
@@ -1738,7 +1756,7 @@ recv_recover_page_func(
 			}
 		}
 
-		if (recv->len > RECV_DATA_BLOCK_SIZE) {
+		if (recv->len > RECV_DATA_INLINE_SIZE) {
 			mem_free(buf);
 		}
 
@@ -1835,6 +1853,111 @@ recv_read_in_area(
 	return(n);
 }
 
+/*******************************************************************//**
+Applies the hashed log records of every step'th hash cell, starting from
+the cell first, to the pages. Pages in the buffer pool are recovered
+right away. For the other pages, the surrounding area is read ahead
+asynchronously by recv_read_in_area(), and the i/o handler threads
+recover the pages when the reads complete. The caller must own
+recv_sys->mutex, it is released while pages are recovered or read. */
+static
+void
+recv_apply_hashed_cells(
+/*====================*/
+	ulint	first,		/*!< in: first hash cell */
+	ulint	step,		/*!< in: number of apply threads */
+	ibool	print_progress)	/*!< in: TRUE if progress in percent
+				should be printed */
+{
+	recv_addr_t*	recv_addr;
+	ulint		n_cells = hash_get_n_cells(recv_sys->addr_hash);
+	mtr_t		mtr;
+
+	ut_ad(mutex_own(&recv_sys->mutex));
+
+	for (ulint i = first; i < n_cells; i += step) {
+
+		for (recv_addr = static_cast<recv_addr_t*>(
+				HASH_GET_FIRST(recv_sys->addr_hash, i));
+		     recv_addr != 0;
+		     recv_addr = static_cast<recv_addr_t*>(
+				HASH_GET_NEXT(addr_hash, recv_addr))) {
+
+			ulint	space = recv_addr->space;
+			ulint	zip_size = fil_space_get_zip_size(space);
+			ulint	page_no = recv_addr->page_no;
+
+			if (recv_addr->state == RECV_NOT_PROCESSED) {
+
+				mutex_exit(&(recv_sys->mutex));
+
+				if (buf_page_peek(space, page_no)) {
+					buf_block_t*	block;
+
+					mtr_start(&mtr);
+
+					block = buf_page_get(
+						space, zip_size, page_no,
+						RW_X_LATCH, &mtr);
+					buf_block_dbg_add_level(
+						block, SYNC_NO_ORDER_CHECK);
+
+					recv_recover_page(FALSE, block);
+					mtr_commit(&mtr);
+				} else {
+					recv_read_in_area(space, zip_size,
+							  page_no);
+				}
+
+				mutex_enter(&(recv_sys->mutex));
+			}
+		}
+
+		if (print_progress
+		    && (i * 100) / n_cells != ((i + step) * 100) / n_cells) {
+
+			fprintf(stderr, "%lu ", (ulong) ((i * 100) / n_cells));
+		}
+	}
+}
+
+/******************************************************************//**
+Thread which applies its share of a batch of hashed log records, see
+recv_apply_hashed_log_recs().
+@return a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(recv_apply_thread)(
+/*==============================*/
+	void*	arg)	/*!< in: number of the thread, the first hash
+			cell it applies */
+{
+	my_thread_init();
+
+#ifdef UNIV_PFS_THREAD
+	pfs_register_thread(recv_apply_thread_key);
+#endif /* UNIV_PFS_THREAD */
+
+	mutex_enter(&(recv_sys->mutex));
+
+	recv_apply_hashed_cells(reinterpret_cast<ulint>(arg),
+				recv_sys->n_apply_threads, FALSE);
+
+	ut_a(recv_sys->n_apply_threads_active > 0);
+	recv_sys->n_apply_threads_active--;
+
+	mutex_exit(&(recv_sys->mutex));
+
+	my_thread_end();
+
+	/* We count the number of threads in os_thread_exit().
+	A created thread should always use that to exit and not
+	use return() to exit. */
+	os_thread_exit(NULL);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
 /*******************************************************************//**
 Empties the hash table of stored log records, applying them to appropriate
 pages. */
@@ -1852,10 +1975,9 @@ recv_apply_hashed_log_recs(
 				the caller must in this case own the log
 				mutex */
 {
-	recv_addr_t* recv_addr;
 	ulint	i;
+	ulint	n_threads;
 	ibool	has_printed	= FALSE;
-	mtr_t	mtr;
 loop:
 	mutex_enter(&(recv_sys->mutex));
 
@@ -1877,62 +1999,40 @@ loop:
 	recv_sys->apply_log_recs = TRUE;
 	recv_sys->apply_batch_on = TRUE;
 
-	for (i = 0; i < hash_get_n_cells(recv_sys->addr_hash); i++) {
+	n_threads = ut_min(srv_n_recv_apply_threads,
+			   hash_get_n_cells(recv_sys->addr_hash));
 
-		for (recv_addr = static_cast<recv_addr_t*>(
-				HASH_GET_FIRST(recv_sys->addr_hash, i));
-		     recv_addr != 0;
-		     recv_addr = static_cast<recv_addr_t*>(
-				HASH_GET_NEXT(addr_hash, recv_addr))) {
-
-			ulint	space = recv_addr->space;
-			ulint	zip_size = fil_space_get_zip_size(space);
-			ulint	page_no = recv_addr->page_no;
+	if (recv_sys->n_addrs != 0) {
+		has_printed = TRUE;
 
-			if (recv_addr->state == RECV_NOT_PROCESSED) {
-				if (!has_printed) {
-					ib_logf(IB_LOG_LEVEL_INFO,
-						"Starting an apply batch"
-						" of log records"
-						" to the database...");
-					fputs("InnoDB: Progress in percent: ",
-					      stderr);
-					has_printed = TRUE;
-				}
+		ib_logf(IB_LOG_LEVEL_INFO,
+			"Starting an apply batch of log records"
+			" to the database with %lu threads...",
+			(ulong) n_threads);
+		fputs("InnoDB: Progress in percent: ", stderr);
+	}
 
-				mutex_exit(&(recv_sys->mutex));
+	/* Fan out the hash cells, that is the pages partitioned by
+	recv_fold(space, page_no), over the apply threads. This thread
+	applies the first share itself. */
 
-				if (buf_page_peek(space, page_no)) {
-					buf_block_t*	block;
+	recv_sys->n_apply_threads = n_threads;
+	recv_sys->n_apply_threads_active = n_threads - 1;
 
-					mtr_start(&mtr);
+	for (i = 1; i < n_threads; i++) {
+		os_thread_create(recv_apply_thread,
+				 reinterpret_cast<void*>(i), NULL);
+	}
 
-					block = buf_page_get(
-						space, zip_size, page_no,
-						RW_X_LATCH, &mtr);
-					buf_block_dbg_add_level(
-						block, SYNC_NO_ORDER_CHECK);
+	recv_apply_hashed_cells(0, n_threads, has_printed);
 
-					recv_recover_page(FALSE, block);
-					mtr_commit(&mtr);
-				} else {
-					recv_read_in_area(space, zip_size,
-							  page_no);
-				}
+	while (recv_sys->n_apply_threads_active != 0) {
 
-				mutex_enter(&(recv_sys->mutex));
-			}
-		}
+		mutex_exit(&(recv_sys->mutex));
 
-		if (has_printed
-		    && (i * 100) / hash_get_n_cells(recv_sys->addr_hash)
-		    != ((i + 1) * 100)
-		    / hash_get_n_cells(recv_sys->addr_hash)) {
+		os_thread_sleep(100000);
 
-			fprintf(stderr, "%lu ", (ulong)
-				((i * 100)
-				 / hash_get_n_cells(recv_sys->addr_hash)));
-		}
+		mutex_enter(&(recv_sys->mutex));
 	}
 
 	/* Wait until all the pages have been processed */
@@ -2911,6 +3011,30 @@ recv_scan_log_recs(
 }
 
 #ifndef UNIV_HOTBACKUP
+/*******************************************************//**
+Gets the amount of memory the hashed log records may take in
+recv_sys->heap before they are applied in a batch. The heap grows into
+the buffer pool, and innodb_recovery_max_memory can bound it further,
+so that the memory used by recovery does not depend on the amount of
+redo log to apply.
+@return	memory limit in bytes */
+static
+ulint
+recv_heap_max_size(void)
+/*====================*/
+{
+	ulint	max_size = (buf_pool_get_n_pages()
+			    - (recv_n_pool_free_frames
+			       * srv_buf_pool_instances))
+		* UNIV_PAGE_SIZE;
+
+	if (srv_recv_max_memory != 0 && srv_recv_max_memory < max_size) {
+		max_size = srv_recv_max_memory;
+	}
+
+	return(max_size);
+}
+
 /*******************************************************//**
 Scans log from a buffer and stores new log data to the parsing buffer. Parses
 and hashes the log records if new data found. */
@@ -2940,9 +3064,7 @@ recv_group_scan_log_recs(
 				       group, start_lsn, end_lsn);
 
 		finished = recv_scan_log_recs(
-			(buf_pool_get_n_pages()
-			- (recv_n_pool_free_frames * srv_buf_pool_instances))
-			* UNIV_PAGE_SIZE,
+			recv_heap_max_size(),
 			TRUE, log_sys->buf, RECV_SCAN_SIZE,
 			start_lsn, contiguous_lsn, group_scanned_lsn);
 		start_lsn = end_lsn;
@@ -3335,6 +3457,7 @@ recv_recovery_from_checkpoint_start_func(
 
 	log_sys->buf_free = (ulint) log_sys->lsn % OS_FILE_LOG_BLOCK_SIZE;
 	log_sys->buf_next_to_write = log_sys->buf_free;
+	log_sys->buf_ready_lsn = log_sys->lsn;
 	log_sys->written_to_some_lsn = log_sys->lsn;
 	log_sys->written_to_all_lsn = log_sys->lsn;
 
@@ -3556,6 +3679,7 @@ recv_reset_logs(
 
 	log_sys->buf_free = LOG_BLOCK_HDR_SIZE;
 	log_sys->lsn += LOG_BLOCK_HDR_SIZE;
+	log_sys->buf_ready_lsn = log_sys->lsn;
 
 	MONITOR_SET(MONITOR_LSN_CHECKPOINT_AGE,
 		    (log_sys->lsn - log_sys->last_checkpoint_lsn));
@@ -3825,9 +3949,7 @@ ask_again:
 		       read_offset % UNIV_PAGE_SIZE, len, buf, NULL);
 
 		ret = recv_scan_log_recs(
-			(buf_pool_get_n_pages()
-			- (recv_n_pool_free_frames * srv_buf_pool_instances))
-			* UNIV_PAGE_SIZE, TRUE, buf, len, start_lsn,
+			recv_heap_max_size(), TRUE, buf, len, start_lsn,
 			&dummy_lsn, &scanned_lsn);
 
 		if (scanned_lsn == file_end_lsn) {
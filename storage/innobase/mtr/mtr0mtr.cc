@@ -230,7 +230,38 @@ mtr_add_dirtied_pages_to_flush_list(
 }
 
 /************************************************************//**
-Writes the contents of a mini-transaction log, if any, to the database log. */
+Copies the log records of a mini-transaction to the space reserved for them
+in the log buffer, and marks the space as copied to. */
+static
+void
+mtr_log_write(
+/*==========*/
+	mtr_t*	mtr,	/*!< in: mtr */
+	byte*	ptr)	/*!< in: reserved space in the log buffer,
+			or NULL if nothing is to be copied */
+{
+	dyn_array_t*	mlog = &(mtr->log);
+
+	if (ptr != NULL) {
+		for (dyn_block_t* block = mlog;
+		     block != 0;
+		     block = dyn_array_get_next_block(mlog, block)) {
+
+			ptr = log_buffer_write(
+				ptr,
+				dyn_block_get_data(block),
+				dyn_block_get_used(block));
+		}
+	}
+
+	log_buffer_link(mtr->start_lsn, mtr->end_lsn);
+}
+
+/************************************************************//**
+Writes the contents of a mini-transaction log, if any, to the database log.
+Only the reservation of the space in the log buffer is done under the log
+mutex: the log records are copied to it after the mutex has been released,
+concurrently with other mini-transactions. */
 static
 void
 mtr_log_reserve_and_write(
@@ -240,6 +271,7 @@ mtr_log_reserve_and_write(
 	dyn_array_t*	mlog;
 	ulint		data_size;
 	byte*		first_data;
+	byte*		log_ptr		= NULL;
 
 	ut_ad(!srv_read_only_mode);
 
@@ -260,35 +292,28 @@ mtr_log_reserve_and_write(
 		len = mtr->log_mode != MTR_LOG_NO_REDO
 			? dyn_block_get_used(mlog) : 0;
 
-		mtr->end_lsn = log_reserve_and_write_fast(
-			first_data, len, &mtr->start_lsn);
+		mtr->end_lsn = log_reserve_fast(
+			first_data, len, &mtr->start_lsn, &log_ptr);
 
 		if (mtr->end_lsn) {
 
-			/* Success. We have the log mutex.
-			Add pages to flush list and exit */
-			mtr_add_dirtied_pages_to_flush_list(mtr);
+			/* Success. We have the log mutex. */
+			if (len == 0) {
+				log_ptr = NULL;
+			}
 
-			return;
+			goto reserved;
 		}
 	}
 
 	data_size = dyn_array_get_data_size(mlog);
 
-	/* Open the database log for log_write_low */
+	/* Open the database log for log_buffer_reserve */
 	mtr->start_lsn = log_reserve_and_open(data_size);
 
 	if (mtr->log_mode == MTR_LOG_ALL) {
 
-		for (dyn_block_t* block = mlog;
-		     block != 0;
-		     block = dyn_array_get_next_block(mlog, block)) {
-
-			log_write_low(
-				dyn_block_get_data(block),
-				dyn_block_get_used(block));
-		}
-
+		log_ptr = log_buffer_reserve(data_size);
 	} else {
 		ut_ad(mtr->log_mode == MTR_LOG_NONE
 		      || mtr->log_mode == MTR_LOG_NO_REDO);
@@ -297,7 +322,19 @@ mtr_log_reserve_and_write(
 
 	mtr->end_lsn = log_close();
 
+reserved:
+#ifdef HAVE_ATOMIC_BUILTINS
+	mtr_add_dirtied_pages_to_flush_list(mtr);
+
+	/* We still hold the latches on the modified pages, so that they
+	cannot be flushed before the log records are in the log buffer */
+	mtr_log_write(mtr, log_ptr);
+#else
+	/* log_buffer_link() needs the log mutex */
+	mtr_log_write(mtr, log_ptr);
+
 	mtr_add_dirtied_pages_to_flush_list(mtr);
+#endif /* HAVE_ATOMIC_BUILTINS */
 }
 #endif /* !UNIV_HOTBACKUP */
 
@@ -44,6 +44,12 @@ using namespace std;
 #include "page0types.h"
 #include "log0recv.h"
 #include "zlib.h"
+#ifdef HAVE_LZ4
+# include <lz4.h>
+#endif /* HAVE_LZ4 */
+#ifdef HAVE_ZSTD
+# include <zstd.h>
+#endif /* HAVE_ZSTD */
 #ifndef UNIV_HOTBACKUP
 # include "buf0buf.h"
 # include "buf0lru.h"
@@ -74,6 +80,9 @@ UNIV_INTERN mysql_pfs_key_t		page_zip_stat_per_index_mutex_key;
 /* Compression level to be used by zlib. Settable by user. */
 UNIV_INTERN uint	page_zip_level = DEFAULT_COMPRESSION_LEVEL;
 
+/* Codec for compressing pages, PAGE_ZIP_CODEC_ZLIB, ... Settable by user. */
+UNIV_INTERN ulong	page_zip_codec = PAGE_ZIP_CODEC_ZLIB;
+
 /* Whether or not to log compressed page images to avoid possible
 compression algorithm changes in zlib. */
 UNIV_INTERN my_bool	page_zip_log_pages = true;
@@ -761,6 +770,412 @@ page_zip_set_alloc(
 	strm->opaque = heap;
 }
 
+/**********************************************************************//**
+Determine if a codec was compiled in.
+@return	true if pages can be compressed and decompressed with the codec */
+UNIV_INTERN
+bool
+page_zip_codec_is_available(
+/*========================*/
+	ulint	codec)	/*!< in: codec, PAGE_ZIP_CODEC_ZLIB, ... */
+{
+	switch (codec) {
+	case PAGE_ZIP_CODEC_ZLIB:
+		return(true);
+#ifdef HAVE_LZ4
+	case PAGE_ZIP_CODEC_LZ4:
+		return(true);
+#endif /* HAVE_LZ4 */
+#ifdef HAVE_ZSTD
+	case PAGE_ZIP_CODEC_ZSTD:
+		return(true);
+#endif /* HAVE_ZSTD */
+	}
+
+	return(false);
+}
+
+/** Size of the header of a stream that was not compressed with zlib:
+codec, compressed length and length of the index information */
+#define PAGE_ZIP_CODEC_HEADER_SIZE	5
+
+/** Maximum uncompressed length of a stream: the index information
+and the compressed part of an uncompressed page */
+#define PAGE_ZIP_CODEC_RAW_SIZE		(2 * UNIV_PAGE_SIZE)
+
+/** Compressed page stream.  The records are passed to deflate() and
+read by inflate() piece by piece, at the positions where they are
+stored on the uncompressed page.  Codecs other than zlib compress and
+decompress the whole stream at once.  For them, the pieces are
+collected to and read from an uncompressed copy of the stream, so that
+the same code compresses and decompresses the records for every codec. */
+struct page_zip_stream_t : public z_stream {
+	ulint		codec;		/*!< PAGE_ZIP_CODEC_ZLIB, ... */
+	ulint		level;		/*!< compression level */
+	byte*		raw;		/*!< uncompressed stream, or NULL */
+	ulint		raw_len;	/*!< length of raw */
+	ulint		raw_pos;	/*!< inflate(): current position
+					in raw */
+	ulint		block_len;	/*!< length of the index
+					information at the start of raw */
+	ulint		payload_len;	/*!< inflate(): length of the
+					stream on the compressed page */
+	bool		consumed;	/*!< inflate(): whether next_in
+					has been moved past the stream */
+};
+
+/**********************************************************************//**
+Compress a stream with a codec other than zlib.
+@return	compressed length, or 0 if the data does not fit in dst */
+static
+ulint
+page_zip_codec_compress(
+/*====================*/
+	ulint		codec,	/*!< in: codec */
+	ulint		level,	/*!< in: compression level, 0..9 */
+	const byte*	src,	/*!< in: data to compress */
+	ulint		src_len,/*!< in: length of src */
+	byte*		dst,	/*!< out: compressed data */
+	ulint		dst_len)/*!< in: size of dst */
+{
+	switch (codec) {
+#ifdef HAVE_LZ4
+	case PAGE_ZIP_CODEC_LZ4:
+		/* Higher levels trade speed for compression by
+		reducing the acceleration factor. */
+		return(static_cast<ulint>(LZ4_compress_fast(
+			reinterpret_cast<const char*>(src),
+			reinterpret_cast<char*>(dst),
+			static_cast<int>(src_len),
+			static_cast<int>(dst_len),
+			static_cast<int>(10 - ut_min(level, 9UL)))));
+#endif /* HAVE_LZ4 */
+#ifdef HAVE_ZSTD
+	case PAGE_ZIP_CODEC_ZSTD:
+		{
+			size_t	len = ZSTD_compress(
+				dst, dst_len, src, src_len,
+				static_cast<int>(ut_max(level, 1UL)));
+
+			return(ZSTD_isError(len) ? 0 : len);
+		}
+#endif /* HAVE_ZSTD */
+	}
+
+	ut_ad(0);
+	return(0);
+}
+
+/**********************************************************************//**
+Decompress a stream with a codec other than zlib.
+@return	uncompressed length, or 0 if the data is corrupted */
+static
+ulint
+page_zip_codec_decompress(
+/*======================*/
+	ulint		codec,	/*!< in: codec */
+	const byte*	src,	/*!< in: compressed data */
+	ulint		src_len,/*!< in: length of src */
+	byte*		dst,	/*!< out: uncompressed data */
+	ulint		dst_len)/*!< in: size of dst */
+{
+	switch (codec) {
+#ifdef HAVE_LZ4
+	case PAGE_ZIP_CODEC_LZ4:
+		{
+			int	len = LZ4_decompress_safe(
+				reinterpret_cast<const char*>(src),
+				reinterpret_cast<char*>(dst),
+				static_cast<int>(src_len),
+				static_cast<int>(dst_len));
+
+			return(len < 0 ? 0 : static_cast<ulint>(len));
+		}
+#endif /* HAVE_LZ4 */
+#ifdef HAVE_ZSTD
+	case PAGE_ZIP_CODEC_ZSTD:
+		{
+			size_t	len = ZSTD_decompress(
+				dst, dst_len, src, src_len);
+
+			return(ZSTD_isError(len) ? 0 : len);
+		}
+#endif /* HAVE_ZSTD */
+	}
+
+	return(0);
+}
+
+/**********************************************************************//**
+Initialize a stream for compressing a page.
+@return	Z_OK, or Z_STREAM_ERROR if the codec is not available */
+static
+int
+page_zip_deflate_init(
+/*==================*/
+	page_zip_stream_t*	strm,	/*!< out: compressed stream */
+	ulint			level,	/*!< in: compression level
+					and codec */
+	mem_heap_t*		heap)	/*!< in: memory heap to use */
+{
+	page_zip_set_alloc(strm, heap);
+
+	strm->codec = level >> PAGE_ZIP_CODEC_SHIFT;
+	strm->level = level & PAGE_ZIP_LEVEL_MASK;
+	strm->raw = NULL;
+
+	if (strm->codec == PAGE_ZIP_CODEC_ZLIB) {
+		return(deflateInit2(strm, static_cast<int>(strm->level),
+				    Z_DEFLATED, UNIV_PAGE_SIZE_SHIFT,
+				    MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY));
+	}
+
+	if (!page_zip_codec_is_available(strm->codec)) {
+		return(Z_STREAM_ERROR);
+	}
+
+	strm->raw = static_cast<byte*>(
+		mem_heap_alloc(heap, PAGE_ZIP_CODEC_RAW_SIZE));
+	strm->raw_len = 0;
+	strm->block_len = ULINT_UNDEFINED;
+	strm->total_in = strm->total_out = 0;
+	strm->msg = NULL;
+
+	return(Z_OK);
+}
+
+/**********************************************************************//**
+Compress data.  Other codecs than zlib collect the data until Z_FINISH.
+@return	deflate() status: Z_OK, Z_BUF_ERROR, ... */
+static
+int
+page_zip_deflate(
+/*=============*/
+	z_streamp	strm,	/*!< in/out: compressed stream */
+	int		flush)	/*!< in: Z_NO_FLUSH, Z_FULL_FLUSH, Z_FINISH */
+{
+	page_zip_stream_t*	s = static_cast<page_zip_stream_t*>(strm);
+
+	if (s->codec == PAGE_ZIP_CODEC_ZLIB) {
+		return(deflate(strm, flush));
+	}
+
+	ut_a(s->raw_len + s->avail_in <= PAGE_ZIP_CODEC_RAW_SIZE);
+
+	memcpy(s->raw + s->raw_len, s->next_in, s->avail_in);
+	s->raw_len += s->avail_in;
+	s->total_in += s->avail_in;
+	s->next_in += s->avail_in;
+	s->avail_in = 0;
+
+	switch (flush) {
+	case Z_NO_FLUSH:
+		return(Z_OK);
+	case Z_FULL_FLUSH:
+		/* The index information ends here. */
+		ut_ad(s->block_len == ULINT_UNDEFINED);
+		s->block_len = s->raw_len;
+		return(Z_OK);
+	case Z_FINISH:
+		break;
+	default:
+		ut_error;
+	}
+
+	ut_ad(s->block_len <= s->raw_len);
+
+	if (s->avail_out <= PAGE_ZIP_CODEC_HEADER_SIZE) {
+		return(Z_BUF_ERROR);
+	}
+
+	ulint	len = page_zip_codec_compress(
+		s->codec, s->level, s->raw, s->raw_len,
+		s->next_out + PAGE_ZIP_CODEC_HEADER_SIZE,
+		s->avail_out - PAGE_ZIP_CODEC_HEADER_SIZE);
+
+	if (!len) {
+		return(Z_BUF_ERROR);
+	}
+
+	ut_ad(len <= 0xFFFF);
+
+	mach_write_to_1(s->next_out, s->codec);
+	mach_write_to_2(s->next_out + 1, len);
+	mach_write_to_2(s->next_out + 3, s->block_len);
+
+	len += PAGE_ZIP_CODEC_HEADER_SIZE;
+	s->next_out += len;
+	s->avail_out -= static_cast<uInt>(len);
+	s->total_out += len;
+
+	return(Z_STREAM_END);
+}
+
+/**********************************************************************//**
+Free a compressed stream.
+@return	deflateEnd() status */
+static
+int
+page_zip_deflate_end(
+/*=================*/
+	z_streamp	strm)	/*!< in/out: compressed stream */
+{
+	if (static_cast<page_zip_stream_t*>(strm)->codec
+	    == PAGE_ZIP_CODEC_ZLIB) {
+		return(deflateEnd(strm));
+	}
+
+	return(Z_OK);
+}
+
+/**********************************************************************//**
+Initialize a stream for decompressing a page.  The codec is determined
+from the first byte of the stream.
+@return	inflateInit2() status */
+static
+int
+page_zip_inflate_init(
+/*==================*/
+	page_zip_stream_t*	strm,	/*!< in/out: next_in and avail_in
+					of the compressed stream */
+	mem_heap_t*		heap)	/*!< in: memory heap to use */
+{
+	page_zip_set_alloc(strm, heap);
+
+	strm->raw = NULL;
+
+	if ((*strm->next_in & 0xF) == Z_DEFLATED) {
+		strm->codec = PAGE_ZIP_CODEC_ZLIB;
+		return(inflateInit2(strm, UNIV_PAGE_SIZE_SHIFT));
+	}
+
+	/* The stream is decompressed by the first page_zip_inflate(),
+	so that errors will be reported by it. */
+	strm->codec = *strm->next_in;
+	strm->raw_len = strm->raw_pos = 0;
+	strm->consumed = false;
+	strm->total_in = strm->total_out = 0;
+	strm->msg = NULL;
+
+	return(Z_OK);
+}
+
+/**********************************************************************//**
+Decompress a stream that was compressed with a codec other than zlib.
+@return	true on success, false if the stream is corrupted */
+static
+bool
+page_zip_inflate_raw(
+/*=================*/
+	page_zip_stream_t*	s)	/*!< in/out: compressed stream */
+{
+	const byte*	header = s->next_in;
+
+	if (s->avail_in <= PAGE_ZIP_CODEC_HEADER_SIZE) {
+		return(false);
+	}
+
+	s->payload_len = PAGE_ZIP_CODEC_HEADER_SIZE
+		+ mach_read_from_2(header + 1);
+	s->block_len = mach_read_from_2(header + 3);
+
+	if (s->payload_len > s->avail_in) {
+		return(false);
+	}
+
+	s->raw = static_cast<byte*>(
+		mem_heap_alloc(static_cast<mem_heap_t*>(s->opaque),
+			       PAGE_ZIP_CODEC_RAW_SIZE));
+
+	s->raw_len = page_zip_codec_decompress(
+		s->codec, header + PAGE_ZIP_CODEC_HEADER_SIZE,
+		s->payload_len - PAGE_ZIP_CODEC_HEADER_SIZE,
+		s->raw, PAGE_ZIP_CODEC_RAW_SIZE);
+
+	return(s->raw_len >= s->block_len && s->block_len > 0);
+}
+
+/**********************************************************************//**
+Decompress data.  Other codecs than zlib copy the data from the
+uncompressed stream.  Like inflate(), Z_BLOCK stops at the end of the
+index information, and Z_STREAM_END is returned as soon as the end of
+the stream is reached.  Then next_in, avail_in and total_in are updated
+to skip the compressed stream.
+@return	inflate() status: Z_OK, Z_STREAM_END, Z_BUF_ERROR, ... */
+static
+int
+page_zip_inflate(
+/*=============*/
+	z_streamp	strm,	/*!< in/out: compressed stream */
+	int		flush)	/*!< in: Z_BLOCK, Z_SYNC_FLUSH, Z_FINISH */
+{
+	page_zip_stream_t*	s = static_cast<page_zip_stream_t*>(strm);
+
+	if (s->codec == PAGE_ZIP_CODEC_ZLIB) {
+		return(inflate(strm, flush));
+	}
+
+	if (s->raw == NULL && !page_zip_inflate_raw(s)) {
+		s->msg = const_cast<char*>("corrupted stream");
+		return(Z_DATA_ERROR);
+	}
+
+	ulint	end = s->raw_len;
+
+	if (flush == Z_BLOCK) {
+		if (s->raw_pos < s->block_len) {
+			end = s->block_len;
+		} else {
+			return(Z_OK);
+		}
+	}
+
+	ulint	len = ut_min(end - s->raw_pos, ulint(s->avail_out));
+
+	memcpy(s->next_out, s->raw + s->raw_pos, len);
+	s->raw_pos += len;
+	s->next_out += len;
+	s->avail_out -= static_cast<uInt>(len);
+	s->total_out += len;
+
+	if (s->raw_pos < s->raw_len || flush == Z_BLOCK) {
+		return(len ? Z_OK : Z_BUF_ERROR);
+	}
+
+	if (!s->consumed) {
+		if (s->payload_len > s->avail_in) {
+			/* The stream overlaps the space reserved
+			for uncompressed data. */
+			s->msg = const_cast<char*>("corrupted stream");
+			return(Z_DATA_ERROR);
+		}
+
+		s->next_in += s->payload_len;
+		s->avail_in -= static_cast<uInt>(s->payload_len);
+		s->total_in = s->payload_len;
+		s->consumed = true;
+	}
+
+	return(Z_STREAM_END);
+}
+
+/**********************************************************************//**
+Free a decompressed stream.
+@return	inflateEnd() status */
+static
+int
+page_zip_inflate_end(
+/*=================*/
+	z_streamp	strm)	/*!< in/out: compressed stream */
+{
+	if (static_cast<page_zip_stream_t*>(strm)->codec
+	    == PAGE_ZIP_CODEC_ZLIB) {
+		return(inflateEnd(strm));
+	}
+
+	return(Z_OK);
+}
+
 #if 0 || defined UNIV_DEBUG || defined UNIV_ZIP_DEBUG
 /** Symbol for enabling compression and decompression diagnostics */
 # define PAGE_ZIP_COMPRESS_DBG
@@ -794,21 +1209,20 @@ page_zip_compress_deflate(
 	if (UNIV_LIKELY_NULL(logfile)) {
 		fwrite(strm->next_in, 1, strm->avail_in, logfile);
 	}
-	status = deflate(strm, flush);
+	status = page_zip_deflate(strm, flush);
 	if (UNIV_UNLIKELY(page_zip_compress_dbg)) {
 		fprintf(stderr, " -> %d\n", status);
 	}
 	return(status);
 }
 
-/* Redefine deflate(). */
-# undef deflate
-/** Debug wrapper for the zlib compression routine deflate().
+/** Debug wrapper for the compression routine page_zip_deflate().
 Log the operation if page_zip_compress_dbg is set.
 @param strm	in/out: compressed stream
 @param flush	in: flushing method
 @return		deflate() status: Z_OK, Z_BUF_ERROR, ... */
-# define deflate(strm, flush) page_zip_compress_deflate(logfile, strm, flush)
+# define page_zip_deflate(strm, flush)			\
+	page_zip_compress_deflate(logfile, strm, flush)
 /** Declaration of the logfile parameter */
 # define FILE_LOGFILE FILE* logfile,
 /** The logfile parameter */
@@ -856,7 +1270,7 @@ page_zip_compress_node_ptrs(
 			rec - REC_N_NEW_EXTRA_BYTES - c_stream->next_in);
 
 		if (c_stream->avail_in) {
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 				break;
 			}
@@ -869,7 +1283,7 @@ page_zip_compress_node_ptrs(
 			rec_offs_data_size(offsets) - REC_NODE_PTR_SIZE);
 
 		if (c_stream->avail_in) {
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 				break;
 			}
@@ -914,7 +1328,7 @@ page_zip_compress_sec(
 		if (UNIV_LIKELY(c_stream->avail_in)) {
 			UNIV_MEM_ASSERT_RW(c_stream->next_in,
 					   c_stream->avail_in);
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 				break;
 			}
@@ -978,7 +1392,7 @@ page_zip_compress_clust_ext(
 				src - c_stream->next_in);
 
 			if (c_stream->avail_in) {
-				err = deflate(c_stream, Z_NO_FLUSH);
+				err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 				if (UNIV_UNLIKELY(err != Z_OK)) {
 
 					return(err);
@@ -1007,7 +1421,7 @@ page_zip_compress_clust_ext(
 			c_stream->avail_in = static_cast<uInt>(
 				src - c_stream->next_in);
 			if (UNIV_LIKELY(c_stream->avail_in)) {
-				err = deflate(c_stream, Z_NO_FLUSH);
+				err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 				if (UNIV_UNLIKELY(err != Z_OK)) {
 
 					return(err);
@@ -1105,7 +1519,7 @@ page_zip_compress_clust(
 			- c_stream->next_in);
 
 		if (c_stream->avail_in) {
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 
 				goto func_exit;
@@ -1153,7 +1567,7 @@ page_zip_compress_clust(
 				src - c_stream->next_in);
 
 			if (c_stream->avail_in) {
-				err = deflate(c_stream, Z_NO_FLUSH);
+				err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 				if (UNIV_UNLIKELY(err != Z_OK)) {
 
 					return(err);
@@ -1181,7 +1595,7 @@ page_zip_compress_clust(
 			rec + rec_offs_data_size(offsets) - c_stream->next_in);
 
 		if (c_stream->avail_in) {
-			err = deflate(c_stream, Z_NO_FLUSH);
+			err = page_zip_deflate(c_stream, Z_NO_FLUSH);
 			if (UNIV_UNLIKELY(err != Z_OK)) {
 
 				goto func_exit;
@@ -1209,7 +1623,7 @@ page_zip_compress(
 	ulint		level,	/*!< in: compression level */
 	mtr_t*		mtr)	/*!< in: mini-transaction, or NULL */
 {
-	z_stream	c_stream;
+	page_zip_stream_t	c_stream;
 	int		err;
 	ulint		n_fields;/* number of index fields needed */
 	byte*		fields;	/*!< index field information */
@@ -1328,11 +1742,7 @@ page_zip_compress(
 	buf_end = buf + page_zip_get_size(page_zip) - PAGE_DATA;
 
 	/* Compress the data payload. */
-	page_zip_set_alloc(&c_stream, heap);
-
-	err = deflateInit2(&c_stream, static_cast<int>(level),
-			   Z_DEFLATED, UNIV_PAGE_SIZE_SHIFT,
-			   MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+	err = page_zip_deflate_init(&c_stream, level, heap);
 	ut_a(err == Z_OK);
 
 	c_stream.next_out = buf;
@@ -1377,7 +1787,7 @@ page_zip_compress(
 	}
 
 	UNIV_MEM_ASSERT_RW(c_stream.next_in, c_stream.avail_in);
-	err = deflate(&c_stream, Z_FULL_FLUSH);
+	err = page_zip_deflate(&c_stream, Z_FULL_FLUSH);
 	if (err != Z_OK) {
 		goto zlib_error;
 	}
@@ -1431,11 +1841,11 @@ page_zip_compress(
 	ut_a(c_stream.avail_in <= UNIV_PAGE_SIZE - PAGE_ZIP_START - PAGE_DIR);
 
 	UNIV_MEM_ASSERT_RW(c_stream.next_in, c_stream.avail_in);
-	err = deflate(&c_stream, Z_FINISH);
+	err = page_zip_deflate(&c_stream, Z_FINISH);
 
 	if (UNIV_UNLIKELY(err != Z_STREAM_END)) {
 zlib_error:
-		deflateEnd(&c_stream);
+		page_zip_deflate_end(&c_stream);
 		mem_heap_free(heap);
 err_exit:
 #ifdef PAGE_ZIP_COMPRESS_DBG
@@ -1461,7 +1871,7 @@ err_exit:
 		return(FALSE);
 	}
 
-	err = deflateEnd(&c_stream);
+	err = page_zip_deflate_end(&c_stream);
 	ut_a(err == Z_OK);
 
 	ut_ad(buf + c_stream.total_out == c_stream.next_out);
@@ -2239,7 +2649,7 @@ page_zip_decompress_node_ptrs(
 
 		ut_ad(d_stream->avail_out < UNIV_PAGE_SIZE
 		      - PAGE_ZIP_START - PAGE_DIR);
-		switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+		switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 		case Z_STREAM_END:
 			page_zip_decompress_heap_no(
 				d_stream, rec, heap_status);
@@ -2274,7 +2684,7 @@ page_zip_decompress_node_ptrs(
 		d_stream->avail_out =static_cast<uInt>(
 			rec_offs_data_size(offsets) - REC_NODE_PTR_SIZE);
 
-		switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+		switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 		case Z_STREAM_END:
 			goto zlib_done;
 		case Z_OK:
@@ -2313,12 +2723,12 @@ page_zip_decompress_node_ptrs(
 		goto zlib_error;
 	}
 
-	if (UNIV_UNLIKELY(inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
+	if (UNIV_UNLIKELY(page_zip_inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
 		page_zip_fail(("page_zip_decompress_node_ptrs:"
 			       " inflate(Z_FINISH)=%s\n",
 			       d_stream->msg));
 zlib_error:
-		inflateEnd(d_stream);
+		page_zip_inflate_end(d_stream);
 		return(FALSE);
 	}
 
@@ -2326,7 +2736,7 @@ zlib_error:
 	if the modification log is nonempty. */
 
 zlib_done:
-	if (UNIV_UNLIKELY(inflateEnd(d_stream) != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate_end(d_stream) != Z_OK)) {
 		ut_error;
 	}
 
@@ -2427,7 +2837,7 @@ page_zip_decompress_sec(
 			rec - REC_N_NEW_EXTRA_BYTES - d_stream->next_out);
 
 		if (UNIV_LIKELY(d_stream->avail_out)) {
-			switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+			switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 			case Z_STREAM_END:
 				page_zip_decompress_heap_no(
 					d_stream, rec, heap_status);
@@ -2467,12 +2877,12 @@ page_zip_decompress_sec(
 		goto zlib_error;
 	}
 
-	if (UNIV_UNLIKELY(inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
+	if (UNIV_UNLIKELY(page_zip_inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
 		page_zip_fail(("page_zip_decompress_sec:"
 			       " inflate(Z_FINISH)=%s\n",
 			       d_stream->msg));
 zlib_error:
-		inflateEnd(d_stream);
+		page_zip_inflate_end(d_stream);
 		return(FALSE);
 	}
 
@@ -2480,7 +2890,7 @@ zlib_error:
 	if the modification log is nonempty. */
 
 zlib_done:
-	if (UNIV_UNLIKELY(inflateEnd(d_stream) != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate_end(d_stream) != Z_OK)) {
 		ut_error;
 	}
 
@@ -2573,7 +2983,7 @@ page_zip_decompress_clust_ext(
 			d_stream->avail_out = static_cast<uInt>(
 				dst - d_stream->next_out);
 
-			switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+			switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 			case Z_STREAM_END:
 			case Z_OK:
 			case Z_BUF_ERROR:
@@ -2604,7 +3014,7 @@ page_zip_decompress_clust_ext(
 
 			d_stream->avail_out = static_cast<uInt>(
 				dst - d_stream->next_out);
-			switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+			switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 			case Z_STREAM_END:
 			case Z_OK:
 			case Z_BUF_ERROR:
@@ -2683,7 +3093,7 @@ page_zip_decompress_clust(
 
 		ut_ad(d_stream->avail_out < UNIV_PAGE_SIZE
 		      - PAGE_ZIP_START - PAGE_DIR);
-		err = inflate(d_stream, Z_SYNC_FLUSH);
+		err = page_zip_inflate(d_stream, Z_SYNC_FLUSH);
 		switch (err) {
 		case Z_STREAM_END:
 			page_zip_decompress_heap_no(
@@ -2740,7 +3150,7 @@ page_zip_decompress_clust(
 			d_stream->avail_out = static_cast<uInt>(
 				dst - d_stream->next_out);
 
-			switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+			switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 			case Z_STREAM_END:
 			case Z_OK:
 			case Z_BUF_ERROR:
@@ -2770,7 +3180,7 @@ page_zip_decompress_clust(
 		d_stream->avail_out = static_cast<uInt>(
 			rec_get_end(rec, offsets) - d_stream->next_out);
 
-		switch (inflate(d_stream, Z_SYNC_FLUSH)) {
+		switch (page_zip_inflate(d_stream, Z_SYNC_FLUSH)) {
 		case Z_STREAM_END:
 		case Z_OK:
 		case Z_BUF_ERROR:
@@ -2800,12 +3210,12 @@ page_zip_decompress_clust(
 		goto zlib_error;
 	}
 
-	if (UNIV_UNLIKELY(inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
+	if (UNIV_UNLIKELY(page_zip_inflate(d_stream, Z_FINISH) != Z_STREAM_END)) {
 		page_zip_fail(("page_zip_decompress_clust:"
 			       " inflate(Z_FINISH)=%s\n",
 			       d_stream->msg));
 zlib_error:
-		inflateEnd(d_stream);
+		page_zip_inflate_end(d_stream);
 		return(FALSE);
 	}
 
@@ -2813,7 +3223,7 @@ zlib_error:
 	if the modification log is nonempty. */
 
 zlib_done:
-	if (UNIV_UNLIKELY(inflateEnd(d_stream) != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate_end(d_stream) != Z_OK)) {
 		ut_error;
 	}
 
@@ -2957,7 +3367,7 @@ page_zip_decompress(
 				page header fields that should not change
 				after page creation */
 {
-	z_stream	d_stream;
+	page_zip_stream_t	d_stream;
 	dict_index_t*	index	= NULL;
 	rec_t**		recs;	/*!< dense page directory, sorted by address */
 	ulint		n_dense;/* number of user records on the page */
@@ -3041,8 +3451,6 @@ zlib_error:
 	memcpy(page + (PAGE_NEW_SUPREMUM - REC_N_NEW_EXTRA_BYTES + 1),
 	       supremum_extra_data, sizeof supremum_extra_data);
 
-	page_zip_set_alloc(&d_stream, heap);
-
 	d_stream.next_in = page_zip->data + PAGE_DATA;
 	/* Subtract the space reserved for
 	the page header and the end marker of the modification log. */
@@ -3051,20 +3459,19 @@ zlib_error:
 	d_stream.next_out = page + PAGE_ZIP_START;
 	d_stream.avail_out = UNIV_PAGE_SIZE - PAGE_ZIP_START;
 
-	if (UNIV_UNLIKELY(inflateInit2(&d_stream, UNIV_PAGE_SIZE_SHIFT)
-			  != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate_init(&d_stream, heap) != Z_OK)) {
 		ut_error;
 	}
 
-	/* Decode the zlib header and the index information. */
-	if (UNIV_UNLIKELY(inflate(&d_stream, Z_BLOCK) != Z_OK)) {
+	/* Decode the stream header and the index information. */
+	if (UNIV_UNLIKELY(page_zip_inflate(&d_stream, Z_BLOCK) != Z_OK)) {
 
 		page_zip_fail(("page_zip_decompress:"
 			       " 1 inflate(Z_BLOCK)=%s\n", d_stream.msg));
 		goto zlib_error;
 	}
 
-	if (UNIV_UNLIKELY(inflate(&d_stream, Z_BLOCK) != Z_OK)) {
+	if (UNIV_UNLIKELY(page_zip_inflate(&d_stream, Z_BLOCK) != Z_OK)) {
 
 		page_zip_fail(("page_zip_decompress:"
 			       " 2 inflate(Z_BLOCK)=%s\n", d_stream.msg));
@@ -4643,7 +5050,8 @@ page_zip_reorganize(
 	/* Restore logging. */
 	mtr_set_log_mode(mtr, log_mode);
 
-	if (!page_zip_compress(page_zip, page, index, page_zip_level, mtr)) {
+	if (!page_zip_compress(page_zip, page, index, page_zip_get_level(),
+			       mtr)) {
 
 #ifndef UNIV_HOTBACKUP
 		buf_block_free(temp_block);
@@ -205,7 +205,8 @@ que_thr_end_lock_wait(
 	que_thr_t*	thr;
 	ibool		was_active;
 
-	ut_ad(lock_mutex_own());
+	/* The caller owns lock_sys->mutex, or the lock_sys->rec_hash
+	partition mutex of the record lock which is granted to trx. */
 	ut_ad(trx_mutex_own(trx));
 
 	thr = trx->lock.wait_thr;
@@ -172,6 +172,18 @@ In which order will the views be opened? Should it matter? If no, why?
 
 The order does not matter. No new transactions can be created and no running
 transaction can commit or rollback (or free views).
+
+What if an auto-commit non-locking transaction reuses its closed read view
+without acquiring trx_sys->mutex while purge is opening its view?
+
+The closed view stays in trx_sys_t::view_list and purge skips it. The owner
+first marks the view open and then checks, after a full memory barrier,
+that trx_sys_t::rw_trx_version has not changed since the view was created.
+If purge did not see the view as open, then purge created or cloned its
+view under trx_sys->mutex from the same set of read-write transactions and
+serialisation numbers. The view is reused only in that case; it differs
+from a newly created view only by the ids of read-only transactions, which
+do not modify anything.
 */
 
 /*********************************************************************//**
@@ -191,7 +203,9 @@ read_view_create_low(
 			heap, sizeof(*view) + n * sizeof(*view->trx_ids)));
 
 	view->n_trx_ids = n;
+	view->max_trx_ids = n;
 	view->trx_ids = (trx_id_t*) &view[1];
+	view->closed = FALSE;
 
 	return(view);
 }
@@ -231,10 +245,13 @@ read_view_clone(
 	memcpy(clone, view, sz);
 
 	clone->trx_ids = (trx_id_t*) &clone[1];
+	clone->max_trx_ids = clone->n_trx_ids;
 
 	new_view = (read_view_t*) &clone->trx_ids[clone->n_trx_ids];
 	new_view->trx_ids = (trx_id_t*) &new_view[1];
 	new_view->n_trx_ids = clone->n_trx_ids + 1;
+	new_view->max_trx_ids = new_view->n_trx_ids;
+	new_view->closed = FALSE;
 
 	ut_a(new_view->n_trx_ids == view->n_trx_ids + 1);
 
@@ -273,52 +290,70 @@ read_view_add(
 	ut_ad(read_view_list_validate());
 }
 
-/** Functor to create thew view trx_ids array. */
-struct	CreateView {
+/*********************************************************************//**
+Copies the ids of the active read-write transactions from
+trx_sys->rw_trx_ids to the view and sets the limits of the view. The
+view must have room for trx_sys->n_rw_trx_ids ids. */
+static
+void
+read_view_fill(
+/*===========*/
+	read_view_t*	view,		/*!< in/out: read view */
+	trx_id_t	exclude_id)	/*!< in: trx id that the view should
+					see, or 0 */
+{
+	ulint		n_ids = trx_sys->n_rw_trx_ids;
+	const trx_id_t*	ids = trx_sys->rw_trx_ids;
+	const trx_t*	trx;
+	ulint		pos;
 
-	CreateView(read_view_t*	view)
-		: m_view(view)
-	{
-		  m_n_trx = m_view->n_trx_ids;
-		  m_view->n_trx_ids = 0;
-	}
+	ut_ad(mutex_own(&trx_sys->mutex));
+	ut_a(view->max_trx_ids >= n_ids);
 
-	void	operator()(const trx_t* trx)
-	{
-		ut_ad(mutex_own(&trx_sys->mutex));
-		ut_ad(trx->in_rw_trx_list);
+	/* Committed in memory transactions have already been removed
+	from trx_sys->rw_trx_ids. */
 
-		/* trx->state cannot change from or to NOT_STARTED
-		while we are holding the trx_sys->mutex. It may change
-		from ACTIVE to PREPARED or COMMITTED. */
+	pos = exclude_id > 0 ? trx_sys_rw_trx_ids_find(exclude_id) : n_ids;
 
-		if (trx->id != m_view->creator_trx_id
-		    && !trx_state_eq(trx, TRX_STATE_COMMITTED_IN_MEMORY)) {
+	if (pos < n_ids && ids[pos] == exclude_id) {
 
-			ut_ad(m_n_trx > m_view->n_trx_ids);
+		memcpy(view->trx_ids, ids, pos * sizeof(*ids));
+		memcpy(view->trx_ids + pos, ids + pos + 1,
+		       (n_ids - pos - 1) * sizeof(*ids));
 
-			m_view->trx_ids[m_view->n_trx_ids++] = trx->id;
+		view->n_trx_ids = n_ids - 1;
+	} else {
+		memcpy(view->trx_ids, ids, n_ids * sizeof(*ids));
 
-			/* NOTE that a transaction whose trx number is <
-			trx_sys->max_trx_id can still be active, if it is
-			in the middle of its commit! Note that when a
-			transaction starts, we initialize trx->no to
-			TRX_ID_MAX. */
+		view->n_trx_ids = n_ids;
+	}
 
-			/* trx->no is protected by trx_sys->mutex, which
-			we are holding. It is assigned by trx_commit()
-			before lock_trx_release_locks() assigns
-			trx->state = TRX_STATE_COMMITTED_IN_MEMORY. */
+	/* No future transactions should be visible in the view */
 
-			if (m_view->low_limit_no > trx->no) {
-				m_view->low_limit_no = trx->no;
-			}
-		}
+	view->low_limit_id = trx_sys->max_trx_id;
+	view->low_limit_no = view->low_limit_id;
+
+	/* NOTE that a transaction whose trx number is <
+	trx_sys->max_trx_id can still be active, if it is
+	in the middle of its commit! The serialisation list
+	is sorted on trx->no, smallest first. */
+
+	trx = UT_LIST_GET_FIRST(trx_sys->serialisation_list);
+
+	if (trx != NULL && trx->no < view->low_limit_no) {
+		view->low_limit_no = trx->no;
 	}
 
-	read_view_t*	m_view;
-	ulint		m_n_trx;
-};
+	if (view->n_trx_ids > 0) {
+		/* The first active transaction has the smallest id: */
+		view->up_limit_id = view->trx_ids[0];
+	} else {
+		view->up_limit_id = view->low_limit_id;
+	}
+
+	view->version = trx_sys->rw_trx_version;
+	view->closed = FALSE;
+}
 
 /*********************************************************************//**
 Opens a read view where exactly the transactions serialized before this
@@ -334,31 +369,18 @@ read_view_open_now_low(
 					allocated */
 {
 	read_view_t*	view;
-	ulint		n_trx = UT_LIST_GET_LEN(trx_sys->rw_trx_list);
 
 	ut_ad(mutex_own(&trx_sys->mutex));
 
-	view = read_view_create_low(n_trx, heap);
+	view = read_view_create_low(trx_sys->n_rw_trx_ids, heap);
 
 	view->undo_no = 0;
 	view->type = VIEW_NORMAL;
 	view->creator_trx_id = cr_trx_id;
 
-	/* No future transactions should be visible in the view */
-
-	view->low_limit_no = trx_sys->max_trx_id;
-	view->low_limit_id = view->low_limit_no;
-
 	/* No active transaction should be visible, except cr_trx */
 
-	ut_list_map(trx_sys->rw_trx_list, &trx_t::trx_list, CreateView(view));
-
-	if (view->n_trx_ids > 0) {
-		/* The last active transaction has the smallest id: */
-		view->up_limit_id = view->trx_ids[view->n_trx_ids - 1];
-	} else {
-		view->up_limit_id = view->low_limit_id;
-	}
+	read_view_fill(view, cr_trx_id);
 
 	/* Purge views are not added to the view list. */
 	if (cr_trx_id > 0) {
@@ -369,23 +391,69 @@ read_view_open_now_low(
 }
 
 /*********************************************************************//**
-Opens a read view where exactly the transactions serialized before this
-point in time are seen in the view.
-@return	own: read view struct */
+Opens a read view for a MySQL transaction where exactly the transactions
+serialized before this point in time are seen in the view. The memory of
+the previous view of the transaction is reused if it is large enough. A
+closed view of an auto-commit non-locking transaction is reused as is,
+without acquiring trx_sys->mutex, if no read-write transaction has been
+started, serialised or committed since it was created.
+@return	read view struct */
 UNIV_INTERN
 read_view_t*
-read_view_open_now(
-/*===============*/
-	trx_id_t	cr_trx_id,	/*!< in: trx_id of creating
-					transaction, or 0 used in purge */
-	mem_heap_t*	heap)		/*!< in: memory heap from which
-					allocated */
+read_view_open_for_mysql(
+/*=====================*/
+	trx_t*		trx)	/*!< in/out: transaction */
 {
-	read_view_t*	view;
+	read_view_t*	view = trx->cached_read_view;
 
-	mutex_enter(&trx_sys->mutex);
+	ut_ad(trx->global_read_view == NULL);
+
+	trx->cached_read_view = NULL;
+
+	if (view != NULL && view->closed) {
+#ifdef HAVE_ATOMIC_BUILTINS
+		if (trx_is_autocommit_non_locking(trx)) {
+
+			/* Reopen the view before checking the version.
+			The compare-and-swap is a full memory barrier. */
+
+			os_compare_and_swap_ulint(&view->closed, TRUE, FALSE);
+
+			if (view->version == trx_sys->rw_trx_version) {
 
-	view = read_view_open_now_low(cr_trx_id, heap);
+				return(view);
+			}
+
+			view->closed = TRUE;
+		}
+#endif /* HAVE_ATOMIC_BUILTINS */
+
+		mutex_enter(&trx_sys->mutex);
+
+		UT_LIST_REMOVE(view_list, trx_sys->view_list, view);
+	} else {
+		mutex_enter(&trx_sys->mutex);
+	}
+
+	if (view == NULL || view->max_trx_ids < trx_sys->n_rw_trx_ids) {
+
+		/* Leave room for more transactions, so that the
+		memory can be reused by the following views. */
+
+		mem_heap_empty(trx->global_read_view_heap);
+
+		view = read_view_create_low(
+			2 * trx_sys->n_rw_trx_ids + 1,
+			trx->global_read_view_heap);
+	}
+
+	view->undo_no = 0;
+	view->type = VIEW_NORMAL;
+	view->creator_trx_id = trx->id;
+
+	read_view_fill(view, trx->id);
+
+	read_view_add(view);
 
 	mutex_exit(&trx_sys->mutex);
 
@@ -413,7 +481,13 @@ read_view_purge_open(
 
 	mutex_enter(&trx_sys->mutex);
 
-	oldest_view = UT_LIST_GET_LAST(trx_sys->view_list);
+	/* Closed views are only kept for reuse, skip them. */
+
+	for (oldest_view = UT_LIST_GET_LAST(trx_sys->view_list);
+	     oldest_view != NULL && oldest_view->closed;
+	     oldest_view = UT_LIST_GET_PREV(view_list, oldest_view)) {
+		/* No op */
+	}
 
 	if (oldest_view == NULL) {
 
@@ -445,7 +519,7 @@ read_view_purge_open(
 
 		id = oldest_view->trx_ids[i - insert_done];
 
-		if (insert_done == 0 && creator_trx_id > id) {
+		if (insert_done == 0 && creator_trx_id < id) {
 			id = creator_trx_id;
 			insert_done = 1;
 		}
@@ -466,9 +540,9 @@ read_view_purge_open(
 	view->low_limit_id = oldest_view->low_limit_id;
 
 	if (view->n_trx_ids > 0) {
-		/* The last active transaction has the smallest id: */
+		/* The first active transaction has the smallest id: */
 
-		view->up_limit_id = view->trx_ids[view->n_trx_ids - 1];
+		view->up_limit_id = view->trx_ids[0];
 	} else {
 		view->up_limit_id = oldest_view->up_limit_id;
 	}
@@ -478,23 +552,57 @@ read_view_purge_open(
 
 /*********************************************************************//**
 Closes a consistent read view for MySQL. This function is called at an SQL
-statement end if the trx isolation level is <= TRX_ISO_READ_COMMITTED. */
+statement end if the trx isolation level is <= TRX_ISO_READ_COMMITTED and
+at transaction commit. The memory of the view is kept for the next view of
+the transaction. The view of an auto-commit non-locking transaction is left
+in trx_sys->view_list, marked closed. */
 UNIV_INTERN
 void
 read_view_close_for_mysql(
 /*======================*/
-	trx_t*		trx)	/*!< in: trx which has a read view */
+	trx_t*		trx,		/*!< in: trx which has a read view */
+	bool		own_mutex)	/*!< in: true if caller owns the
+					trx_sys_t::mutex */
 {
-	ut_a(trx->global_read_view);
+	read_view_t*	view = trx->global_read_view;
 
-	read_view_remove(trx->global_read_view, false);
+	ut_a(view != NULL);
+	ut_ad(!view->closed);
+	ut_ad(trx->cached_read_view == NULL);
 
-	mem_heap_empty(trx->global_read_view_heap);
+	if (trx_is_autocommit_non_locking(trx)) {
+		view->closed = TRUE;
+	} else {
+		read_view_remove(view, own_mutex);
+	}
 
+	trx->cached_read_view = view;
 	trx->read_view = NULL;
 	trx->global_read_view = NULL;
 }
 
+/*********************************************************************//**
+Frees the cached read view of a MySQL transaction, removing it from
+trx_sys->view_list if it is still there. */
+UNIV_INTERN
+void
+read_view_free_for_mysql(
+/*=====================*/
+	trx_t*		trx)	/*!< in/out: transaction */
+{
+	read_view_t*	view = trx->cached_read_view;
+
+	if (view != NULL) {
+		if (view->closed) {
+			read_view_remove(view, false);
+		}
+
+		trx->cached_read_view = NULL;
+
+		mem_heap_empty(trx->global_read_view_heap);
+	}
+}
+
 /*********************************************************************//**
 Prints a read view to stderr. */
 UNIV_INTERN
@@ -546,7 +654,6 @@ read_cursor_view_create_for_mysql(
 {
 	read_view_t*	view;
 	mem_heap_t*	heap;
-	ulint		n_trx;
 	cursor_view_t*	curview;
 
 	/* Use larger heap than in trx_create when creating a read_view
@@ -567,34 +674,19 @@ read_cursor_view_create_for_mysql(
 
 	mutex_enter(&trx_sys->mutex);
 
-	n_trx = UT_LIST_GET_LEN(trx_sys->rw_trx_list);
-
-	curview->read_view = read_view_create_low(n_trx, curview->heap);
+	curview->read_view = read_view_create_low(
+		trx_sys->n_rw_trx_ids, curview->heap);
 
 	view = curview->read_view;
 	view->undo_no = cr_trx->undo_no;
 	view->type = VIEW_HIGH_GRANULARITY;
-	view->creator_trx_id = UINT64_UNDEFINED;
-
-	/* No future transactions should be visible in the view */
-
-	view->low_limit_no = trx_sys->max_trx_id;
-	view->low_limit_id = view->low_limit_no;
 
-	/* No active transaction should be visible */
+	/* No active transaction should be visible, not even cr_trx */
 
-	ut_list_map(trx_sys->rw_trx_list, &trx_t::trx_list, CreateView(view));
+	read_view_fill(view, 0);
 
 	view->creator_trx_id = cr_trx->id;
 
-	if (view->n_trx_ids > 0) {
-		/* The last active transaction has the smallest id: */
-
-		view->up_limit_id = view->trx_ids[view->n_trx_ids - 1];
-	} else {
-		view->up_limit_id = view->low_limit_id;
-	}
-
 	read_view_add(view);
 
 	mutex_exit(&trx_sys->mutex);
@@ -734,7 +734,7 @@ loop:
 	/* If we run out of current sort buffer, need to sort
 	and flush the sort buffer to disk */
 	if (t_ctx.rows_added[t_ctx.buf_used] && !processed) {
-		row_merge_buf_sort(buf[t_ctx.buf_used], NULL);
+		row_merge_buf_sort(buf[t_ctx.buf_used], NULL, 1);
 		row_merge_buf_write(buf[t_ctx.buf_used],
 				    merge_file[t_ctx.buf_used],
 				    block[t_ctx.buf_used]);
@@ -800,7 +800,7 @@ exit:
 	be hold in one block memory */
 	for (i = 0; i < FTS_NUM_AUX_INDEX; i++) {
 		if (t_ctx.rows_added[i]) {
-			row_merge_buf_sort(buf[i], NULL);
+			row_merge_buf_sort(buf[i], NULL, 1);
 			row_merge_buf_write(
 				buf[i], merge_file[i], block[i]);
 
@@ -865,7 +865,7 @@ exit:
 
 		error = row_merge_sort(psort_info->psort_common->trx,
 				       psort_info->psort_common->dup,
-				       merge_file[i], block[i], &tmpfd[i]);
+				       merge_file[i], &tmpfd[i], 1);
 		if (error != DB_SUCCESS) {
 			close(tmpfd[i]);
 			goto func_exit;
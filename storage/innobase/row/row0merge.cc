@@ -743,6 +743,109 @@ row_merge_tuple_sort(
 			      tuples, aux, low, high, row_merge_tuple_cmp_ctx);
 }
 
+/** Minimum number of tuples that a thread sorts in
+row_merge_tuple_sort_par() */
+#define ROW_MERGE_SORT_PAR_MIN_TUPLES	4096
+
+/** A part of a sort buffer that is sorted in a thread of its own */
+struct row_merge_sort_part_t {
+	ulint		n_uniq;		/*!< number of unique fields */
+	ulint		n_field;	/*!< number of fields */
+	mtuple_t*	tuples;		/*!< tuples */
+	mtuple_t*	aux;		/*!< work area */
+	ulint		low;		/*!< lower bound, inclusive */
+	ulint		high;		/*!< upper bound, exclusive */
+	ulint		n_threads;	/*!< number of threads to use */
+};
+
+/**********************************************************************//**
+Merge sort a part of the tuple buffer of a non-unique index in
+parallel threads. */
+static
+void
+row_merge_tuple_sort_par(
+/*=====================*/
+	row_merge_sort_part_t*	part);	/*!< in/out: sorting area */
+
+/*************************************************************//**
+Thread that sorts a part of a sort buffer.
+@return	a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(row_merge_tuple_sort_thread)(
+/*========================================*/
+	void*	arg)	/*!< in/out: row_merge_sort_part_t */
+{
+	row_merge_tuple_sort_par(static_cast<row_merge_sort_part_t*>(arg));
+
+	os_thread_exit(NULL, false);
+
+	OS_THREAD_DUMMY_RETURN;
+}
+
+/**********************************************************************//**
+Merge sort the tuple buffer of a non-unique index in main memory, in up
+to part->n_threads threads.  The lower half of the sorting area is sorted
+in a new thread while the calling thread sorts the upper half, and the
+calling thread merges the halves in the same way as
+row_merge_tuple_sort().  Duplicates are not reported, because
+row_merge_dup_report() is not thread-safe. */
+static
+void
+row_merge_tuple_sort_par(
+/*=====================*/
+	row_merge_sort_part_t*	part)	/*!< in/out: sorting area */
+{
+	const ulint	n_uniq	= part->n_uniq;
+	const ulint	n_field	= part->n_field;
+	mtuple_t*	tuples	= part->tuples;
+	mtuple_t*	aux	= part->aux;
+	const ulint	low	= part->low;
+	const ulint	high	= part->high;
+
+	if (part->n_threads < 2
+	    || high - low < 2 * ROW_MERGE_SORT_PAR_MIN_TUPLES) {
+		row_merge_tuple_sort(n_uniq, n_field, NULL,
+				     tuples, aux, low, high);
+		return;
+	}
+
+	const ulint		mid = (low + high) / 2;
+	row_merge_sort_part_t	lower = *part;
+	row_merge_sort_part_t	upper = *part;
+	os_thread_t		thread;
+
+	lower.high = mid;
+	lower.n_threads = part->n_threads / 2;
+	upper.low = mid;
+	upper.n_threads = part->n_threads - lower.n_threads;
+
+	thread = os_thread_create(row_merge_tuple_sort_thread, &lower, NULL);
+
+	row_merge_tuple_sort_par(&upper);
+
+	os_thread_join(thread);
+
+	ulint	l = low;
+	ulint	h = mid;
+
+	for (ulint i = low; i < high; i++) {
+		if (l >= mid) {
+			aux[i] = tuples[h++];
+		} else if (h >= high) {
+			aux[i] = tuples[l++];
+		} else if (row_merge_tuple_cmp(n_uniq, n_field,
+					       tuples[l], tuples[h], NULL)
+			   > 0) {
+			aux[i] = tuples[h++];
+		} else {
+			aux[i] = tuples[l++];
+		}
+	}
+
+	memcpy(tuples + low, aux + low, (high - low) * sizeof *tuples);
+}
+
 /******************************************************//**
 Sort a buffer. */
 UNIV_INTERN
@@ -750,9 +853,23 @@ void
 row_merge_buf_sort(
 /*===============*/
 	row_merge_buf_t*	buf,	/*!< in/out: sort buffer */
-	row_merge_dup_t*	dup)	/*!< in/out: reporter of duplicates
+	row_merge_dup_t*	dup,	/*!< in/out: reporter of duplicates
 					(NULL if non-unique index) */
+	ulint			n_threads)/*!< in: maximum number of
+					threads to sort a non-unique
+					index with */
 {
+	if (dup == NULL && n_threads > 1) {
+		row_merge_sort_part_t	part = {
+			dict_index_get_n_unique(buf->index),
+			dict_index_get_n_fields(buf->index),
+			buf->tuples, buf->tmp_tuples,
+			0, buf->n_tuples, n_threads};
+
+		row_merge_tuple_sort_par(&part);
+		return;
+	}
+
 	row_merge_tuple_sort(dict_index_get_n_unique(buf->index),
 			     dict_index_get_n_fields(buf->index),
 			     dup,
@@ -806,37 +923,6 @@ row_merge_buf_write(
 #endif /* UNIV_DEBUG */
 }
 
-/******************************************************//**
-Create a memory heap and allocate space for row_merge_rec_offsets()
-and mrec_buf_t[3].
-@return	memory heap */
-static
-mem_heap_t*
-row_merge_heap_create(
-/*==================*/
-	const dict_index_t*	index,		/*!< in: record descriptor */
-	mrec_buf_t**		buf,		/*!< out: 3 buffers */
-	ulint**			offsets1,	/*!< out: offsets */
-	ulint**			offsets2)	/*!< out: offsets */
-{
-	ulint		i	= 1 + REC_OFFS_HEADER_SIZE
-		+ dict_index_get_n_fields(index);
-	mem_heap_t*	heap	= mem_heap_create(2 * i * sizeof **offsets1
-						  + 3 * sizeof **buf);
-
-	*buf = static_cast<mrec_buf_t*>(
-		mem_heap_alloc(heap, 3 * sizeof **buf));
-	*offsets1 = static_cast<ulint*>(
-		mem_heap_alloc(heap, i * sizeof **offsets1));
-	*offsets2 = static_cast<ulint*>(
-		mem_heap_alloc(heap, i * sizeof **offsets2));
-
-	(*offsets1)[0] = (*offsets2)[0] = i;
-	(*offsets1)[1] = (*offsets2)[1] = dict_index_get_n_fields(index);
-
-	return(heap);
-}
-
 /********************************************************************//**
 Read a merge block from the file system.
 @return	TRUE if request was successful, FALSE if fail */
@@ -1795,7 +1881,7 @@ write_buffers:
 					row_merge_dup_t	dup = {
 						buf->index, table, col_map, 0};
 
-					row_merge_buf_sort(buf, &dup);
+					row_merge_buf_sort(buf, &dup, 1);
 
 					if (dup.n_dup) {
 						err = DB_DUPLICATE_KEY;
@@ -1804,7 +1890,9 @@ write_buffers:
 						break;
 					}
 				} else {
-					row_merge_buf_sort(buf, NULL);
+					row_merge_buf_sort(
+						buf, NULL,
+						srv_merge_sort_threads);
 				}
 			} else if (online && new_table == old_table) {
 				/* Note the newest transaction that
@@ -2001,343 +2089,347 @@ wait_again:
 	DBUG_RETURN(err);
 }
 
-/** Write a record via buffer 2 and read the next record to buffer N.
-@param N	number of the buffer (0 or 1)
-@param INDEX	record descriptor
-@param AT_END	statement to execute at end of input */
-#define ROW_MERGE_WRITE_GET_NEXT(N, INDEX, AT_END)			\
-	do {								\
-		b2 = row_merge_write_rec(&block[2 * srv_sort_buf_size], \
-					 &buf[2], b2,			\
-					 of->fd, &of->offset,		\
-					 mrec##N, offsets##N);		\
-		if (UNIV_UNLIKELY(!b2 || ++of->n_rec > file->n_rec)) {	\
-			goto corrupt;					\
-		}							\
-		b##N = row_merge_read_rec(&block[N * srv_sort_buf_size],\
-					  &buf[N], b##N, INDEX,		\
-					  file->fd, foffs##N,		\
-					  &mrec##N, offsets##N);	\
-		if (UNIV_UNLIKELY(!b##N)) {				\
-			if (mrec##N) {					\
-				goto corrupt;				\
-			}						\
-			AT_END;						\
-		}							\
-	} while (0)
+/** State of a thread merging groups of sorted runs.  The runs of a
+merge pass are merged in groups of up to n_ways consecutive runs, and
+the groups are distributed round-robin among the threads. */
+struct row_merge_worker_t {
+	trx_t*			trx;	/*!< transaction */
+	const row_merge_dup_t*	dup;	/*!< descriptor of index being
+					created */
+	struct TABLE*		table;	/*!< MySQL table, for reporting
+					duplicate key values, or NULL */
+	const merge_file_t*	file;	/*!< input file */
+	int			out_fd;	/*!< output file */
+	const ulint*		run_offset;/*!< first block of each input run */
+	ulint			n_run;	/*!< number of input runs */
+	ulint			n_ways;	/*!< maximum number of runs
+					merged by one group */
+	ulint			first;	/*!< first group to merge */
+	ulint			step;	/*!< distance between the groups
+					merged by this thread */
+	volatile ibool*		failed;/*!< in/out: set when some thread
+					fails */
+	row_merge_block_t*	block;	/*!< n_ways input blocks
+					followed by the output block */
+	ulint			block_size;/*!< size of block, in bytes */
+	mem_heap_t*		heap;	/*!< memory heap for the arrays */
+	mrec_buf_t*		buf;	/*!< buffers for records spanning
+					two blocks, [n_ways + 1] */
+	ulint*			foffs;	/*!< input file offsets */
+	const byte**		b;	/*!< positions in the input blocks */
+	const mrec_t**		mrec;	/*!< current record of each run,
+					NULL at the end of the run */
+	ulint**			offsets;/*!< offsets of mrec[] */
+	ulint*			tree;	/*!< loser tree; tree[0] is the
+					run holding the smallest record */
+	ulint			k;	/*!< number of runs in the group
+					being merged */
+	bool			dup_found;/*!< whether two records compared
+					equal */
+	ulint			n_rec;	/*!< out: number of records written */
+	ulint			end_offset;/*!< out: end of the last output
+					run written */
+	dberr_t			error;	/*!< out: error code */
+	os_event_t		done;	/*!< signalled when the pass
+					has been completed */
+	os_thread_t		thread;	/*!< thread handle */
+};
 
 /*************************************************************//**
-Merge two blocks of records on disk and write a bigger block.
-@return	DB_SUCCESS or error code */
+Allocate the buffers of a merge thread.
+@return	true on success, false if out of memory */
 static MY_ATTRIBUTE((nonnull, warn_unused_result))
-dberr_t
-row_merge_blocks(
-/*=============*/
-	const row_merge_dup_t*	dup,	/*!< in: descriptor of
-					index being created */
-	const merge_file_t*	file,	/*!< in: file containing
-					index entries */
-	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
-	ulint*			foffs0,	/*!< in/out: offset of first
-					source list in the file */
-	ulint*			foffs1,	/*!< in/out: offset of second
-					source list in the file */
-	merge_file_t*		of)	/*!< in/out: output file */
+bool
+row_merge_worker_create(
+/*====================*/
+	row_merge_worker_t*	w,	/*!< out: merge thread state */
+	ulint			n_ways)	/*!< in: maximum number of runs
+					merged at a time */
 {
-	mem_heap_t*	heap;	/*!< memory heap for offsets0, offsets1 */
-
-	mrec_buf_t*	buf;	/*!< buffer for handling
-				split mrec in block[] */
-	const byte*	b0;	/*!< pointer to block[0] */
-	const byte*	b1;	/*!< pointer to block[srv_sort_buf_size] */
-	byte*		b2;	/*!< pointer to block[2 * srv_sort_buf_size] */
-	const mrec_t*	mrec0;	/*!< merge rec, points to block[0] or buf[0] */
-	const mrec_t*	mrec1;	/*!< merge rec, points to
-				block[srv_sort_buf_size] or buf[1] */
-	ulint*		offsets0;/* offsets of mrec0 */
-	ulint*		offsets1;/* offsets of mrec1 */
-
-#ifdef UNIV_DEBUG
-	if (row_merge_print_block) {
-		fprintf(stderr,
-			"row_merge_blocks fd=%d ofs=%lu + fd=%d ofs=%lu"
-			" = fd=%d ofs=%lu\n",
-			file->fd, (ulong) *foffs0,
-			file->fd, (ulong) *foffs1,
-			of->fd, (ulong) of->offset);
-	}
-#endif /* UNIV_DEBUG */
+	const dict_index_t*	index = w->dup->index;
+	ulint			n_offs = 1 + REC_OFFS_HEADER_SIZE
+		+ dict_index_get_n_fields(index);
 
-	heap = row_merge_heap_create(dup->index, &buf, &offsets0, &offsets1);
+	w->n_ways = n_ways;
+	w->block_size = (n_ways + 1) * srv_sort_buf_size;
+	w->block = static_cast<row_merge_block_t*>(
+		os_mem_alloc_large(&w->block_size));
 
-	/* Write a record and read the next record.  Split the output
-	file in two halves, which can be merged on the following pass. */
+	if (w->block == NULL) {
+		return(false);
+	}
 
-	if (!row_merge_read(file->fd, *foffs0, &block[0])
-	    || !row_merge_read(file->fd, *foffs1, &block[srv_sort_buf_size])) {
-corrupt:
-		mem_heap_free(heap);
-		return(DB_CORRUPTION);
+	w->heap = mem_heap_create((n_ways + 1) * sizeof *w->buf
+				  + n_ways * (n_offs * sizeof **w->offsets
+					      + sizeof *w->offsets
+					      + sizeof *w->foffs
+					      + sizeof *w->b
+					      + sizeof *w->mrec
+					      + sizeof *w->tree));
+
+	w->buf = static_cast<mrec_buf_t*>(
+		mem_heap_alloc(w->heap, (n_ways + 1) * sizeof *w->buf));
+	w->foffs = static_cast<ulint*>(
+		mem_heap_alloc(w->heap, n_ways * sizeof *w->foffs));
+	w->b = static_cast<const byte**>(
+		mem_heap_alloc(w->heap, n_ways * sizeof *w->b));
+	w->mrec = static_cast<const mrec_t**>(
+		mem_heap_alloc(w->heap, n_ways * sizeof *w->mrec));
+	w->tree = static_cast<ulint*>(
+		mem_heap_alloc(w->heap, n_ways * sizeof *w->tree));
+	w->offsets = static_cast<ulint**>(
+		mem_heap_alloc(w->heap, n_ways * sizeof *w->offsets));
+
+	for (ulint i = 0; i < n_ways; i++) {
+		w->offsets[i] = static_cast<ulint*>(
+			mem_heap_alloc(w->heap,
+				       n_offs * sizeof **w->offsets));
+		w->offsets[i][0] = n_offs;
+		w->offsets[i][1] = dict_index_get_n_fields(index);
 	}
 
-	b0 = &block[0];
-	b1 = &block[srv_sort_buf_size];
-	b2 = &block[2 * srv_sort_buf_size];
+	w->done = os_event_create();
 
-	b0 = row_merge_read_rec(
-		&block[0], &buf[0], b0, dup->index,
-		file->fd, foffs0, &mrec0, offsets0);
-	b1 = row_merge_read_rec(
-		&block[srv_sort_buf_size],
-		&buf[srv_sort_buf_size], b1, dup->index,
-		file->fd, foffs1, &mrec1, offsets1);
-	if (UNIV_UNLIKELY(!b0 && mrec0)
-	    || UNIV_UNLIKELY(!b1 && mrec1)) {
+	return(true);
+}
 
-		goto corrupt;
+/*************************************************************//**
+Free the buffers of a merge thread. */
+static MY_ATTRIBUTE((nonnull))
+void
+row_merge_worker_free(
+/*==================*/
+	row_merge_worker_t*	w)	/*!< in/out: merge thread state */
+{
+	if (w->block != NULL) {
+		os_mem_free_large(w->block, w->block_size);
+		mem_heap_free(w->heap);
+		os_event_free(w->done);
 	}
+}
 
-	while (mrec0 && mrec1) {
-		switch (cmp_rec_rec_simple(
-				mrec0, mrec1, offsets0, offsets1,
-				dup->index, dup->table)) {
-		case 0:
-			mem_heap_free(heap);
-			return(DB_DUPLICATE_KEY);
-		case -1:
-			ROW_MERGE_WRITE_GET_NEXT(0, dup->index, goto merged);
-			break;
-		case 1:
-			ROW_MERGE_WRITE_GET_NEXT(1, dup->index, goto merged);
-			break;
-		default:
-			ut_error;
-		}
+/*************************************************************//**
+Compare the current records of two runs in the loser tree.  Run k
+stands for a record that is smaller than any other, and a run that
+has been exhausted for a record that is greater than any other.
+@return	true if the record of run r0 is smaller than that of run r1 */
+static MY_ATTRIBUTE((nonnull, warn_unused_result))
+bool
+row_merge_tree_less(
+/*================*/
+	row_merge_worker_t*	w,	/*!< in/out: merge thread state */
+	ulint			r0,	/*!< in: run */
+	ulint			r1)	/*!< in: run */
+{
+	if (r0 == w->k) {
+		return(true);
+	} else if (r1 == w->k) {
+		return(false);
+	} else if (w->mrec[r0] == NULL) {
+		return(false);
+	} else if (w->mrec[r1] == NULL) {
+		return(true);
 	}
 
-merged:
-	if (mrec0) {
-		/* append all mrec0 to output */
-		for (;;) {
-			ROW_MERGE_WRITE_GET_NEXT(0, dup->index, goto done0);
-		}
+	int	cmp = cmp_rec_rec_simple(
+		w->mrec[r0], w->mrec[r1], w->offsets[r0], w->offsets[r1],
+		w->dup->index, w->table);
+
+	if (UNIV_UNLIKELY(cmp == 0)) {
+		w->dup_found = true;
 	}
-done0:
-	if (mrec1) {
-		/* append all mrec1 to output */
-		for (;;) {
-			ROW_MERGE_WRITE_GET_NEXT(1, dup->index, goto done1);
+
+	return(cmp < 0);
+}
+
+/*************************************************************//**
+Replay the matches of a run from its leaf up to the root of the loser
+tree, after the current record of the run has changed.  The loser of
+each match stays in the node, and the overall winner is stored in
+tree[0]. */
+static MY_ATTRIBUTE((nonnull))
+void
+row_merge_tree_adjust(
+/*==================*/
+	row_merge_worker_t*	w,	/*!< in/out: merge thread state */
+	ulint			r)	/*!< in: run whose record changed */
+{
+	for (ulint t = (r + w->k) / 2; t > 0; t /= 2) {
+		if (row_merge_tree_less(w, w->tree[t], r)) {
+			ulint	winner = w->tree[t];
+			w->tree[t] = r;
+			r = winner;
 		}
 	}
-done1:
 
-	mem_heap_free(heap);
-	b2 = row_merge_write_eof(&block[2 * srv_sort_buf_size],
-				 b2, of->fd, &of->offset);
-	return(b2 ? DB_SUCCESS : DB_CORRUPTION);
+	w->tree[0] = r;
 }
 
 /*************************************************************//**
-Copy a block of index entries.
-@return	TRUE on success, FALSE on failure */
+Merge a group of consecutive sorted runs into one run.  The output
+run is written to the output file starting at the offset of the first
+input run of the group.  It cannot be longer than the input runs
+together, so that the groups can be merged in parallel.
+@return	DB_SUCCESS or error code */
 static MY_ATTRIBUTE((nonnull, warn_unused_result))
-ibool
-row_merge_blocks_copy(
-/*==================*/
-	const dict_index_t*	index,	/*!< in: index being created */
-	const merge_file_t*	file,	/*!< in: input file */
-	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
-	ulint*			foffs0,	/*!< in/out: input file offset */
-	merge_file_t*		of)	/*!< in/out: output file */
+dberr_t
+row_merge_group(
+/*============*/
+	row_merge_worker_t*	w,	/*!< in/out: merge thread state */
+	ulint			group)	/*!< in: number of the group */
 {
-	mem_heap_t*	heap;	/*!< memory heap for offsets0, offsets1 */
+	const merge_file_t*	file	= w->file;
+	const dict_index_t*	index	= w->dup->index;
+	const ulint		first	= group * w->n_ways;
+	row_merge_block_t*	oblock;
+	byte*			ob;
+	ulint			ooffs;
+
+	ut_ad(first < w->n_run);
+
+	w->k = ut_min(w->n_ways, w->n_run - first);
+	w->dup_found = false;
 
-	mrec_buf_t*	buf;	/*!< buffer for handling
-				split mrec in block[] */
-	const byte*	b0;	/*!< pointer to block[0] */
-	byte*		b2;	/*!< pointer to block[2 * srv_sort_buf_size] */
-	const mrec_t*	mrec0;	/*!< merge rec, points to block[0] */
-	ulint*		offsets0;/* offsets of mrec0 */
-	ulint*		offsets1;/* dummy offsets */
+	ooffs = w->run_offset[first];
+	oblock = &w->block[w->n_ways * srv_sort_buf_size];
+	ob = oblock;
 
 #ifdef UNIV_DEBUG
+	const ulint	end_offset = first + w->k < w->n_run
+		? w->run_offset[first + w->k]
+		: file->offset;
+
 	if (row_merge_print_block) {
 		fprintf(stderr,
-			"row_merge_blocks_copy fd=%d ofs=%lu"
+			"row_merge_group fd=%d ofs=%lu runs=%lu"
 			" = fd=%d ofs=%lu\n",
-			file->fd, (ulong) foffs0,
-			of->fd, (ulong) of->offset);
+			file->fd, (ulong) ooffs, (ulong) w->k,
+			w->out_fd, (ulong) ooffs);
 	}
 #endif /* UNIV_DEBUG */
 
-	heap = row_merge_heap_create(index, &buf, &offsets0, &offsets1);
-
-	/* Write a record and read the next record.  Split the output
-	file in two halves, which can be merged on the following pass. */
+	for (ulint i = 0; i < w->k; i++) {
+		row_merge_block_t*	block
+			= &w->block[i * srv_sort_buf_size];
 
-	if (!row_merge_read(file->fd, *foffs0, &block[0])) {
-corrupt:
-		mem_heap_free(heap);
-		return(FALSE);
-	}
+		w->foffs[i] = w->run_offset[first + i];
 
-	b0 = &block[0];
+		if (!row_merge_read(file->fd, w->foffs[i], block)) {
+			return(DB_CORRUPTION);
+		}
 
-	b2 = &block[2 * srv_sort_buf_size];
+		w->b[i] = row_merge_read_rec(
+			block, &w->buf[i], block, index,
+			file->fd, &w->foffs[i], &w->mrec[i], w->offsets[i]);
 
-	b0 = row_merge_read_rec(&block[0], &buf[0], b0, index,
-				file->fd, foffs0, &mrec0, offsets0);
-	if (UNIV_UNLIKELY(!b0 && mrec0)) {
+		if (UNIV_UNLIKELY(!w->b[i] && w->mrec[i])) {
+			return(DB_CORRUPTION);
+		}
 
-		goto corrupt;
+		w->tree[i] = w->k;
 	}
 
-	if (mrec0) {
-		/* append all mrec0 to output */
-		for (;;) {
-			ROW_MERGE_WRITE_GET_NEXT(0, index, goto done0);
-		}
+	for (ulint i = w->k; i--; ) {
+		row_merge_tree_adjust(w, i);
 	}
-done0:
-
-	/* The file offset points to the beginning of the last page
-	that has been read.  Update it to point to the next block. */
-	(*foffs0)++;
-
-	mem_heap_free(heap);
-	return(row_merge_write_eof(&block[2 * srv_sort_buf_size],
-				   b2, of->fd, &of->offset)
-	       != NULL);
-}
-
-/*************************************************************//**
-Merge disk files.
-@return	DB_SUCCESS or error code */
-static MY_ATTRIBUTE((nonnull))
-dberr_t
-row_merge(
-/*======*/
-	trx_t*			trx,	/*!< in: transaction */
-	const row_merge_dup_t*	dup,	/*!< in: descriptor of
-					index being created */
-	merge_file_t*		file,	/*!< in/out: file containing
-					index entries */
-	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
-	int*			tmpfd,	/*!< in/out: temporary file handle */
-	ulint*			num_run,/*!< in/out: Number of runs remain
-					to be merged */
-	ulint*			run_offset) /*!< in/out: Array contains the
-					first offset number for each merge
-					run */
-{
-	ulint		foffs0;	/*!< first input offset */
-	ulint		foffs1;	/*!< second input offset */
-	dberr_t		error;	/*!< error code */
-	merge_file_t	of;	/*!< output file */
-	const ulint	ihalf	= run_offset[*num_run / 2];
-				/*!< half the input file */
-	ulint		n_run	= 0;
-				/*!< num of runs generated from this merge */
-
-	UNIV_MEM_ASSERT_W(&block[0], 3 * srv_sort_buf_size);
-
-	ut_ad(ihalf < file->offset);
 
-	of.fd = *tmpfd;
-	of.offset = 0;
-	of.n_rec = 0;
-
-#ifdef POSIX_FADV_SEQUENTIAL
-	/* The input file will be read sequentially, starting from the
-	beginning and the middle.  In Linux, the POSIX_FADV_SEQUENTIAL
-	affects the entire file.  Each block will be read exactly once. */
-	posix_fadvise(file->fd, 0, 0,
-		      POSIX_FADV_SEQUENTIAL | POSIX_FADV_NOREUSE);
-#endif /* POSIX_FADV_SEQUENTIAL */
+	for (;;) {
+		ulint	r = w->tree[0];
 
-	/* Merge blocks to the output file. */
-	foffs0 = 0;
-	foffs1 = ihalf;
+		if (UNIV_UNLIKELY(w->dup_found)) {
+			return(DB_DUPLICATE_KEY);
+		}
 
-	UNIV_MEM_INVALID(run_offset, *num_run * sizeof *run_offset);
+		if (w->mrec[r] == NULL) {
+			/* All runs have been exhausted. */
+			break;
+		}
 
-	for (; foffs0 < ihalf && foffs1 < file->offset; foffs0++, foffs1++) {
+		ob = row_merge_write_rec(oblock, &w->buf[w->n_ways], ob,
+					 w->out_fd, &ooffs,
+					 w->mrec[r], w->offsets[r]);
 
-		if (trx_is_interrupted(trx)) {
-			return(DB_INTERRUPTED);
+		if (UNIV_UNLIKELY(!ob || ++w->n_rec > file->n_rec)) {
+			return(DB_CORRUPTION);
 		}
 
-		/* Remember the offset number for this run */
-		run_offset[n_run++] = of.offset;
-
-		error = row_merge_blocks(dup, file, block,
-					 &foffs0, &foffs1, &of);
+		w->b[r] = row_merge_read_rec(
+			&w->block[r * srv_sort_buf_size], &w->buf[r],
+			w->b[r], index, file->fd, &w->foffs[r],
+			&w->mrec[r], w->offsets[r]);
 
-		if (error != DB_SUCCESS) {
-			return(error);
+		if (UNIV_UNLIKELY(!w->b[r] && w->mrec[r])) {
+			return(DB_CORRUPTION);
 		}
 
+		row_merge_tree_adjust(w, r);
 	}
 
-	/* Copy the last blocks, if there are any. */
-
-	while (foffs0 < ihalf) {
-		if (UNIV_UNLIKELY(trx_is_interrupted(trx))) {
-			return(DB_INTERRUPTED);
-		}
+	if (!row_merge_write_eof(oblock, ob, w->out_fd, &ooffs)) {
+		return(DB_CORRUPTION);
+	}
 
-		/* Remember the offset number for this run */
-		run_offset[n_run++] = of.offset;
+	ut_ad(ooffs <= end_offset);
 
-		if (!row_merge_blocks_copy(dup->index, file, block,
-					   &foffs0, &of)) {
-			return(DB_CORRUPTION);
-		}
+	if (ooffs > w->end_offset) {
+		w->end_offset = ooffs;
 	}
 
-	ut_ad(foffs0 == ihalf);
+	return(DB_SUCCESS);
+}
 
-	while (foffs1 < file->offset) {
-		if (trx_is_interrupted(trx)) {
-			return(DB_INTERRUPTED);
-		}
+/*************************************************************//**
+Merge the groups of a merge pass that are assigned to a thread. */
+static MY_ATTRIBUTE((nonnull))
+void
+row_merge_worker_pass(
+/*==================*/
+	row_merge_worker_t*	w)	/*!< in/out: merge thread state */
+{
+	const ulint	n_groups = (w->n_run + w->n_ways - 1) / w->n_ways;
 
-		/* Remember the offset number for this run */
-		run_offset[n_run++] = of.offset;
+	w->n_rec = 0;
+	w->end_offset = 0;
+	w->error = DB_SUCCESS;
 
-		if (!row_merge_blocks_copy(dup->index, file, block,
-					   &foffs1, &of)) {
-			return(DB_CORRUPTION);
+	for (ulint g = w->first; g < n_groups; g += w->step) {
+		if (*w->failed) {
+			break;
 		}
-	}
 
-	ut_ad(foffs1 == file->offset);
+		if (trx_is_interrupted(w->trx)) {
+			w->error = DB_INTERRUPTED;
+		} else {
+			w->error = row_merge_group(w, g);
+		}
 
-	if (UNIV_UNLIKELY(of.n_rec != file->n_rec)) {
-		return(DB_CORRUPTION);
+		if (w->error != DB_SUCCESS) {
+			*w->failed = TRUE;
+			break;
+		}
 	}
 
-	ut_ad(n_run <= *num_run);
-
-	*num_run = n_run;
+	UNIV_MEM_INVALID(w->block, w->block_size);
+}
 
-	/* Each run can contain one or more offsets. As merge goes on,
-	the number of runs (to merge) will reduce until we have one
-	single run. So the number of runs will always be smaller than
-	the number of offsets in file */
-	ut_ad((*num_run) <= file->offset);
+/*************************************************************//**
+Thread that merges groups of sorted runs in a merge pass.
+@return	a dummy parameter */
+extern "C" UNIV_INTERN
+os_thread_ret_t
+DECLARE_THREAD(row_merge_sort_thread)(
+/*==================================*/
+	void*	arg)	/*!< in/out: row_merge_worker_t */
+{
+	row_merge_worker_t*	w = static_cast<row_merge_worker_t*>(arg);
 
-	/* The number of offsets in output file is always equal or
-	smaller than input file */
-	ut_ad(of.offset <= file->offset);
+	row_merge_worker_pass(w);
 
-	/* Swap file descriptors for the next pass. */
-	*tmpfd = file->fd;
-	*file = of;
+	os_event_set(w->done);
 
-	UNIV_MEM_INVALID(&block[0], 3 * srv_sort_buf_size);
+	os_thread_exit(NULL, false);
 
-	return(DB_SUCCESS);
+	OS_THREAD_DUMMY_RETURN;
 }
 
 /*************************************************************//**
@@ -2352,13 +2444,17 @@ row_merge_sort(
 					index being created */
 	merge_file_t*		file,	/*!< in/out: file containing
 					index entries */
-	row_merge_block_t*	block,	/*!< in/out: 3 buffers */
-	int*			tmpfd)	/*!< in/out: temporary file handle */
+	int*			tmpfd,	/*!< in/out: temporary file handle */
+	ulint			n_threads)/*!< in: maximum number of
+					merge threads */
 {
-	const ulint	half	= file->offset / 2;
-	ulint		num_runs;
-	ulint*		run_offset;
-	dberr_t		error	= DB_SUCCESS;
+	const ulint		n_ways	= srv_merge_sort_ways;
+	ulint			num_runs;
+	ulint*			run_offset;
+	row_merge_worker_t*	workers;
+	ulint			n_workers;
+	volatile ibool		failed	= FALSE;
+	dberr_t			error	= DB_SUCCESS;
 	DBUG_ENTER("row_merge_sort");
 
 	/* Record the number of merge runs we need to perform */
@@ -2369,29 +2465,134 @@ row_merge_sort(
 		DBUG_RETURN(error);
 	}
 
-	/* "run_offset" records each run's first offset number */
-	run_offset = (ulint*) mem_alloc(file->offset * sizeof(ulint));
+	ut_ad(n_ways >= 2);
+	ut_ad(n_threads >= 1);
+
+	/* Only a single thread may report a duplicate key value,
+	because the record is converted to the MySQL table record. */
+	if (dup->table && dict_index_is_unique(dup->index)) {
+		n_threads = 1;
+	}
+
+	n_workers = ut_min(n_threads, (num_runs + n_ways - 1) / n_ways);
+
+	/* "run_offset" records each run's first offset number.
+	Initially, each block is a run of its own. */
+	run_offset = (ulint*) mem_alloc(num_runs * sizeof *run_offset);
+
+	for (ulint i = 0; i < num_runs; i++) {
+		run_offset[i] = i;
+	}
 
-	/* This tells row_merge() where to start for the first round
-	of merge. */
-	run_offset[half] = half;
+	workers = static_cast<row_merge_worker_t*>(
+		mem_zalloc(n_workers * sizeof *workers));
 
-	/* The file should always contain at least one byte (the end
-	of file marker).  Thus, it must be at least one block. */
-	ut_ad(file->offset > 0);
+	for (ulint i = 0; i < n_workers; i++) {
+		row_merge_worker_t*	w = &workers[i];
+
+		w->trx = trx;
+		w->dup = dup;
+		w->table = dup->table;
+		w->failed = &failed;
+
+		if (!row_merge_worker_create(w, n_ways)) {
+			error = DB_OUT_OF_MEMORY;
+			goto func_exit;
+		}
+	}
 
 	/* Merge the runs until we have one big run */
 	do {
-		error = row_merge(trx, dup, file, block, tmpfd,
-				  &num_runs, run_offset);
+		const ulint	n_groups = (num_runs + n_ways - 1) / n_ways;
+		const ulint	n_active = ut_min(n_workers, n_groups);
+		ulint		n_rec = 0;
+		ulint		end_offset = 0;
+
+#ifdef POSIX_FADV_SEQUENTIAL
+		/* Each run of the input file will be read sequentially.
+		In Linux, the POSIX_FADV_SEQUENTIAL affects the entire
+		file.  Each block will be read exactly once. */
+		posix_fadvise(file->fd, 0, 0,
+			      POSIX_FADV_SEQUENTIAL | POSIX_FADV_NOREUSE);
+#endif /* POSIX_FADV_SEQUENTIAL */
+
+		for (ulint i = 0; i < n_active; i++) {
+			row_merge_worker_t*	w = &workers[i];
+
+			w->file = file;
+			w->out_fd = *tmpfd;
+			w->run_offset = run_offset;
+			w->n_run = num_runs;
+			w->first = i;
+			w->step = n_active;
+
+			if (i > 0) {
+				os_event_reset(w->done);
+				w->thread = os_thread_create(
+					row_merge_sort_thread, w, NULL);
+			}
+		}
+
+		/* The calling thread merges its share, too. */
+		row_merge_worker_pass(&workers[0]);
+
+		for (ulint i = 0; i < n_active; i++) {
+			row_merge_worker_t*	w = &workers[i];
+
+			if (i > 0) {
+				os_event_wait(w->done);
+				os_thread_join(w->thread);
+			}
+
+			if (w->error != DB_SUCCESS) {
+				/* Prefer the error of the thread that
+				failed first over DB_INTERRUPTED. */
+				if (error == DB_SUCCESS
+				    || error == DB_INTERRUPTED) {
+					error = w->error;
+				}
+			}
+
+			n_rec += w->n_rec;
+			end_offset = ut_max(end_offset, w->end_offset);
+		}
 
 		if (error != DB_SUCCESS) {
 			break;
 		}
 
-		UNIV_MEM_ASSERT_RW(run_offset, num_runs * sizeof *run_offset);
+		if (UNIV_UNLIKELY(n_rec != file->n_rec)) {
+			error = DB_CORRUPTION;
+			break;
+		}
+
+		/* The output file is never longer than the input. */
+		ut_ad(end_offset <= file->offset);
+
+		/* Each group became a run starting at the offset of
+		its first input run. */
+		for (ulint i = 0; i < n_groups; i++) {
+			run_offset[i] = run_offset[i * n_ways];
+		}
+
+		UNIV_MEM_INVALID(run_offset + n_groups,
+				 (num_runs - n_groups) * sizeof *run_offset);
+
+		num_runs = n_groups;
+
+		/* Swap file descriptors for the next pass. */
+		int	fd = *tmpfd;
+		*tmpfd = file->fd;
+		file->fd = fd;
+		file->offset = end_offset;
 	} while (num_runs > 1);
 
+func_exit:
+	for (ulint i = 0; i < n_workers; i++) {
+		row_merge_worker_free(&workers[i]);
+	}
+
+	mem_free(workers);
 	mem_free(run_offset);
 
 	DBUG_RETURN(error);
@@ -2486,6 +2687,16 @@ row_merge_insert_index_tuples(
 	if (!row_merge_read(fd, foffs, block)) {
 		error = DB_CORRUPTION;
 	} else {
+		btr_cur_t	cursor;
+		mtr_t		mtr;
+		/* Whether mtr is holding the rightmost leaf page, with
+		the cursor positioned on the last inserted record. The
+		records arrive in ascending order and nobody else can
+		access the index yet, so that consecutive records are
+		appended to the same leaf in one mini-transaction
+		until the page fills up. */
+		bool		leaf_latched = false;
+
 		buf = static_cast<mrec_buf_t*>(
 			mem_heap_alloc(heap, sizeof *buf));
 
@@ -2495,8 +2706,6 @@ row_merge_insert_index_tuples(
 			ulint		n_ext;
 			big_rec_t*	big_rec;
 			rec_t*		rec;
-			btr_cur_t	cursor;
-			mtr_t		mtr;
 
 			b = row_merge_read_rec(block, buf, b, index,
 					       fd, &foffs, &mrec, offsets);
@@ -2552,22 +2761,30 @@ row_merge_insert_index_tuples(
 			}
 
 			ut_ad(dtuple_validate(dtuple));
-			log_free_check();
-
-			mtr_start(&mtr);
-			/* Insert after the last user record. */
-			btr_cur_open_at_index_side(
-				false, index, BTR_MODIFY_LEAF,
-				&cursor, 0, &mtr);
-			page_cur_position(
-				page_rec_get_prev(btr_cur_get_rec(&cursor)),
-				btr_cur_get_block(&cursor),
-				btr_cur_get_page_cur(&cursor));
-			cursor.flag = BTR_CUR_BINARY;
+
+			if (!leaf_latched) {
+				log_free_check();
+
+				mtr_start(&mtr);
+				/* Insert after the last user record. */
+				btr_cur_open_at_index_side(
+					false, index, BTR_MODIFY_LEAF,
+					&cursor, 0, &mtr);
+				page_cur_position(
+					page_rec_get_prev(
+						btr_cur_get_rec(&cursor)),
+					btr_cur_get_block(&cursor),
+					btr_cur_get_page_cur(&cursor));
+				cursor.flag = BTR_CUR_BINARY;
+				leaf_latched = true;
+			}
 #ifdef UNIV_DEBUG
 			/* Check that the records are inserted in order. */
 			rec = btr_cur_get_rec(&cursor);
 
+			ut_ad(page_rec_get_next(rec)
+			      == page_get_supremum_rec(page_align(rec)));
+
 			if (!page_rec_is_infimum(rec)) {
 				ulint*	rec_offsets = rec_get_offsets(
 					rec, index, offsets,
@@ -2585,8 +2802,11 @@ row_merge_insert_index_tuples(
 				dtuple, &rec, &big_rec, 0, NULL, &mtr);
 
 			if (error == DB_FAIL) {
+				/* The leaf page is full. Split it and
+				continue on the new rightmost leaf. */
 				ut_ad(!big_rec);
 				mtr_commit(&mtr);
+				log_free_check();
 				mtr_start(&mtr);
 				btr_cur_open_at_index_side(
 					false, index, BTR_MODIFY_TREE,
@@ -2603,6 +2823,11 @@ row_merge_insert_index_tuples(
 					| BTR_KEEP_SYS_FLAG | BTR_CREATE_FLAG,
 					&cursor, &ins_offsets, &ins_heap,
 					dtuple, &rec, &big_rec, 0, NULL, &mtr);
+
+				/* The mini-transaction is holding latches
+				on the whole tree. Release them before the
+				next record. */
+				leaf_latched = false;
 			}
 
 			if (!dict_index_is_clust(index)) {
@@ -2612,7 +2837,23 @@ row_merge_insert_index_tuples(
 					trx_id, &mtr);
 			}
 
-			mtr_commit(&mtr);
+			if (UNIV_LIKELY_NULL(big_rec)) {
+				/* The off-page columns are written in
+				mini-transactions of their own. */
+				leaf_latched = false;
+			}
+
+			if (leaf_latched && error == DB_SUCCESS) {
+				/* Position the cursor on the inserted
+				record, which is the last one on the
+				page. */
+				page_cur_position(
+					rec, btr_cur_get_block(&cursor),
+					btr_cur_get_page_cur(&cursor));
+			} else {
+				leaf_latched = false;
+				mtr_commit(&mtr);
+			}
 
 			if (UNIV_LIKELY_NULL(big_rec)) {
 				/* If the system crashes at this
@@ -2633,12 +2874,17 @@ row_merge_insert_index_tuples(
 			}
 
 			if (error != DB_SUCCESS) {
+				ut_ad(!leaf_latched);
 				goto err_exit;
 			}
 
 			mem_heap_empty(tuple_heap);
 			mem_heap_empty(ins_heap);
 		}
+
+		if (leaf_latched) {
+			mtr_commit(&mtr);
+		}
 	}
 
 err_exit:
@@ -3812,7 +4058,7 @@ wait_again:
 
 			error = row_merge_sort(
 				trx, &dup, &merge_files[i],
-				block, &tmpfd);
+				&tmpfd, srv_merge_sort_threads);
 
 			if (error == DB_SUCCESS) {
 				error = row_merge_insert_index_tuples(
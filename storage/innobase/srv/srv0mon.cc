@@ -52,6 +52,20 @@ Created 12/9/2009 Jimmy Yang
 #define MONITOR_BUF_PAGE_WRITTEN(name, description, code)	\
 	 MONITOR_BUF_PAGE(name, description, code, "written", PAGE_WRITTEN)
 
+/* Macro to standardize the names of the per partition counters in the
+"adaptive_hash_index" module */
+#define MONITOR_AHI_PART(n, op, description, code)			\
+	{"adaptive_hash_part" #n "_" op, "adaptive_hash_index",		\
+	 "Number of " description " in Adaptive Hash Index partition " #n, \
+	 MONITOR_NONE, MONITOR_DEFAULT_START,				\
+	 static_cast<monitor_id_t>(MONITOR_ADAPTIVE_HASH_PART_##code + n)}
+
+#define MONITOR_AHI_PART_HITS(n)					\
+	MONITOR_AHI_PART(n, "hits", "successful searches", HITS)
+
+#define MONITOR_AHI_PART_MISSES(n)					\
+	MONITOR_AHI_PART(n, "misses", "failed searches", MISSES)
+
 
 /** This array defines basic static information of monitor counters,
 including each monitor's name, module it belongs to, a short
@@ -440,6 +454,36 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_SET_MEMBER, MONITOR_FLUSH_BACKGROUND_TOTAL_PAGE,
 	 MONITOR_FLUSH_BACKGROUND_PAGES},
 
+	/* Counters for the page cleaner threads */
+	{"buffer_flush_page_cleaner_rounds", "buffer",
+	 "Number of rounds in which the page cleaner threads flushed"
+	 " the buffer pool instances",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_PC_ROUNDS},
+
+	{"buffer_flush_page_cleaner_round_usec", "buffer",
+	 "Time (in microseconds) spent in page cleaner rounds",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_PC_ROUND_MICROSECOND},
+
+	{"buffer_flush_page_cleaner_worker_instances", "buffer",
+	 "Number of buffer pool instances flushed by page cleaner"
+	 " worker threads instead of the coordinator",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_PC_WORKER_INSTANCES},
+
+	{"buffer_flush_page_cleaner_LRU_usec", "buffer",
+	 "Time (in microseconds) spent by the page cleaner threads"
+	 " flushing the LRU list tails",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_PC_LRU_MICROSECOND},
+
+	{"buffer_flush_page_cleaner_list_usec", "buffer",
+	 "Time (in microseconds) spent by the page cleaner threads"
+	 " flushing the flush lists",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_FLUSH_PC_LIST_MICROSECOND},
+
 	/* Cumulative counter for LRU batch scan */
 	{"buffer_LRU_batch_scanned", "buffer",
 	 "Total pages scanned as part of LRU batch",
@@ -855,6 +899,38 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_EXISTING | MONITOR_DEFAULT_ON),
 	 MONITOR_DEFAULT_START, MONITOR_OVLD_LOG_WRITES},
 
+	{"log_writer_writes", "recovery",
+	 "Number of log writes done by the log writer thread",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_WRITER_WRITES},
+
+	{"log_flusher_flushes", "recovery",
+	 "Number of log flushes to disk done by the log flusher thread",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_FLUSHER_FLUSHES},
+
+	{"log_flusher_flush_usec", "recovery",
+	 "Time (in microseconds) spent by the log flusher thread"
+	 " to flush the log to disk",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_FLUSHER_MICROSECOND},
+
+	{"log_write_waits", "recovery",
+	 "Number of waits for the log writer thread to write the log",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_WRITE_WAITS},
+
+	{"log_flush_waits", "recovery",
+	 "Number of waits for the log flusher thread to flush the log",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_FLUSH_WAITS},
+
+	{"log_wait_usec", "recovery",
+	 "Time (in microseconds) spent waiting for the log writer and"
+	 " flusher threads",
+	 MONITOR_NONE,
+	 MONITOR_DEFAULT_START, MONITOR_LOG_WAIT_MICROSECOND},
+
 	/* ========== Counters for Page Compression ========== */
 	{"module_compress", "compression", "Page Compression Info",
 	 MONITOR_MODULE,
@@ -961,6 +1037,40 @@ static monitor_info_t	innodb_counter_info[] =
 	 MONITOR_NONE,
 	 MONITOR_DEFAULT_START, MONITOR_ADAPTIVE_HASH_ROW_UPDATED},
 
+	MONITOR_AHI_PART_HITS(0),
+	MONITOR_AHI_PART_HITS(1),
+	MONITOR_AHI_PART_HITS(2),
+	MONITOR_AHI_PART_HITS(3),
+	MONITOR_AHI_PART_HITS(4),
+	MONITOR_AHI_PART_HITS(5),
+	MONITOR_AHI_PART_HITS(6),
+	MONITOR_AHI_PART_HITS(7),
+	MONITOR_AHI_PART_HITS(8),
+	MONITOR_AHI_PART_HITS(9),
+	MONITOR_AHI_PART_HITS(10),
+	MONITOR_AHI_PART_HITS(11),
+	MONITOR_AHI_PART_HITS(12),
+	MONITOR_AHI_PART_HITS(13),
+	MONITOR_AHI_PART_HITS(14),
+	MONITOR_AHI_PART_HITS(15),
+
+	MONITOR_AHI_PART_MISSES(0),
+	MONITOR_AHI_PART_MISSES(1),
+	MONITOR_AHI_PART_MISSES(2),
+	MONITOR_AHI_PART_MISSES(3),
+	MONITOR_AHI_PART_MISSES(4),
+	MONITOR_AHI_PART_MISSES(5),
+	MONITOR_AHI_PART_MISSES(6),
+	MONITOR_AHI_PART_MISSES(7),
+	MONITOR_AHI_PART_MISSES(8),
+	MONITOR_AHI_PART_MISSES(9),
+	MONITOR_AHI_PART_MISSES(10),
+	MONITOR_AHI_PART_MISSES(11),
+	MONITOR_AHI_PART_MISSES(12),
+	MONITOR_AHI_PART_MISSES(13),
+	MONITOR_AHI_PART_MISSES(14),
+	MONITOR_AHI_PART_MISSES(15),
+
 	/* ========== Counters for tablespace ========== */
 	{"module_file", "file_system", "Tablespace and File System Manager",
 	 MONITOR_MODULE,
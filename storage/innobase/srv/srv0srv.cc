@@ -143,6 +143,11 @@ on duplicate key checking and foreign key checking */
 UNIV_INTERN ibool	srv_locks_unsafe_for_binlog = FALSE;
 /** Sort buffer size in index creation */
 UNIV_INTERN ulong	srv_sort_buf_size = 1048576;
+/** Number of sorted runs merged at a time in index creation */
+UNIV_INTERN ulong	srv_merge_sort_ways = 8;
+/** Number of threads sorting the records in memory and merging
+sorted runs in index creation */
+UNIV_INTERN ulong	srv_merge_sort_threads = 4;
 /** Maximum modification log file size for online index creation */
 UNIV_INTERN unsigned long long	srv_online_max_size;
 
@@ -196,6 +201,9 @@ UNIV_INTERN ib_uint64_t	srv_log_file_size	= IB_UINT64_MAX;
 UNIV_INTERN ib_uint64_t	srv_log_file_size_requested;
 /* size in database pages */
 UNIV_INTERN ulint	srv_log_buffer_size	= ULINT_MAX;
+/** If TRUE, log_writer_thread and log_flusher_thread write and flush the
+log, and the committing threads wait for them */
+UNIV_INTERN my_bool	srv_log_writer_threads	= TRUE;
 UNIV_INTERN ulong	srv_flush_log_at_trx_commit = 1;
 UNIV_INTERN uint	srv_flush_log_at_timeout = 1;
 UNIV_INTERN ulong	srv_page_size		= UNIV_PAGE_SIZE_DEF;
@@ -231,6 +239,8 @@ UNIV_INTERN ulint	srv_buf_pool_size	= ULINT_MAX;
 UNIV_INTERN ulint       srv_buf_pool_instances  = 1;
 /* number of locks to protect buf_pool->page_hash */
 UNIV_INTERN ulong	srv_n_page_hash_locks = 16;
+/* number of mutexes to protect lock_sys->rec_hash */
+UNIV_INTERN ulong	srv_n_lock_sys_partitions = 16;
 /** Scan depth for LRU flush batch i.e.: number of blocks scanned*/
 UNIV_INTERN ulong	srv_LRU_scan_depth	= 1024;
 /** whether or not to flush neighbors of a block */
@@ -300,6 +310,20 @@ UNIV_INTERN ulong	srv_flushing_avg_loops		= 30;
 /* The number of purge threads to use.*/
 UNIV_INTERN ulong	srv_n_purge_threads = 1;
 
+/* The number of threads applying redo log records to pages in crash
+recovery, see recv_apply_hashed_log_recs(). */
+UNIV_INTERN ulong	srv_n_recv_apply_threads = 4;
+
+/* The number of page cleaner threads: buf_flush_page_cleaner_thread and
+srv_n_page_cleaners - 1 buf_flush_page_cleaner_worker threads. Capped by
+the number of buffer pool instances at startup. */
+UNIV_INTERN ulong	srv_n_page_cleaners = 4;
+
+/* Maximum memory in bytes for the parsed redo log records in crash
+recovery before they are applied in a batch, 0 means limited by the
+buffer pool size only */
+UNIV_INTERN ulong	srv_recv_max_memory = 0;
+
 /* the number of pages to purge in one batch */
 UNIV_INTERN ulong	srv_purge_batch_size = 20;
 
@@ -328,6 +352,10 @@ UNIV_INTERN ulong	srv_force_recovery_crash;
 
 UNIV_INTERN my_bool	srv_print_all_deadlocks = FALSE;
 
+/** Milliseconds between the deadlock searches of lock_deadlock_thread.
+When 0, every lock wait is checked for deadlocks when it is enqueued. */
+UNIV_INTERN ulong	srv_deadlock_detect_interval = 0;
+
 /** Enable INFORMATION_SCHEMA.innodb_cmp_per_index */
 UNIV_INTERN my_bool	srv_cmp_per_index_enabled = FALSE;
 
@@ -360,6 +388,11 @@ batch flushing i.e.: LRU flushing and flush_list flushing. The rest
 of the pages are used for single page flushing. */
 UNIV_INTERN ulong	srv_doublewrite_batch_size	= 120;
 
+/** If TRUE, batch flushes are doublewritten to one file per buffer pool
+instance and flush type instead of to the doublewrite blocks of the
+system tablespace. */
+UNIV_INTERN my_bool	srv_parallel_doublewrite	= TRUE;
+
 UNIV_INTERN ulong	srv_replication_delay		= 0;
 
 /*-------------------------------------------*/
@@ -611,6 +644,13 @@ and/or load it during startup. */
 UNIV_INTERN char	srv_buffer_pool_dump_at_shutdown = FALSE;
 UNIV_INTERN char	srv_buffer_pool_load_at_startup = FALSE;
 
+/** If TRUE, the buffer pool is dumped in the compact binary format */
+UNIV_INTERN char	srv_buffer_pool_dump_binary = FALSE;
+
+/** Interval in seconds between periodic buffer pool dumps, 0 disables
+them. */
+UNIV_INTERN ulong	srv_buffer_pool_dump_interval = 0;
+
 /** Slot index in the srv_sys->sys_threads array for the purge thread. */
 static const ulint	SRV_PURGE_SLOT	= 1;
 
@@ -1233,7 +1273,7 @@ srv_printf_innodb_monitor(
 	      "-------------------------------------\n", file);
 	ibuf_print(file);
 
-	ha_print_info(file, btr_search_sys->hash_index);
+	btr_search_print_info(file);
 
 	fprintf(file,
 		"%.2f hash searches/s, %.2f non-hash searches/s\n",
@@ -1881,6 +1921,12 @@ srv_any_background_threads_are_active(void)
 		thread_active = "srv_error_monitor_thread";
 	} else if (lock_sys->timeout_thread_active) {
 		thread_active = "srv_lock_timeout thread";
+	} else if (lock_sys->deadlock_thread_active) {
+		thread_active = "lock_deadlock_thread";
+	} else if (log_sys->writer_thread_active) {
+		thread_active = "log_writer_thread";
+	} else if (log_sys->flusher_thread_active) {
+		thread_active = "log_flusher_thread";
 	} else if (srv_monitor_active) {
 		thread_active = "srv_monitor_thread";
 	} else if (srv_buf_dump_thread_active) {
@@ -1893,6 +1939,9 @@ srv_any_background_threads_are_active(void)
 	os_event_set(srv_monitor_event);
 	os_event_set(srv_buf_dump_event);
 	os_event_set(lock_sys->timeout_event);
+	os_event_set(lock_sys->deadlock_event);
+	os_event_set(log_sys->writer_event);
+	os_event_set(log_sys->flusher_event);
 	os_event_set(dict_stats_event);
 
 	return(thread_active);
@@ -157,6 +157,9 @@ static const ulint SRV_UNDO_TABLESPACE_SIZE_IN_PAGES =
 /* Keys to register InnoDB threads with performance schema */
 UNIV_INTERN mysql_pfs_key_t	io_handler_thread_key;
 UNIV_INTERN mysql_pfs_key_t	srv_lock_timeout_thread_key;
+UNIV_INTERN mysql_pfs_key_t	srv_lock_deadlock_thread_key;
+UNIV_INTERN mysql_pfs_key_t	log_writer_thread_key;
+UNIV_INTERN mysql_pfs_key_t	log_flusher_thread_key;
 UNIV_INTERN mysql_pfs_key_t	srv_error_monitor_thread_key;
 UNIV_INTERN mysql_pfs_key_t	srv_monitor_thread_key;
 UNIV_INTERN mysql_pfs_key_t	srv_master_thread_key;
@@ -1853,6 +1856,8 @@ innobase_start_or_create_for_mysql(void)
 	srv_max_n_threads = 1   /* io_ibuf_thread */
 			    + 1 /* io_log_thread */
 			    + 1 /* lock_wait_timeout_thread */
+			    + 1 /* lock_deadlock_thread */
+			    + 2 /* log_writer_thread, log_flusher_thread */
 			    + 1 /* srv_error_monitor_thread */
 			    + 1 /* srv_monitor_thread */
 			    + 1 /* srv_master_thread */
@@ -1861,7 +1866,9 @@ innobase_start_or_create_for_mysql(void)
 			    + 1 /* dict_stats_thread */
 			    + 1 /* fts_optimize_thread */
 			    + 1 /* recv_writer_thread */
-			    + 1 /* buf_flush_page_cleaner_thread */
+			    + srv_n_recv_apply_threads /* recv_apply_thread */
+			    + srv_n_page_cleaners /* buf_flush_page_cleaner_thread
+						  and workers */
 			    + 1 /* trx_rollback_or_clean_all_recovered */
 			    + 128 /* added as margin, for use of
 				  InnoDB Memcached etc. */
@@ -1882,8 +1889,10 @@ innobase_start_or_create_for_mysql(void)
 	srv_boot();
 
 	ib_logf(IB_LOG_LEVEL_INFO,
-		"%s CPU crc32 instructions",
-		ut_crc32_sse2_enabled ? "Using" : "Not using");
+		"%s CPU crc32 instructions%s",
+		ut_crc32_sse2_enabled ? "Using" : "Not using",
+		ut_crc32_sse2_enabled && ut_crc32_pclmul_enabled
+		? " on 3 interleaved streams" : "");
 
 	if (!srv_read_only_mode) {
 
@@ -2465,6 +2474,10 @@ files_checked:
 			LOG_CHECKPOINT, LSN_MAX,
 			min_flushed_lsn, max_flushed_lsn);
 
+		/* The pages read from the doublewrite files are only
+		needed while recovery can restore torn pages. */
+		buf_dblwr_free_loaded_pages();
+
 		if (err != DB_SUCCESS) {
 
 			return(DB_ERROR);
@@ -2665,6 +2678,10 @@ files_checked:
 		buf_dblwr_create();
 	}
 
+	/* Recovery is over: the batches in the doublewrite files are
+	no longer needed. */
+	buf_dblwr_reset_files();
+
 	/* Here the double write buffer has already been created and so
 	any new rollback segments will be allocated after the double
 	write buffer. The default segment should already exist.
@@ -2701,6 +2718,17 @@ files_checked:
 			lock_wait_timeout_thread,
 			NULL, thread_ids + 2 + SRV_MAX_N_IO_THREADS);
 
+		/* Create the thread which searches for deadlocks when
+		innodb_deadlock_detect_interval is set */
+		os_thread_create(lock_deadlock_thread, NULL, NULL);
+
+		/* Create the threads which write and flush the log for
+		the committing transactions */
+		if (srv_log_writer_threads) {
+			os_thread_create(log_writer_thread, NULL, NULL);
+			os_thread_create(log_flusher_thread, NULL, NULL);
+		}
+
 		/* Create the thread which warns of long semaphore waits */
 		os_thread_create(
 			srv_error_monitor_thread,
@@ -2762,7 +2790,20 @@ files_checked:
 	}
 
 	if (!srv_read_only_mode) {
+		/* A worker thread would have no buffer pool instance
+		to flush in parallel with the others */
+		if (srv_n_page_cleaners > srv_buf_pool_instances) {
+			srv_n_page_cleaners = srv_buf_pool_instances;
+		}
+
+		buf_flush_page_cleaner_init(srv_n_page_cleaners - 1);
+
 		os_thread_create(buf_flush_page_cleaner_thread, NULL, NULL);
+
+		for (i = 1; i < srv_n_page_cleaners; i++) {
+			os_thread_create(buf_flush_page_cleaner_worker,
+					 NULL, NULL);
+		}
 	}
 
 #ifdef UNIV_DEBUG
@@ -3005,8 +3046,12 @@ innobase_shutdown_for_mysql(void)
 		HERE OR EARLIER */
 
 		if (!srv_read_only_mode) {
-			/* a. Let the lock timeout thread exit */
+			/* a. Let the lock timeout, deadlock and log threads
+			exit */
 			os_event_set(lock_sys->timeout_event);
+			os_event_set(lock_sys->deadlock_event);
+			os_event_set(log_sys->writer_event);
+			os_event_set(log_sys->flusher_event);
 
 			/* b. srv error monitor thread exits automatically,
 			no need to do anything here */
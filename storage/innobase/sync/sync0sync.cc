@@ -993,7 +993,7 @@ sync_thread_levels_nonempty_gen(
 
 /******************************************************************//**
 Checks if the level array for the current thread is empty,
-except for the btr_search_latch.
+except for an adaptive hash index partition latch.
 @return	a latch, or NULL if empty except the exceptions specified below */
 UNIV_INTERN
 void*
@@ -1001,7 +1001,8 @@ sync_thread_levels_nonempty_trx(
 /*============================*/
 	ibool	has_search_latch)
 				/*!< in: TRUE if and only if the thread
-				is supposed to hold btr_search_latch */
+				is supposed to hold a partition latch of
+				the adaptive hash index */
 {
 	ulint		i;
 	sync_arr_t*	arr;
@@ -1147,9 +1148,9 @@ sync_thread_add_level(
 	case SYNC_ANY_LATCH:
 	case SYNC_FILE_FORMAT_TAG:
 	case SYNC_DOUBLEWRITE:
-	case SYNC_SEARCH_SYS:
 	case SYNC_THREADS:
 	case SYNC_LOCK_SYS:
+	case SYNC_LOCK_SYS_LATCH:
 	case SYNC_LOCK_WAIT_SYS:
 	case SYNC_TRX_SYS:
 	case SYNC_IBUF_BITMAP_MUTEX:
@@ -1182,7 +1183,8 @@ sync_thread_add_level(
 		break;
 	case SYNC_BUF_FLUSH_LIST:
 	case SYNC_BUF_POOL:
-		/* We can have multiple mutexes of this type therefore we
+	case SYNC_SEARCH_SYS:
+		/* We can have multiple latches of this type therefore we
 		can only check whether the greater than condition holds. */
 		if (!sync_thread_levels_g(array, level-1, TRUE)) {
 			fprintf(stderr,
@@ -1208,6 +1210,16 @@ sync_thread_add_level(
 			ut_a(sync_thread_levels_contain(array, SYNC_BUF_POOL));
 		}
 		break;
+	case SYNC_LOCK_REC_HASH:
+		/* The thread must hold lock_sys->latch, and it is
+		allowed to own only ONE lock_sys->rec_hash partition
+		mutex unless it owns the lock_sys->mutex. */
+		ut_a(sync_thread_levels_contain(array, SYNC_LOCK_SYS_LATCH));
+		if (!sync_thread_levels_g(array, level, FALSE)) {
+			ut_a(sync_thread_levels_g(array, level - 1, TRUE));
+			ut_a(sync_thread_levels_contain(array, SYNC_LOCK_SYS));
+		}
+		break;
 	case SYNC_REC_LOCK:
 		if (sync_thread_levels_contain(array, SYNC_LOCK_SYS)) {
 			ut_a(sync_thread_levels_g(array, SYNC_REC_LOCK - 1,
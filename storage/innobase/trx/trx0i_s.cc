@@ -608,7 +608,7 @@ thd_done:
 		row->trx_foreign_key_error = NULL;
 	}
 
-	row->trx_has_search_latch = (ibool) trx->has_search_latch;
+	row->trx_has_search_latch = trx->has_search_latch != NULL;
 
 	row->trx_search_latch_timeout = trx->search_latch_timeout;
 
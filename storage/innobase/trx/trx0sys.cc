@@ -46,6 +46,7 @@ Created 3/26/1996 Heikki Tuuri
 #include "log0recv.h"
 #include "os0file.h"
 #include "read0read.h"
+#include "ut0counter.h"
 
 #ifdef WITH_WSREP
 #include "ha_prototypes.h" /* wsrep_is_wsrep_xid() */
@@ -708,6 +709,8 @@ trx_sys_init_at_db_start(void)
 			trx_sys->max_trx_id);
 	}
 
+	trx_sys_rw_trx_ids_init();
+
 	mutex_exit(&trx_sys->mutex);
 
 	UT_LIST_INIT(trx_sys->view_list);
@@ -1353,6 +1356,12 @@ trx_sys_close(void)
 	ut_a(UT_LIST_GET_LEN(trx_sys->ro_trx_list) == 0);
 	ut_a(UT_LIST_GET_LEN(trx_sys->rw_trx_list) == 0);
 	ut_a(UT_LIST_GET_LEN(trx_sys->mysql_trx_list) == 0);
+	ut_a(UT_LIST_GET_LEN(trx_sys->serialisation_list) == 0);
+	ut_a(trx_sys->n_rw_trx_ids == 0);
+
+	if (trx_sys->rw_trx_ids_mem != NULL) {
+		ut_free(trx_sys->rw_trx_ids_mem);
+	}
 
 	mutex_free(&trx_sys->mutex);
 
@@ -1361,6 +1370,139 @@ trx_sys_close(void)
 	trx_sys = NULL;
 }
 
+/*****************************************************************//**
+Makes room for at least one more id in trx_sys->rw_trx_ids. */
+static
+void
+trx_sys_rw_trx_ids_reserve(void)
+/*============================*/
+{
+	ulint		size;
+	void*		mem;
+	trx_id_t*	ids;
+
+	ut_ad(mutex_own(&trx_sys->mutex));
+
+	if (trx_sys->n_rw_trx_ids < trx_sys->rw_trx_ids_size) {
+		return;
+	}
+
+	size = ut_max(2 * trx_sys->rw_trx_ids_size, TRX_SYS_RW_TRX_IDS_MIN);
+
+	mem = ut_malloc(size * sizeof(*ids) + CACHE_LINE_SIZE);
+
+	ids = static_cast<trx_id_t*>(ut_align(mem, CACHE_LINE_SIZE));
+
+	if (trx_sys->n_rw_trx_ids > 0) {
+		memcpy(ids, trx_sys->rw_trx_ids,
+		       trx_sys->n_rw_trx_ids * sizeof(*ids));
+	}
+
+	if (trx_sys->rw_trx_ids_mem != NULL) {
+		ut_free(trx_sys->rw_trx_ids_mem);
+	}
+
+	trx_sys->rw_trx_ids_mem = mem;
+	trx_sys->rw_trx_ids = ids;
+	trx_sys->rw_trx_ids_size = size;
+}
+
+/*****************************************************************//**
+Adds the id of a read-write transaction that has just been started to
+trx_sys->rw_trx_ids. The id must be bigger than any id in the array. */
+UNIV_INTERN
+void
+trx_sys_rw_trx_id_add(
+/*==================*/
+	trx_id_t	id)	/*!< in: transaction id */
+{
+	ut_ad(mutex_own(&trx_sys->mutex));
+	ut_ad(trx_sys->n_rw_trx_ids == 0
+	      || trx_sys->rw_trx_ids[trx_sys->n_rw_trx_ids - 1] < id);
+
+	trx_sys_rw_trx_ids_reserve();
+
+	trx_sys->rw_trx_ids[trx_sys->n_rw_trx_ids++] = id;
+
+	++trx_sys->rw_trx_version;
+}
+
+/*****************************************************************//**
+Removes a read-write transaction from trx_sys->rw_trx_ids and from
+trx_sys->serialisation_list. Called before the transaction becomes
+committed in memory, so that read views created after that see its
+modifications. */
+UNIV_INTERN
+void
+trx_sys_rw_trx_id_remove(
+/*=====================*/
+	trx_t*		trx)	/*!< in/out: read-write transaction */
+{
+	ulint		pos;
+	trx_id_t*	ids = trx_sys->rw_trx_ids;
+
+	ut_ad(mutex_own(&trx_sys->mutex));
+	ut_ad(!trx->read_only);
+
+	pos = trx_sys_rw_trx_ids_find(trx->id);
+
+	ut_a(pos < trx_sys->n_rw_trx_ids);
+	ut_a(ids[pos] == trx->id);
+
+	memmove(&ids[pos], &ids[pos + 1],
+		(trx_sys->n_rw_trx_ids - pos - 1) * sizeof(*ids));
+
+	--trx_sys->n_rw_trx_ids;
+
+	/* A transaction is on the serialisation list if and only if
+	it has been assigned a serialisation number. */
+
+	if (trx->no != TRX_ID_MAX) {
+		UT_LIST_REMOVE(no_list, trx_sys->serialisation_list, trx);
+	}
+
+	++trx_sys->rw_trx_version;
+}
+
+/*****************************************************************//**
+Builds trx_sys->rw_trx_ids and trx_sys->serialisation_list from the
+recovered transactions in trx_sys->rw_trx_list at database start. */
+UNIV_INTERN
+void
+trx_sys_rw_trx_ids_init(void)
+/*=========================*/
+{
+	trx_t*	trx;
+
+	ut_a(srv_is_being_started);
+	ut_ad(mutex_own(&trx_sys->mutex));
+
+	UT_LIST_INIT(trx_sys->serialisation_list);
+
+	/* The rw_trx_list is sorted on trx id, biggest first. Recovered
+	transactions that were not committed are assigned trx->no equal
+	to their trx->id, therefore the serialisation list stays sorted
+	on trx->no, smallest first. */
+
+	for (trx = UT_LIST_GET_LAST(trx_sys->rw_trx_list);
+	     trx != NULL;
+	     trx = UT_LIST_GET_PREV(trx_list, trx)) {
+
+		ut_ad(trx->is_recovered);
+
+		if (trx_state_eq(trx, TRX_STATE_COMMITTED_IN_MEMORY)) {
+			continue;
+		}
+
+		trx_sys_rw_trx_id_add(trx->id);
+
+		if (trx->no != TRX_ID_MAX) {
+			UT_LIST_ADD_LAST(
+				no_list, trx_sys->serialisation_list, trx);
+		}
+	}
+}
+
 /*********************************************************************
 Check if there are any active (non-prepared) transactions.
 @return total number of active transactions or 0 if none */
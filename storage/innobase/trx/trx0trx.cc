@@ -236,6 +236,8 @@ trx_free(
 	ut_a(UT_LIST_GET_LEN(trx->lock.trx_locks) == 0);
 
 	if (trx->global_read_view_heap) {
+		read_view_free_for_mysql(trx);
+
 		mem_heap_free(trx->global_read_view_heap);
 	}
 
@@ -316,6 +318,12 @@ trx_free_prepared(
 
 	ut_a(!trx->read_only);
 
+	mutex_enter(&trx_sys->mutex);
+
+	trx_sys_rw_trx_id_remove(trx);
+
+	mutex_exit(&trx_sys->mutex);
+
 	UT_LIST_REMOVE(trx_list, trx_sys->rw_trx_list, trx);
 	ut_d(trx->in_rw_trx_list = FALSE);
 
@@ -860,8 +868,8 @@ trx_start_low(
         trx->xid.formatID = -1;
 #endif /* WITH_WSREP */
 
-	/* The initial value for trx->no: TRX_ID_MAX is used in
-	read_view_open_now: */
+	/* The initial value for trx->no: TRX_ID_MAX means that the
+	transaction is not on trx_sys->serialisation_list: */
 
 	trx->no = TRX_ID_MAX;
 
@@ -905,6 +913,8 @@ trx_start_low(
 			trx_sys->rw_max_trx_id = trx->id;
 		}
 #endif /* UNIV_DEBUG */
+
+		trx_sys_rw_trx_id_add(trx->id);
 	}
 
 	ut_ad(trx_sys_validate_trx_list());
@@ -932,8 +942,19 @@ trx_serialisation_number_get(
 
 	mutex_enter(&trx_sys->mutex);
 
+	/* A recovered XA PREPARED transaction is already on the
+	serialisation list with trx->no == trx->id. */
+
+	if (trx->no != TRX_ID_MAX) {
+		UT_LIST_REMOVE(no_list, trx_sys->serialisation_list, trx);
+	}
+
 	trx->no = trx_sys_get_new_trx_id();
 
+	UT_LIST_ADD_LAST(no_list, trx_sys->serialisation_list, trx);
+
+	++trx_sys->rw_trx_version;
+
 	/* If the rollack segment is not empty then the
 	new trx_t::no can't be less than any trx_t::no
 	already in the rollback segment. User threads only
@@ -1205,10 +1226,24 @@ trx_commit_in_memory(
 
 		trx->state = TRX_STATE_NOT_STARTED;
 
-		read_view_remove(trx->global_read_view, false);
+		if (trx->global_read_view != NULL) {
+			read_view_close_for_mysql(trx, false);
+		}
 
 		MONITOR_INC(MONITOR_TRX_NL_RO_COMMIT);
 	} else {
+		if (!trx->read_only) {
+			/* Read views that are created from now on must
+			see the modifications of the transaction, before
+			its locks are released. */
+
+			mutex_enter(&trx_sys->mutex);
+
+			trx_sys_rw_trx_id_remove(trx);
+
+			mutex_exit(&trx_sys->mutex);
+		}
+
 		lock_trx_release_locks(trx);
 
 		/* Remove the transaction from the list of active
@@ -1221,6 +1256,17 @@ trx_commit_in_memory(
 		assert_trx_in_list(trx);
 
 		if (trx->read_only) {
+			/* A read-only transaction that modified a
+			TEMPORARY table was assigned a serialisation
+			number, but it never was in rw_trx_ids. */
+
+			if (trx->no != TRX_ID_MAX) {
+				UT_LIST_REMOVE(no_list,
+					       trx_sys->serialisation_list,
+					       trx);
+				++trx_sys->rw_trx_version;
+			}
+
 			UT_LIST_REMOVE(trx_list, trx_sys->ro_trx_list, trx);
 			ut_d(trx->in_ro_trx_list = FALSE);
 			MONITOR_INC(MONITOR_TRX_RO_COMMIT);
@@ -1240,20 +1286,15 @@ trx_commit_in_memory(
 
 		/* We already own the trx_sys_t::mutex, by doing it here we
 		avoid a potential context switch later. */
-		read_view_remove(trx->global_read_view, true);
+		if (trx->global_read_view != NULL) {
+			read_view_close_for_mysql(trx, true);
+		}
 
 		ut_ad(trx_sys_validate_trx_list());
 
 		mutex_exit(&trx_sys->mutex);
 	}
 
-	if (trx->global_read_view != NULL) {
-
-		mem_heap_empty(trx->global_read_view_heap);
-
-		trx->global_read_view = NULL;
-	}
-
 	trx->read_view = NULL;
 
 	if (lsn) {
@@ -1506,8 +1547,7 @@ trx_assign_read_view(
 
 	if (!trx->read_view) {
 
-		trx->read_view = read_view_open_now(
-			trx->id, trx->global_read_view_heap);
+		trx->read_view = read_view_open_for_mysql(trx);
 
 		trx->global_read_view = trx->read_view;
 	}
@@ -0,0 +1,274 @@
+/* Copyright (c) 2015, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA */
+
+/*
+  Tests of the reservation of space in the redo log buffer.
+
+  In the concurrent test every thread commits mini-transactions of random
+  length like mtr_log_reserve_and_write() does: the space is reserved with
+  log_buffer_reserve() under log_sys->mutex, the log records are copied
+  with log_buffer_write() after releasing it and the range is marked as
+  copied with log_buffer_link(). Whenever the log buffer is half full, the
+  thread that holds log_sys->mutex waits for the copies to complete and
+  discards the buffer contents, like a log write does.
+*/
+
+// First include (the generated) my_config.h, to get correct platform defines,
+// then gtest.h (before any other MySQL headers), to avoid min() macros etc ...
+#include "my_config.h"
+#include <gtest/gtest.h>
+
+#include "univ.i"
+#include "log0log.h"
+#include "mem0mem.h"
+#include "os0sync.h"
+#include "os0thread.h"
+#include "srv0conc.h"
+#include "srv0srv.h"
+#include "sync0sync.h"
+#include "ut0mem.h"
+#include "ut0rnd.h"
+#include "ut0ut.h"
+
+#include "thread_utils.h"
+
+#include <vector>
+
+namespace innodb_log0log_unittest {
+
+/* mini-transactions committed by one thread */
+static const ulint n_mtr= 20000;
+/* maximum length of the log of a mini-transaction */
+static const ulint max_mtr_len= 1024;
+
+/* the equivalent of a log write followed by
+log_sys_check_flush_completion() */
+static void discard_log_buffer()
+{
+  ulint const move_start= ut_calc_align_down(log_sys->buf_free,
+                                             OS_FILE_LOG_BLOCK_SIZE);
+
+  log_buffer_wait_ready();
+  memmove(log_sys->buf, log_sys->buf + move_start, OS_FILE_LOG_BLOCK_SIZE);
+  log_sys->buf_free-= move_start;
+}
+
+class LogBufferTest : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    /* wait array slots, one per commit thread is enough */
+    srv_max_n_threads= 128;
+    /* 8 MiB log buffer */
+    srv_log_buffer_size= 8 * 1024 * 1024 / UNIV_PAGE_SIZE;
+    ut_mem_init();
+    os_sync_init();
+    sync_init();
+    mem_init(8 * 1024 * 1024);
+    log_init();
+  }
+
+  virtual void TearDown()
+  {
+    log_shutdown();
+    log_mem_free();
+    sync_close();
+    os_sync_free();
+    mem_close();
+    ut_free_all_mem();
+  }
+
+};
+
+
+TEST_F(LogBufferTest, WriteSkipsBlockHeaders)
+{
+  static const ulint len= 5 * OS_FILE_LOG_BLOCK_SIZE + 100;
+  byte str[len];
+
+  for (ulint i= 0; i < len; i++)
+    str[i]= static_cast<byte>(i % 251);
+
+  mutex_enter(&log_sys->mutex);
+  lsn_t const start_lsn= log_sys->lsn;
+  ulint const start_offset= log_sys->buf_free;
+  byte *ptr= log_buffer_reserve(len);
+  lsn_t const end_lsn= log_sys->lsn;
+  mutex_exit(&log_sys->mutex);
+
+  EXPECT_EQ(log_sys->buf + start_offset, ptr);
+  /* the string spans 6 blocks and thus 5 block boundaries */
+  EXPECT_EQ(len + 5 * (LOG_BLOCK_HDR_SIZE + LOG_BLOCK_TRL_SIZE),
+            end_lsn - start_lsn);
+  EXPECT_EQ(log_sys->buf + log_sys->buf_free,
+            log_buffer_write(ptr, str, len));
+
+  /* nothing has been linked yet */
+  mutex_enter(&log_sys->mutex);
+  EXPECT_EQ(start_lsn, log_sys->buf_ready_lsn);
+  log_buffer_link(start_lsn, end_lsn);
+  EXPECT_EQ(end_lsn, log_buffer_wait_ready());
+  mutex_exit(&log_sys->mutex);
+
+  ulint offset= start_offset;
+  for (ulint i= 0; i < len; i++)
+  {
+    if (offset % OS_FILE_LOG_BLOCK_SIZE
+        == OS_FILE_LOG_BLOCK_SIZE - LOG_BLOCK_TRL_SIZE)
+    {
+      const byte *block= log_sys->buf + offset - offset
+        % OS_FILE_LOG_BLOCK_SIZE;
+
+      EXPECT_EQ(OS_FILE_LOG_BLOCK_SIZE, log_block_get_data_len(block));
+      EXPECT_EQ(log_block_get_hdr_no(block) + 1,
+                log_block_get_hdr_no(block + OS_FILE_LOG_BLOCK_SIZE));
+      offset+= LOG_BLOCK_TRL_SIZE + LOG_BLOCK_HDR_SIZE;
+    }
+    ASSERT_EQ(str[i], log_sys->buf[offset]);
+    offset++;
+  }
+  EXPECT_EQ(log_sys->buf_free, offset);
+}
+
+
+TEST_F(LogBufferTest, LinkOutOfOrder)
+{
+  static const ulint n_ranges= 8;
+  lsn_t start_lsn[n_ranges + 1];
+  byte str[100];
+
+  memset(str, 0, sizeof str);
+
+  mutex_enter(&log_sys->mutex);
+  lsn_t const initial_lsn= log_sys->lsn;
+  for (ulint i= 0; i < n_ranges; i++)
+  {
+    start_lsn[i]= log_sys->lsn;
+    log_buffer_write(log_buffer_reserve(sizeof str), str, sizeof str);
+  }
+  start_lsn[n_ranges]= log_sys->lsn;
+
+  /* the ready lsn advances only over a contiguous prefix of the linked
+  ranges */
+  for (ulint i= n_ranges; i-- > 1; )
+    log_buffer_link(start_lsn[i], start_lsn[i + 1]);
+  log_buffer_link(initial_lsn, initial_lsn);
+  EXPECT_EQ(initial_lsn, log_sys->buf_ready_lsn);
+
+  log_buffer_link(start_lsn[0], start_lsn[1]);
+  EXPECT_EQ(start_lsn[n_ranges], log_buffer_wait_ready());
+  EXPECT_EQ(start_lsn[n_ranges], log_sys->buf_ready_lsn);
+  mutex_exit(&log_sys->mutex);
+
+  for (ulint i= 0; i < LOG_RECENT_WRITTEN_SIZE; i++)
+    ASSERT_EQ(0U, log_sys->recent_written[i]);
+}
+
+
+class Commit_thread : public thread::Thread
+{
+public:
+  explicit Commit_thread(ulint id)
+    : m_id(id), m_reserved(0)
+  {
+    for (ulint i= 0; i < max_mtr_len; i++)
+      m_log[i]= static_cast<byte>(m_id + i);
+  }
+
+  lsn_t reserved() const { return m_reserved; }
+
+protected:
+  virtual void run()
+  {
+    ulint rnd= ut_fold_ulint_pair(m_id, 0x9e3779b9);
+
+    for (ulint i= 0; i < n_mtr; i++)
+    {
+      rnd= ut_rnd_gen_next_ulint(rnd);
+      commit(16 + rnd % (max_mtr_len - 16));
+    }
+  }
+
+private:
+  void commit(ulint len)
+  {
+    mutex_enter(&log_sys->mutex);
+
+    while (!log_buffer_can_reserve())
+    {
+      /* like log_reserve_and_open() */
+      mutex_exit(&log_sys->mutex);
+      os_thread_yield();
+      mutex_enter(&log_sys->mutex);
+    }
+
+    if (log_sys->buf_free > log_sys->max_buf_free)
+      discard_log_buffer();
+
+    lsn_t const start_lsn= log_sys->lsn;
+    byte *ptr= log_buffer_reserve(len);
+    lsn_t const end_lsn= log_sys->lsn;
+
+#ifdef HAVE_ATOMIC_BUILTINS
+    mutex_exit(&log_sys->mutex);
+    log_buffer_write(ptr, m_log, len);
+    log_buffer_link(start_lsn, end_lsn);
+#else
+    /* log_buffer_link() needs log_sys->mutex */
+    log_buffer_write(ptr, m_log, len);
+    log_buffer_link(start_lsn, end_lsn);
+    mutex_exit(&log_sys->mutex);
+#endif /* HAVE_ATOMIC_BUILTINS */
+
+    m_reserved+= end_lsn - start_lsn;
+  }
+
+  ulint m_id;
+  lsn_t m_reserved;
+  byte  m_log[max_mtr_len];
+};
+
+
+TEST_F(LogBufferTest, ConcurrentCommit)
+{
+  static const ulint n_threads= 16;
+
+  mutex_enter(&log_sys->mutex);
+  lsn_t const start_lsn= log_sys->lsn;
+  mutex_exit(&log_sys->mutex);
+
+  std::vector<Commit_thread*> threads;
+  for (ulint i= 0; i < n_threads; i++)
+    threads.push_back(new Commit_thread(i + 1));
+
+  for (ulint i= 0; i < n_threads; i++)
+    threads[i]->start();
+  lsn_t reserved= 0;
+  for (ulint i= 0; i < n_threads; i++)
+  {
+    threads[i]->join();
+    reserved+= threads[i]->reserved();
+    delete threads[i];
+  }
+
+  /* the reserved ranges were contiguous and have all been copied */
+  mutex_enter(&log_sys->mutex);
+  EXPECT_EQ(start_lsn + reserved, log_sys->lsn);
+  EXPECT_EQ(log_sys->lsn, log_buffer_wait_ready());
+  mutex_exit(&log_sys->mutex);
+}
+
+}
@@ -0,0 +1,174 @@
+/* Copyright (c) 2015, Oracle and/or its affiliates. All rights reserved.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA */
+
+/*
+  Tests of the CRC32 implementations behind ut_crc32(), and a micro
+  benchmark of them.
+
+  Every implementation that the CPU supports must compute the same
+  CRC-32C as the portable slice-by-8 one, for any length and alignment.
+  The benchmark checksums 16KiB pages the way buf_calc_page_crc32() does
+  and prints the throughput of every implementation.
+*/
+
+// First include (the generated) my_config.h, to get correct platform defines,
+// then gtest.h (before any other MySQL headers), to avoid min() macros etc ...
+#include "my_config.h"
+#include <gtest/gtest.h>
+
+#include "univ.i"
+#include "fil0fil.h"
+#include "ut0crc32.h"
+#include "ut0rnd.h"
+#include "ut0ut.h"
+
+#include <string.h>
+#include <vector>
+
+namespace innodb_ut0crc32_unittest {
+
+/* pages checksummed by the benchmark, for every implementation */
+static const ulint n_pages= 20000;
+static const ulint page_size= 16384;
+
+/* keeps the benchmarked calls from being optimized away */
+static volatile ib_uint32_t crc_sink;
+
+struct Crc32_impl
+{
+  const char    *name;
+  ib_ut_crc32_t func;
+};
+
+class Crc32Test : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    ut_crc32_init();
+
+    Crc32_impl const slice8= { "slice8", ut_crc32_slice8 };
+    m_impls.push_back(slice8);
+    if (ut_crc32_sse2_enabled)
+    {
+      Crc32_impl const sse42= { "sse42", ut_crc32_sse42 };
+      m_impls.push_back(sse42);
+    }
+    if (ut_crc32_sse2_enabled && ut_crc32_pclmul_enabled)
+    {
+      Crc32_impl const sse42_3way= { "sse42_3way", ut_crc32_sse42_3way };
+      m_impls.push_back(sse42_3way);
+    }
+  }
+
+  std::vector<Crc32_impl> m_impls;
+};
+
+
+TEST_F(Crc32Test, KnownValue)
+{
+  static const char str[]= "123456789";
+
+  for (size_t i= 0; i < m_impls.size(); i++)
+    EXPECT_EQ(0xE3069283U,
+              m_impls[i].func(reinterpret_cast<const byte*>(str),
+                              sizeof str - 1))
+      << m_impls[i].name;
+
+  /* a page of zero bytes */
+  std::vector<byte> zero(page_size);
+  for (size_t i= 1; i < m_impls.size(); i++)
+    EXPECT_EQ(m_impls[0].func(&zero[0], page_size),
+              m_impls[i].func(&zero[0], page_size))
+      << m_impls[i].name;
+}
+
+
+TEST_F(Crc32Test, AllLengthsAndAlignments)
+{
+  static const ulint max_len= 3 * page_size + 100;
+  std::vector<byte> buf(max_len + 8);
+  ulint rnd= 1;
+
+  for (size_t i= 0; i < buf.size(); i++)
+  {
+    rnd= ut_rnd_gen_next_ulint(rnd);
+    buf[i]= static_cast<byte>(rnd);
+  }
+
+  for (ulint offset= 0; offset < 8; offset++)
+  {
+    for (ulint len= 0; len <= max_len;
+         len+= len < 2048 ? 1 : 1 + len % 61)
+    {
+      const byte *ptr= &buf[offset];
+      ib_uint32_t const expected= ut_crc32_slice8(ptr, len);
+
+      for (size_t i= 1; i < m_impls.size(); i++)
+        ASSERT_EQ(expected, m_impls[i].func(ptr, len))
+          << m_impls[i].name << " offset " << offset << " len " << len;
+    }
+  }
+}
+
+
+class Crc32Bench : public Crc32Test
+{
+protected:
+  /* returns the checksummed megabytes per second */
+  static double run(ib_ut_crc32_t func, const byte *pages, ulint n)
+  {
+    ib_uint32_t sum= 0;
+    ullint start;
+    ullint end;
+
+    ut_time_us(&start);
+    for (ulint i= 0; i < n_pages; i++)
+    {
+      const byte *page= pages + (i % n) * page_size;
+
+      /* like buf_calc_page_crc32() */
+      sum^= func(page + FIL_PAGE_OFFSET,
+                 FIL_PAGE_FILE_FLUSH_LSN - FIL_PAGE_OFFSET)
+        ^ func(page + FIL_PAGE_DATA,
+               page_size - FIL_PAGE_DATA - FIL_PAGE_END_LSN_OLD_CHKSUM);
+    }
+    ut_time_us(&end);
+    crc_sink= sum;
+
+    return static_cast<double>(n_pages) * page_size / (end - start + 1);
+  }
+};
+
+
+TEST_F(Crc32Bench, Pages)
+{
+  /* 64 pages, more than fit in the L1 cache */
+  static const ulint n= 64;
+  std::vector<byte> pages(n * page_size);
+  ulint rnd= 2;
+
+  for (size_t i= 0; i < pages.size(); i++)
+  {
+    rnd= ut_rnd_gen_next_ulint(rnd);
+    pages[i]= static_cast<byte>(rnd);
+  }
+
+  for (size_t i= 0; i < m_impls.size(); i++)
+    printf("# %-10s %8.0f MB/s\n",
+           m_impls[i].name, run(m_impls[i].func, &pages[0], n));
+}
+
+}
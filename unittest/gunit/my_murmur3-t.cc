@@ -19,6 +19,7 @@
 #include <gtest/gtest.h>
 
 #include "my_murmur3.h"
+#include "my_md5.h"
 
 /*
   Putting everything in a namespace prevents any (unintentional)
@@ -105,4 +106,102 @@ TEST(Murmur3, Bug16396598)
     EXPECT_GT(4U, buckets[i]);
 }
 
+
+/* Check 128-bit hash against reference values of x64 MurmurHash3. */
+
+TEST(Murmur3, Basic128)
+{
+  const char *str= "The quick brown fox jumps over the lazy dog";
+  uchar digest[MURMUR3_128_HASH_SIZE];
+
+  murmur3_128((const uchar *)str, strlen(str), 0, digest);
+  EXPECT_EQ(0xe34bbc7bbc071b6cULL, uint8korr(digest));
+  EXPECT_EQ(0x7a433ca9c49a9347ULL, uint8korr(digest + 8));
+
+  murmur3_128((const uchar *)"hello", 5, 0, digest);
+  EXPECT_EQ(0xcbd8a7b341bd9b02ULL, uint8korr(digest));
+  EXPECT_EQ(0x5b1e906a48ae1d19ULL, uint8korr(digest + 8));
+}
+
+
+/* Test for empty key. */
+
+TEST(Murmur3, Empty128)
+{
+  uchar digest[MURMUR3_128_HASH_SIZE];
+
+  murmur3_128(NULL, 0, 0, digest);
+  EXPECT_EQ(0ULL, uint8korr(digest));
+  EXPECT_EQ(0ULL, uint8korr(digest + 8));
+}
+
+
+/*
+  Hashing key in pieces of arbitrary size should give the same result
+  as hashing it in one go, as this is how rows are hashed field by field.
+*/
+
+TEST(Murmur3, Incremental128)
+{
+  uchar buff[100];
+  for (uint i= 0; i < sizeof(buff); ++i)
+    buff[i]= (uchar) (i * 7 + 3);
+
+  uchar expected[MURMUR3_128_HASH_SIZE];
+  murmur3_128(buff, sizeof(buff), 42, expected);
+
+  for (uint step= 1; step <= 33; ++step)
+  {
+    murmur3_128_ctx ctx;
+    uchar digest[MURMUR3_128_HASH_SIZE];
+
+    murmur3_128_init(&ctx, 42);
+    for (uint pos= 0; pos < sizeof(buff); pos+= step)
+      murmur3_128_update(&ctx, buff + pos,
+                         MY_MIN(step, sizeof(buff) - pos));
+    murmur3_128_final(&ctx, digest);
+    EXPECT_EQ(0, memcmp(expected, digest, sizeof(digest))) << "step " << step;
+  }
+}
+
+
+/*
+  Compare cost of MD5 and 128-bit MurmurHash3 on wide BLOB-like values,
+  which is what row hashing of tables without primary key boils down to.
+  Increase num_iterations to get meaningful timings.
+*/
+
+static const int num_iterations= 1;
+static const size_t wide_row_size= 64 * 1024;
+
+class Murmur3Bench : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    buff= new char[wide_row_size];
+    for (size_t i= 0; i < wide_row_size; ++i)
+      buff[i]= (char) (i * 31);
+  }
+  virtual void TearDown()
+  {
+    delete[] buff;
+  }
+  char *buff;
+};
+
+TEST_F(Murmur3Bench, WideRowMD5)
+{
+  char digest[MD5_HASH_SIZE];
+  for (int ix= 0; ix < num_iterations * 1000; ++ix)
+    compute_md5_hash(digest, buff, wide_row_size);
+}
+
+TEST_F(Murmur3Bench, WideRowMurmur3)
+{
+  uchar digest[MURMUR3_128_HASH_SIZE];
+  for (int ix= 0; ix < num_iterations * 1000; ++ix)
+    murmur3_128((const uchar *)buff, wide_row_size, 0, digest);
+}
+
 }  // namespace
@@ -0,0 +1,83 @@
+/* Copyright (C) 2015 Codership Oy <info@codership.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA */
+
+// First include (the generated) my_config.h, to get correct platform defines,
+// then gtest.h (before any other MySQL headers), to avoid min() macros etc ...
+#include "my_config.h"
+#include <gtest/gtest.h>
+
+#include "wsrep_hotkey.h"
+
+namespace wsrep_hotkey_unittest {
+
+/* spread test keys over the whole 64-bit range */
+static ulonglong key(ulonglong i)
+{
+  return (i + 1) * 0x9e3779b97f4a7c15ULL;
+}
+
+
+TEST(CmSketchTest, NeverUndercounts)
+{
+  wsp::cm_sketch *sketch= new wsp::cm_sketch;
+
+  for (ulonglong i= 0; i < 10000; ++i)
+    sketch->add(key(i), 1 + i % 7);
+
+  for (ulonglong i= 0; i < 10000; ++i)
+    EXPECT_LE(1 + i % 7, sketch->estimate(key(i)));
+
+  delete sketch;
+}
+
+
+TEST(CmSketchTest, HeavyHitter)
+{
+  wsp::cm_sketch *sketch= new wsp::cm_sketch;
+
+  uint32 hot= 0;
+  for (ulonglong i= 0; i < 20000; ++i)
+  {
+    sketch->add(key(i), 1);
+    if (i % 10 == 0) hot= sketch->add(key(1000000), 1);
+  }
+
+  /* 2000 hits on the hot key, little noise from 20000 unique keys */
+  EXPECT_LE(2000U, hot);
+  EXPECT_GT(2100U, hot);
+  EXPECT_EQ(hot, sketch->estimate(key(1000000)));
+  EXPECT_GT(10U, sketch->estimate(key(5)));
+
+  delete sketch;
+}
+
+
+TEST(CmSketchTest, Halve)
+{
+  wsp::cm_sketch *sketch= new wsp::cm_sketch;
+
+  EXPECT_EQ(0U, sketch->estimate(key(1)));
+  EXPECT_EQ(100U, sketch->add(key(1), 100));
+  sketch->halve();
+  EXPECT_EQ(50U, sketch->estimate(key(1)));
+  sketch->halve();
+  EXPECT_EQ(25U, sketch->estimate(key(1)));
+  sketch->clear();
+  EXPECT_EQ(0U, sketch->estimate(key(1)));
+
+  delete sketch;
+}
+
+}
@@ -0,0 +1,317 @@
+/* Copyright (C) 2015 Codership Oy <info@codership.com>
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; version 2 of the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA */
+
+// First include (the generated) my_config.h, to get correct platform defines,
+// then gtest.h (before any other MySQL headers), to avoid min() macros etc ...
+#include "my_config.h"
+#include <gtest/gtest.h>
+
+#include "wsrep_ws_log.h"
+#include "my_sys.h"
+#include "m_string.h"
+
+#include <vector>
+
+namespace wsrep_ws_log_unittest {
+
+static const wsrep_uuid_t uuid1= {{ 1, }};
+static const wsrep_uuid_t uuid2= {{ 2, }};
+
+class WsLogTest : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    fn_format(m_path, "wsrep_ws_log-t.log", DATA_DIR, "", MYF(0));
+    fn_format(m_joiner_path, "wsrep_ws_log-t.joiner", DATA_DIR, "", MYF(0));
+    fn_format(m_stream_path, "wsrep_ws_log-t.stream", DATA_DIR, "", MYF(0));
+    my_delete(m_path, MYF(0));
+    my_delete(m_joiner_path, MYF(0));
+    my_delete(m_stream_path, MYF(0));
+  }
+
+  virtual void TearDown()
+  {
+    my_delete(m_path, MYF(0));
+    my_delete(m_joiner_path, MYF(0));
+    my_delete(m_stream_path, MYF(0));
+  }
+
+  /* write set payload derived from seqno so that it can be verified */
+  static size_t fill(wsrep_seqno_t seqno, uchar* buf)
+  {
+    size_t const len= 100 + (seqno * 37) % 300;
+    for (size_t i= 0; i < len; ++i)
+      buf[i]= (uchar) (seqno + i);
+    return len;
+  }
+
+  static void verify(wsp::ws_log& log, wsrep_seqno_t seqno)
+  {
+    uchar  expected[512];
+    size_t const expected_len= fill(seqno, expected);
+    uchar* buf= NULL;
+    size_t len= 0;
+    uint32 flags= 0;
+    ASSERT_EQ(0, log.read(seqno, &buf, &len, &flags)) << "seqno " << seqno;
+    EXPECT_EQ(WSREP_FLAG_COMMIT, flags);
+    EXPECT_EQ(expected_len, len);
+    EXPECT_EQ(0, memcmp(expected, buf, len));
+    my_free(buf);
+  }
+
+  static void append(wsp::ws_log& log, wsrep_seqno_t seqno)
+  {
+    uchar  buf[512];
+    size_t const len= fill(seqno, buf);
+    EXPECT_EQ(0, log.append(uuid1, seqno, WSREP_FLAG_COMMIT, buf, len));
+  }
+
+  static bool is_skip(wsp::ws_log& log, wsrep_seqno_t seqno)
+  {
+    uchar* buf= NULL;
+    size_t len= 0;
+    uint32 flags= 0;
+    if (log.read(seqno, &buf, &len, &flags)) return false;
+    my_free(buf);
+    return len == 0 && flags == wsp::ws_log::flag_skip;
+  }
+
+  /* joiner side of a transfer: write sets go to the joiner's own log */
+  static int apply(void* ctx, wsrep_seqno_t seqno, uint32 flags,
+                   const void* buf, size_t len)
+  {
+    return ((wsp::ws_log*) ctx)->append(uuid1, seqno, flags, buf, len);
+  }
+
+  static int count(void* ctx, wsrep_seqno_t seqno, uint32 flags,
+                   const void* buf, size_t len)
+  {
+    ++*(int*) ctx;
+    return 0;
+  }
+
+  char m_path[FN_REFLEN];
+  char m_joiner_path[FN_REFLEN];
+  char m_stream_path[FN_REFLEN];
+};
+
+
+TEST_F(WsLogTest, AppendRead)
+{
+  wsp::ws_log log;
+  ASSERT_EQ(0, log.open(m_path, 1024 * 1024));
+  EXPECT_EQ(WSREP_SEQNO_UNDEFINED, log.first());
+
+  for (wsrep_seqno_t s= 1; s <= 100; ++s)
+    append(log, s);
+
+  EXPECT_EQ(1, log.first());
+  EXPECT_EQ(100, log.last());
+  for (wsrep_seqno_t s= 1; s <= 100; ++s)
+    verify(log, s);
+
+  uchar* buf;
+  size_t len;
+  uint32 flags;
+  EXPECT_EQ(-ENOENT, log.read(101, &buf, &len, &flags));
+  EXPECT_TRUE(log.covers(uuid1, 1, 100));
+  EXPECT_FALSE(log.covers(uuid1, 1, 101));
+  EXPECT_FALSE(log.covers(uuid2, 1, 100));
+
+  /* an out of order write set means that a skip was logged for it */
+  uchar data[8]= { 0, };
+  EXPECT_EQ(-ERANGE, log.append(uuid1, 50, WSREP_FLAG_COMMIT,
+                                data, sizeof(data)));
+  EXPECT_FALSE(log.covers(uuid1, 50, 100));
+  EXPECT_EQ(WSREP_SEQNO_UNDEFINED, log.first());
+  append(log, 101);
+  EXPECT_EQ(101, log.first());
+  EXPECT_TRUE(log.covers(uuid1, 101, 101));
+}
+
+
+TEST_F(WsLogTest, Skips)
+{
+  wsp::ws_log log;
+  ASSERT_EQ(0, log.open(m_path, 1024 * 1024));
+
+  log.position(uuid1, 10);
+  append(log, 12);
+  append(log, 13);
+  append(log, 16);
+  EXPECT_EQ(11, log.first());
+  EXPECT_EQ(16, log.last());
+  EXPECT_TRUE(log.covers(uuid1, 11, 16));
+  EXPECT_TRUE(is_skip(log, 11));
+  EXPECT_TRUE(is_skip(log, 14));
+  EXPECT_TRUE(is_skip(log, 15));
+  verify(log, 16);
+
+  /* donor logs seqnos which it knows committed nothing */
+  EXPECT_EQ(0, log.append(uuid1, 18, wsp::ws_log::flag_skip, NULL, 0));
+  EXPECT_EQ(-EEXIST, log.append(uuid1, 18, wsp::ws_log::flag_skip, NULL, 0));
+  EXPECT_TRUE(log.covers(uuid1, 11, 18));
+  EXPECT_TRUE(is_skip(log, 17));
+
+  /* state transfer leaves the log behind: history restarts */
+  log.position(uuid1, 18);
+  EXPECT_TRUE(log.covers(uuid1, 11, 18));
+  log.position(uuid1, 30);
+  EXPECT_FALSE(log.covers(uuid1, 11, 18));
+  EXPECT_TRUE(log.covers(uuid1, 31, 30));
+  append(log, 31);
+  EXPECT_TRUE(log.covers(uuid1, 31, 31));
+}
+
+
+TEST_F(WsLogTest, WrapAround)
+{
+  wsp::ws_log log;
+  ASSERT_EQ(0, log.open(m_path, 16 * 1024));
+
+  for (wsrep_seqno_t s= 1; s <= 1000; ++s)
+    append(log, s);
+
+  /* oldest write sets are evicted, the rest is contiguous and intact */
+  wsrep_seqno_t const first= log.first();
+  EXPECT_LT(1, first);
+  EXPECT_EQ(1000, log.last());
+  for (wsrep_seqno_t s= first; s <= 1000; ++s)
+    verify(log, s);
+
+  uchar  big[10 * 1024]= { 0, };
+  EXPECT_EQ(-EMSGSIZE, log.append(uuid1, 1001, WSREP_FLAG_COMMIT,
+                                  big, sizeof(big)));
+  EXPECT_FALSE(log.covers(uuid1, first, 1001));
+  append(log, 1002);
+  EXPECT_TRUE(log.covers(uuid1, 1002, 1002));
+}
+
+
+TEST_F(WsLogTest, Recovery)
+{
+  wsrep_seqno_t first;
+  {
+    wsp::ws_log log;
+    ASSERT_EQ(0, log.open(m_path, 16 * 1024));
+    for (wsrep_seqno_t s= 1; s <= 500; ++s)
+      append(log, s);
+    first= log.first();
+  }
+
+  wsp::ws_log log;
+  ASSERT_EQ(0, log.open(m_path, 16 * 1024));
+  wsrep_uuid_t uuid;
+  log.uuid(&uuid);
+  EXPECT_EQ(0, memcmp(&uuid1, &uuid, sizeof(uuid)));
+  EXPECT_EQ(first, log.first());
+  EXPECT_EQ(500, log.last());
+  for (wsrep_seqno_t s= first; s <= 500; ++s)
+    verify(log, s);
+
+  /* log continues after reopen */
+  append(log, 501);
+  verify(log, 501);
+
+  /* new history restarts the log */
+  uchar data[8]= { 0, };
+  EXPECT_EQ(0, log.append(uuid2, 1, WSREP_FLAG_COMMIT, data, sizeof(data)));
+  EXPECT_EQ(1, log.first());
+  EXPECT_EQ(1, log.last());
+}
+
+
+/*
+  Donor serves a range to joiner as the native SST method does, with a file
+  standing in for the socket and the dummy provider for the real one.
+*/
+TEST_F(WsLogTest, Transfer)
+{
+  wsrep_t* provider= NULL;
+  ASSERT_EQ(0, wsrep_load(WSREP_NONE, &provider, NULL));
+
+  wsp::ws_log donor;
+  ASSERT_EQ(0, donor.open(m_path, 1024 * 1024));
+  for (wsrep_seqno_t s= 1; s <= 50; ++s)
+    if (s % 7) append(donor, s);
+  donor.append(uuid1, 52, wsp::ws_log::flag_skip, NULL, 0);
+
+  /* joiner is at seqno 20 */
+  wsp::ws_log joiner;
+  ASSERT_EQ(0, joiner.open(m_joiner_path, 1024 * 1024));
+  joiner.position(uuid1, 20);
+  ASSERT_TRUE(donor.covers(uuid1, 21, 52));
+
+  File out= my_open(m_stream_path, O_RDWR | O_CREAT | O_TRUNC, MYF(MY_WME));
+  ASSERT_LE(0, out);
+  ASSERT_EQ(0, donor.serve(21, 52, wsp::ws_stream_file_write, &out));
+  my_close(out, MYF(0));
+
+  wsrep_gtid_t const sent= { uuid1, 52 };
+  EXPECT_EQ(WSREP_OK, provider->sst_sent(provider, &sent, 0));
+
+  File in= my_open(m_stream_path, O_RDONLY, MYF(MY_WME));
+  ASSERT_LE(0, in);
+  wsrep_seqno_t last;
+  EXPECT_EQ(0, wsp::ws_stream_get(wsp::ws_stream_file_read, &in, 21,
+                                  apply, &joiner, &last));
+  my_close(in, MYF(0));
+  EXPECT_EQ(52, last);
+  EXPECT_EQ(WSREP_OK, provider->sst_received(provider, &sent, NULL, 0, 0));
+
+  /* joiner keeps its history going */
+  EXPECT_TRUE(joiner.covers(uuid1, 21, 52));
+  for (wsrep_seqno_t s= 21; s <= 50; ++s)
+  {
+    if (s % 7) verify(joiner, s);
+    else EXPECT_TRUE(is_skip(joiner, s));
+  }
+  EXPECT_TRUE(is_skip(joiner, 51));
+  EXPECT_TRUE(is_skip(joiner, 52));
+
+  /* a stream which does not continue joiner state is refused */
+  int records= 0;
+  in= my_open(m_stream_path, O_RDWR, MYF(MY_WME));
+  EXPECT_EQ(-EPROTO, wsp::ws_stream_get(wsp::ws_stream_file_read, &in, 20,
+                                        count, &records, &last));
+  EXPECT_EQ(0, records);
+
+  /* so is a damaged one */
+  uchar byte;
+  my_pread(in, &byte, 1, 40, MYF(MY_NABP));
+  byte^= 0xff;
+  my_pwrite(in, &byte, 1, 40, MYF(MY_NABP));
+  my_seek(in, 0, MY_SEEK_SET, MYF(0));
+  EXPECT_EQ(-EPROTO, wsp::ws_stream_get(wsp::ws_stream_file_read, &in, 21,
+                                        count, &records, &last));
+  EXPECT_EQ(0, records);
+  EXPECT_EQ(20, last);
+
+  /* and a truncated one */
+  byte^= 0xff;
+  my_pwrite(in, &byte, 1, 40, MYF(MY_NABP));
+  my_chsize(in, my_seek(in, 0, MY_SEEK_END, MYF(0)) - 30, 0, MYF(0));
+  my_seek(in, 0, MY_SEEK_SET, MYF(0));
+  EXPECT_EQ(-EIO, wsp::ws_stream_get(wsp::ws_stream_file_read, &in, 21,
+                                     count, &records, &last));
+  EXPECT_EQ(31, records);
+  EXPECT_EQ(51, last);
+  my_close(in, MYF(0));
+
+  wsrep_unload(provider);
+}
+
+}
@@ -20,13 +20,26 @@
 
 #include <errno.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 
+/*! Dummy backend stats variables */
+enum wsrep_dummy_stats
+{
+    DUMMY_STATS_DATA_COPIED,
+    DUMMY_STATS_DATA_REFERENCED,
+    DUMMY_STATS_MAX
+};
+
 /*! Dummy backend context. */
 typedef struct wsrep_dummy
 {
     wsrep_log_cb_t log_fn;
     char* options;
+    /* scratch buffer to emulate provider copying appended data */
+    void*  data_buf;
+    size_t data_buf_size;
+    struct wsrep_stats_var stats[DUMMY_STATS_MAX + 1];
 } wsrep_dummy_t;
 
 /* Get pointer to wsrep_dummy context from wsrep_t pointer */
@@ -48,6 +61,7 @@ static void dummy_free(wsrep_t *w)
         free(WSREP_DUMMY(w)->options);
         WSREP_DUMMY(w)->options = NULL;
     }
+    free(WSREP_DUMMY(w)->data_buf);
     free(w->ctx);
     w->ctx = NULL;
 }
@@ -170,15 +184,40 @@ static wsrep_status_t dummy_append_key(
     return WSREP_OK;
 }
 
+/*
+ * Appended data is not stored anywhere, but copying is emulated so that
+ * the cost of copy vs. by-reference hand-off can be measured against this
+ * backend. Byte counts are reported in stats.
+ */
 static wsrep_status_t dummy_append_data(
     wsrep_t* w,
     wsrep_ws_handle_t*      ws_handle  __attribute__((unused)),
-    const struct wsrep_buf* data       __attribute__((unused)),
-    const size_t            count      __attribute__((unused)),
+    const struct wsrep_buf* data,
+    const size_t            count,
     const wsrep_data_type_t type       __attribute__((unused)),
-    const bool              copy       __attribute__((unused)))
-{
-    WSREP_DBUG_ENTER(w);
+    const bool              copy)
+{
+    wsrep_dummy_t* const d = WSREP_DUMMY(w);
+    size_t i;
+
+    WSREP_DBUG_ENTER(w);
+
+    for (i = 0; i < count; ++i) {
+        if (copy) {
+            if (data[i].len > d->data_buf_size) {
+                void* const tmp = realloc(d->data_buf, data[i].len);
+                if (!tmp) return WSREP_FATAL;
+                d->data_buf = tmp;
+                d->data_buf_size = data[i].len;
+            }
+            memcpy(d->data_buf, data[i].ptr, data[i].len);
+            d->stats[DUMMY_STATS_DATA_COPIED].value._int64 += data[i].len;
+        }
+        else {
+            d->stats[DUMMY_STATS_DATA_REFERENCED].value._int64 += data[i].len;
+        }
+    }
+
     return WSREP_OK;
 }
 
@@ -272,14 +311,16 @@ static wsrep_status_t dummy_snapshot(
     return WSREP_OK;
 }
 
-static struct wsrep_stats_var dummy_stats[] = {
-    { NULL, WSREP_VAR_STRING, { 0 } }
+static const struct wsrep_stats_var dummy_stats[] = {
+    { "dummy_data_copied",     WSREP_VAR_INT64,  { 0 } },
+    { "dummy_data_referenced", WSREP_VAR_INT64,  { 0 } },
+    { NULL,                    WSREP_VAR_STRING, { 0 } }
 };
 
 static struct wsrep_stats_var* dummy_stats_get (wsrep_t* w)
 {
     WSREP_DBUG_ENTER(w);
-    return dummy_stats;
+    return WSREP_DUMMY(w)->stats;
 }
 
 static void dummy_stats_free (
@@ -292,6 +333,8 @@ static void dummy_stats_free (
 static void dummy_stats_reset (wsrep_t* w)
 {
     WSREP_DBUG_ENTER(w);
+    WSREP_DUMMY(w)->stats[DUMMY_STATS_DATA_COPIED].value._int64 = 0;
+    WSREP_DUMMY(w)->stats[DUMMY_STATS_DATA_REFERENCED].value._int64 = 0;
 }
 
 static wsrep_seqno_t dummy_pause (wsrep_t* w)
@@ -402,6 +445,9 @@ int wsrep_dummy_loader(wsrep_t* w)
     // initialize private context
     WSREP_DUMMY(w)->log_fn = NULL;
     WSREP_DUMMY(w)->options = NULL;
+    WSREP_DUMMY(w)->data_buf = NULL;
+    WSREP_DUMMY(w)->data_buf_size = 0;
+    memcpy(WSREP_DUMMY(w)->stats, dummy_stats, sizeof(dummy_stats));
 
     return 0;
 }